@@ -69,6 +69,25 @@ address field should be ignored. The address is either a part of the data or thi
 frame that doesn't require an address*/
 #define I2C_TRANSFER_OPTIONS_NO_ADDRESS		0x00000040
 
+/* The device's buffers are purged before a transfer only if an earlier transfer failed and left
+them in an unknown state. Setting this bit forces the purge */
+#define I2C_TRANSFER_OPTIONS_PURGE			0x00000080
+
+/* Flags of I2C_Msg, used by I2C_Transfer */
+/* The message reads from the slave, otherwise it writes to it */
+#define I2C_MSG_READ			0x00000001
+
+/* Don't generate a repeated START and don't send the address. The data of the message
+continues the previous message, in the same direction */
+#define I2C_MSG_NO_START		0x00000002
+
+/* Don't fail the transfer if the slave nAcks the address or a byte written in this message */
+#define I2C_MSG_IGNORE_NACK		0x00000004
+
+/* End the message with a STOP, the next message starts with a START. Needed e.g. by bus
+switches, which only apply a new channel selection on STOP */
+#define I2C_MSG_STOP			0x00000008
+
 #define I2C_CMD_GETDEVICEID_RD	0xF9
 #define I2C_CMD_GETDEVICEID_WR	0xF8
 
@@ -84,6 +103,22 @@ HIGH is supported only in FT232H chip. This feature is called DriveOnlyZero feat
 enabled when the following bit is set in the options parameter in function I2C_Init */
 #define I2C_ENABLE_DRIVE_ONLY_ZERO	0x0002
 
+/* Clock stretching by slaves is supported on hi-speed chips(FT2232H, FT4232H & FT232H) when this
+bit is set in ConfigOptions. The MPSSE is put in adaptive clocking mode, in which it waits for
+SCL to go high before continuing. SCL has to be connected to GPIOL3(ADBUS7) as well */
+#define I2C_ENABLE_CLOCK_STRETCHING	0x0004
+
+/* Fast initialization: the device isn't reset and the MPSSE isn't reset/re-enabled when it is
+found already running(e.g. when a channel is reopened), and the fixed waits are replaced by
+waiting for the MPSSE to echo a command. Setting this bit in ConfigOptions selects it */
+#define I2C_ENABLE_FAST_INIT		0x0080
+
+/* Calibration: after initialization the latency timer and the USB transfer sizes are measured on
+the device and the best ones for short register accesses(latency) or block transfers(throughput)
+are applied, overriding LatencyTimer. Setting one of these bits in ConfigOptions selects it */
+#define I2C_CALIBRATE_LATENCY		0x0100
+#define I2C_CALIBRATE_THROUGHPUT	0x0200
+
 
 
 /******************************************************************************/
@@ -126,6 +161,23 @@ typedef struct ChannelConfig_t
 	uint32			Options;
 }ChannelConfig;
 
+/* Transport settings of a channel(FT_TransportProfile) and the workload classes */
+#include "libMPSSE_profile.h"
+
+
+/* One segment of a combined I2C transaction(see I2C_Transfer) */
+typedef struct I2C_Msg_t
+{
+	uint32			addr;	/* 7bit address of the slave */
+	uint32			flags;	/* I2C_MSG_* */
+	uint32			len;	/* number of bytes to be written/read */
+	uint8			*buf;	/* data to be written, or buffer for the data read */
+	FT_STATUS		status;	/* returned: FT_OK, FT_DEVICE_NOT_FOUND if the address was nAcked or
+							FT_FAILED_TO_WRITE_DEVICE if a byte written was nAcked */
+	uint32			sizeTransferred;	/* returned: bytes read, or bytes written before
+							the first nAck */
+}I2C_Msg;
+
 
 /******************************************************************************/
 /*								External variables							  */
@@ -142,14 +194,30 @@ FTDI_API FT_STATUS I2C_GetNumChannels(uint32 *numChannels);
 FTDI_API FT_STATUS I2C_GetChannelInfo(uint32 index,
 	FT_DEVICE_LIST_INFO_NODE *chanInfo);
 FTDI_API FT_STATUS I2C_OpenChannel(uint32 index, FT_HANDLE *handle);
+FTDI_API FT_STATUS I2C_OpenChannelEx(void *arg, uint32 flags, FT_HANDLE *handle);
 FTDI_API FT_STATUS I2C_InitChannel(FT_HANDLE handle, ChannelConfig *config);
 FTDI_API FT_STATUS I2C_CloseChannel(FT_HANDLE handle);
+FTDI_API FT_STATUS I2C_RecoverChannel(FT_HANDLE handle);
+FTDI_API FT_STATUS I2C_CalibrateChannel(FT_HANDLE handle, uint32 workload,
+	FT_TransportProfile *profiles);
 FTDI_API FT_STATUS I2C_DeviceRead(FT_HANDLE handle, uint32 deviceAddress,
 uint32 sizeToTransfer, uint8 *buffer, uint32 *sizeTransfered, uint32 options);
 FTDI_API FT_STATUS I2C_DeviceWrite(FT_HANDLE handle, uint32 deviceAddress,
 uint32 sizeToTransfer, uint8 *buffer, uint32 *sizeTransfered, uint32 options);
+FTDI_API FT_STATUS I2C_DeviceWriteGetAcks(FT_HANDLE handle, uint32 deviceAddress,
+uint32 sizeToTransfer, uint8 *buffer, uint32 *sizeTransfered, uint32 options,
+uint8 *ackBitmap, uint32 *firstNack);
+FTDI_API FT_STATUS I2C_Transfer(FT_HANDLE handle, I2C_Msg *msgs, uint32 count);
+FTDI_API FT_STATUS I2C_ScanBus(FT_HANDLE handle, uint8 *presence);
+FTDI_API FT_STATUS I2C_PollRegister(FT_HANDLE handle, uint32 deviceAddress, uint8 reg,
+	uint8 mask, uint8 expected, uint32 timeout, uint8 *value, uint32 *elapsedUs);
+FTDI_API FT_STATUS I2C_PollAck(FT_HANDLE handle, uint32 deviceAddress, uint32 timeout,
+	uint32 *elapsedUs);
 FTDI_API FT_STATUS FT_WriteGPIO(FT_HANDLE handle, uint8 dir, uint8 value);
 FTDI_API FT_STATUS FT_ReadGPIO(FT_HANDLE handle,uint8 *value);
+FTDI_API FT_STATUS FT_SyncChannel(FT_HANDLE handle);
+FTDI_API FT_STATUS FT_SetTransportProfile(FT_HANDLE handle, const FT_TransportProfile *profile);
+FTDI_API FT_STATUS FT_SetBackend(const char *name);
 
 
 
@@ -0,0 +1,58 @@
+/*!
+ * \file libMPSSE_profile.h
+ *
+ * \author FTDI
+ * \date 20261018
+ *
+ * Copyright (C) 2000-2014 Future Technology Devices International Limited
+ *
+ *
+ * THIS SOFTWARE IS PROVIDED BY FUTURE TECHNOLOGY DEVICES INTERNATIONAL LIMITED ``AS IS'' AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL FUTURE TECHNOLOGY DEVICES INTERNATIONAL LIMITED
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ * Project: libMPSSE
+ * Module: Transport profiles
+ *
+ * Rivision History:
+ * 0.1 - initial version
+ */
+
+#ifndef LIBMPSSE_PROFILE_H
+#define LIBMPSSE_PROFILE_H
+
+/* Shared by the I2C and SPI headers and the library itself, which define uint8 and uint32
+before including it */
+
+
+/******************************************************************************/
+/*								Macro defines								  */
+/******************************************************************************/
+/* Workload classes of the transport profiles(see I2C_CalibrateChannel/SPI_CalibrateChannel) */
+#define FT_PROFILE_LATENCY			0	/* short exchanges, each waiting for the last */
+#define FT_PROFILE_THROUGHPUT		1	/* long block transfers */
+#define FT_PROFILE_COUNT			2
+
+
+/******************************************************************************/
+/*								Type defines								  */
+/******************************************************************************/
+
+/* Transport settings of a channel and how they performed when they were measured */
+typedef struct FT_TransportProfile_t
+{
+	uint8	latencyTimer;		/* latency timer in milliseconds */
+	uint32	inTransferSize;		/* USB transfer sizes(see FT_SetUSBParameters), multiples of 64 */
+	uint32	outTransferSize;
+	uint32	roundTripUs;		/* measured time of a command/response round trip */
+	uint32	bytesPerSecond;		/* measured rate of a block read */
+}FT_TransportProfile;
+
+/******************************************************************************/
+
+
+#endif	/*LIBMPSSE_PROFILE_H*/
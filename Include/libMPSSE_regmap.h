@@ -0,0 +1,71 @@
+/*!
+ * \file libMPSSE_regmap.h
+ *
+ * \author FTDI
+ * \date 20261018
+ *
+ * Copyright (C) 2000-2014 Future Technology Devices International Limited
+ *
+ *
+ * THIS SOFTWARE IS PROVIDED BY FUTURE TECHNOLOGY DEVICES INTERNATIONAL LIMITED ``AS IS'' AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL FUTURE TECHNOLOGY DEVICES INTERNATIONAL LIMITED
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Project: libMPSSE
+ * Module: Regmap
+ *
+ * Rivision History:
+ * 0.1 - initial version
+ */
+
+#ifndef LIBMPSSE_REGMAP_H
+#define LIBMPSSE_REGMAP_H
+
+#include "libMPSSE_i2c.h"
+
+
+/******************************************************************************/
+/*								Macro defines								  */
+/******************************************************************************/
+/* Flags of a register, see REGMAP_SetFlags */
+/* The device changes the register by itself, it is never cached */
+#define REGMAP_FLAG_VOLATILE		0x01
+/* Reading the register has side effects(e.g. clears interrupt flags), it is only read when the
+user application asks for it, never to fill the cache */
+#define REGMAP_FLAG_PRECIOUS		0x02
+
+/* Options of REGMAP_Init */
+/* The device doesn't advance its register pointer after each byte, registers are accessed one
+at a time */
+#define REGMAP_OPTION_NO_AUTO_INCREMENT	0x00000001
+
+
+/******************************************************************************/
+/*								Function declarations						  */
+/******************************************************************************/
+FTDI_API FT_STATUS REGMAP_Init(FT_HANDLE handle, uint32 deviceAddress, uint32 numRegisters,
+	uint32 options);
+FTDI_API FT_STATUS REGMAP_Exit(FT_HANDLE handle, uint32 deviceAddress);
+FTDI_API FT_STATUS REGMAP_SetFlags(FT_HANDLE handle, uint32 deviceAddress, uint32 reg,
+	uint8 flags);
+FTDI_API FT_STATUS REGMAP_Read(FT_HANDLE handle, uint32 deviceAddress, uint32 reg,
+	uint8 *value);
+FTDI_API FT_STATUS REGMAP_Write(FT_HANDLE handle, uint32 deviceAddress, uint32 reg,
+	uint8 value);
+FTDI_API FT_STATUS REGMAP_UpdateBits(FT_HANDLE handle, uint32 deviceAddress, uint32 reg,
+	uint8 mask, uint8 value);
+FTDI_API FT_STATUS REGMAP_Prefetch(FT_HANDLE handle, uint32 deviceAddress, uint32 first,
+	uint32 count);
+FTDI_API FT_STATUS REGMAP_Sync(FT_HANDLE handle, uint32 deviceAddress);
+FTDI_API FT_STATUS REGMAP_Invalidate(FT_HANDLE handle, uint32 deviceAddress);
+
+/******************************************************************************/
+
+
+#endif	/*LIBMPSSE_REGMAP_H*/
+
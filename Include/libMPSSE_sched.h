@@ -0,0 +1,92 @@
+/*!
+ * \file libMPSSE_sched.h
+ *
+ * \author FTDI
+ * \date 20261018
+ *
+ * Copyright (C) 2000-2014 Future Technology Devices International Limited
+ *
+ *
+ * THIS SOFTWARE IS PROVIDED BY FUTURE TECHNOLOGY DEVICES INTERNATIONAL LIMITED ``AS IS'' AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL FUTURE TECHNOLOGY DEVICES INTERNATIONAL LIMITED
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Project: libMPSSE
+ * Module: Scheduler
+ *
+ * Rivision History:
+ * 0.1 - initial version
+ */
+
+#ifndef LIBMPSSE_SCHED_H
+#define LIBMPSSE_SCHED_H
+
+/* Either of the protocol headers provides the data types */
+#if !defined(LIBMPSSE_I2C_H) && !defined(LIBMPSSE_SPI_H)
+#include "libMPSSE_i2c.h"
+#endif
+
+
+/******************************************************************************/
+/*								Macro defines								  */
+/******************************************************************************/
+/* Bus of a channel, see SCHED_Init */
+#define SCHED_BUS_I2C			0
+#define SCHED_BUS_SPI			1
+
+/* Limits of the scheduler of one channel */
+#define SCHED_MAX_SENSORS		64
+#define SCHED_MAX_COMMAND		4	/* bytes written before the data is read */
+#define SCHED_MAX_READ			32	/* bytes read per sample */
+
+/* Share of the tick that the reads of the sensors may take on the bus, in percent. The rest is
+left for the USB round trip and the application */
+#define SCHED_TICK_BUDGET_PERCENT	50
+
+
+/******************************************************************************/
+/*								Type defines								  */
+/******************************************************************************/
+
+/* How a sensor is read. On an I2C channel the command bytes(e.g. the register address) are
+written to the slave at address and then readLength bytes are read with a repeated START. On an
+SPI channel the chip select given by address(SPI_CONFIG_OPTION_CS_*) is asserted, the command
+bytes are clocked out and then readLength bytes are clocked in */
+typedef struct SCHED_Recipe_t
+{
+	uint32		address;
+	uint8		command[SCHED_MAX_COMMAND];
+	uint32		commandLength;
+	uint32		readLength;
+}SCHED_Recipe;
+
+/* One sample of a sensor */
+typedef struct SCHED_Sample_t
+{
+	uint64		timestamp;	/* time in microseconds(Infra_GetTimeUs) the tick was started */
+	uint32		sequence;	/* number of the sample, starting at 1 */
+	FT_STATUS	status;		/* FT_OK, or e.g. FT_DEVICE_NOT_FOUND if the slave nAcked */
+	uint8		data[SCHED_MAX_READ];
+}SCHED_Sample;
+
+
+/******************************************************************************/
+/*								Function declarations						  */
+/******************************************************************************/
+FTDI_API FT_STATUS SCHED_Init(FT_HANDLE handle, uint32 bus, uint32 tickUs);
+FTDI_API FT_STATUS SCHED_Exit(FT_HANDLE handle);
+FTDI_API FT_STATUS SCHED_AddSensor(FT_HANDLE handle, const SCHED_Recipe *recipe,
+	uint32 periodUs, uint32 *sensorId);
+FTDI_API FT_STATUS SCHED_Tick(FT_HANDLE handle);
+FTDI_API FT_STATUS SCHED_GetSample(FT_HANDLE handle, uint32 sensorId, SCHED_Sample *sample);
+
+/******************************************************************************/
+
+
+#endif	/*LIBMPSSE_SCHED_H*/
+
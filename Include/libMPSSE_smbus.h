@@ -0,0 +1,72 @@
+/*!
+ * \file libMPSSE_smbus.h
+ *
+ * \author FTDI
+ * \date 20261018
+ *
+ * Copyright (C) 2000-2014 Future Technology Devices International Limited
+ *
+ *
+ * THIS SOFTWARE IS PROVIDED BY FUTURE TECHNOLOGY DEVICES INTERNATIONAL LIMITED ``AS IS'' AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL FUTURE TECHNOLOGY DEVICES INTERNATIONAL LIMITED
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Project: libMPSSE
+ * Module: SMBus
+ *
+ * Rivision History:
+ * 0.1 - initial version
+ */
+
+#ifndef LIBMPSSE_SMBUS_H
+#define LIBMPSSE_SMBUS_H
+
+#include "libMPSSE_i2c.h"
+
+
+/******************************************************************************/
+/*								Macro defines								  */
+/******************************************************************************/
+/* Options of the SMBUS_* functions */
+/* Append a Packet Error Code to the data written, and check the one that comes with the data
+read. FT_IO_ERROR is returned if it doesn't match */
+#define SMBUS_OPTION_PEC		0x00000001
+
+/* Largest number of data bytes of a block transfer */
+#define SMBUS_BLOCK_MAX			32
+
+
+/******************************************************************************/
+/*								Function declarations						  */
+/******************************************************************************/
+FTDI_API FT_STATUS SMBUS_Quick(FT_HANDLE handle, uint32 deviceAddress, bool read);
+FTDI_API FT_STATUS SMBUS_SendByte(FT_HANDLE handle, uint32 deviceAddress, uint8 value,
+	uint32 options);
+FTDI_API FT_STATUS SMBUS_ReceiveByte(FT_HANDLE handle, uint32 deviceAddress, uint8 *value,
+	uint32 options);
+FTDI_API FT_STATUS SMBUS_WriteByte(FT_HANDLE handle, uint32 deviceAddress, uint8 command,
+	uint8 value, uint32 options);
+FTDI_API FT_STATUS SMBUS_ReadByte(FT_HANDLE handle, uint32 deviceAddress, uint8 command,
+	uint8 *value, uint32 options);
+FTDI_API FT_STATUS SMBUS_WriteWord(FT_HANDLE handle, uint32 deviceAddress, uint8 command,
+	uint16 value, uint32 options);
+FTDI_API FT_STATUS SMBUS_ReadWord(FT_HANDLE handle, uint32 deviceAddress, uint8 command,
+	uint16 *value, uint32 options);
+FTDI_API FT_STATUS SMBUS_ProcessCall(FT_HANDLE handle, uint32 deviceAddress, uint8 command,
+	uint16 value, uint16 *result, uint32 options);
+FTDI_API FT_STATUS SMBUS_BlockWrite(FT_HANDLE handle, uint32 deviceAddress, uint8 command,
+	uint8 *buffer, uint32 count, uint32 options);
+FTDI_API FT_STATUS SMBUS_BlockRead(FT_HANDLE handle, uint32 deviceAddress, uint8 command,
+	uint8 *buffer, uint32 *count, uint32 options);
+FTDI_API uint8 SMBUS_Pec(uint8 crc, const uint8 *data, uint32 length);
+
+/******************************************************************************/
+
+
+#endif	/*LIBMPSSE_SMBUS_H*/
+
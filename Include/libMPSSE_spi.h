@@ -72,6 +72,17 @@
 
 #define SPI_CONFIG_OPTION_CS_ACTIVELOW	0x00000020
 
+/* Fast initialization: the device isn't reset and the MPSSE isn't reset/re-enabled when it is
+found already running(e.g. when a channel is reopened), and the fixed waits are replaced by
+waiting for the MPSSE to echo a command */
+#define SPI_CONFIG_OPTION_FAST_INIT		0x00000080
+
+/* Calibration: after initialization the latency timer and the USB transfer sizes are measured on
+the device and the best ones for short register accesses(latency) or block transfers(throughput)
+are applied, overriding LatencyTimer */
+#define SPI_CONFIG_OPTION_CALIBRATE_LATENCY		0x00000100
+#define SPI_CONFIG_OPTION_CALIBRATE_THROUGHPUT	0x00000200
+
 
 /******************************************************************************/
 /*								Type defines								  */
@@ -133,6 +144,9 @@ typedef struct ChannelConfig_t
 	uint16		reserved;
 }ChannelConfig;
 
+/* Transport settings of a channel(FT_TransportProfile) and the workload classes */
+#include "libMPSSE_profile.h"
+
 
 /******************************************************************************/
 /*								External variables							  */
@@ -149,8 +163,12 @@ FTDI_API FT_STATUS SPI_GetNumChannels(uint32 *numChannels);
 FTDI_API FT_STATUS SPI_GetChannelInfo(uint32 index,
 	FT_DEVICE_LIST_INFO_NODE *chanInfo);
 FTDI_API FT_STATUS SPI_OpenChannel(uint32 index, FT_HANDLE *handle);
+FTDI_API FT_STATUS SPI_OpenChannelEx(void *arg, uint32 flags, FT_HANDLE *handle);
 FTDI_API FT_STATUS SPI_InitChannel(FT_HANDLE handle, ChannelConfig *config);
 FTDI_API FT_STATUS SPI_CloseChannel(FT_HANDLE handle);
+FTDI_API FT_STATUS SPI_RecoverChannel(FT_HANDLE handle);
+FTDI_API FT_STATUS SPI_CalibrateChannel(FT_HANDLE handle, uint32 workload,
+	FT_TransportProfile *profiles);
 FTDI_API FT_STATUS SPI_Read(FT_HANDLE handle, uint8 *buffer,
 	uint32 sizeToTransfer, uint32 *sizeTransfered, uint32 options);
 FTDI_API FT_STATUS SPI_Write(FT_HANDLE handle, uint8 *buffer,
@@ -162,7 +180,12 @@ FTDI_API FT_STATUS SPI_IsBusy(FT_HANDLE handle, bool *state);
 FTDI_API FT_STATUS SPI_ChangeCS(FT_HANDLE handle, uint32 configOptions);
 FTDI_API FT_STATUS FT_WriteGPIO(FT_HANDLE handle, uint8 dir, uint8 value);
 FTDI_API FT_STATUS FT_ReadGPIO(FT_HANDLE handle,uint8 *value);
+FTDI_API FT_STATUS FT_SyncChannel(FT_HANDLE handle);
+FTDI_API FT_STATUS FT_SetTransportProfile(FT_HANDLE handle, const FT_TransportProfile *profile);
+FTDI_API FT_STATUS FT_SetBackend(const char *name);
 FTDI_API FT_STATUS SPI_ToggleCS(FT_HANDLE handle, bool state);
+FTDI_API FT_STATUS SPI_PollStatus(FT_HANDLE handle, uint8 *command, uint32 commandLength,
+	uint8 mask, uint8 expected, uint32 timeout, uint8 *value, uint32 *elapsedUs);
 
 
 
@@ -0,0 +1,387 @@
+/*!
+ * \file ftdi_backend.c
+ *
+ * \author FTDI
+ * \date 20261018
+ *
+ * Copyright (C) 2000-2014 Future Technology Devices International Limited
+ *
+ *
+ * THIS SOFTWARE IS PROVIDED BY FUTURE TECHNOLOGY DEVICES INTERNATIONAL LIMITED ``AS IS'' AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL FUTURE TECHNOLOGY DEVICES INTERNATIONAL LIMITED
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Project: libMPSSE
+ * Module: Backend
+ *
+ * Rivision History:
+ * 0.1 - initial version
+ */
+
+
+/******************************************************************************/
+/*								Include files					  			  */
+/******************************************************************************/
+#include "ftdi_infra.h"		/*Common portable infrastructure(datatypes, libraries, etc)*/
+#include "ftdi_common.h"	/*Common across I2C, SPI, JTAG modules*/
+#include "ftdi_backend.h"	/*Backend specific*/
+#include "ftdi_emu.h"		/*MPSSE emulator*/
+#ifdef FTDI_LIBUSB_BACKEND
+#include "ftdi_libusb.h"	/*libusb-1.0 backend*/
+#endif
+
+
+/******************************************************************************/
+/*								Macro and type defines					  		  */
+/******************************************************************************/
+
+
+/******************************************************************************/
+/*								Local function declarations					  */
+/******************************************************************************/
+FT_STATUS Backend_D2xxCreateDeviceInfoList(LPDWORD numDevices);
+FT_STATUS Backend_D2xxGetDeviceInfoList(FT_DEVICE_LIST_INFO_NODE *list, LPDWORD numDevices);
+FT_STATUS Backend_D2xxOpen(uint32 index, FT_HANDLE *handle);
+FT_STATUS Backend_D2xxOpenEx(PVOID arg, DWORD flags, FT_HANDLE *handle);
+FT_STATUS Backend_D2xxClose(FT_HANDLE handle);
+FT_STATUS Backend_D2xxWrite(FT_HANDLE handle, LPVOID buffer, DWORD bytesToWrite,
+	LPDWORD bytesWritten);
+FT_STATUS Backend_D2xxRead(FT_HANDLE handle, LPVOID buffer, DWORD bytesToRead,
+	LPDWORD bytesRead);
+FT_STATUS Backend_D2xxGetQueueStatus(FT_HANDLE handle, LPDWORD amountInRxQueue);
+FT_STATUS Backend_D2xxPurge(FT_HANDLE handle, ULONG mask);
+FT_STATUS Backend_D2xxResetDevice(FT_HANDLE handle);
+FT_STATUS Backend_D2xxSetBitMode(FT_HANDLE handle, UCHAR mask, UCHAR mode);
+FT_STATUS Backend_D2xxSetLatencyTimer(FT_HANDLE handle, UCHAR latency);
+FT_STATUS Backend_D2xxSetUSBParameters(FT_HANDLE handle, ULONG inTransferSize,
+	ULONG outTransferSize);
+FT_STATUS Backend_D2xxSetChars(FT_HANDLE handle, UCHAR eventCh, UCHAR eventChEn,
+	UCHAR errorCh, UCHAR errorChEn);
+FT_STATUS Backend_D2xxSetTimeouts(FT_HANDLE handle, ULONG readTimeout, ULONG writeTimeout);
+FT_STATUS Backend_D2xxGetDeviceInfo(FT_HANDLE handle, FT_DEVICE *ftDevice, LPDWORD deviceID,
+	PCHAR serialNumber, PCHAR description);
+
+
+/******************************************************************************/
+/*								Global variables							  */
+/******************************************************************************/
+
+const Backend_Ops Backend_D2xx =
+{
+	"d2xx",
+	Backend_D2xxCreateDeviceInfoList,
+	Backend_D2xxGetDeviceInfoList,
+	Backend_D2xxOpen,
+	Backend_D2xxOpenEx,
+	Backend_D2xxClose,
+	Backend_D2xxWrite,
+	Backend_D2xxRead,
+	Backend_D2xxGetQueueStatus,
+	Backend_D2xxPurge,
+	Backend_D2xxResetDevice,
+	Backend_D2xxSetBitMode,
+	Backend_D2xxSetLatencyTimer,
+	Backend_D2xxSetUSBParameters,
+	Backend_D2xxSetChars,
+	Backend_D2xxSetTimeouts,
+	Backend_D2xxGetDeviceInfo
+};
+
+/* Backends that can be selected by name, the first one is the default */
+static const Backend_Ops *const Backend_List[] =
+{
+	&Backend_D2xx,
+	&Backend_Emulator,
+#ifdef FTDI_LIBUSB_BACKEND
+	&Backend_Libusb,
+#endif
+};
+
+/* Backend the channels are enumerated and opened with, NULL until BACKEND_ENV_NAME was read */
+static const Backend_Ops *Backend_Selected=NULL;
+
+/*Root of the linked list that holds the channels opened through a backend. Nodes are added with
+the lock taken(Infra_Lock) and published with INFRA_STORE_POINTER. They are never freed: the node
+of a closed channel gets a NULL handle and is reused, so Backend_Get walks the list without the
+lock*/
+static Backend_Channel *Backend_ListHead=NULL;
+
+
+/******************************************************************************/
+/*						Public function definitions						  */
+/******************************************************************************/
+
+/*!
+ * \brief Looks up a backend by its name
+ *
+ * \param[in] name Name of the backend, NULL for the default backend(D2XX)
+ * \return Pointer to the operations of the backend, NULL if there is no backend of that name
+ * \sa FT_SetBackend
+ * \note
+ * \warning
+ */
+const Backend_Ops* Backend_Find(const char *name)
+{
+	uint32 i;
+
+	if(NULL == name)
+		return Backend_List[0];
+	for(i=0; i<sizeof(Backend_List)/sizeof(Backend_List[0]); i++)
+	{
+		if(0 == strcmp(Backend_List[i]->name,name))
+			return Backend_List[i];
+	}
+	return NULL;
+}
+
+/*!
+ * \brief Returns the backend that the channels are enumerated and opened with
+ *
+ * \param none
+ * \return Pointer to the operations of the backend
+ * \sa Backend_Select
+ * \note Until a backend is selected, the one named by the environment variable BACKEND_ENV_NAME
+ * is used, the default one if the variable isn't set or names no backend. This lets programs
+ * written for D2XX run on another backend unchanged
+ * \warning To be called with the lock taken(Infra_Lock)
+ */
+const Backend_Ops* Backend_GetSelected(void)
+{
+	const char *name;
+
+	if(NULL == Backend_Selected)
+	{
+		name = getenv(BACKEND_ENV_NAME);
+		Backend_Selected = Backend_Find(name);
+		if(NULL == Backend_Selected)
+		{
+			DBG(MSG_WARN,"unknown backend %s\n",name);
+			Backend_Selected = Backend_List[0];
+		}
+	}
+	return Backend_Selected;
+}
+
+/*!
+ * \brief Selects the backend that the channels are enumerated and opened with
+ *
+ * \param[in] ops Pointer to the operations of the backend
+ * \return none
+ * \sa Backend_Find
+ * \note The channels that are open already keep the backend they were opened with
+ * \warning To be called with the lock taken(Infra_Lock)
+ */
+void Backend_Select(const Backend_Ops *ops)
+{
+	DBG(MSG_DEBUG,"backend %s\n",ops->name);
+	Backend_Selected = ops;
+}
+
+/*!
+ * \brief Records the backend a channel was opened with
+ *
+ * \param[in] handle Handle of the channel
+ * \param[in] ops Pointer to the operations of the backend
+ * \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide)
+ * \sa Backend_Detach, Backend_Get
+ * \note If the handle is recorded already then its backend is replaced
+ * \warning
+ */
+FT_STATUS Backend_Attach(FT_HANDLE handle, const Backend_Ops *ops)
+{
+	FT_STATUS status=FT_OK;
+	Backend_Channel *tempNode;
+	Backend_Channel *freeNode=NULL;
+	FN_ENTER;
+
+	Infra_Lock();
+	for(tempNode=Backend_ListHead; NULL != tempNode; tempNode=tempNode->next)
+	{
+		if(tempNode->handle == handle)
+			break;
+		if((NULL == tempNode->handle) && (NULL == freeNode))
+			freeNode = tempNode;
+	}
+	if(NULL != tempNode)
+	{
+		INFRA_STORE_POINTER(&tempNode->ops,ops);
+	}
+	else if(NULL != freeNode)
+	{/* the backend is set before the node can be found by its handle */
+		INFRA_STORE_POINTER(&freeNode->ops,ops);
+		INFRA_STORE_POINTER(&freeNode->handle,handle);
+	}
+	else
+	{
+		tempNode = (Backend_Channel *) INFRA_MALLOC(sizeof(Backend_Channel));
+		if(NULL == tempNode)
+		{
+			status = FT_INSUFFICIENT_RESOURCES;
+			DBG(MSG_ERR,"Failed allocating memory\n");
+		}
+		else
+		{
+			tempNode->handle = handle;
+			tempNode->ops = ops;
+			tempNode->next = Backend_ListHead;
+			INFRA_STORE_POINTER(&Backend_ListHead,tempNode);
+		}
+	}
+	Infra_Unlock();
+	FN_EXIT;
+	return status;
+}
+
+/*!
+ * \brief Forgets the backend of a channel that is being closed
+ *
+ * \param[in] handle Handle of the channel
+ * \return none
+ * \sa Backend_Attach
+ * \note The node of the channel is kept for the next channel that is opened
+ * \warning
+ */
+void Backend_Detach(FT_HANDLE handle)
+{
+	Backend_Channel *tempNode;
+
+	if(NULL == handle)
+		return;
+	Infra_Lock();
+	for(tempNode=Backend_ListHead; NULL != tempNode; tempNode=tempNode->next)
+	{
+		if(tempNode->handle == handle)
+		{/*Node found*/
+			INFRA_STORE_POINTER(&tempNode->handle,NULL);
+			break;
+		}
+	}
+	Infra_Unlock();
+}
+
+/*!
+ * \brief Returns the backend of a channel
+ *
+ * This function is called for every operation on a channel, so it doesn't take the lock: it
+ * walks the list of channels, which only grows, with the loads that pair with the stores of
+ * Backend_Attach.
+ *
+ * \param[in] handle Handle of the channel
+ * \return Pointer to the operations of the backend the channel was opened with. The D2XX backend
+ *		is returned for handles that weren't opened by this library, e.g. by FT_Open
+ * \sa Backend_Attach
+ * \note
+ * \warning
+ */
+const Backend_Ops* Backend_Get(FT_HANDLE handle)
+{
+	Backend_Channel *tempNode;
+
+	if(NULL == handle)
+		return &Backend_D2xx;
+	for(tempNode=(Backend_Channel *)INFRA_LOAD_POINTER(&Backend_ListHead); NULL != tempNode;
+		tempNode=tempNode->next)
+	{
+		if((FT_HANDLE)INFRA_LOAD_POINTER(&tempNode->handle) == handle)
+			return (const Backend_Ops *)INFRA_LOAD_POINTER(&tempNode->ops);
+	}
+	return &Backend_D2xx;
+}
+
+
+/******************************************************************************/
+/*						Local function definitions						  */
+/******************************************************************************/
+
+/* The D2XX backend passes every operation on to the function of the same name of the driver */
+
+FT_STATUS Backend_D2xxCreateDeviceInfoList(LPDWORD numDevices)
+{
+	return FT_CreateDeviceInfoList(numDevices);
+}
+
+FT_STATUS Backend_D2xxGetDeviceInfoList(FT_DEVICE_LIST_INFO_NODE *list, LPDWORD numDevices)
+{
+	return FT_GetDeviceInfoList(list,numDevices);
+}
+
+FT_STATUS Backend_D2xxOpen(uint32 index, FT_HANDLE *handle)
+{
+	return FT_Open((int)index,handle);
+}
+
+FT_STATUS Backend_D2xxOpenEx(PVOID arg, DWORD flags, FT_HANDLE *handle)
+{
+	return FT_OpenEx(arg,flags,handle);
+}
+
+FT_STATUS Backend_D2xxClose(FT_HANDLE handle)
+{
+	return FT_Close(handle);
+}
+
+FT_STATUS Backend_D2xxWrite(FT_HANDLE handle, LPVOID buffer, DWORD bytesToWrite,
+	LPDWORD bytesWritten)
+{
+	return FT_Write(handle,buffer,bytesToWrite,bytesWritten);
+}
+
+FT_STATUS Backend_D2xxRead(FT_HANDLE handle, LPVOID buffer, DWORD bytesToRead,
+	LPDWORD bytesRead)
+{
+	return FT_Read(handle,buffer,bytesToRead,bytesRead);
+}
+
+FT_STATUS Backend_D2xxGetQueueStatus(FT_HANDLE handle, LPDWORD amountInRxQueue)
+{
+	return FT_GetQueueStatus(handle,amountInRxQueue);
+}
+
+FT_STATUS Backend_D2xxPurge(FT_HANDLE handle, ULONG mask)
+{
+	return FT_Purge(handle,mask);
+}
+
+FT_STATUS Backend_D2xxResetDevice(FT_HANDLE handle)
+{
+	return FT_ResetDevice(handle);
+}
+
+FT_STATUS Backend_D2xxSetBitMode(FT_HANDLE handle, UCHAR mask, UCHAR mode)
+{
+	return FT_SetBitMode(handle,mask,mode);
+}
+
+FT_STATUS Backend_D2xxSetLatencyTimer(FT_HANDLE handle, UCHAR latency)
+{
+	return FT_SetLatencyTimer(handle,latency);
+}
+
+FT_STATUS Backend_D2xxSetUSBParameters(FT_HANDLE handle, ULONG inTransferSize,
+	ULONG outTransferSize)
+{
+	return FT_SetUSBParameters(handle,inTransferSize,outTransferSize);
+}
+
+FT_STATUS Backend_D2xxSetChars(FT_HANDLE handle, UCHAR eventCh, UCHAR eventChEn,
+	UCHAR errorCh, UCHAR errorChEn)
+{
+	return FT_SetChars(handle,eventCh,eventChEn,errorCh,errorChEn);
+}
+
+FT_STATUS Backend_D2xxSetTimeouts(FT_HANDLE handle, ULONG readTimeout, ULONG writeTimeout)
+{
+	return FT_SetTimeouts(handle,readTimeout,writeTimeout);
+}
+
+FT_STATUS Backend_D2xxGetDeviceInfo(FT_HANDLE handle, FT_DEVICE *ftDevice, LPDWORD deviceID,
+	PCHAR serialNumber, PCHAR description)
+{
+	return FT_GetDeviceInfo(handle,ftDevice,deviceID,serialNumber,description,NULL);
+}
+
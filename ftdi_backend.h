@@ -0,0 +1,101 @@
+/*!
+ * \file ftdi_backend.h
+ *
+ * \author FTDI
+ * \date 20261018
+ *
+ * Copyright (C) 2000-2014 Future Technology Devices International Limited
+ *
+ *
+ * THIS SOFTWARE IS PROVIDED BY FUTURE TECHNOLOGY DEVICES INTERNATIONAL LIMITED ``AS IS'' AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL FUTURE TECHNOLOGY DEVICES INTERNATIONAL LIMITED
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Project: libMPSSE
+ * Module: Backend
+ *
+ * Rivision History:
+ * 0.1 - initial version
+ */
+
+#ifndef FTDI_BACKEND_H
+#define FTDI_BACKEND_H
+
+#include "ftdi_infra.h"		/*Common portable infrastructure(datatypes, libraries, etc)*/
+
+
+/******************************************************************************/
+/*								Macro defines								  */
+/******************************************************************************/
+/* Environment variable naming the backend used until FT_SetBackend is called */
+#define BACKEND_ENV_NAME				"LIBMPSSE_BACKEND"
+
+
+/******************************************************************************/
+/*								Type defines								  */
+/******************************************************************************/
+
+/* Operations of a transport backend. They take the same parameters and return the same status
+codes as the D2XX functions of the same name, so that the middle layer doesn't have to know which
+backend a channel was opened with. The handles are the ones returned by open and openEx of the
+same backend */
+typedef struct Backend_Ops_t
+{
+	/* Name the backend is selected by(FT_SetBackend) */
+	const char *name;
+	FT_STATUS (*createDeviceInfoList)(LPDWORD numDevices);
+	FT_STATUS (*getDeviceInfoList)(FT_DEVICE_LIST_INFO_NODE *list, LPDWORD numDevices);
+	FT_STATUS (*open)(uint32 index, FT_HANDLE *handle);
+	FT_STATUS (*openEx)(PVOID arg, DWORD flags, FT_HANDLE *handle);
+	FT_STATUS (*close)(FT_HANDLE handle);
+	FT_STATUS (*write)(FT_HANDLE handle, LPVOID buffer, DWORD bytesToWrite,
+		LPDWORD bytesWritten);
+	FT_STATUS (*read)(FT_HANDLE handle, LPVOID buffer, DWORD bytesToRead, LPDWORD bytesRead);
+	FT_STATUS (*getQueueStatus)(FT_HANDLE handle, LPDWORD amountInRxQueue);
+	FT_STATUS (*purge)(FT_HANDLE handle, ULONG mask);
+	FT_STATUS (*resetDevice)(FT_HANDLE handle);
+	FT_STATUS (*setBitMode)(FT_HANDLE handle, UCHAR mask, UCHAR mode);
+	FT_STATUS (*setLatencyTimer)(FT_HANDLE handle, UCHAR latency);
+	FT_STATUS (*setUSBParameters)(FT_HANDLE handle, ULONG inTransferSize,
+		ULONG outTransferSize);
+	FT_STATUS (*setChars)(FT_HANDLE handle, UCHAR eventCh, UCHAR eventChEn, UCHAR errorCh,
+		UCHAR errorChEn);
+	FT_STATUS (*setTimeouts)(FT_HANDLE handle, ULONG readTimeout, ULONG writeTimeout);
+	FT_STATUS (*getDeviceInfo)(FT_HANDLE handle, FT_DEVICE *ftDevice, LPDWORD deviceID,
+		PCHAR serialNumber, PCHAR description);
+}Backend_Ops;
+
+/* A channel opened through a backend. The channels are stored in the form of a linked list whose
+nodes are never freed(see Backend_Get) */
+typedef struct Backend_Channel_t
+{
+	FT_HANDLE			handle;
+	const Backend_Ops	*ops;
+	struct Backend_Channel_t *next;
+}Backend_Channel;
+
+
+/******************************************************************************/
+/*								External variables							  */
+/******************************************************************************/
+/* The FTDI D2XX driver, the default backend */
+extern const Backend_Ops Backend_D2xx;
+
+
+/******************************************************************************/
+/*								Function declarations						  */
+/******************************************************************************/
+const Backend_Ops* Backend_Find(const char *name);
+const Backend_Ops* Backend_GetSelected(void);
+void Backend_Select(const Backend_Ops *ops);
+FT_STATUS Backend_Attach(FT_HANDLE handle, const Backend_Ops *ops);
+void Backend_Detach(FT_HANDLE handle);
+const Backend_Ops* Backend_Get(FT_HANDLE handle);
+
+#endif /* FTDI_BACKEND_H */
+
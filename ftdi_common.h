@@ -62,8 +62,15 @@ Implement the lock/unlock only if really required, otherwise keep as placeholder
 #define MPSSE_CMD_SEND_IMMEDIATE			0x87
 #define MPSSE_CMD_ENABLE_3PHASE_CLOCKING	0x8C
 #define MPSSE_CMD_DISABLE_3PHASE_CLOCKING	0x8D
+#define MPSSE_CMD_ENABLE_ADAPTIVE_CLOCKING	0x96
+#define MPSSE_CMD_DISABLE_ADAPTIVE_CLOCKING	0x97
 #define MPSSE_CMD_ENABLE_DRIVE_ONLY_ZERO	0x9E
 
+/*MPSSE Clock-only commands(hi-speed devices only) - clock for n bits/bytes with no data
+transfer, used as precise delays */
+#define MPSSE_CMD_CLOCK_N_BITS				0x8E
+#define MPSSE_CMD_CLOCK_N_BYTES				0x8F
+
 /*MPSSE Data Command - LSB First */
 #define MPSSE_CMD_DATA_LSB_FIRST			0x08
 
@@ -121,6 +128,9 @@ service(say, hardware initialization) required. The following enumeration is hen
 as the first parameter across all the middle layer APIs */
 typedef enum FT_LegacyProtocol_t{SPI, I2C, JTAG}FT_LegacyProtocol;
 
+/* Transport settings of a channel(FT_TransportProfile) and the workload classes */
+#include "libMPSSE_profile.h"
+
 
 
 /******************************************************************************/
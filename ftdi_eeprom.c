@@ -0,0 +1,252 @@
+/*!
+ * \file ftdi_eeprom.c
+ *
+ * \author FTDI
+ * \date 20261018
+ *
+ * Copyright (C) 2000-2014 Future Technology Devices International Limited
+ *
+ *
+ * THIS SOFTWARE IS PROVIDED BY FUTURE TECHNOLOGY DEVICES INTERNATIONAL LIMITED ``AS IS'' AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL FUTURE TECHNOLOGY DEVICES INTERNATIONAL LIMITED
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Project: libMPSSE
+ * Module: EEPROM
+ *
+ * Rivision History:
+ * 0.1 - initial version
+ */
+
+
+/******************************************************************************/
+/*								Include files					  			  */
+/******************************************************************************/
+#include "ftdi_infra.h"		/*Common portable infrastructure(datatypes, libraries, etc)*/
+#include "ftdi_common.h"	/*Common across I2C, SPI, JTAG modules*/
+#include "ftdi_eeprom.h"	/*EEPROM specific*/
+
+
+/******************************************************************************/
+/*								Macro and type defines					  		  */
+/******************************************************************************/
+/* Enabling the macro will lead to checking of all parameters that are passed to the library from
+    the user application*/
+#define ENABLE_PARAMETER_CHECKING	1
+
+/* Slave address that holds a memory address, the address bits above the address bytes are
+sent in the low bits of the slave address */
+#define EEPROM_SLAVE_ADDRESS(device,address)	((device)->deviceAddress | \
+	((address) >> (8*(device)->addressBytes)))
+
+/* Number of bytes from a memory address to the end of its block, sequential reads roll over at
+the end of a block on some parts */
+#define EEPROM_BLOCK_REMAINING(device,address)	((1UL << (8*(device)->addressBytes)) - \
+	((address) & ((1UL << (8*(device)->addressBytes)) - 1)))
+
+
+/******************************************************************************/
+/*								Local function declarations					  */
+/******************************************************************************/
+uint32 EEPROM_MakeAddress(const EEPROM_Device *device, uint32 address, uint8 *buffer);
+
+
+/******************************************************************************/
+/*								Global variables							  */
+/******************************************************************************/
+
+
+/******************************************************************************/
+/*						Public function definitions						  */
+/******************************************************************************/
+
+/*!
+ * \brief Reads data from an I2C EEPROM
+ *
+ * This function reads a range of the EEPROM with sequential reads. Each transaction writes the
+ * memory address and reads up to EEPROM_READ_CHUNK_SIZE bytes in a single round trip(see
+ * I2C_Transfer), so the whole array can be read with a bounded amount of memory for the commands.
+ *
+ * \param[in] device Pointer to the geometry of the EEPROM
+ * \param[in] address Memory address of the first byte to be read
+ * \param[out] buffer Pointer to the buffer where the data read is stored
+ * \param[in] sizeToTransfer Number of bytes to be read
+ * \param[out] sizeTransferred Pointer to the number of bytes read
+ * \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide)
+ * \sa
+ * \note
+ * \warning
+ */
+FTDI_API FT_STATUS EEPROM_Read(EEPROM_Device *device, uint32 address, uint8 *buffer,
+	uint32 sizeToTransfer, uint32 *sizeTransferred)
+{
+	FT_STATUS status=FT_OK;
+	I2C_Msg msgs[2];
+	uint8 addressBuffer[EEPROM_MAX_ADDRESS_BYTES];
+	uint32 current;
+	uint32 len;
+	FN_ENTER;
+#ifdef ENABLE_PARAMETER_CHECKING
+	CHECK_NULL_RET(device);
+	CHECK_NULL_RET(buffer);
+	CHECK_NULL_RET(sizeTransferred);
+	if((device->addressBytes < 1) || (device->addressBytes > EEPROM_MAX_ADDRESS_BYTES) ||
+		(address > device->size) || (sizeToTransfer > (device->size - address)))
+	{
+		DBG(MSG_ERR,"invalid range 0x%x+%u\n",(unsigned)address,(unsigned)sizeToTransfer);
+		return FT_INVALID_PARAMETER;
+	}
+#endif
+
+	*sizeTransferred = 0;
+	while((FT_OK == status) && (*sizeTransferred < sizeToTransfer))
+	{
+		current = address + *sizeTransferred;
+		len = sizeToTransfer - *sizeTransferred;
+		if(len > EEPROM_READ_CHUNK_SIZE)
+			len = EEPROM_READ_CHUNK_SIZE;
+		if(len > EEPROM_BLOCK_REMAINING(device,current))
+			len = EEPROM_BLOCK_REMAINING(device,current);
+
+		msgs[0].addr = EEPROM_SLAVE_ADDRESS(device,current);
+		msgs[0].flags = 0;
+		msgs[0].len = EEPROM_MakeAddress(device,current,addressBuffer);
+		msgs[0].buf = addressBuffer;
+		msgs[1].addr = msgs[0].addr;
+		msgs[1].flags = I2C_MSG_READ;
+		msgs[1].len = len;
+		msgs[1].buf = &buffer[*sizeTransferred];
+		status = I2C_Transfer(device->handle,msgs,2);
+		if(FT_OK == status)
+			*sizeTransferred += len;
+	}
+	FN_EXIT;
+	return status;
+}
+
+/*!
+ * \brief Writes data to an I2C EEPROM
+ *
+ * This function splits the data on page boundaries and writes each page with one transaction,
+ * the memory address and the data of the page sent in a single round trip(see I2C_Transfer).
+ * The end of the write cycle of each page is detected by polling the EEPROM for an address ack
+ * (see EEPROM_WaitReady) rather than waiting for the longest write cycle.
+ *
+ * \param[in] device Pointer to the geometry of the EEPROM
+ * \param[in] address Memory address of the first byte to be written
+ * \param[in] buffer Pointer to the data to be written
+ * \param[in] sizeToTransfer Number of bytes to be written
+ * \param[out] sizeTransferred Pointer to the number of bytes written, in whole pages
+ * \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide)
+ * \sa
+ * \note The function returns after the write cycle of the last page has completed
+ * \warning
+ */
+FTDI_API FT_STATUS EEPROM_Write(EEPROM_Device *device, uint32 address, uint8 *buffer,
+	uint32 sizeToTransfer, uint32 *sizeTransferred)
+{
+	FT_STATUS status=FT_OK;
+	I2C_Msg msgs[2];
+	uint8 addressBuffer[EEPROM_MAX_ADDRESS_BYTES];
+	uint32 current;
+	uint32 len;
+	FN_ENTER;
+#ifdef ENABLE_PARAMETER_CHECKING
+	CHECK_NULL_RET(device);
+	CHECK_NULL_RET(buffer);
+	CHECK_NULL_RET(sizeTransferred);
+	if((device->addressBytes < 1) || (device->addressBytes > EEPROM_MAX_ADDRESS_BYTES) ||
+		(0 == device->pageSize) || (address > device->size) ||
+		(sizeToTransfer > (device->size - address)))
+	{
+		DBG(MSG_ERR,"invalid range 0x%x+%u\n",(unsigned)address,(unsigned)sizeToTransfer);
+		return FT_INVALID_PARAMETER;
+	}
+#endif
+
+	*sizeTransferred = 0;
+	while((FT_OK == status) && (*sizeTransferred < sizeToTransfer))
+	{
+		current = address + *sizeTransferred;
+		/* up to the end of the page, the address wraps around within the page otherwise */
+		len = device->pageSize - (current % device->pageSize);
+		if(len > (sizeToTransfer - *sizeTransferred))
+			len = sizeToTransfer - *sizeTransferred;
+
+		msgs[0].addr = EEPROM_SLAVE_ADDRESS(device,current);
+		msgs[0].flags = 0;
+		msgs[0].len = EEPROM_MakeAddress(device,current,addressBuffer);
+		msgs[0].buf = addressBuffer;
+		msgs[1].addr = msgs[0].addr;
+		msgs[1].flags = I2C_MSG_NO_START;
+		msgs[1].len = len;
+		msgs[1].buf = &buffer[*sizeTransferred];
+		status = I2C_Transfer(device->handle,msgs,2);
+		if(FT_OK == status)
+			status = EEPROM_WaitReady(device,current);
+		if(FT_OK == status)
+			*sizeTransferred += len;
+	}
+	FN_EXIT;
+	return status;
+}
+
+/*!
+ * \brief Waits for the write cycle of an I2C EEPROM to complete
+ *
+ * The EEPROM doesn't ack its address while it is programming a page. This function polls for
+ * the address ack with batches of probes sent in a single packet(see I2C_PollAck) until the
+ * EEPROM acks or writeTime has elapsed.
+ *
+ * \param[in] device Pointer to the geometry of the EEPROM
+ * \param[in] address A memory address in the block that was written
+ * \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide)
+ * \sa
+ * \note FT_DEVICE_NOT_FOUND is returned if the EEPROM didn't ack within writeTime
+ * \warning
+ */
+FTDI_API FT_STATUS EEPROM_WaitReady(EEPROM_Device *device, uint32 address)
+{
+	FT_STATUS status;
+	uint32 elapsedUs=0;
+	FN_ENTER;
+#ifdef ENABLE_PARAMETER_CHECKING
+	CHECK_NULL_RET(device);
+#endif
+	status = I2C_PollAck(device->handle,EEPROM_SLAVE_ADDRESS(device,address),
+		device->writeTime,&elapsedUs);
+	DBG(MSG_DEBUG,"write cycle took %uus\n",(unsigned)elapsedUs);
+	FN_EXIT;
+	return status;
+}
+
+
+/******************************************************************************/
+/*						Local function definitions						  */
+/******************************************************************************/
+
+/*!
+ * \brief Makes the address bytes of a memory address
+ *
+ * \param[in] device Pointer to the geometry of the EEPROM
+ * \param[in] address Memory address
+ * \param[out] buffer Buffer of EEPROM_MAX_ADDRESS_BYTES bytes for the address, MSB first
+ * \return Number of address bytes
+ * \sa EEPROM_SLAVE_ADDRESS
+ * \note
+ * \warning
+ */
+uint32 EEPROM_MakeAddress(const EEPROM_Device *device, uint32 address, uint8 *buffer)
+{
+	uint32 i;
+
+	for(i=0; i<device->addressBytes; i++)
+		buffer[i] = (uint8)(address >> (8*(device->addressBytes-1-i)));
+	return device->addressBytes;
+}
+
@@ -0,0 +1,79 @@
+/*!
+ * \file ftdi_eeprom.h
+ *
+ * \author FTDI
+ * \date 20261018
+ *
+ * Copyright (C) 2000-2014 Future Technology Devices International Limited
+ *
+ *
+ * THIS SOFTWARE IS PROVIDED BY FUTURE TECHNOLOGY DEVICES INTERNATIONAL LIMITED ``AS IS'' AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL FUTURE TECHNOLOGY DEVICES INTERNATIONAL LIMITED
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Project: libMPSSE
+ * Module: EEPROM
+ *
+ * Rivision History:
+ * 0.1 - initial version
+ */
+
+#ifndef FTDI_EEPROM_H
+#define FTDI_EEPROM_H
+
+#include "ftdi_i2c.h"
+
+
+/******************************************************************************/
+/*								Macro defines								  */
+/******************************************************************************/
+/* Largest number of bytes read in one transaction by EEPROM_Read */
+#define EEPROM_READ_CHUNK_SIZE		2048
+
+/* Largest number of address bytes */
+#define EEPROM_MAX_ADDRESS_BYTES	2
+
+
+/******************************************************************************/
+/*								Type defines								  */
+/******************************************************************************/
+
+/* Geometry of a 24Cxx/M24xxx I2C EEPROM, filled in by the user application. Typical values:
+	24C01/24C02			size 128/256,		pageSize 8,		addressBytes 1
+	24C04/08/16			size 512-2048,		pageSize 16,	addressBytes 1
+	24C32/24C64			size 4096/8192,		pageSize 32,	addressBytes 2
+	24C128/24C256		size 16384/32768,	pageSize 64,	addressBytes 2
+	24C512				size 65536,			pageSize 128,	addressBytes 2
+	24CM01/M24M01		size 131072,		pageSize 256,	addressBytes 2
+Address bits that don't fit in the address bytes(e.g. A10-A8 of a 24C16) are sent in the low bits
+of the slave address, as these parts expect */
+typedef struct EEPROM_Device_t
+{
+	FT_HANDLE	handle;			/* I2C channel the EEPROM is connected to */
+	uint32		deviceAddress;	/* 7bit slave address of the first block, e.g. 0x50 */
+	uint32		size;			/* in bytes */
+	uint32		pageSize;		/* in bytes */
+	uint8		addressBytes;	/* 1 or 2 */
+	uint32		writeTime;		/* longest write cycle in milliseconds(tWR, usually 5-10ms) */
+}EEPROM_Device;
+
+
+/******************************************************************************/
+/*								Function declarations						  */
+/******************************************************************************/
+FTDI_API FT_STATUS EEPROM_Read(EEPROM_Device *device, uint32 address, uint8 *buffer,
+	uint32 sizeToTransfer, uint32 *sizeTransferred);
+FTDI_API FT_STATUS EEPROM_Write(EEPROM_Device *device, uint32 address, uint8 *buffer,
+	uint32 sizeToTransfer, uint32 *sizeTransferred);
+FTDI_API FT_STATUS EEPROM_WaitReady(EEPROM_Device *device, uint32 address);
+
+/******************************************************************************/
+
+
+#endif	/*FTDI_EEPROM_H*/
+
@@ -0,0 +1,1664 @@
+/*!
+ * \file ftdi_emu.c
+ *
+ * \author FTDI
+ * \date 20261018
+ *
+ * Copyright (C) 2000-2014 Future Technology Devices International Limited
+ *
+ *
+ * THIS SOFTWARE IS PROVIDED BY FUTURE TECHNOLOGY DEVICES INTERNATIONAL LIMITED ``AS IS'' AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL FUTURE TECHNOLOGY DEVICES INTERNATIONAL LIMITED
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Project: libMPSSE
+ * Module: Emulator
+ *
+ * Rivision History:
+ * 0.1 - initial version
+ */
+
+
+/******************************************************************************/
+/*								Include files					  			  */
+/******************************************************************************/
+#include "ftdi_infra.h"		/*Common portable infrastructure(datatypes, libraries, etc)*/
+#include "ftdi_common.h"	/*Common across I2C, SPI, JTAG modules*/
+#include "ftdi_emu.h"		/*Emulator specific*/
+
+
+/******************************************************************************/
+/*								Macro and type defines					  		  */
+/******************************************************************************/
+
+
+/******************************************************************************/
+/*								Local function declarations					  */
+/******************************************************************************/
+FT_STATUS Emu_CreateDeviceInfoList(LPDWORD numDevices);
+FT_STATUS Emu_GetDeviceInfoList(FT_DEVICE_LIST_INFO_NODE *list, LPDWORD numDevices);
+FT_STATUS Emu_Open(uint32 index, FT_HANDLE *handle);
+FT_STATUS Emu_OpenEx(PVOID arg, DWORD flags, FT_HANDLE *handle);
+FT_STATUS Emu_Close(FT_HANDLE handle);
+FT_STATUS Emu_Write(FT_HANDLE handle, LPVOID buffer, DWORD bytesToWrite, LPDWORD bytesWritten);
+FT_STATUS Emu_Read(FT_HANDLE handle, LPVOID buffer, DWORD bytesToRead, LPDWORD bytesRead);
+FT_STATUS Emu_GetQueueStatus(FT_HANDLE handle, LPDWORD amountInRxQueue);
+FT_STATUS Emu_Purge(FT_HANDLE handle, ULONG mask);
+FT_STATUS Emu_ResetDevice(FT_HANDLE handle);
+FT_STATUS Emu_SetBitMode(FT_HANDLE handle, UCHAR mask, UCHAR mode);
+FT_STATUS Emu_SetLatencyTimer(FT_HANDLE handle, UCHAR latency);
+FT_STATUS Emu_SetUSBParameters(FT_HANDLE handle, ULONG inTransferSize, ULONG outTransferSize);
+FT_STATUS Emu_SetChars(FT_HANDLE handle, UCHAR eventCh, UCHAR eventChEn, UCHAR errorCh,
+	UCHAR errorChEn);
+FT_STATUS Emu_SetTimeouts(FT_HANDLE handle, ULONG readTimeout, ULONG writeTimeout);
+FT_STATUS Emu_GetDeviceInfo(FT_HANDLE handle, FT_DEVICE *ftDevice, LPDWORD deviceID,
+	PCHAR serialNumber, PCHAR description);
+
+void Emu_GetInfo(FT_DEVICE_LIST_INFO_NODE *info);
+FT_STATUS Emu_OpenDevice(FT_HANDLE *handle);
+uint32 Emu_GetEnv(const char *name, uint32 defaultValue);
+void Emu_Sleep(uint64 ns);
+FT_STATUS Emu_Reserve(uint8 **buffer, uint32 *size, uint32 needed);
+void Emu_ResetMpsse(Emu_Device *device);
+uint32 Emu_CommandLength(const uint8 *command, uint32 available);
+FT_STATUS Emu_Execute(Emu_Device *device, const uint8 *command);
+FT_STATUS Emu_Shift(Emu_Device *device, uint8 opcode, const uint8 *out, uint32 bits);
+uint64 Emu_Time(Emu_Device *device, uint64 halfCycles);
+uint8 Emu_LowPins(Emu_Device *device);
+uint8 Emu_DiLevel(Emu_Device *device);
+void Emu_Notify(Emu_Device *device, uint8 oldPins);
+FT_STATUS Emu_Answer(Emu_Device *device, uint8 data);
+void Emu_Flush(Emu_Device *device, uint64 time);
+uint32 Emu_Ready(Emu_Device *device, uint64 now);
+uint64 Emu_NextReady(Emu_Device *device, uint64 now);
+void Emu_Update24c(Emu_Device *device, Emu_Slave *slave, uint8 oldPins, uint8 newPins);
+void Emu_Byte24c(Emu_Device *device, Emu_Slave *slave, Emu_Eeprom24 *eeprom);
+void Emu_Update93c(Emu_Device *device, Emu_Slave *slave, uint8 oldPins, uint8 newPins);
+void Emu_Command93c(Emu_Slave *slave, Emu_Eeprom93 *eeprom);
+void Emu_End93c(Emu_Device *device, Emu_Eeprom93 *eeprom);
+void Emu_UpdateFlash(Emu_Device *device, Emu_Slave *slave, uint8 oldPins, uint8 newPins);
+void Emu_ByteFlash(Emu_Device *device, Emu_Flash *flash, uint8 data);
+void Emu_EndFlash(Emu_Device *device, Emu_Flash *flash);
+
+
+/******************************************************************************/
+/*								Global variables							  */
+/******************************************************************************/
+
+const Backend_Ops Backend_Emulator =
+{
+	"emulator",
+	Emu_CreateDeviceInfoList,
+	Emu_GetDeviceInfoList,
+	Emu_Open,
+	Emu_OpenEx,
+	Emu_Close,
+	Emu_Write,
+	Emu_Read,
+	Emu_GetQueueStatus,
+	Emu_Purge,
+	Emu_ResetDevice,
+	Emu_SetBitMode,
+	Emu_SetLatencyTimer,
+	Emu_SetUSBParameters,
+	Emu_SetChars,
+	Emu_SetTimeouts,
+	Emu_GetDeviceInfo
+};
+
+/* The emulated chip, the only one there is */
+static Emu_Device Emu_Chip;
+
+/* The slaves keep their memory from one opening of the chip to the next, like a board that stays
+powered. The memory of the flash is allocated on the first opening */
+static Emu_Eeprom24 Emu_I2cEeprom;
+static Emu_Eeprom93 Emu_MicrowireEeprom;
+static Emu_Flash Emu_SpiFlash;
+
+static Emu_Slave Emu_Slaves[] =
+{
+	{"24C16",Emu_Update24c,&Emu_I2cEeprom,FALSE},
+	{"93LC56B",Emu_Update93c,&Emu_MicrowireEeprom,FALSE},
+	{"SPI flash",Emu_UpdateFlash,&Emu_SpiFlash,FALSE}
+};
+
+#define EMU_NUM_SLAVES		(sizeof(Emu_Slaves)/sizeof(Emu_Slaves[0]))
+
+
+/******************************************************************************/
+/*						Local function definitions						  */
+/******************************************************************************/
+
+/*!
+ * \brief Enumerates the emulated chip
+ *
+ * \param[out] numDevices Number of ports, always 1
+ * \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide)
+ * \sa
+ * \note
+ * \warning
+ */
+FT_STATUS Emu_CreateDeviceInfoList(LPDWORD numDevices)
+{
+	*numDevices = 1;
+	return FT_OK;
+}
+
+/*!
+ * \brief Returns the information of the emulated chip
+ *
+ * \param[out] list Array of the information of the ports(memory to be allocated by caller)
+ * \param[out] numDevices Number of ports, always 1
+ * \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide)
+ * \sa
+ * \note
+ * \warning To be called with the lock taken(Infra_Lock), as Mid_RefreshChannels does
+ */
+FT_STATUS Emu_GetDeviceInfoList(FT_DEVICE_LIST_INFO_NODE *list, LPDWORD numDevices)
+{
+	Emu_GetInfo(&list[0]);
+	*numDevices = 1;
+	return FT_OK;
+}
+
+/*!
+ * \brief Opens the emulated chip
+ *
+ * \param[in] index Index of the port, only 0 exists
+ * \param[out] handle Pointer to the handle
+ * \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide)
+ * \sa
+ * \note
+ * \warning
+ */
+FT_STATUS Emu_Open(uint32 index, FT_HANDLE *handle)
+{
+	FT_STATUS status=FT_DEVICE_NOT_FOUND;
+	FN_ENTER;
+	if(0 == index)
+		status = Emu_OpenDevice(handle);
+	FN_EXIT;
+	return status;
+}
+
+/*!
+ * \brief Opens the emulated chip by its serial number, description or location
+ *
+ * \param[in] arg Serial number or description(string), or location ID(cast to a pointer)
+ * \param[in] flags FT_OPEN_BY_SERIAL_NUMBER, FT_OPEN_BY_DESCRIPTION or FT_OPEN_BY_LOCATION
+ * \param[out] handle Pointer to the handle
+ * \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide)
+ * \sa
+ * \note
+ * \warning
+ */
+FT_STATUS Emu_OpenEx(PVOID arg, DWORD flags, FT_HANDLE *handle)
+{
+	FT_STATUS status=FT_DEVICE_NOT_FOUND;
+	FN_ENTER;
+	if(((FT_OPEN_BY_SERIAL_NUMBER == flags) &&
+			(0 == strcmp(EMU_SERIAL_NUMBER,(const char*)arg))) ||
+		((FT_OPEN_BY_DESCRIPTION == flags) &&
+			(0 == strcmp(EMU_DESCRIPTION,(const char*)arg))) ||
+		((FT_OPEN_BY_LOCATION == flags) && (EMU_LOCATION_ID == (DWORD)(size_t)arg)))
+		status = Emu_OpenDevice(handle);
+	FN_EXIT;
+	return status;
+}
+
+/*!
+ * \brief Closes the emulated chip
+ *
+ * \param[in] handle Handle of the port
+ * \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide)
+ * \sa
+ * \note The pins are released, which deselects the slaves
+ * \warning
+ */
+FT_STATUS Emu_Close(FT_HANDLE handle)
+{
+	FT_STATUS status=FT_OK;
+	Emu_Device *device=(Emu_Device*)handle;
+	FN_ENTER;
+	CHECK_NULL_RET(handle);
+	Emu_ResetMpsse(device);
+	INFRA_FREE(device->command);
+	INFRA_FREE(device->answer);
+	Infra_Lock();
+	device->open = FALSE;
+	Infra_Unlock();
+	FN_EXIT;
+	return status;
+}
+
+/*!
+ * \brief Writes commands to the MPSSE
+ *
+ * The commands are executed as soon as they are complete, a command split over two writes is
+ * kept until the rest of it arrives. The MPSSE runs on emulated time: a command starts when the
+ * previous one is done or when it reaches the chip, whichever is later, and the shifting
+ * commands take as long as the clock set makes them take.
+ *
+ * \param[in] handle Handle of the port
+ * \param[in] buffer Commands to be written
+ * \param[in] bytesToWrite Number of bytes to be written
+ * \param[out] bytesWritten Number of bytes written
+ * \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide)
+ * \sa
+ * \note The bytes written while the MPSSE isn't enabled are dropped, as the UART they would go
+ * out on isn't connected
+ * \warning
+ */
+FT_STATUS Emu_Write(FT_HANDLE handle, LPVOID buffer, DWORD bytesToWrite, LPDWORD bytesWritten)
+{
+	FT_STATUS status;
+	Emu_Device *device=(Emu_Device*)handle;
+	uint64 arrival;
+	uint32 offset=0;
+	uint32 length;
+
+	*bytesWritten = 0;
+	if(ENABLE_MPSSE != device->bitMode)
+	{
+		*bytesWritten = bytesToWrite;
+		return FT_OK;
+	}
+	status = Emu_Reserve(&device->command,&device->commandSize,
+		device->commandLength+(uint32)bytesToWrite);
+	if(FT_OK != status)
+		return status;
+	INFRA_MEMCPY(device->command + device->commandLength,buffer,bytesToWrite);
+	device->commandLength += (uint32)bytesToWrite;
+
+	arrival = Infra_GetTimeUs()*1000 + (device->latencyModel ? EMU_USB_FRAME_NS : 0);
+	if(device->time < arrival)
+		device->time = arrival;
+	while((FT_OK == status) && (offset < device->commandLength))
+	{
+		length = Emu_CommandLength(&device->command[offset],device->commandLength-offset);
+		if((0 == length) || (length > device->commandLength-offset))
+			break;
+		status = Emu_Execute(device,&device->command[offset]);
+		offset += length;
+	}
+	device->commandLength -= offset;
+	memmove(device->command,device->command+offset,device->commandLength);
+	if(FT_OK == status)
+		*bytesWritten = bytesToWrite;
+	return status;
+}
+
+/*!
+ * \brief Reads the answers of the MPSSE
+ *
+ * With the latency model on, the thread sleeps until the answers reach the host, i.e. until a
+ * microframe after the chip flushed them because of SEND_IMMEDIATE, a full packet or the latency
+ * timer.
+ *
+ * \param[in] handle Handle of the port
+ * \param[out] buffer Buffer the data is read into
+ * \param[in] bytesToRead Number of bytes to be read
+ * \param[out] bytesRead Number of bytes read
+ * \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide)
+ * \sa
+ * \note As with D2XX, FT_OK is returned with fewer bytes read when the read timeout expires.
+ * Unlike D2XX, the read returns at once when no answer is pending at all, since none can come
+ * \warning
+ */
+FT_STATUS Emu_Read(FT_HANDLE handle, LPVOID buffer, DWORD bytesToRead, LPDWORD bytesRead)
+{
+	Emu_Device *device=(Emu_Device*)handle;
+	uint64 deadline;
+	uint64 now;
+	uint64 next;
+	uint32 count;
+
+	*bytesRead = 0;
+	now = Infra_GetTimeUs()*1000;
+	deadline = now + (uint64)device->readTimeout*1000000;
+	while(1)
+	{
+		count = Emu_Ready(device,now);
+		if(count > bytesToRead - *bytesRead)
+			count = (uint32)(bytesToRead - *bytesRead);
+		INFRA_MEMCPY((uint8*)buffer + *bytesRead,device->answer + device->answerStart,count);
+		device->answerStart += count;
+		device->consumed += count;
+		*bytesRead += count;
+		while((device->flushCount > 0) &&
+			(device->flushes[device->flushHead].end <= device->consumed))
+		{
+			device->flushHead = (device->flushHead+1) % EMU_MAX_FLUSHES;
+			device->flushCount--;
+		}
+		if(*bytesRead == bytesToRead)
+			break;
+		next = Emu_NextReady(device,now);
+		if(0 == next)
+			break;
+		if((0 != device->readTimeout) && (next > deadline))
+		{
+			if(deadline > now)
+				Emu_Sleep(deadline-now);
+			break;
+		}
+		Emu_Sleep(next-now);
+		now = Infra_GetTimeUs()*1000;
+	}
+	if(device->consumed == device->produced)
+		device->answerStart = 0;
+	return FT_OK;
+}
+
+FT_STATUS Emu_GetQueueStatus(FT_HANDLE handle, LPDWORD amountInRxQueue)
+{
+	*amountInRxQueue = Emu_Ready((Emu_Device*)handle,Infra_GetTimeUs()*1000);
+	return FT_OK;
+}
+
+/*!
+ * \brief Purges the buffers of the emulated chip
+ *
+ * \param[in] handle Handle of the port
+ * \param[in] mask FT_PURGE_RX and/or FT_PURGE_TX
+ * \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide)
+ * \sa
+ * \note Purging the receive buffer drops the answers the chip didn't flush yet as well.
+ * Purging the transmit buffer drops the part of a command received so far
+ * \warning
+ */
+FT_STATUS Emu_Purge(FT_HANDLE handle, ULONG mask)
+{
+	Emu_Device *device=(Emu_Device*)handle;
+
+	if(mask & FT_PURGE_RX)
+	{
+		device->consumed = device->produced;
+		device->flushed = device->produced;
+		device->answerStart = 0;
+		device->flushHead = 0;
+		device->flushCount = 0;
+	}
+	if(mask & FT_PURGE_TX)
+		device->commandLength = 0;
+	return FT_OK;
+}
+
+FT_STATUS Emu_ResetDevice(FT_HANDLE handle)
+{
+	return Emu_Purge(handle,FT_PURGE_RX | FT_PURGE_TX);
+}
+
+/*!
+ * \brief Sets the bit mode of the emulated chip
+ *
+ * \param[in] handle Handle of the port
+ * \param[in] mask Directions of the pins, unused
+ * \param[in] mode RESET_INTERFACE resets the MPSSE, ENABLE_MPSSE enables it
+ * \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide)
+ * \sa
+ * \note The other modes(bit bang, ...) aren't emulated, the writes are dropped while they are set
+ * \warning
+ */
+FT_STATUS Emu_SetBitMode(FT_HANDLE handle, UCHAR mask, UCHAR mode)
+{
+	Emu_Device *device=(Emu_Device*)handle;
+
+	(void)mask;
+	if(RESET_INTERFACE == mode)
+		Emu_ResetMpsse(device);
+	device->bitMode = mode;
+	return FT_OK;
+}
+
+FT_STATUS Emu_SetLatencyTimer(FT_HANDLE handle, UCHAR latency)
+{
+	((Emu_Device*)handle)->latencyTimer = latency;
+	return FT_OK;
+}
+
+FT_STATUS Emu_SetUSBParameters(FT_HANDLE handle, ULONG inTransferSize, ULONG outTransferSize)
+{
+	(void)handle;
+	(void)inTransferSize;
+	(void)outTransferSize;
+	return FT_OK;
+}
+
+FT_STATUS Emu_SetChars(FT_HANDLE handle, UCHAR eventCh, UCHAR eventChEn, UCHAR errorCh,
+	UCHAR errorChEn)
+{
+	(void)handle;
+	(void)eventCh;
+	(void)eventChEn;
+	(void)errorCh;
+	(void)errorChEn;
+	return FT_OK;
+}
+
+FT_STATUS Emu_SetTimeouts(FT_HANDLE handle, ULONG readTimeout, ULONG writeTimeout)
+{
+	Emu_Device *device=(Emu_Device*)handle;
+
+	device->readTimeout = (uint32)readTimeout;
+	device->writeTimeout = (uint32)writeTimeout;
+	return FT_OK;
+}
+
+FT_STATUS Emu_GetDeviceInfo(FT_HANDLE handle, FT_DEVICE *ftDevice, LPDWORD deviceID,
+	PCHAR serialNumber, PCHAR description)
+{
+	Emu_Device *device=(Emu_Device*)handle;
+
+	if(NULL != ftDevice)
+		*ftDevice = (FT_DEVICE)device->info.Type;
+	if(NULL != deviceID)
+		*deviceID = device->info.ID;
+	if(NULL != serialNumber)
+		strcpy(serialNumber,device->info.SerialNumber);
+	if(NULL != description)
+		strcpy(description,device->info.Description);
+	return FT_OK;
+}
+
+/*!
+ * \brief Fills in the information of the emulated chip
+ *
+ * \param[out] info Pointer to the information
+ * \return none
+ * \sa
+ * \note
+ * \warning
+ */
+void Emu_GetInfo(FT_DEVICE_LIST_INFO_NODE *info)
+{
+	memset(info,0,sizeof(FT_DEVICE_LIST_INFO_NODE));
+	info->Flags = FT_FLAGS_HISPEED;
+	if(Emu_Chip.open)
+	{
+		info->Flags |= FT_FLAGS_OPENED;
+		info->ftHandle = (FT_HANDLE)&Emu_Chip;
+	}
+	info->Type = FT_DEVICE_232H;
+	info->ID = EMU_DEVICE_ID;
+	info->LocId = EMU_LOCATION_ID;
+	strcpy(info->SerialNumber,EMU_SERIAL_NUMBER);
+	strcpy(info->Description,EMU_DESCRIPTION);
+}
+
+/*!
+ * \brief Opens the emulated chip
+ *
+ * The chip comes up as after a power cycle, with the MPSSE reset. The memories of the slaves are
+ * erased on the first opening only.
+ *
+ * \param[out] handle Pointer to the handle
+ * \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide)
+ * \sa
+ * \note FT_DEVICE_NOT_OPENED is returned if the chip is open already
+ * \warning
+ */
+FT_STATUS Emu_OpenDevice(FT_HANDLE *handle)
+{
+	FT_STATUS status=FT_OK;
+	Emu_Device *device=&Emu_Chip;
+	uint32 i;
+	FN_ENTER;
+
+	Infra_Lock();
+	if(device->open)
+	{
+		status = FT_DEVICE_NOT_OPENED;
+	}
+	else if(NULL == Emu_SpiFlash.memory)
+	{
+		Emu_SpiFlash.memory = (uint8*)INFRA_MALLOC(EMU_FLASH_SIZE);
+		if(NULL == Emu_SpiFlash.memory)
+		{
+			status = FT_INSUFFICIENT_RESOURCES;
+		}
+		else
+		{
+			memset(Emu_SpiFlash.memory,0xFF,EMU_FLASH_SIZE);
+			memset(Emu_I2cEeprom.memory,0xFF,sizeof(Emu_I2cEeprom.memory));
+			memset(Emu_MicrowireEeprom.memory,0xFF,sizeof(Emu_MicrowireEeprom.memory));
+		}
+	}
+	if(FT_OK == status)
+	{
+		memset(device,0,sizeof(Emu_Device));
+		device->command = (uint8*)INFRA_MALLOC(EMU_BUFFER_SIZE);
+		device->answer = (uint8*)INFRA_MALLOC(EMU_BUFFER_SIZE);
+		if((NULL == device->command) || (NULL == device->answer))
+		{
+			INFRA_FREE(device->command);
+			INFRA_FREE(device->answer);
+			status = FT_INSUFFICIENT_RESOURCES;
+		}
+	}
+	if(FT_OK == status)
+	{
+		device->open = TRUE;
+		device->commandSize = EMU_BUFFER_SIZE;
+		device->answerSize = EMU_BUFFER_SIZE;
+		Emu_GetInfo(&device->info);
+		device->bitMode = RESET_INTERFACE;
+		device->latencyTimer = EMU_DEFAULT_LATENCY;
+		device->latencyModel = (0 != Emu_GetEnv(EMU_ENV_LATENCY,1));
+		device->writeTime = (uint64)Emu_GetEnv(EMU_ENV_WRITE_TIME,0)*1000;
+		device->time = Infra_GetTimeUs()*1000;
+		device->divideBy5 = TRUE;
+		/* Nothing drives the pins, the slaves start out deselected and idle */
+		for(i=0; i<EMU_NUM_SLAVES; i++)
+			Emu_Slaves[i].pullLow = FALSE;
+		Emu_I2cEeprom.state = EMU_I2C_IDLE;
+		Emu_MicrowireEeprom.state = EMU_93C_START;
+		Emu_MicrowireEeprom.cycle = EMU_93C_CYCLE_NONE;
+		Emu_SpiFlash.opcode = 0;
+		Emu_SpiFlash.txValid = FALSE;
+		*handle = (FT_HANDLE)device;
+		DBG(MSG_DEBUG,"latency model %s, EEPROM write time %uus\n",
+			device->latencyModel?"on":"off",(unsigned)(device->writeTime/1000));
+	}
+	Infra_Unlock();
+	FN_EXIT;
+	return status;
+}
+
+/*!
+ * \brief Reads a number from the environment
+ *
+ * \param[in] name Name of the environment variable
+ * \param[in] defaultValue Value returned if the variable isn't set
+ * \return Value of the variable
+ * \sa
+ * \note
+ * \warning
+ */
+uint32 Emu_GetEnv(const char *name, uint32 defaultValue)
+{
+	const char *value=getenv(name);
+
+	if((NULL == value) || ('\0' == *value))
+		return defaultValue;
+	return (uint32)strtoul(value,NULL,0);
+}
+
+/*!
+ * \brief Puts the thread to sleep
+ *
+ * \param[in] ns Time to sleep in nanoseconds
+ * \return none
+ * \sa
+ * \note Rounded up to the resolution of the platform's sleep
+ * \warning
+ */
+void Emu_Sleep(uint64 ns)
+{
+#ifdef __linux__
+	usleep((useconds_t)((ns+999)/1000));
+#else
+	Sleep((DWORD)((ns+999999)/1000000));
+#endif
+}
+
+/*!
+ * \brief Makes sure a buffer can hold a number of bytes
+ *
+ * \param[in,out] buffer Pointer to the buffer, replaced by a larger one if needed
+ * \param[in,out] size Pointer to the size of the buffer
+ * \param[in] needed Number of bytes the buffer has to hold
+ * \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide)
+ * \sa
+ * \note The contents are kept
+ * \warning
+ */
+FT_STATUS Emu_Reserve(uint8 **buffer, uint32 *size, uint32 needed)
+{
+	uint8 *newBuffer;
+	uint32 newSize=*size;
+
+	if(needed <= *size)
+		return FT_OK;
+	while(newSize < needed)
+		newSize *= 2;
+	newBuffer = (uint8*)INFRA_MALLOC(newSize);
+	if(NULL == newBuffer)
+		return FT_INSUFFICIENT_RESOURCES;
+	INFRA_MEMCPY(newBuffer,*buffer,*size);
+	INFRA_FREE(*buffer);
+	*buffer = newBuffer;
+	*size = newSize;
+	return FT_OK;
+}
+
+/*!
+ * \brief Resets the MPSSE
+ *
+ * All pins become inputs, and the clock, loopback and the other settings go back to their state
+ * at power up. The part of a command received so far is dropped.
+ *
+ * \param[in] device Pointer to the chip
+ * \return none
+ * \sa
+ * \note
+ * \warning
+ */
+void Emu_ResetMpsse(Emu_Device *device)
+{
+	uint8 oldPins=Emu_LowPins(device);
+
+	device->lowValue = 0;
+	device->lowDirection = 0;
+	device->lowDriveZero = 0;
+	device->highValue = 0;
+	device->highDirection = 0;
+	device->highDriveZero = 0;
+	device->divisor = 0;
+	device->divideBy5 = TRUE;
+	device->threePhase = FALSE;
+	device->loopback = FALSE;
+	device->adaptive = FALSE;
+	device->commandLength = 0;
+	Emu_Notify(device,oldPins);
+}
+
+/*!
+ * \brief Returns the length of a command
+ *
+ * \param[in] command Pointer to the command
+ * \param[in] available Number of bytes received from command on
+ * \return Number of bytes of the command, 0 if more bytes are needed to tell
+ * \sa
+ * \note The commands the MPSSE doesn't know are one byte long
+ * \warning
+ */
+uint32 Emu_CommandLength(const uint8 *command, uint32 available)
+{
+	uint8 opcode=command[0];
+
+	if((opcode >= EMU_DATA_FIRST) && (opcode <= EMU_DATA_LAST))
+	{
+		if(opcode & EMU_DATA_BIT_MODE)
+			return (opcode & EMU_DATA_OUT) ? 3 : 2;
+		if(!(opcode & EMU_DATA_OUT))
+			return 3;
+		if(available < 3)
+			return 0;
+		return 3 + ((uint32)command[1] | ((uint32)command[2]<<8)) + 1;
+	}
+	switch(opcode)
+	{
+		case MPSSE_CMD_SET_DATA_BITS_LOWBYTE:
+		case MPSSE_CMD_SET_DATA_BITS_HIGHBYTE:
+		case EMU_CMD_SET_DIVISOR:
+		case MPSSE_CMD_CLOCK_N_BYTES:
+		case MPSSE_CMD_ENABLE_DRIVE_ONLY_ZERO:
+			return 3;
+		case MPSSE_CMD_CLOCK_N_BITS:
+			return 2;
+		default:
+			return 1;
+	}
+}
+
+/*!
+ * \brief Executes a command
+ *
+ * \param[in] device Pointer to the chip
+ * \param[in] command Pointer to the command, which is complete
+ * \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide)
+ * \sa
+ * \note The commands that aren't emulated(JTAG TMS, wait on I/O, ...) are answered as bad
+ * commands. Adaptive clocking is accepted and ignored, as RTCK is taken to follow TCK at once
+ * \warning
+ */
+FT_STATUS Emu_Execute(Emu_Device *device, const uint8 *command)
+{
+	FT_STATUS status=FT_OK;
+	uint8 opcode=command[0];
+	uint8 oldPins;
+	uint8 pins;
+	uint8 driven;
+	uint32 length;
+
+	if((opcode >= EMU_DATA_FIRST) && (opcode <= EMU_DATA_LAST))
+	{
+		if(opcode & EMU_DATA_BIT_MODE)
+			return Emu_Shift(device,opcode,&command[2],(uint32)(command[1] & 0x07)+1);
+		length = ((uint32)command[1] | ((uint32)command[2]<<8)) + 1;
+		return Emu_Shift(device,opcode,&command[3],8*length);
+	}
+	switch(opcode)
+	{
+		case MPSSE_CMD_SET_DATA_BITS_LOWBYTE:
+			oldPins = Emu_LowPins(device);
+			device->lowValue = command[1];
+			device->lowDirection = command[2];
+			Emu_Notify(device,oldPins);
+			break;
+		case MPSSE_CMD_SET_DATA_BITS_HIGHBYTE:
+			device->highValue = command[1];
+			device->highDirection = command[2];
+			break;
+		case MPSSE_CMD_GET_DATA_BITS_LOWBYTE:
+			pins = (uint8)(Emu_LowPins(device) & ~EMU_PIN_DI);
+			if(Emu_DiLevel(device))
+				pins |= EMU_PIN_DI;
+			status = Emu_Answer(device,pins);
+			break;
+		case MPSSE_CMD_GET_DATA_BITS_HIGHBYTE:
+			driven = (uint8)(device->highDirection & ~(device->highDriveZero & device->highValue));
+			status = Emu_Answer(device,(uint8)((driven & device->highValue) |
+				(~driven & EMU_HIGH_PULL_UPS)));
+			break;
+		case EMU_CMD_LOOPBACK_ON:
+			device->loopback = TRUE;
+			break;
+		case EMU_CMD_LOOPBACK_OFF:
+			device->loopback = FALSE;
+			break;
+		case EMU_CMD_SET_DIVISOR:
+			device->divisor = (uint16)(command[1] | (command[2]<<8));
+			break;
+		case MPSSE_CMD_SEND_IMMEDIATE:
+			if(device->latencyModel)
+				Emu_Flush(device,device->time);
+			break;
+		case EMU_CMD_DIVIDE_BY_5_OFF:
+			device->divideBy5 = FALSE;
+			break;
+		case EMU_CMD_DIVIDE_BY_5_ON:
+			device->divideBy5 = TRUE;
+			break;
+		case MPSSE_CMD_ENABLE_3PHASE_CLOCKING:
+			device->threePhase = TRUE;
+			break;
+		case MPSSE_CMD_DISABLE_3PHASE_CLOCKING:
+			device->threePhase = FALSE;
+			break;
+		case MPSSE_CMD_CLOCK_N_BITS:
+			status = Emu_Shift(device,0,NULL,(uint32)(command[1] & 0x07)+1);
+			break;
+		case MPSSE_CMD_CLOCK_N_BYTES:
+			length = ((uint32)command[1] | ((uint32)command[2]<<8)) + 1;
+			status = Emu_Shift(device,0,NULL,8*length);
+			break;
+		case MPSSE_CMD_ENABLE_ADAPTIVE_CLOCKING:
+			device->adaptive = TRUE;
+			break;
+		case MPSSE_CMD_DISABLE_ADAPTIVE_CLOCKING:
+			device->adaptive = FALSE;
+			break;
+		case MPSSE_CMD_ENABLE_DRIVE_ONLY_ZERO:
+			oldPins = Emu_LowPins(device);
+			device->lowDriveZero = command[1];
+			device->highDriveZero = command[2];
+			Emu_Notify(device,oldPins);
+			break;
+		default:
+			DBG(MSG_DEBUG,"bad command 0x%x\n",(unsigned)opcode);
+			status = Emu_Answer(device,EMU_BAD_COMMAND);
+			if(FT_OK == status)
+				status = Emu_Answer(device,opcode);
+			break;
+	}
+	return status;
+}
+
+/*!
+ * \brief Clocks bits in and/or out
+ *
+ * Every bit is a leading and a trailing edge of SCK, the leading edge being the one away from
+ * the level SCK idles at. Data going out is put on DO ahead of the leading edge when it is to
+ * change on the trailing edge, so that it is stable around the edge the slave samples it on.
+ * Data coming in is sampled from the levels before the edge is seen by the slaves, as the
+ * slaves only change their output after the edge.
+ *
+ * \param[in] device Pointer to the chip
+ * \param[in] opcode Opcode of the command, 0 to clock without data
+ * \param[in] out Pointer to the data to be clocked out
+ * \param[in] bits Number of bits
+ * \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide)
+ * \sa
+ * \note The bytes clocked in are answered as they are complete. In bit mode the bits come in
+ * at the bottom of the byte when MSB first, at its top when LSB first
+ * \warning
+ */
+FT_STATUS Emu_Shift(Emu_Device *device, uint8 opcode, const uint8 *out, uint32 bits)
+{
+	FT_STATUS status=FT_OK;
+	uint64 start=device->time;
+	uint64 phases=device->threePhase ? 3 : 2;
+	bool leadingRising=!(device->lowValue & EMU_PIN_SCK);
+	bool write=(0 != (opcode & EMU_DATA_OUT));
+	bool read=(0 != (opcode & EMU_DATA_IN));
+	bool lsbFirst=(0 != (opcode & EMU_DATA_LSB_FIRST));
+	bool outOnLeading;
+	bool inOnLeading;
+	uint8 value;
+	uint8 oldPins;
+	uint8 in=0;
+	uint8 inBit=0;
+	uint32 i;
+
+	outOnLeading = leadingRising ? !(opcode & EMU_DATA_OUT_NEG_EDGE) :
+		(0 != (opcode & EMU_DATA_OUT_NEG_EDGE));
+	inOnLeading = leadingRising ? !(opcode & EMU_DATA_IN_NEG_EDGE) :
+		(0 != (opcode & EMU_DATA_IN_NEG_EDGE));
+	for(i=0; (FT_OK == status) && (i<bits); i++)
+	{
+		device->time = start + Emu_Time(device,i*phases);
+		value = device->lowValue;
+		if(write)
+		{
+			if((out[i/8] >> (lsbFirst ? (i%8) : (7-i%8))) & 0x01)
+				value |= EMU_PIN_DO;
+			else
+				value &= (uint8)~EMU_PIN_DO;
+			if(!outOnLeading)
+			{
+				oldPins = Emu_LowPins(device);
+				device->lowValue = value;
+				Emu_Notify(device,oldPins);
+			}
+		}
+		/* Leading edge */
+		if(read && inOnLeading)
+			inBit = device->loopback ? ((Emu_LowPins(device) & EMU_PIN_DO) ? 1 : 0) :
+				Emu_DiLevel(device);
+		oldPins = Emu_LowPins(device);
+		device->lowValue = value ^ EMU_PIN_SCK;
+		Emu_Notify(device,oldPins);
+		/* Trailing edge */
+		device->time = start + Emu_Time(device,i*phases+1);
+		if(read && !inOnLeading)
+			inBit = device->loopback ? ((Emu_LowPins(device) & EMU_PIN_DO) ? 1 : 0) :
+				Emu_DiLevel(device);
+		oldPins = Emu_LowPins(device);
+		device->lowValue ^= EMU_PIN_SCK;
+		Emu_Notify(device,oldPins);
+		if(read)
+		{
+			in = lsbFirst ? (uint8)((in>>1) | (inBit<<7)) : (uint8)((in<<1) | inBit);
+			if((7 == i%8) || (i+1 == bits))
+			{
+				status = Emu_Answer(device,in);
+				in = 0;
+			}
+		}
+	}
+	device->time = start + Emu_Time(device,bits*phases);
+	return status;
+}
+
+/*!
+ * \brief Converts a number of half cycles of SCK into time
+ *
+ * \param[in] device Pointer to the chip
+ * \param[in] halfCycles Number of half cycles
+ * \return Time in nanoseconds
+ * \sa
+ * \note SCK is the MPSSE clock divided by (1+divisor)*2
+ * \warning
+ */
+uint64 Emu_Time(Emu_Device *device, uint64 halfCycles)
+{
+	return halfCycles*((uint64)device->divisor+1)*1000 /
+		(device->divideBy5 ? EMU_CLOCK_12MHZ : EMU_CLOCK_60MHZ);
+}
+
+/*!
+ * \brief Returns the levels of the low byte pins as the MPSSE drives them
+ *
+ * \param[in] device Pointer to the chip
+ * \return Levels of the pins, the pins that aren't driven are at the level of their pull
+ * \sa
+ * \note EMU_PIN_DI is as driven by the MPSSE, see Emu_DiLevel for the level the slaves make it
+ * \warning
+ */
+uint8 Emu_LowPins(Emu_Device *device)
+{
+	uint8 driven=(uint8)(device->lowDirection & ~(device->lowDriveZero & device->lowValue));
+
+	return (uint8)((driven & device->lowValue) | (~driven & EMU_LOW_PULL_UPS));
+}
+
+/*!
+ * \brief Returns the level of EMU_PIN_DI
+ *
+ * \param[in] device Pointer to the chip
+ * \return 0 if the MPSSE or a slave pulls the pin low, 1 otherwise
+ * \sa
+ * \note
+ * \warning
+ */
+uint8 Emu_DiLevel(Emu_Device *device)
+{
+	uint32 i;
+
+	if(!(Emu_LowPins(device) & EMU_PIN_DI))
+		return 0;
+	for(i=0; i<EMU_NUM_SLAVES; i++)
+	{
+		if(Emu_Slaves[i].pullLow)
+			return 0;
+	}
+	return 1;
+}
+
+/*!
+ * \brief Lets the slaves see a change of the pins
+ *
+ * \param[in] device Pointer to the chip
+ * \param[in] oldPins Levels of the pins before the change(Emu_LowPins)
+ * \return none
+ * \sa
+ * \note
+ * \warning
+ */
+void Emu_Notify(Emu_Device *device, uint8 oldPins)
+{
+	uint8 newPins=Emu_LowPins(device);
+	uint32 i;
+
+	if(newPins == oldPins)
+		return;
+	for(i=0; i<EMU_NUM_SLAVES; i++)
+		Emu_Slaves[i].update(device,&Emu_Slaves[i],oldPins,newPins);
+}
+
+/*!
+ * \brief Adds a byte to the answers of the MPSSE
+ *
+ * The answers are flushed to the host when they fill a packet, and when the latency timer expires
+ * before more answers are produced.
+ *
+ * \param[in] device Pointer to the chip
+ * \param[in] data Byte to be answered
+ * \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide)
+ * \sa Emu_Flush
+ * \note
+ * \warning
+ */
+FT_STATUS Emu_Answer(Emu_Device *device, uint8 data)
+{
+	FT_STATUS status;
+	uint64 latency=(uint64)device->latencyTimer*1000000;
+	uint32 count=(uint32)(device->produced - device->consumed);
+
+	if(device->produced == device->flushed)
+	{
+		device->pendingSince = device->time;
+	}
+	else if(device->latencyModel && (device->time >= device->pendingSince + latency))
+	{
+		Emu_Flush(device,device->pendingSince + latency);
+		device->pendingSince = device->time;
+	}
+	if(device->answerStart + count + 1 > device->answerSize)
+	{
+		memmove(device->answer,device->answer + device->answerStart,count);
+		device->answerStart = 0;
+		status = Emu_Reserve(&device->answer,&device->answerSize,count+1);
+		if(FT_OK != status)
+			return status;
+	}
+	device->answer[device->answerStart + count] = data;
+	device->produced++;
+	if(device->latencyModel && (device->produced - device->flushed >= EMU_PACKET_PAYLOAD))
+		Emu_Flush(device,device->time);
+	return FT_OK;
+}
+
+/*!
+ * \brief Flushes the answers produced so far to the host
+ *
+ * \param[in] device Pointer to the chip
+ * \param[in] time Time of the flush
+ * \return none
+ * \sa Emu_Ready
+ * \note When there are EMU_MAX_FLUSHES flushes waiting to be read already, the flush is merged
+ * into the last one
+ * \warning
+ */
+void Emu_Flush(Emu_Device *device, uint64 time)
+{
+	Emu_FlushMark *flush;
+
+	if(device->produced == device->flushed)
+		return;
+	if(EMU_MAX_FLUSHES == device->flushCount)
+	{
+		flush = &device->flushes[(device->flushHead + device->flushCount-1) % EMU_MAX_FLUSHES];
+	}
+	else
+	{
+		flush = &device->flushes[(device->flushHead + device->flushCount) % EMU_MAX_FLUSHES];
+		device->flushCount++;
+	}
+	flush->end = device->produced;
+	flush->ready = time + EMU_USB_FRAME_NS;
+	device->flushed = device->produced;
+}
+
+/*!
+ * \brief Returns the number of answers that have reached the host
+ *
+ * \param[in] device Pointer to the chip
+ * \param[in] now Current time
+ * \return Number of bytes that can be read
+ * \sa Emu_NextReady
+ * \note
+ * \warning
+ */
+uint32 Emu_Ready(Emu_Device *device, uint64 now)
+{
+	uint64 latency=(uint64)device->latencyTimer*1000000;
+	uint64 ready=device->consumed;
+	Emu_FlushMark *flush;
+	uint32 i;
+
+	if(!device->latencyModel)
+		return (uint32)(device->produced - device->consumed);
+	if((device->produced > device->flushed) && (now >= device->pendingSince + latency))
+		Emu_Flush(device,device->pendingSince + latency);
+	for(i=0; i<device->flushCount; i++)
+	{
+		flush = &device->flushes[(device->flushHead+i) % EMU_MAX_FLUSHES];
+		if(flush->ready > now)
+			break;
+		ready = flush->end;
+	}
+	return (uint32)(ready - device->consumed);
+}
+
+/*!
+ * \brief Returns when the next answers will reach the host
+ *
+ * \param[in] device Pointer to the chip
+ * \param[in] now Current time, Emu_Ready having been called with it
+ * \return Time the next answers can be read, 0 if no answer is pending
+ * \sa Emu_Ready
+ * \note
+ * \warning
+ */
+uint64 Emu_NextReady(Emu_Device *device, uint64 now)
+{
+	Emu_FlushMark *flush;
+	uint32 i;
+
+	if(!device->latencyModel)
+		return 0;
+	for(i=0; i<device->flushCount; i++)
+	{
+		flush = &device->flushes[(device->flushHead+i) % EMU_MAX_FLUSHES];
+		if((flush->end > device->consumed) && (flush->ready > now))
+			return flush->ready;
+	}
+	if(device->produced > device->flushed)
+		return device->pendingSince + (uint64)device->latencyTimer*1000000 + EMU_USB_FRAME_NS;
+	return 0;
+}
+
+/*!
+ * \brief Follows the pins for the 24C16 I2C EEPROM
+ *
+ * SCL is EMU_PIN_SCK, the EEPROM reads SDA from EMU_PIN_DO and pulls EMU_PIN_DI low. It samples
+ * SDA on the rising edges of SCL and changes its output on the falling edges. A write is
+ * committed on STOP, after which the EEPROM doesn't acknowledge its address for the write time.
+ *
+ * \param[in] device Pointer to the chip
+ * \param[in] slave Pointer to the slave
+ * \param[in] oldPins Levels of the pins before the change
+ * \param[in] newPins Levels of the pins after the change
+ * \return none
+ * \sa
+ * \note
+ * \warning
+ */
+void Emu_Update24c(Emu_Device *device, Emu_Slave *slave, uint8 oldPins, uint8 newPins)
+{
+	Emu_Eeprom24 *eeprom=(Emu_Eeprom24*)slave->model;
+	bool sclBefore=(0 != (oldPins & EMU_PIN_SCK));
+	bool sclAfter=(0 != (newPins & EMU_PIN_SCK));
+	uint8 sdaBefore=(oldPins & EMU_PIN_DO) ? 1 : 0;
+	uint8 sdaAfter=(newPins & EMU_PIN_DO) ? 1 : 0;
+	uint16 page;
+	uint8 i;
+
+	if(sclBefore && sclAfter && (sdaBefore != sdaAfter))
+	{
+		if(sdaAfter)
+		{/* STOP */
+			if((EMU_I2C_WRITE == eeprom->state) && (0 != eeprom->latchMask) &&
+				(eeprom->bitCount <= 1))
+			{
+				page = (uint16)(eeprom->address & ~(EMU_24C_PAGE_SIZE-1));
+				for(i=0; i<EMU_24C_PAGE_SIZE; i++)
+				{
+					if(eeprom->latchMask & (1<<i))
+						eeprom->memory[page | i] = eeprom->latch[i];
+				}
+				eeprom->busyUntil = device->time + device->writeTime;
+			}
+			eeprom->state = EMU_I2C_IDLE;
+		}
+		else
+		{/* START */
+			eeprom->state = EMU_I2C_ADDRESS;
+			eeprom->transmit = FALSE;
+		}
+		eeprom->latchMask = 0;
+		eeprom->bitCount = 0;
+		slave->pullLow = FALSE;
+		return;
+	}
+	if(EMU_I2C_IDLE == eeprom->state)
+		return;
+	if(!sclBefore && sclAfter)
+	{
+		if(eeprom->bitCount < 8)
+		{
+			if(!eeprom->transmit)
+				eeprom->shift = (uint8)((eeprom->shift<<1) | sdaAfter);
+		}
+		else if(eeprom->transmit)
+		{
+			eeprom->masterAck = !sdaAfter;
+		}
+		eeprom->bitCount++;
+	}
+	else if(sclBefore && !sclAfter)
+	{
+		if(8 == eeprom->bitCount)
+		{
+			if(eeprom->transmit)
+				slave->pullLow = FALSE;
+			else
+				Emu_Byte24c(device,slave,eeprom);
+		}
+		else if(9 == eeprom->bitCount)
+		{
+			eeprom->bitCount = 0;
+			slave->pullLow = FALSE;
+			if(EMU_I2C_READ == eeprom->state)
+			{
+				if(!eeprom->transmit || eeprom->masterAck)
+				{
+					eeprom->transmit = TRUE;
+					eeprom->shift = eeprom->memory[eeprom->address];
+					eeprom->address = (uint16)((eeprom->address+1) % EMU_24C_SIZE);
+					slave->pullLow = !(eeprom->shift & 0x80);
+				}
+				else
+				{/* nAcked, the master is done reading */
+					eeprom->state = EMU_I2C_IDLE;
+				}
+			}
+		}
+		else if(eeprom->transmit && (eeprom->bitCount > 0) && (eeprom->bitCount < 8))
+		{
+			slave->pullLow = !((eeprom->shift >> (7-eeprom->bitCount)) & 0x01);
+		}
+	}
+}
+
+/*!
+ * \brief Handles a byte received by the 24C16 I2C EEPROM
+ *
+ * This function is called on the falling edge of SCL after the 8th bit, and pulls SDA low for
+ * the acknowledge if the byte is accepted.
+ *
+ * \param[in] device Pointer to the chip
+ * \param[in] slave Pointer to the slave
+ * \param[in] eeprom Pointer to the EEPROM
+ * \return none
+ * \sa Emu_Update24c
+ * \note The 3 lower bits of the device address select the block of 256 bytes
+ * \warning
+ */
+void Emu_Byte24c(Emu_Device *device, Emu_Slave *slave, Emu_Eeprom24 *eeprom)
+{
+	bool ack=TRUE;
+	uint8 data=eeprom->shift;
+
+	switch(eeprom->state)
+	{
+		case EMU_I2C_ADDRESS:
+			if((EMU_24C_ADDRESS != ((data>>1) & EMU_24C_ADDRESS_MASK)) ||
+				(device->time < eeprom->busyUntil))
+			{
+				ack = FALSE;
+				break;
+			}
+			eeprom->address = (uint16)((((data>>1) & EMU_24C_BLOCK_MASK)<<8) |
+				(eeprom->address & 0xFF));
+			eeprom->state = (data & 0x01) ? EMU_I2C_READ : EMU_I2C_WORD_ADDRESS;
+			break;
+		case EMU_I2C_WORD_ADDRESS:
+			eeprom->address = (uint16)((eeprom->address & 0x700) | data);
+			eeprom->latchMask = 0;
+			eeprom->state = EMU_I2C_WRITE;
+			break;
+		case EMU_I2C_WRITE:
+			/* The address rolls over within the page */
+			eeprom->latch[eeprom->address % EMU_24C_PAGE_SIZE] = data;
+			eeprom->latchMask |= (uint16)(1 << (eeprom->address % EMU_24C_PAGE_SIZE));
+			eeprom->address = (uint16)((eeprom->address & ~(EMU_24C_PAGE_SIZE-1)) |
+				((eeprom->address+1) % EMU_24C_PAGE_SIZE));
+			break;
+		default:
+			ack = FALSE;
+			break;
+	}
+	if(!ack)
+		eeprom->state = EMU_I2C_IDLE;
+	slave->pullLow = ack;
+}
+
+/*!
+ * \brief Follows the pins for the 93LC56B Microwire EEPROM
+ *
+ * CS is EMU_PIN_CS_MICROWIRE(active high), CLK is EMU_PIN_SCK, DI is EMU_PIN_DO and DO is
+ * EMU_PIN_DI. A command is a start bit, 2 opcode bits and 8 address bits, clocked in on the
+ * rising edges. Data is clocked out on the rising edges as well, after a dummy 0. Until the start
+ * bit, DO tells whether a write cycle is in progress(low) or not(high).
+ *
+ * \param[in] device Pointer to the chip
+ * \param[in] slave Pointer to the slave
+ * \param[in] oldPins Levels of the pins before the change
+ * \param[in] newPins Levels of the pins after the change
+ * \return none
+ * \sa
+ * \note
+ * \warning
+ */
+void Emu_Update93c(Emu_Device *device, Emu_Slave *slave, uint8 oldPins, uint8 newPins)
+{
+	Emu_Eeprom93 *eeprom=(Emu_Eeprom93*)slave->model;
+	uint8 bit=(newPins & EMU_PIN_DO) ? 1 : 0;
+
+	if(!(newPins & EMU_PIN_CS_MICROWIRE))
+	{
+		if(oldPins & EMU_PIN_CS_MICROWIRE)
+			Emu_End93c(device,eeprom);
+		slave->pullLow = FALSE;
+		return;
+	}
+	if(!(oldPins & EMU_PIN_CS_MICROWIRE))
+	{
+		eeprom->state = EMU_93C_START;
+		eeprom->cycle = EMU_93C_CYCLE_NONE;
+	}
+	if(EMU_93C_START == eeprom->state)
+		slave->pullLow = (device->time < eeprom->busyUntil);
+	if(!(!(oldPins & EMU_PIN_SCK) && (newPins & EMU_PIN_SCK)) ||
+		!(oldPins & EMU_PIN_CS_MICROWIRE))
+		return;
+
+	switch(eeprom->state)
+	{
+		case EMU_93C_START:
+			if(bit && !slave->pullLow)
+			{
+				eeprom->state = EMU_93C_OPCODE;
+				eeprom->count = 0;
+				eeprom->opcode = 0;
+				slave->pullLow = FALSE;
+			}
+			break;
+		case EMU_93C_OPCODE:
+			eeprom->opcode = (uint8)((eeprom->opcode<<1) | bit);
+			if(2 == ++eeprom->count)
+			{
+				eeprom->state = EMU_93C_ADDRESS;
+				eeprom->count = 0;
+				eeprom->address = 0;
+			}
+			break;
+		case EMU_93C_ADDRESS:
+			eeprom->address = (uint8)((eeprom->address<<1) | bit);
+			if(8 == ++eeprom->count)
+				Emu_Command93c(slave,eeprom);
+			break;
+		case EMU_93C_DATA:
+			eeprom->data = (uint16)((eeprom->data<<1) | bit);
+			if(16 == ++eeprom->count)
+			{
+				eeprom->cycle = (EMU_93C_OPCODE_WRITE == eeprom->opcode) ?
+					EMU_93C_CYCLE_WRITE : EMU_93C_CYCLE_WRAL;
+				eeprom->state = EMU_93C_DONE;
+			}
+			break;
+		case EMU_93C_READ:
+			/* Sequential read, the next word follows D0 without a dummy bit */
+			if(0 == eeprom->readBit)
+			{
+				eeprom->address = (uint8)((eeprom->address+1) & EMU_93C_WORD_MASK);
+				eeprom->readBit = 16;
+			}
+			eeprom->readBit--;
+			slave->pullLow = !((eeprom->memory[eeprom->address] >> eeprom->readBit) & 0x01);
+			break;
+		default:
+			break;
+	}
+}
+
+/*!
+ * \brief Decodes a command of the 93LC56B Microwire EEPROM once its address is complete
+ *
+ * \param[in] slave Pointer to the slave
+ * \param[in] eeprom Pointer to the EEPROM
+ * \return none
+ * \sa Emu_Update93c
+ * \note
+ * \warning
+ */
+void Emu_Command93c(Emu_Slave *slave, Emu_Eeprom93 *eeprom)
+{
+	eeprom->count = 0;
+	eeprom->data = 0;
+	eeprom->state = EMU_93C_DONE;
+	switch(eeprom->opcode)
+	{
+		case EMU_93C_OPCODE_READ:
+			eeprom->address &= EMU_93C_WORD_MASK;
+			eeprom->readBit = 16;
+			eeprom->state = EMU_93C_READ;
+			/* Dummy 0 ahead of the data */
+			slave->pullLow = TRUE;
+			break;
+		case EMU_93C_OPCODE_WRITE:
+			eeprom->state = EMU_93C_DATA;
+			break;
+		case EMU_93C_OPCODE_ERASE:
+			eeprom->cycle = EMU_93C_CYCLE_ERASE;
+			break;
+		default:
+			switch(eeprom->address >> 6)
+			{
+				case EMU_93C_EWEN:
+					eeprom->writeEnabled = TRUE;
+					break;
+				case EMU_93C_EWDS:
+					eeprom->writeEnabled = FALSE;
+					break;
+				case EMU_93C_ERAL:
+					eeprom->cycle = EMU_93C_CYCLE_ERAL;
+					break;
+				default:
+					eeprom->state = EMU_93C_DATA;
+					break;
+			}
+			break;
+	}
+}
+
+/*!
+ * \brief Starts the write cycle of the 93LC56B Microwire EEPROM, if any, when CS goes low
+ *
+ * \param[in] device Pointer to the chip
+ * \param[in] eeprom Pointer to the EEPROM
+ * \return none
+ * \sa Emu_Update93c
+ * \note The cycle is dropped when writing isn't enabled(EWEN)
+ * \warning
+ */
+void Emu_End93c(Emu_Device *device, Emu_Eeprom93 *eeprom)
+{
+	uint32 i;
+
+	if((EMU_93C_CYCLE_NONE != eeprom->cycle) && eeprom->writeEnabled)
+	{
+		switch(eeprom->cycle)
+		{
+			case EMU_93C_CYCLE_WRITE:
+				eeprom->memory[eeprom->address & EMU_93C_WORD_MASK] = eeprom->data;
+				break;
+			case EMU_93C_CYCLE_ERASE:
+				eeprom->memory[eeprom->address & EMU_93C_WORD_MASK] = 0xFFFF;
+				break;
+			default:
+				for(i=0; i<EMU_93C_WORDS; i++)
+					eeprom->memory[i] = (EMU_93C_CYCLE_WRAL == eeprom->cycle) ?
+						eeprom->data : 0xFFFF;
+				break;
+		}
+		eeprom->busyUntil = device->time + device->writeTime;
+	}
+	eeprom->cycle = EMU_93C_CYCLE_NONE;
+	eeprom->state = EMU_93C_START;
+}
+
+/*!
+ * \brief Follows the pins for the SPI flash
+ *
+ * CS# is EMU_PIN_CS_FLASH(active low), SCK is EMU_PIN_SCK, SI is EMU_PIN_DO and SO is
+ * EMU_PIN_DI. The flash supports SPI modes 0 and 3: it samples SI on the rising edges of SCK and
+ * changes SO on the falling edges.
+ *
+ * \param[in] device Pointer to the chip
+ * \param[in] slave Pointer to the slave
+ * \param[in] oldPins Levels of the pins before the change
+ * \param[in] newPins Levels of the pins after the change
+ * \return none
+ * \sa
+ * \note
+ * \warning
+ */
+void Emu_UpdateFlash(Emu_Device *device, Emu_Slave *slave, uint8 oldPins, uint8 newPins)
+{
+	Emu_Flash *flash=(Emu_Flash*)slave->model;
+
+	if(newPins & EMU_PIN_CS_FLASH)
+	{
+		if(!(oldPins & EMU_PIN_CS_FLASH))
+			Emu_EndFlash(device,flash);
+		slave->pullLow = FALSE;
+		return;
+	}
+	if(oldPins & EMU_PIN_CS_FLASH)
+	{
+		flash->opcode = 0;
+		flash->count = 0;
+		flash->bitCount = 0;
+		flash->txValid = FALSE;
+		slave->pullLow = FALSE;
+		return;
+	}
+	if(!(oldPins & EMU_PIN_SCK) && (newPins & EMU_PIN_SCK))
+	{
+		flash->shift = (uint8)((flash->shift<<1) | ((newPins & EMU_PIN_DO) ? 1 : 0));
+		if(8 == ++flash->bitCount)
+		{
+			flash->bitCount = 0;
+			flash->txBit = 0;
+			Emu_ByteFlash(device,flash,flash->shift);
+		}
+	}
+	else if((oldPins & EMU_PIN_SCK) && !(newPins & EMU_PIN_SCK))
+	{
+		if(flash->txValid && (flash->txBit < 8))
+		{
+			slave->pullLow = !((flash->tx >> (7-flash->txBit)) & 0x01);
+			flash->txBit++;
+		}
+		else
+		{
+			slave->pullLow = FALSE;
+		}
+	}
+}
+
+/*!
+ * \brief Handles a byte received by the SPI flash
+ *
+ * This function is called on the rising edge of SCK of the 8th bit, and loads the byte that is
+ * shifted out next, if any.
+ *
+ * \param[in] device Pointer to the chip
+ * \param[in] flash Pointer to the flash
+ * \param[in] data Byte received
+ * \return none
+ * \sa Emu_UpdateFlash
+ * \note While the flash is busy only the status register can be read. The commands that change
+ * the memory or the status register take effect when CS# goes high
+ * \warning
+ */
+void Emu_ByteFlash(Emu_Device *device, Emu_Flash *flash, uint8 data)
+{
+	static const uint8 jedecId[3]={EMU_FLASH_MANUFACTURER,EMU_FLASH_MEMORY_TYPE,
+		EMU_FLASH_CAPACITY};
+	uint8 status=flash->status;
+
+	if(device->time < flash->busyUntil)
+		status |= EMU_FLASH_WIP;
+	flash->count++;
+	flash->txValid = FALSE;
+	if(1 == flash->count)
+	{
+		flash->opcode = data;
+		flash->address = 0;
+		if((status & EMU_FLASH_WIP) && (EMU_FLASH_READ_STATUS != data))
+			flash->opcode = 0;
+		else if(EMU_FLASH_PAGE_PROGRAM == data)
+			memset(flash->page,0xFF,EMU_FLASH_PAGE_SIZE);
+	}
+	else if(flash->count <= 4)
+	{
+		flash->address = (flash->address<<8) | data;
+	}
+	switch(flash->opcode)
+	{
+		case EMU_FLASH_READ_STATUS:
+			flash->tx = status;
+			flash->txValid = TRUE;
+			break;
+		case EMU_FLASH_JEDEC_ID:
+			flash->tx = jedecId[(flash->count-1)%3];
+			flash->txValid = TRUE;
+			break;
+		case EMU_FLASH_RELEASE_POWER_DOWN:
+			if(flash->count >= 4)
+			{
+				flash->tx = EMU_FLASH_DEVICE_ID;
+				flash->txValid = TRUE;
+			}
+			break;
+		case EMU_FLASH_READ:
+		case EMU_FLASH_FAST_READ:
+			/* Fast read has a dummy byte after the address */
+			if(flash->count >= ((EMU_FLASH_READ == flash->opcode) ? 4U : 5U))
+			{
+				flash->tx = flash->memory[flash->address % EMU_FLASH_SIZE];
+				flash->address++;
+				flash->txValid = TRUE;
+			}
+			break;
+		case EMU_FLASH_PAGE_PROGRAM:
+			/* The address wraps around within the page */
+			if(flash->count >= 5)
+			{
+				flash->page[flash->address % EMU_FLASH_PAGE_SIZE] = data;
+				flash->address = (flash->address & ~(EMU_FLASH_PAGE_SIZE-1)) |
+					((flash->address+1) % EMU_FLASH_PAGE_SIZE);
+			}
+			break;
+		case EMU_FLASH_WRITE_STATUS:
+			if(2 == flash->count)
+				flash->newStatus = data;
+			break;
+		default:
+			break;
+	}
+}
+
+/*!
+ * \brief Executes the command of the SPI flash that takes effect when CS# goes high
+ *
+ * \param[in] device Pointer to the chip
+ * \param[in] flash Pointer to the flash
+ * \return none
+ * \sa Emu_UpdateFlash
+ * \note As on the real parts, a command that changes the memory is dropped unless CS# goes high
+ * on a byte boundary with the write enable latch(WEL) set. Programming only clears bits
+ * \warning
+ */
+void Emu_EndFlash(Emu_Device *device, Emu_Flash *flash)
+{
+	uint32 base;
+	uint32 size=0;
+	uint64 busyTime=0;
+	uint32 i;
+
+	if(0 != flash->bitCount)
+		return;
+	switch(flash->opcode)
+	{
+		case EMU_FLASH_WRITE_ENABLE:
+			flash->status |= EMU_FLASH_WEL;
+			return;
+		case EMU_FLASH_WRITE_DISABLE:
+			flash->status &= (uint8)~EMU_FLASH_WEL;
+			return;
+		case EMU_FLASH_PAGE_PROGRAM:
+			if(flash->count < 5)
+				return;
+			busyTime = EMU_FLASH_PROGRAM_NS;
+			break;
+		case EMU_FLASH_SECTOR_ERASE:
+			if(4 != flash->count)
+				return;
+			size = EMU_FLASH_SECTOR_SIZE;
+			busyTime = EMU_FLASH_SECTOR_ERASE_NS;
+			break;
+		case EMU_FLASH_BLOCK_ERASE:
+			if(4 != flash->count)
+				return;
+			size = EMU_FLASH_BLOCK_SIZE;
+			busyTime = EMU_FLASH_BLOCK_ERASE_NS;
+			break;
+		case EMU_FLASH_CHIP_ERASE:
+		case EMU_FLASH_CHIP_ERASE_ALT:
+			if(1 != flash->count)
+				return;
+			size = EMU_FLASH_SIZE;
+			busyTime = EMU_FLASH_CHIP_ERASE_NS;
+			break;
+		case EMU_FLASH_WRITE_STATUS:
+			if(2 != flash->count)
+				return;
+			busyTime = EMU_FLASH_WRITE_STATUS_NS;
+			break;
+		default:
+			return;
+	}
+	if(!(flash->status & EMU_FLASH_WEL))
+		return;
+
+	if(EMU_FLASH_PAGE_PROGRAM == flash->opcode)
+	{
+		base = (flash->address % EMU_FLASH_SIZE) & ~(EMU_FLASH_PAGE_SIZE-1);
+		for(i=0; i<EMU_FLASH_PAGE_SIZE; i++)
+			flash->memory[base+i] &= flash->page[i];
+	}
+	else if(EMU_FLASH_WRITE_STATUS == flash->opcode)
+	{
+		flash->status = (uint8)((flash->status & ~EMU_FLASH_STATUS_WRITABLE) |
+			(flash->newStatus & EMU_FLASH_STATUS_WRITABLE));
+	}
+	else
+	{
+		base = (flash->address % EMU_FLASH_SIZE) & ~(size-1);
+		memset(flash->memory + base,0xFF,size);
+	}
+	flash->status &= (uint8)~EMU_FLASH_WEL;
+	flash->busyUntil = device->time + busyTime;
+}
@@ -0,0 +1,306 @@
+/*!
+ * \file ftdi_emu.h
+ *
+ * \author FTDI
+ * \date 20261018
+ *
+ * Copyright (C) 2000-2014 Future Technology Devices International Limited
+ *
+ *
+ * THIS SOFTWARE IS PROVIDED BY FUTURE TECHNOLOGY DEVICES INTERNATIONAL LIMITED ``AS IS'' AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL FUTURE TECHNOLOGY DEVICES INTERNATIONAL LIMITED
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Project: libMPSSE
+ * Module: Emulator
+ *
+ * Rivision History:
+ * 0.1 - initial version
+ */
+
+#ifndef FTDI_EMU_H
+#define FTDI_EMU_H
+
+#include "ftdi_backend.h"
+
+
+/******************************************************************************/
+/*								Macro defines								  */
+/******************************************************************************/
+/* Environment variables read when the channel is opened. LIBMPSSE_EMU_LATENCY=0 turns the USB
+latency model off, the answers of the MPSSE can then be read as soon as they are produced.
+LIBMPSSE_EMU_WRITE_TIME is the write cycle time of the EEPROMs in microseconds, 0 by default so
+that the samples, which read back right after writing, don't have to poll for completion */
+#define EMU_ENV_LATENCY					"LIBMPSSE_EMU_LATENCY"
+#define EMU_ENV_WRITE_TIME				"LIBMPSSE_EMU_WRITE_TIME"
+
+/* The emulated chip, a single FT232H */
+#define EMU_DEVICE_ID					0x04036014
+#define EMU_LOCATION_ID					0x0E01
+#define EMU_SERIAL_NUMBER				"EMU00001"
+#define EMU_DESCRIPTION					"Single RS232-HS"
+
+/* Bits of the opcodes of the data shifting commands(0x10 to 0x3F) */
+#define EMU_DATA_OUT_NEG_EDGE			0x01
+#define EMU_DATA_BIT_MODE				0x02
+#define EMU_DATA_IN_NEG_EDGE			0x04
+#define EMU_DATA_LSB_FIRST				0x08
+#define EMU_DATA_OUT					0x10
+#define EMU_DATA_IN						0x20
+#define EMU_DATA_FIRST					0x10
+#define EMU_DATA_LAST					0x3F
+
+/* Commands that ftdi_common.h has no name for */
+#define EMU_CMD_LOOPBACK_ON				0x84
+#define EMU_CMD_LOOPBACK_OFF			0x85
+#define EMU_CMD_SET_DIVISOR				0x86
+#define EMU_CMD_DIVIDE_BY_5_OFF			0x8A
+#define EMU_CMD_DIVIDE_BY_5_ON			0x8B
+/* Answer to a command the MPSSE doesn't know, followed by the command */
+#define EMU_BAD_COMMAND					0xFA
+
+/* Clock of the MPSSE in MHz with divide-by-5 off and on */
+#define EMU_CLOCK_60MHZ					60
+#define EMU_CLOCK_12MHZ					12
+
+/* Wiring of the emulated board, all slaves are on the low byte */
+#define EMU_PIN_SCK						0x01	/* SCK of SPI, SCL of I2C */
+#define EMU_PIN_DO						0x02	/* MOSI, SDA as driven by the MPSSE */
+#define EMU_PIN_DI						0x04	/* MISO, SDA as seen by the MPSSE */
+#define EMU_PIN_CS_MICROWIRE			0x08	/* CS of the 93LC56B, active high */
+#define EMU_PIN_CS_FLASH				0x10	/* CS# of the SPI flash, active low */
+/* Levels the pins float to when nothing drives them. ADBUS3 has a pull-down so that the 93LC56B
+is deselected, the other pins have pull-ups */
+#define EMU_LOW_PULL_UPS				0xF7
+#define EMU_HIGH_PULL_UPS				0xFF
+
+/* USB latency model: the commands reach the chip one microframe after they are written, the
+answers are sent in packets of up to EMU_PACKET_PAYLOAD bytes which reach the host one
+microframe after the chip flushed them */
+#define EMU_USB_FRAME_NS				125000
+#define EMU_PACKET_PAYLOAD				510
+#define EMU_DEFAULT_LATENCY				16
+/* Flushes waiting to be read before they are merged */
+#define EMU_MAX_FLUSHES					64
+/* Initial size of the buffers of commands and answers */
+#define EMU_BUFFER_SIZE					4096
+
+/* 24C16 I2C EEPROM: 8 blocks of 256 bytes at the addresses 0x50 to 0x57 */
+#define EMU_24C_ADDRESS					0x50
+#define EMU_24C_ADDRESS_MASK			0x78
+#define EMU_24C_BLOCK_MASK				0x07
+#define EMU_24C_SIZE					2048
+#define EMU_24C_PAGE_SIZE				16
+
+/* 93LC56B Microwire EEPROM organized as 128 words of 16 bits */
+#define EMU_93C_WORDS					128
+#define EMU_93C_WORD_MASK				0x7F
+#define EMU_93C_OPCODE_EXTENDED			0x0
+#define EMU_93C_OPCODE_WRITE			0x1
+#define EMU_93C_OPCODE_READ				0x2
+#define EMU_93C_OPCODE_ERASE			0x3
+/* The extended opcode is told by the 2 upper bits of the address */
+#define EMU_93C_EWDS					0x0
+#define EMU_93C_WRAL					0x1
+#define EMU_93C_ERAL					0x2
+#define EMU_93C_EWEN					0x3
+/* Write cycles started when CS goes low */
+#define EMU_93C_CYCLE_NONE				0
+#define EMU_93C_CYCLE_WRITE				1
+#define EMU_93C_CYCLE_ERASE				2
+#define EMU_93C_CYCLE_WRAL				3
+#define EMU_93C_CYCLE_ERAL				4
+
+/* SPI NOR flash of 1MB(W25Q80 like) */
+#define EMU_FLASH_SIZE					0x100000
+#define EMU_FLASH_PAGE_SIZE				256
+#define EMU_FLASH_SECTOR_SIZE			4096
+#define EMU_FLASH_BLOCK_SIZE			65536
+#define EMU_FLASH_MANUFACTURER			0xEF
+#define EMU_FLASH_MEMORY_TYPE			0x40
+#define EMU_FLASH_CAPACITY				0x14
+#define EMU_FLASH_DEVICE_ID				0x13
+#define EMU_FLASH_WRITE_STATUS			0x01
+#define EMU_FLASH_PAGE_PROGRAM			0x02
+#define EMU_FLASH_READ					0x03
+#define EMU_FLASH_WRITE_DISABLE			0x04
+#define EMU_FLASH_READ_STATUS			0x05
+#define EMU_FLASH_WRITE_ENABLE			0x06
+#define EMU_FLASH_FAST_READ				0x0B
+#define EMU_FLASH_SECTOR_ERASE			0x20
+#define EMU_FLASH_CHIP_ERASE			0x60
+#define EMU_FLASH_JEDEC_ID				0x9F
+#define EMU_FLASH_RELEASE_POWER_DOWN	0xAB
+#define EMU_FLASH_CHIP_ERASE_ALT		0xC7
+#define EMU_FLASH_BLOCK_ERASE			0xD8
+/* Bits of the status register, the bits above WEL can be written(they protect nothing here) */
+#define EMU_FLASH_WIP					0x01
+#define EMU_FLASH_WEL					0x02
+#define EMU_FLASH_STATUS_WRITABLE		0xFC
+/* Busy times in nanoseconds */
+#define EMU_FLASH_PROGRAM_NS			700000
+#define EMU_FLASH_SECTOR_ERASE_NS		45000000
+#define EMU_FLASH_BLOCK_ERASE_NS		150000000
+#define EMU_FLASH_CHIP_ERASE_NS			2000000000ULL
+#define EMU_FLASH_WRITE_STATUS_NS		10000000
+
+
+/******************************************************************************/
+/*								Type defines								  */
+/******************************************************************************/
+
+/* States of the I2C EEPROM between a START and a STOP */
+typedef enum Emu_I2cState_t
+{
+	EMU_I2C_IDLE = 0,	/* not addressed, waiting for a START */
+	EMU_I2C_ADDRESS,
+	EMU_I2C_WORD_ADDRESS,
+	EMU_I2C_WRITE,
+	EMU_I2C_READ
+}Emu_I2cState;
+
+/* States of the Microwire EEPROM while it is selected */
+typedef enum Emu_MicrowireState_t
+{
+	EMU_93C_START = 0,	/* waiting for the start bit */
+	EMU_93C_OPCODE,
+	EMU_93C_ADDRESS,
+	EMU_93C_DATA,
+	EMU_93C_READ,
+	EMU_93C_DONE		/* waiting to be deselected */
+}Emu_MicrowireState;
+
+/* 24C16 I2C EEPROM */
+typedef struct Emu_Eeprom24_t
+{
+	uint8			memory[EMU_24C_SIZE];
+	Emu_I2cState	state;
+	/* Clocks of the current byte, 8 is the acknowledge */
+	uint8			bitCount;
+	uint8			shift;
+	/* TRUE while the EEPROM sends the byte, masterAck is the acknowledge the master gave */
+	bool			transmit;
+	bool			masterAck;
+	/* Address counter */
+	uint16			address;
+	/* Page write buffer, mask tells the bytes that were written */
+	uint8			latch[EMU_24C_PAGE_SIZE];
+	uint16			latchMask;
+	uint64			busyUntil;
+}Emu_Eeprom24;
+
+/* 93LC56B Microwire EEPROM */
+typedef struct Emu_Eeprom93_t
+{
+	uint16			memory[EMU_93C_WORDS];
+	Emu_MicrowireState state;
+	uint8			count;
+	uint8			opcode;
+	uint8			address;
+	uint16			data;
+	/* Bit of the word being read that is output next */
+	uint8			readBit;
+	/* Write cycle started when CS goes low(EMU_93C_CYCLE_*) */
+	uint8			cycle;
+	bool			writeEnabled;
+	uint64			busyUntil;
+}Emu_Eeprom93;
+
+/* SPI NOR flash */
+typedef struct Emu_Flash_t
+{
+	uint8			*memory;
+	uint8			opcode;
+	/* Bytes received since CS# went low, the opcode included */
+	uint32			count;
+	uint32			address;
+	uint8			shift;
+	uint8			bitCount;
+	/* Byte being shifted out, from bit 7 */
+	uint8			tx;
+	bool			txValid;
+	uint8			txBit;
+	uint8			status;
+	uint8			newStatus;
+	uint8			page[EMU_FLASH_PAGE_SIZE];
+	uint64			busyUntil;
+}Emu_Flash;
+
+struct Emu_Device_t;
+
+/* A slave on the pins of the low byte. update is called whenever the level of a pin as driven by
+the MPSSE changes, with the levels before and after the change. The slave answers through pullLow,
+set while it pulls EMU_PIN_DI low */
+typedef struct Emu_Slave_t
+{
+	const char		*name;
+	void			(*update)(struct Emu_Device_t *device, struct Emu_Slave_t *slave,
+						uint8 oldPins, uint8 newPins);
+	void			*model;
+	bool			pullLow;
+}Emu_Slave;
+
+/* A flush of the answers: the bytes up to end(counted from the opening) reach the host at ready */
+typedef struct Emu_FlushMark_t
+{
+	uint64			end;
+	uint64			ready;
+}Emu_FlushMark;
+
+/* The emulated chip, its address is the handle of the channel. Times are in nanoseconds on the
+scale of Infra_GetTimeUs */
+typedef struct Emu_Device_t
+{
+	bool			open;
+	FT_DEVICE_LIST_INFO_NODE info;
+	uint8			bitMode;
+	uint8			latencyTimer;
+	uint32			readTimeout;
+	uint32			writeTimeout;
+	bool			latencyModel;
+	uint64			writeTime;
+	/* State of the MPSSE */
+	uint8			lowValue;
+	uint8			lowDirection;
+	uint8			lowDriveZero;
+	uint8			highValue;
+	uint8			highDirection;
+	uint8			highDriveZero;
+	uint16			divisor;
+	bool			divideBy5;
+	bool			threePhase;
+	bool			loopback;
+	bool			adaptive;
+	/* Time the MPSSE is done with the commands received so far */
+	uint64			time;
+	/* Commands received that are not complete yet */
+	uint8			*command;
+	uint32			commandLength;
+	uint32			commandSize;
+	/* Answers not read yet, answer[answerStart] is the byte number consumed */
+	uint8			*answer;
+	uint32			answerStart;
+	uint32			answerSize;
+	uint64			produced;
+	uint64			consumed;
+	uint64			flushed;
+	/* Time the first answer that isn't flushed yet was produced */
+	uint64			pendingSince;
+	Emu_FlushMark	flushes[EMU_MAX_FLUSHES];
+	uint32			flushHead;
+	uint32			flushCount;
+}Emu_Device;
+
+
+/******************************************************************************/
+/*								External variables							  */
+/******************************************************************************/
+/* The MPSSE emulator */
+extern const Backend_Ops Backend_Emulator;
+
+#endif /* FTDI_EMU_H */
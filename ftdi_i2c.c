@@ -39,6 +39,7 @@
 #include "ftdi_common.h"	/*Common across I2C, SPI, JTAG modules*/
 #include "ftdi_i2c.h"		/*I2C specific*/
 #include "ftdi_mid.h"		/*Middle layer*/
+#include "ftdi_sched.h"		/*Scheduler, I2C specific parts are implemented here*/
 
 
 /******************************************************************************/
@@ -54,12 +55,29 @@
 /* This macro will enable the code to read acknowledgements from slaves in I2C_RawWrite */
 #define FASTWRITE_READ_ACK
 
-#define START_DURATION_1	10
-#define START_DURATION_2	20
+/* Shortest time for which one SET_DATA_BITS command holds the pins on hi-speed and full-speed
+chips. These are used to work out how many commands make up a bus condition when clock-only
+delays can't be used, and are kept on the low side so that the spec minimums are always met */
+#define I2C_SET_DATA_BITS_NS_HISPEED	100
+#define I2C_SET_DATA_BITS_NS_FULLSPEED	500
 
-#define STOP_DURATION_1	10
-#define STOP_DURATION_2	10
-#define STOP_DURATION_3	10
+/* Bit 0 of the direction byte is SCL */
+#define I2C_DIRECTION_SCL_MASK	0x01
+
+/* Master code that switches the bus to high speed mode(0000 1XXX, XXX = master 0) */
+#define I2C_HS_MASTER_CODE		0x08
+
+/* Number of data bytes handled per chunk of a fast transfer. The commands of two chunks(about
+14 bytes per data byte plus the bus conditions) fit in half of the USB buffer */
+#define I2C_FAST_CHUNK_SIZE		2048
+
+/* Size of a fast transfer is in bits rather than bytes */
+#define I2C_FAST_TRANSFER_IN_BITS(options)	(((options) & I2C_TRANSFER_OPTIONS_FAST_TRANSFER) \
+	== I2C_TRANSFER_OPTIONS_FAST_TRANSFER_BITS)
+
+/* SCL & SDA are open-drain in hardware, see I2C_ENABLE_DRIVE_ONLY_ZERO */
+#define I2C_DRIVES_ONLY_ZERO(context)	((FT_DEVICE_232H == (context)->ftDevice) && \
+	((context)->config.Options & I2C_ENABLE_DRIVE_ONLY_ZERO))
 
 #define SEND_ACK			0x00
 #define SEND_NACK			0x80
@@ -67,43 +85,67 @@
 #define I2C_ADDRESS_READ_MASK	0x01	/*LSB 1 = Read*/
 #define I2C_ADDRESS_WRITE_MASK	0xFE	/*LSB 0 = Write*/
 
-#ifdef I2C_CMD_GETDEVICEID_SUPPORTED
-/* This enum lists the supported I2C modes*/
-typedef enum I2C_Modes_t{
-I2C_STANDARD_MODE = 0,
-I2C_FAST_MODE,
-I2C_FAST_MODE_PLUS,
-I2C_HIGH_SPEED_MODE,
-I2C_MAXIMUM_SUPPORTED_MODES
-}I2C_Modes;
-
-/* This enum lists the various I2C bus condition*/
-typedef enum I2C_Bus_Condition_t{
-I2C_CONDITION_PRESTART,
-I2C_CONDITION_START,
-I2C_CONDITION_POSTSTART,
-I2C_CONDITION_PRESTOP,
-I2C_CONDITION_STOP,
-I2C_CONDITION_POSTSTOP,
-I2C_MAXIMUM_SUPPORTED_CONDITIONS
-}I2C_Bus_Condition;
-#endif
+/* Range of addresses probed by I2C_ScanBus, the others are reserved by the I2C specification */
+#define I2C_SCAN_FIRST_ADDRESS	0x08
+#define I2C_SCAN_LAST_ADDRESS	0x77
+
+/* Probing these addresses with a write could corrupt some EEPROMs, they are probed with a read
+of one byte instead(as i2cdetect does) */
+#define I2C_SCAN_READ_PROBE(addr)	((((addr) >= 0x30) && ((addr) <= 0x37)) || \
+	(((addr) >= 0x50) && ((addr) <= 0x5F)))
+
 
 /******************************************************************************/
 /*								Local function declarations					  */
 /******************************************************************************/
-FT_STATUS I2C_Restart(FT_HANDLE handle);
-FT_STATUS I2C_Write8bitsAndGetAck(FT_HANDLE handle, uint8 data, bool *ack);
-FT_STATUS I2C_Read8bitsAndGiveAck(FT_HANDLE handle, uint8 *data, bool ack);
-FT_STATUS I2C_WriteDeviceAddress(FT_HANDLE handle, uint32 deviceAddress,
-			bool direction, bool AddLen10Bit, bool *ack);
+FT_STATUS I2C_Restart(FT_HANDLE handle, const ChannelContext *context);
+FT_STATUS I2C_Write8bitsAndGetAck(FT_HANDLE handle, const ChannelContext *context,
+	uint8 data, bool *ack);
+FT_STATUS I2C_Read8bitsAndGiveAck(FT_HANDLE handle, const ChannelContext *context,
+	uint8 *data, bool ack);
+FT_STATUS I2C_WriteDeviceAddress(FT_HANDLE handle, const ChannelContext *context,
+			uint32 deviceAddress, bool direction, bool AddLen10Bit, bool *ack);
+FT_STATUS I2C_AddChannelConfig(FT_HANDLE handle);
+FT_STATUS I2C_DelChannelConfig(FT_HANDLE handle);
 FT_STATUS I2C_SaveChannelConfig(FT_HANDLE handle, ChannelConfig *config);
 FT_STATUS I2C_GetChannelConfig(FT_HANDLE handle, ChannelConfig *config);
-FT_STATUS I2C_Start(FT_HANDLE handle);
-FT_STATUS I2C_Stop(FT_HANDLE handle);
+ChannelContext *I2C_FindChannelContext(FT_HANDLE handle);
+ChannelContext *I2C_GetChannelContext(FT_HANDLE handle);
+ChannelContext *I2C_GetDefaultContext(void);
+void I2C_SetTimings(ChannelContext *context);
+uint32 I2C_GetInitClock(const ChannelConfig *config);
+FT_STATUS I2C_Recover(FT_HANDLE handle, ChannelContext *context);
+uint32 I2C_GetClockDivisor(const ChannelContext *context, uint32 sclRate, uint32 *base);
+uint32 I2C_GetMpsseClock(const ChannelContext *context, uint32 sclRate);
+uint32 I2C_AddClock(const ChannelContext *context, uint8 *buffer, uint32 sclRate);
+void I2C_SetHolds(ChannelContext *context, uint32 mpsseClock);
+uint32 I2C_AddCondition(const ChannelContext *context, uint8 *buffer,
+	I2C_Bus_Condition condition, uint8 value, uint8 direction);
+uint32 I2C_MakeStart(const ChannelContext *context, uint8 *buffer);
+uint32 I2C_MakeStop(const ChannelContext *context, uint8 *buffer);
+uint32 I2C_MakeRestart(const ChannelContext *context, uint8 *buffer);
+uint32 I2C_MakeWriteByte(const ChannelContext *context, uint8 *buffer, uint32 *dataOffset);
+uint32 I2C_MakeReadByte(const ChannelContext *context, uint8 *buffer, bool ack);
+uint32 I2C_MakeMasterCode(const ChannelContext *context, uint8 *buffer);
+void I2C_MakeSequences(ChannelContext *context);
+uint32 I2C_AddStart(const ChannelContext *context, uint8 *buffer);
+uint32 I2C_AddStop(const ChannelContext *context, uint8 *buffer);
+uint32 I2C_AddRestart(const ChannelContext *context, uint8 *buffer);
+uint32 I2C_AddWriteByte(const ChannelContext *context, uint8 *buffer, uint8 data);
+uint32 I2C_AddReadByte(const ChannelContext *context, uint8 *buffer, bool ack);
+void I2C_BeginTransfer(FT_HANDLE handle, ChannelContext *context, uint32 options);
+void I2C_EndTransfer(ChannelContext *context, FT_STATUS status);
+uint32 I2C_AddTransfer(const ChannelContext *context, uint8 *buffer, I2C_Msg *msgs,
+	uint32 count, uint32 *sizeToRead);
+FT_STATUS I2C_ParseTransfer(I2C_Msg *msgs, uint32 count, uint8 *inBuffer);
+void I2C_FailTransfer(I2C_Msg *msgs, uint32 count, FT_STATUS status);
+FT_STATUS I2C_Start(FT_HANDLE handle, const ChannelContext *context);
+FT_STATUS I2C_Stop(FT_HANDLE handle, const ChannelContext *context);
+uint32 I2C_AddFastChunk(const ChannelContext *context, uint8 *buffer, uint32 deviceAddress,
+	uint8 *data, uint32 first, uint32 sizeToTransfer, uint32 options, bool read);
 FT_STATUS I2C_FastWrite(FT_HANDLE handle, uint32 deviceAddress,
-uint32 bitsToTransfer, uint8 *buffer, uint8 *ack, uint32 *bytesTransferred,
-uint32 options);
+uint32 bitsToTransfer, uint8 *buffer, uint8 *ackBitmap, uint32 *firstNack,
+uint32 *bytesTransferred, uint32 options);
 FT_STATUS I2C_FastRead(FT_HANDLE handle,uint32 deviceAddress,
 uint32 bitsToTransfer, uint8 *buffer, uint8 *ack, uint32 *bytesTransferred,
 uint32 options);
@@ -113,28 +155,42 @@ uint32 options);
 /*								Global variables							  */
 /******************************************************************************/
 
-#ifdef I2C_CMD_GETDEVICEID_SUPPORTED
 /*!
  * \brief I2C bus condition timings table
  *
- * This table contains the minimim time that the I2C bus needs to be held in, in order to register
- * a condition such as start, stop restart, etc. The table has one row each for the different bus
- * speeds.
+ * This table contains the minimim time in nanoseconds that the I2C bus needs to be held in, in
+ * order to register a condition such as start, stop restart, etc. The table has one row each for
+ * the different bus speeds. The values are the minimums given in the I2C-bus specification
+ * (UM10204) for tSU;STA, tHD;STA, tLOW, tSU;STO and tBUF.
  *
  * \sa
- * \note
+ * \note The low phase of the first bit clocked after a START provides the post-start hold
+ * \note In high speed mode the bus returns to fast mode after STOP, hence tBUF of fast mode
  * \warning
  */
 const uint64 I2C_Timings[I2C_MAXIMUM_SUPPORTED_MODES]
 [I2C_MAXIMUM_SUPPORTED_CONDITIONS] = {
 /*Durations for conditions are as follows:
 pre-start, start, post-start, pre-stop, stop, post-stop */
-{0,0,0,0,0,0,}, /* I2C_CLOCK_STANDARD_MODE */
-{0,0,0,0,0,0,}, /*I2C_CLOCK_FAST_MODE */
-{0,0,0,0,0,0,}, /* I2C_CLOCK_FAST_MODE_PLUS */
-{0,0,0,0,0,0}	/* I2C_CLOCK_HIGH_SPEED_MODE */
+{4700,4000,0,4700,4000,4700}, /* I2C_CLOCK_STANDARD_MODE */
+{600,600,0,1300,600,1300}, /*I2C_CLOCK_FAST_MODE */
+{260,260,0,500,260,500}, /* I2C_CLOCK_FAST_MODE_PLUS */
+{160,160,0,160,160,1300}	/* I2C_CLOCK_HIGH_SPEED_MODE */
 };
-#endif
+
+/*Root of the linked list that holds channel contexts. Nodes are added with the lock
+taken(Infra_Lock) and published with INFRA_STORE_POINTER. They are never freed: the node of a
+closed channel gets a NULL handle and is reused, so I2C_FindChannelContext walks the list without
+the lock*/
+static ChannelContext *I2C_ListHead=NULL;
+
+/* Context used for channels that were not initialized by I2C_InitChannel. It holds standard
+mode timings made of SET_DATA_BITS commands only, which are worked out once(see
+I2C_GetDefaultContext) */
+static ChannelContext I2C_DefaultContext = {0};
+
+/* Points to I2C_DefaultContext once it was filled in, NULL until then */
+static ChannelContext *I2C_DefaultReady=NULL;
 
 
 /******************************************************************************/
@@ -155,6 +211,8 @@ pre-start, start, post-start, pre-stop, stop, post-stop */
  * \note FT2232H has 2 MPSSE ports
  * \note FT4232H has 4 ports but only 2 of them have MPSSEs
  * so call to this function will return 2 if a FT4232 is connected to it.
+ * \note The devices are enumerated by this function only, I2C_GetChannelInfo and
+ * I2C_OpenChannel use the channel list taken by the last call to it
  * \warning
  */
 FTDI_API FT_STATUS I2C_GetNumChannels(uint32 *numChannels)
@@ -227,6 +285,35 @@ FTDI_API FT_STATUS I2C_OpenChannel(uint32 index, FT_HANDLE *handle)
 	return status;
 }
 
+/*!
+ * \brief Opens a channel by its serial number, description or location and returns a handle to it
+ *
+ * This function opens the channel directly, without enumerating the devices or going through
+ * the channel indexes, so that a given adapter can be opened regardless of what else is
+ * connected to the host system
+ *
+ * \param[in] arg Serial number or description(string), or location ID(cast to a pointer)
+ * \param[in] flags FT_OPEN_BY_SERIAL_NUMBER, FT_OPEN_BY_DESCRIPTION or FT_OPEN_BY_LOCATION
+ * \param[out] handle Pointer to the handle of the opened channel
+ * \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide)
+ * \sa I2C_OpenChannel
+ * \note The serial number and description of each port of a multi port chip end with the
+ * letter of the port, e.g. "FT2232H A"
+ * \warning Only the ports that have an MPSSE can be used
+ */
+FTDI_API FT_STATUS I2C_OpenChannelEx(void *arg, uint32 flags, FT_HANDLE *handle)
+{
+	FT_STATUS status;
+	FN_ENTER;
+#ifdef ENABLE_PARAMETER_CHECKING
+	CHECK_NULL_RET(handle);
+#endif
+	status = FT_OpenChannelEx(I2C,arg,flags,handle);
+	CHECK_STATUS(status);
+	FN_EXIT;
+	return status;
+}
+
 /*!
  * \brief Initializes a channel
  *
@@ -236,7 +323,8 @@ FTDI_API FT_STATUS I2C_OpenChannel(uint32 index, FT_HANDLE *handle)
  * \param[out] config Pointer to ChannelConfig structure(memory to be allocated by caller)
  * \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide)
  * \sa
- * \note
+ * \note FT_NOT_SUPPORTED is returned if I2C_ENABLE_CLOCK_STRETCHING is set for a chip without
+ * adaptive clocking
  * \warning
  */
 FTDI_API FT_STATUS I2C_InitChannel(FT_HANDLE handle, ChannelConfig *config)
@@ -245,19 +333,30 @@ FTDI_API FT_STATUS I2C_InitChannel(FT_HANDLE handle, ChannelConfig *config)
 	uint8 buffer[3];//3
 	uint32 noOfBytesToTransfer;
 	uint32 noOfBytesTransferred;
+	uint32 clockRate;
+	FT_DEVICE ftDevice;
 	FN_ENTER;
 #ifdef ENABLE_PARAMETER_CHECKING
 	CHECK_NULL_RET(config);
 	CHECK_NULL_RET(handle);
 #endif
-	if(!(config->Options & I2C_DISABLE_3PHASE_CLOCKING))
-	{/* Adjust clock rate if 3phase clocking should be enabled */
-		config->ClockRate = (config->ClockRate * 3)/2;
+	if(config->Options & I2C_ENABLE_CLOCK_STRETCHING)
+	{/* Adaptive clocking is available on hi-speed chips only */
+		status = Mid_GetFtDeviceType(handle,&ftDevice);
+		CHECK_STATUS(status);
+		if((FT_DEVICE_2232H != ftDevice) && (FT_DEVICE_4232H != ftDevice) &&
+			(FT_DEVICE_232H != ftDevice))
+		{
+			DBG(MSG_ERR,"clock stretching isn't supported by device type %u\n",
+				(unsigned)ftDevice);
+			return FT_NOT_SUPPORTED;
+		}
 	}
+	clockRate = I2C_GetInitClock(config);
 	DBG(MSG_DEBUG,"handle=0x%x ClockRate=%u LatencyTimer=%u Options=0x%x\n",\
 		(unsigned)handle,(unsigned)config->ClockRate,	\
 		(unsigned)config->LatencyTimer,(unsigned)config->Options);
-	status = FT_InitChannel(I2C,handle,(uint32)config->ClockRate,	\
+	status = FT_InitChannel(I2C,handle,clockRate,	\
 		(uint32)config->LatencyTimer,(uint32)config->Options);
 	CHECK_STATUS(status);
 
@@ -272,7 +371,20 @@ FTDI_API FT_STATUS I2C_InitChannel(FT_HANDLE handle, ChannelConfig *config)
 		CHECK_STATUS(status);
 	}
 
+	if(config->Options & I2C_ENABLE_CLOCK_STRETCHING)
+	{
+		DBG(MSG_DEBUG,"Enabling adaptive clocking\n");
+		noOfBytesToTransfer = 1;
+		noOfBytesTransferred = 0;
+		buffer[0] = MPSSE_CMD_ENABLE_ADAPTIVE_CLOCKING;/* MPSSE command */
+		status = FT_Channel_Write(I2C,handle,noOfBytesToTransfer,
+			buffer,&noOfBytesTransferred);
+		CHECK_STATUS(status);
+	}
+
 	/*Save the channel's config data for later use*/
+	status = I2C_AddChannelConfig(handle);
+	CHECK_STATUS(status);
 	status = I2C_SaveChannelConfig(handle,config);
 	CHECK_STATUS(status);
 	FN_EXIT;
@@ -300,6 +412,91 @@ FTDI_API FT_STATUS I2C_CloseChannel(FT_HANDLE handle)
 #endif
 	status = FT_CloseChannel(I2C,handle);
 	CHECK_STATUS(status);
+	SCHED_Exit(handle);
+	status = I2C_DelChannelConfig(handle);
+	CHECK_STATUS(status);
+	FN_EXIT;
+	return status;
+}
+
+/*!
+ * \brief Recovers a channel after a failed transfer
+ *
+ * This function brings a channel back into the state I2C_InitChannel left it in without closing
+ * it: stale data is drained, the MPSSE is resyncronized(and reset if it doesn't respond), and the
+ * clock, the clocking options and the idle state of SCL & SDA are restored from the channel's
+ * context.
+ *
+ * \param[in] handle Handle of the channel
+ * \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide)
+ * \sa I2C_InitChannel
+ * \note The transfer functions do this on their own before the first transfer that follows a
+ *		failed one, so it only has to be called to recover a channel straight away
+ * \warning
+ */
+FTDI_API FT_STATUS I2C_RecoverChannel(FT_HANDLE handle)
+{
+	FT_STATUS status;
+	ChannelContext *context;
+	FN_ENTER;
+#ifdef ENABLE_PARAMETER_CHECKING
+	CHECK_NULL_RET(handle);
+#endif
+	LOCK_CHANNEL(handle);
+	context = I2C_GetChannelContext(handle);
+	if(&I2C_DefaultContext == context)
+	{
+		UNLOCK_CHANNEL(handle);
+		return FT_INVALID_HANDLE;
+	}
+	status = I2C_Recover(handle,context);
+	UNLOCK_CHANNEL(handle);
+	FN_EXIT;
+	return status;
+}
+
+/*!
+ * \brief Calibrates the transport settings of a channel
+ *
+ * This function measures the candidate latency timers and USB transfer sizes on the device,
+ * applies the best ones for the given workload and returns the best profile of every workload,
+ * so that the channel can later be switched between them using FT_SetTransportProfile.
+ *
+ * \param[in] handle Handle of the channel
+ * \param[in] workload FT_PROFILE_LATENCY for register accesses, FT_PROFILE_THROUGHPUT for block
+ *			transfers
+ * \param[out] profiles Array of FT_PROFILE_COUNT profiles indexed by workload. May be NULL
+ * \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide)
+ * \sa FT_SetTransportProfile, I2C_CALIBRATE_LATENCY, I2C_CALIBRATE_THROUGHPUT
+ * \note The bus is left idle with SCL & SDA tristated while measuring
+ * \warning
+ */
+FTDI_API FT_STATUS I2C_CalibrateChannel(FT_HANDLE handle, uint32 workload,
+	FT_TransportProfile *profiles)
+{
+	FT_STATUS status;
+	FT_STATUS recoverStatus;
+	ChannelContext *context;
+	FN_ENTER;
+#ifdef ENABLE_PARAMETER_CHECKING
+	CHECK_NULL_RET(handle);
+#endif
+	LOCK_CHANNEL(handle);
+	context = I2C_GetChannelContext(handle);
+	if(&I2C_DefaultContext == context)
+	{
+		UNLOCK_CHANNEL(handle);
+		return FT_INVALID_HANDLE;
+	}
+	status = FT_CalibrateChannel(handle,I2C_GetInitClock(&context->config),workload,
+		profiles);
+	if(FT_INVALID_PARAMETER != status)
+	{/* Restores the pins and the clocking options */
+		recoverStatus = I2C_Recover(handle,context);
+		if(FT_OK == status)
+			status = recoverStatus;
+	}
+	UNLOCK_CHANNEL(handle);
 	FN_EXIT;
 	return status;
 }
@@ -331,6 +528,7 @@ uint32 sizeToTransfer, uint8 *buffer, uint32 *sizeTransferred, uint32 options)
 	FT_STATUS status=FT_OK;
 	bool ack=FALSE;
 	uint32 i;
+	ChannelContext *context;
 	FN_ENTER;
 #ifdef ENABLE_PARAMETER_CHECKING
 	CHECK_NULL_RET(handle);
@@ -348,7 +546,8 @@ uint32 sizeToTransfer, uint8 *buffer, uint32 *sizeTransferred, uint32 options)
 	(unsigned)options);
 
 	LOCK_CHANNEL(handle);
-	Mid_PurgeDevice(handle);
+	context = I2C_GetChannelContext(handle);
+	I2C_BeginTransfer(handle,context,options);
 
 	if(options & I2C_TRANSFER_OPTIONS_FAST_TRANSFER)
 	{
@@ -358,23 +557,24 @@ uint32 sizeToTransfer, uint8 *buffer, uint32 *sizeTransferred, uint32 options)
 	{
 		/* Write START bit */
 		if(options & I2C_TRANSFER_OPTIONS_START_BIT)
-		{
-			status = I2C_Start(handle);
-			CHECK_STATUS(status);
-		}
+			status = I2C_Start(handle,context);
 
 		/* Write device address (with LSB=1 => READ)  & Get ACK */
-		status = I2C_WriteDeviceAddress(handle,deviceAddress,TRUE,FALSE,&ack);
-		CHECK_STATUS(status);
+		if(FT_OK == status)
+			status = I2C_WriteDeviceAddress(handle,context,deviceAddress,TRUE,FALSE,&ack);
 
-		if(!ack) /*ack bit set actually means device nAcked*/
+		if(FT_OK != status)
+		{
+			DBG(MSG_ERR,"addressing the device failed, status=%u\n",(unsigned)status);
+		}
+		else if(!ack) /*ack bit set actually means device nAcked*/
 		{
 			/* LOOP until sizeToTransfer */
 			for(i=0; ((i<sizeToTransfer) && (status == FT_OK)); i++)
 			{
 				/* Read byte to buffer & Give ACK 
 				(or nACK if it is last byte and I2C_TRANSFER_OPTIONS_NACK_LAST_BYTE is set)*/
-				status = I2C_Read8bitsAndGiveAck(handle,&(buffer[i]),			\
+				status = I2C_Read8bitsAndGiveAck(handle,context,&(buffer[i]),			\
 				(i<(sizeToTransfer-1))?TRUE:									\
 				((options & I2C_TRANSFER_OPTIONS_NACK_LAST_BYTE)?FALSE:TRUE));
 			}
@@ -390,10 +590,7 @@ uint32 sizeToTransfer, uint8 *buffer, uint32 *sizeTransferred, uint32 options)
 			{
 				/* Write STOP bit */
 				if(options & I2C_TRANSFER_OPTIONS_STOP_BIT)
-				{
-					status = I2C_Stop(handle);
-					CHECK_STATUS(status);
-				}
+					status = I2C_Stop(handle,context);
 			}
 		}
 		else
@@ -401,18 +598,17 @@ uint32 sizeToTransfer, uint8 *buffer, uint32 *sizeTransferred, uint32 options)
 			DBG(MSG_ERR,"I2C device with address 0x%x didn't ack when addressed\n",(unsigned)deviceAddress);
 			/* Write STOP bit */
 			if(options & I2C_TRANSFER_OPTIONS_STOP_BIT)
-			{
-				status = I2C_Stop(handle);
-				CHECK_STATUS(status);
-			}
+				status = I2C_Stop(handle,context);
 			/*20111102 : FT_IO_ERROR was returned when a device doesn't respond to the
 	 		master when it is addressed, as well as when a data transfer fails. To distinguish
 	 		between these to errors, FT_DEVICE_NOT_FOUND is now returned after a device
 	 		doesn't respond when its addressed*/
 			/* old code: status = FT_IO_ERROR; */
-			status = FT_DEVICE_NOT_FOUND;
+			if(FT_OK == status)
+				status = FT_DEVICE_NOT_FOUND;
 		}
 	}
+	I2C_EndTransfer(context,status);
 	UNLOCK_CHANNEL(handle);
 	FN_EXIT;
 	return status;
@@ -444,7 +640,9 @@ uint32 sizeToTransfer, uint8 *buffer, uint32 *sizeTransferred, uint32 options)
 {
 	FT_STATUS status=FT_OK;
 	bool ack=FALSE;
+	bool nacked=FALSE;
 	uint32 i;
+	ChannelContext *context;
 	FN_ENTER;
 #ifdef ENABLE_PARAMETER_CHECKING
 	CHECK_NULL_RET(handle);
@@ -462,33 +660,35 @@ uint32 sizeToTransfer, uint8 *buffer, uint32 *sizeTransferred, uint32 options)
 	(unsigned)options);
 
 	LOCK_CHANNEL(handle);
-	Mid_PurgeDevice(handle);
+	context = I2C_GetChannelContext(handle);
+	I2C_BeginTransfer(handle,context,options);
 
 	if(options & I2C_TRANSFER_OPTIONS_FAST_TRANSFER)
 	{
-		status = I2C_FastWrite(handle, deviceAddress, sizeToTransfer, buffer, NULL, sizeTransferred, options);
+		status = I2C_FastWrite(handle, deviceAddress, sizeToTransfer, buffer, NULL, NULL, sizeTransferred, options);
 	}
 	else
 	{
 		/* Write START bit */
 		if(options & I2C_TRANSFER_OPTIONS_START_BIT)
-		{
-			status = I2C_Start(handle);
-			CHECK_STATUS(status);
-		}
+			status = I2C_Start(handle,context);
 
 		/* Write device address (with LSB=0 => WRITE) & Get ACK*/
-		status = I2C_WriteDeviceAddress(handle,deviceAddress,FALSE,FALSE,&ack);
-		CHECK_STATUS(status);
+		if(FT_OK == status)
+			status = I2C_WriteDeviceAddress(handle,context,deviceAddress,FALSE,FALSE,&ack);
 
-		if(!ack) /*ack bit set actually means device nAcked*/
+		if(FT_OK != status)
+		{
+			DBG(MSG_ERR,"addressing the device failed, status=%u\n",(unsigned)status);
+		}
+		else if(!ack) /*ack bit set actually means device nAcked*/
 		{
 			/* LOOP until sizeToTransfer */
 			for(i=0; ((i<sizeToTransfer) && (status == FT_OK)); i++)
 			{
 				/* Write byte to buffer & Get ACK */
 				ack=0;
-				status = I2C_Write8bitsAndGetAck(handle,buffer[i],&ack);
+				status = I2C_Write8bitsAndGetAck(handle,context,buffer[i],&ack);
 				DBG(MSG_DEBUG,"handle=0x%x buffer[%u]=0x%x ack=0x%x \n", \
 					(unsigned)handle, (unsigned)i, (unsigned)buffer[i],
 					(unsigned)(1&ack));
@@ -504,19 +704,21 @@ uint32 sizeToTransfer, uint8 *buffer, uint32 *sizeTransferred, uint32 options)
 						break;*/
 						DBG(MSG_WARN,"returning FT_FAILED_TO_WRITE_DEVICE \
 						options=0x%x ack=0x%x\n",options,ack);
-						
-						/* Write STOP bit */
-						if(options & I2C_TRANSFER_OPTIONS_STOP_BIT)
-						{
-							status = I2C_Stop(handle);
-							CHECK_STATUS(status);
-						}
-						return FT_FAILED_TO_WRITE_DEVICE;
+						nacked = TRUE;
+						break;
 					}
 				}
 			}
 			*sizeTransferred = i;
-			if(*sizeTransferred != sizeToTransfer)
+			if(nacked)
+			{
+				/* Write STOP bit */
+				if(options & I2C_TRANSFER_OPTIONS_STOP_BIT)
+					status = I2C_Stop(handle,context);
+				if(FT_OK == status)
+					status = FT_FAILED_TO_WRITE_DEVICE;
+			}
+			else if(*sizeTransferred != sizeToTransfer)
 			{
 				DBG(MSG_ERR," sizeToTransfer=%u sizeTransferred=%u\n",\
 					(unsigned)sizeToTransfer, (unsigned)*sizeTransferred);
@@ -526,10 +728,7 @@ uint32 sizeToTransfer, uint8 *buffer, uint32 *sizeTransferred, uint32 options)
 			{
 				/* Write STOP bit */
 				if(options & I2C_TRANSFER_OPTIONS_STOP_BIT)
-				{
-					status = I2C_Stop(handle);
-					CHECK_STATUS(status);
-				}
+					status = I2C_Stop(handle,context);
 			}
 		}
 		else
@@ -537,222 +736,630 @@ uint32 sizeToTransfer, uint8 *buffer, uint32 *sizeTransferred, uint32 options)
 			DBG(MSG_ERR,"I2C device with address 0x%x didn't ack when addressed\n",(unsigned)deviceAddress);
 			/* Write STOP bit */
 			if(options & I2C_TRANSFER_OPTIONS_STOP_BIT)
-			{
-				status = I2C_Stop(handle);
-				CHECK_STATUS(status);
-			}
+				status = I2C_Stop(handle,context);
 			/*20111102 : FT_IO_ERROR was returned when a device doesn't respond to the
 	 		master when it is addressed, as well as when a data transfer fails. To distinguish
 	 		between these to errors, FT_DEVICE_NOT_FOUND is now returned after a device
 	 		doesn't respond when its addressed*/
 			/* old code: status = FT_IO_ERROR; */
-			status = FT_DEVICE_NOT_FOUND;
+			if(FT_OK == status)
+				status = FT_DEVICE_NOT_FOUND;
 		}
 	}
+	I2C_EndTransfer(context,status);
 	UNLOCK_CHANNEL(handle);
 	FN_EXIT;
 	return status;
 }
 
 
-#ifdef I2C_CMD_GETDEVICEID_SUPPORTED
 /*!
- * \brief Get the I2C device ID
+ * \brief Writes data to I2C slave and returns the acknowledgements of all bytes written
  *
- * This function retrieves the I2C device ID
+ * This function writes the specified number of bytes to an addressed I2C slave as a fast transfer
+ * and returns the ack bit of each byte as a packed bitmap along with the index of the first byte
+ * that was nAcked, so that the caller does not have to scan the acks of a long burst byte by byte
  *
  * \param[in] handle Handle of the channel
  * \param[in] deviceAddress Address of the I2C slave
- * \param[out] deviceID Address of memory where the 3byte I2C device ID will be stored
+ * \param[in] sizeToTransfer Number of bytes to be written
+ * \param[in] buffer Pointer to the buffer from where data is to be written
+ * \param[out] sizeTransferred Pointer to variable containing the number of bytes written. If
+ *			I2C_TRANSFER_OPTIONS_BREAK_ON_NACK is set then this is the number of bytes
+ *			acked before the first nAck
+ * \param[in] options This parameter specifies data transfer options. The
+ *			I2C_TRANSFER_OPTIONS_FAST_TRANSFER_BYTES bit must be set
+ * \param[out] ackBitmap Pointer to a buffer of (sizeToTransfer+7)/8 bytes where the ack bits
+ *			are stored, bit (n%8) of ackBitmap[n/8] being set if byte n was nAcked. May be NULL
+ * \param[out] firstNack Pointer to variable containing the index of the first nAcked byte, or
+ *			sizeToTransfer if all bytes were acked. May be NULL
  * \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide)
- * \sa
- * \note
+ * \sa	I2C_DeviceWrite, Infra_PackLsb
+ * \note FT_DEVICE_NOT_FOUND is returned if the slave doesn't ack its address
+ * \note Since all bytes are sent in one shot, the bytes following a nAck are still clocked out on
+ *		the bus. I2C_TRANSFER_OPTIONS_BREAK_ON_NACK only changes the reported status
+ *		(FT_FAILED_TO_WRITE_DEVICE) and sizeTransferred
  * \warning
  */
-FTDI_API FT_STATUS I2C_GetDeviceID(FT_HANDLE handle, uint8 deviceAddress,
-	uint8* deviceID)
+FTDI_API FT_STATUS I2C_DeviceWriteGetAcks(FT_HANDLE handle, uint32 deviceAddress,
+uint32 sizeToTransfer, uint8 *buffer, uint32 *sizeTransferred, uint32 options,
+uint8 *ackBitmap, uint32 *firstNack)
 {
-	FT_STATUS status=FT_OTHER_ERROR;
-	bool ack;
+	FT_STATUS status=FT_OK;
+	uint32 nack=0;
+	ChannelContext *context;
 	FN_ENTER;
 #ifdef ENABLE_PARAMETER_CHECKING
-		CHECK_NULL_RET(handle);
-		CHECK_NULL_RET(deviceID);
-		if(deviceAddress>127)
-		{
-			DBG(MSG_WARN,"deviceAddress(0x%x) is greater than 127\n", \
-				(unsigned)deviceAddress);
-			status = FT_INVALID_PARAMETER;
-			return status;
-		}
+	CHECK_NULL_RET(handle);
+	CHECK_NULL_RET(buffer);
+	CHECK_NULL_RET(sizeTransferred);
+	if(deviceAddress>127)
+	{
+		DBG(MSG_WARN,"deviceAddress(0x%x) is greater than 127\n", \
+			(unsigned)deviceAddress);
+		return FT_INVALID_PARAMETER;
+	}
 #endif
+	if(!(options & I2C_TRANSFER_OPTIONS_FAST_TRANSFER_BYTES))
+	{
+		DBG(MSG_WARN,"acks are only collected in fast byte transfers\n");
+		return FT_INVALID_PARAMETER;
+	}
+	DBG(MSG_DEBUG,"handle=0x%x deviceAddress=0x%x sizeToTransfer=%u options= \
+	0x%x\n",(unsigned)handle, (unsigned)deviceAddress, (unsigned)sizeToTransfer,
+	(unsigned)options);
 
-	status = I2C_Start(handle);
-	CHECK_STATUS(status);
-	status = I2C_Write8bitsAndGetAck(handle,(uint8)I2C_CMD_GETDEVICEID_RD,&ack);
-	CHECK_STATUS(status);
-	status = I2C_Write8bitsAndGetAck(handle,deviceAddress, &ack);
-	CHECK_STATUS(status);
-	status = I2C_Restart(handle);
-	CHECK_STATUS(status);
-	status = I2C_Write8bitsAndGetAck(handle,(uint8)I2C_CMD_GETDEVICEID_WR,&ack);
-	CHECK_STATUS(status);
-	status = I2C_Read8bitsAndGiveAck(handle,&(deviceID[0]),I2C_GIVE_ACK);
-	CHECK_STATUS(status);
-	status = I2C_Read8bitsAndGiveAck(handle,&(deviceID[1]),I2C_GIVE_ACK);
-	CHECK_STATUS(status);
-	/*NACK 3rd byte*/
-	status = I2C_Read8bitsAndGiveAck(handle,&(deviceID[2]),I2C_GIVE_NACK);
-	CHECK_STATUS(status);
-
+	LOCK_CHANNEL(handle);
+	context = I2C_GetChannelContext(handle);
+	I2C_BeginTransfer(handle,context,options);
+
+	status = I2C_FastWrite(handle, deviceAddress, sizeToTransfer, buffer, ackBitmap,
+		&nack, sizeTransferred, options);
+	if(NULL != firstNack)
+		*firstNack = nack;
+	if((FT_OK == status) && (nack < sizeToTransfer))
+	{
+		DBG(MSG_WARN,"I2C device(address 0x%x) nAcked byte no %u\n",
+			(unsigned)deviceAddress,(unsigned)nack);
+		if(options & I2C_TRANSFER_OPTIONS_BREAK_ON_NACK)
+		{
+			*sizeTransferred = nack;
+			status = FT_FAILED_TO_WRITE_DEVICE;
+		}
+	}
+	I2C_EndTransfer(context,status);
+	UNLOCK_CHANNEL(handle);
 	FN_EXIT;
 	return status;
 }
-#endif
 
 
-/******************************************************************************/
-/*						Local function definations						  */
-/******************************************************************************/
-#ifdef I2C_CMD_GETDEVICEID_SUPPORTED
 /*!
- * \brief Generate I2C bus restart condition
+ * \brief Performs a combined I2C transaction made of several messages
  *
- * This function generates the restart condition in the I2C bus
+ * This function compiles an array of write and read messages, possibly to different slaves, into
+ * one MPSSE command buffer: a START, the messages separated by repeated STARTs, and a STOP. The
+ * buffer is written to the chip in one shot and the acks and data of all the messages are read
+ * back in one shot, so that e.g. writing a register address and reading the register costs a
+ * single round trip. This is in the spirit of the Linux I2C_RDWR ioctl(struct i2c_msg).
  *
  * \param[in] handle Handle of the channel
- * \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide)
- * \sa
- * \note
+ * \param[in,out] msgs Array of messages. The status and sizeTransferred members of each message
+ *			are filled in, and the data read is stored in the buffers of the read messages
+ * \param[in] count Number of messages in the array
+ * \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide). If a message
+ *			failed then the status of the first failed message is returned
+ * \sa	I2C_Msg, I2C_MSG_READ, I2C_MSG_NO_START, I2C_MSG_IGNORE_NACK, I2C_MSG_STOP
+ * \note The last byte of a read message is nAcked unless the next message continues it
+ *		(I2C_MSG_NO_START)
+ * \note Since the whole transaction is sent in one shot, the bus activity doesn't stop when a
+ *		slave nAcks: bytes are still written, and 0xFF is read from a slave that didn't respond
  * \warning
  */
-FT_STATUS I2C_Restart(FT_HANDLE handle)
+FTDI_API FT_STATUS I2C_Transfer(FT_HANDLE handle, I2C_Msg *msgs, uint32 count)
 {
-	FT_STATUS status;
-	uint8 buffer[3];
-	uint32 noOfBytesToTransfer;
-	uint32 noOfBytesTransferred;
-	I2C_Modes mode;
-
+	FT_STATUS status=FT_OK;
+	ChannelContext *context;
+	uint8 *outBuffer;
+	uint8 *inBuffer=NULL;
+	uint32 sizeToWrite;
+	uint32 sizeToRead=0;
+	uint32 sizeTransferred=0;
+	uint32 i;
 	FN_ENTER;
-#if 0
-	status = I2C_GetChannelConfig(handle,config);
-	if(FT_OK != status)
-		Infra_DbgPrintStatus(status);
-	CHECK_NULL_RET(config);
-	switch(config->ClockRate)
+#ifdef ENABLE_PARAMETER_CHECKING
+	CHECK_NULL_RET(msgs);
+	if(NULL == handle)
 	{
-		case I2C_CLOCK_STANDARD_MODE:
-			mode = I2C_STANDARD_MODE;
-		break;
-
-		case I2C_CLOCK_FAST_MODE:
-			mode = I2C_FAST_MODE;
-		break;
+		I2C_FailTransfer(msgs,count,FT_INVALID_PARAMETER);
+		return FT_INVALID_PARAMETER;
+	}
+#endif
+	for(i=0; i<count; i++)
+	{
+		if((msgs[i].addr > 127) || ((msgs[i].len > 0) && (NULL == msgs[i].buf)) ||
+			((msgs[i].flags & I2C_MSG_READ) && (0 == msgs[i].len)) ||
+			((msgs[i].flags & I2C_MSG_NO_START) && ((0 == i) ||
+			(msgs[i-1].flags & I2C_MSG_STOP) ||
+			((msgs[i].flags ^ msgs[i-1].flags) & I2C_MSG_READ))))
+		{
+			DBG(MSG_WARN,"message %u is invalid\n",(unsigned)i);
+			I2C_FailTransfer(msgs,count,FT_INVALID_PARAMETER);
+			return FT_INVALID_PARAMETER;
+		}
+	}
+	if(0 == count)
+		return FT_OK;
 
-		case I2C_CLOCK_FAST_MODE_PLUS:
-			mode = I2C_FAST_MODE_PLUS;
-		break;
+	LOCK_CHANNEL(handle);
+	context = I2C_GetChannelContext(handle);
+	I2C_BeginTransfer(handle,context,0);
 
-		case I2C_CLOCK_HIGH_SPEED_MODE:
-			mode = I2C_HIGH_SPEED_MODE;
-		break;
+	sizeToWrite = I2C_AddTransfer(context,NULL,msgs,count,&sizeToRead);
+	outBuffer = (uint8*) INFRA_MALLOC(sizeToWrite + sizeToRead);
+	if(NULL == outBuffer)
+	{
+		I2C_FailTransfer(msgs,count,FT_INSUFFICIENT_RESOURCES);
+		I2C_EndTransfer(context,FT_OK);
+		UNLOCK_CHANNEL(handle);
+		return FT_INSUFFICIENT_RESOURCES;
+	}
+	inBuffer = outBuffer + sizeToWrite;
+	I2C_AddTransfer(context,outBuffer,msgs,count,&sizeToRead);
+	DBG(MSG_DEBUG,"count=%u sizeToWrite=%u sizeToRead=%u\n",(unsigned)count,
+		(unsigned)sizeToWrite,(unsigned)sizeToRead);
 
-		default:
-			mode = I2C_MAXIMUM_SUPPORTED_MODES;
+	status = FT_Channel_Write(I2C,handle,sizeToWrite,outBuffer,&sizeTransferred);
+	if((FT_OK == status) && (sizeTransferred != sizeToWrite))
+		status = FT_IO_ERROR;
+	if(FT_OK == status)
+	{
+		status = FT_Channel_Read(I2C,handle,sizeToRead,inBuffer,&sizeTransferred);
+		if((FT_OK == status) && (sizeTransferred != sizeToRead))
+		{
+			DBG(MSG_ERR,"Requested to read %u bytes, no. of bytes read is %u\n",
+				(unsigned)sizeToRead,(unsigned)sizeTransferred);
+			status = FT_IO_ERROR;
+		}
 	}
-#else
-	mode = I2C_STANDARD_MODE;
+	if(FT_OK == status)
+		status = I2C_ParseTransfer(msgs,count,inBuffer);
+	else
+		I2C_FailTransfer(msgs,count,status);
+	INFRA_FREE(outBuffer);
+	I2C_EndTransfer(context,status);
+	UNLOCK_CHANNEL(handle);
+	FN_EXIT;
+	return status;
+}
+
+
+/*!
+ * \brief Finds the slaves present on the I2C bus
+ *
+ * This function probes every 7bit address from 0x08 to 0x77 with a START, the address and a STOP.
+ * The probes of all addresses are made into one command buffer, and all the address ack bits are
+ * read back in one shot, so the whole scan costs a single round trip.
+ *
+ * \param[in] handle Handle of the channel
+ * \param[out] presence Pointer to a 16 byte(128 bit) buffer. Bit (addr%8) of presence[addr/8] is
+ *			set if the slave at address addr acked
+ * \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide)
+ * \sa
+ * \note Addresses 0x30-0x37 and 0x50-0x5F are probed by reading one byte, the others by a write
+ *		without data
+ * \warning
+ */
+FTDI_API FT_STATUS I2C_ScanBus(FT_HANDLE handle, uint8 *presence)
+{
+	FT_STATUS status=FT_OK;
+	ChannelContext *context;
+	uint8 *outBuffer;
+	uint8 *inBuffer;
+	uint8 acks[128];
+	uint32 sizeToWrite=0;
+	uint32 sizeToRead=0;
+	uint32 sizeTransferred=0;
+	uint32 i;
+	uint32 addr;
+	FN_ENTER;
+#ifdef ENABLE_PARAMETER_CHECKING
+	CHECK_NULL_RET(handle);
+	CHECK_NULL_RET(presence);
 #endif
 
-	/*Restart condition SDA, SCL: 0,1->1,1->1,0->1,1->0,1*/
+	LOCK_CHANNEL(handle);
+	context = I2C_GetChannelContext(handle);
+	I2C_BeginTransfer(handle,context,0);
 
-	/*I2C_CONDITION_RESTART_1*/
-	noOfBytesToTransfer = 3;
-	noOfBytesTransferred = 0;
-	buffer[0] = MPSSE_CMD_SET_DATA_BITS_LOWBYTE;/* MPSSE command */
-	buffer[1] = VALUE_SCLHIGH_SDALOW; /* Value */
-	buffer[2] = DIRECTION_SCLOUT_SDAOUT; /* Direction */
-	status = FT_Channel_Write(I2C,handle,noOfBytesToTransfer,
-		buffer,&noOfBytesTransferred);
-	if( (FT_OK != status) && (noOfBytesToTransfer != noOfBytesTransferred) )
+	for(addr=I2C_SCAN_FIRST_ADDRESS; addr<=I2C_SCAN_LAST_ADDRESS; addr++)
 	{
-		Infra_DbgPrintStatus(status);
-		DBG(MSG_ERR,"noOfBytesToTransfer=%d noOfBytesTransferred=%d\n",
-			(int)noOfBytesToTransfer,(int)noOfBytesTransferred);
+		sizeToWrite += I2C_AddStart(context,NULL) + I2C_AddWriteByte(context,NULL,0) +
+			I2C_AddStop(context,NULL);
+		sizeToRead++;
+		if(I2C_SCAN_READ_PROBE(addr))
+		{
+			sizeToWrite += I2C_AddReadByte(context,NULL,FALSE);
+			sizeToRead++;
+		}
 	}
-	Infra_Delay(I2C_Timings[mode][I2C_CONDITION_PRESTART]);
+	sizeToWrite++;	/* for send immediate */
 
-	/*I2C_CONDITION_RESTART_2*/
-	noOfBytesToTransfer = 3;
-	noOfBytesTransferred = 0;
-	buffer[0] = MPSSE_CMD_SET_DATA_BITS_LOWBYTE;/* MPSSE command */
-	buffer[1] = VALUE_SCLHIGH_SDALOW;//  _SDAHIGH; /* Value */										// should NOT be driving SDA high
-	buffer[2] = DIRECTION_SCLOUT_SDAIN;//  _SDAOUT; /* Direction */									// Make this input instead to let line be pulled up
-	status = FT_Channel_Write(I2C,handle,noOfBytesToTransfer,
-		buffer,&noOfBytesTransferred);
-	if( (FT_OK != status) && (noOfBytesToTransfer != noOfBytesTransferred) )
+	outBuffer = (uint8*) INFRA_MALLOC(sizeToWrite + sizeToRead);
+	if(NULL == outBuffer)
 	{
-		Infra_DbgPrintStatus(status);
-		DBG(MSG_ERR,"noOfBytesToTransfer=%d noOfBytesTransferred=%d\n",
-			(int)noOfBytesToTransfer,(int)noOfBytesTransferred);
+		I2C_EndTransfer(context,FT_OK);
+		UNLOCK_CHANNEL(handle);
+		return FT_INSUFFICIENT_RESOURCES;
 	}
-	Infra_Delay(I2C_Timings[mode][I2C_CONDITION_PRESTART]);
+	inBuffer = outBuffer + sizeToWrite;
 
-	/*I2C_CONDITION_RESTART_3*/
-	noOfBytesToTransfer = 3;
-	noOfBytesTransferred = 0;
-	buffer[0] = MPSSE_CMD_SET_DATA_BITS_LOWBYTE;/* MPSSE command */
-	buffer[1] = VALUE_SCLLOW_SDALOW;// _SDAHIGH; /* Value */										// should NOT be driving SDA high
-	buffer[2] = DIRECTION_SCLOUT_SDAIN;//  _SDAOUT; /* Direction */									// Make this input instead to let line be pulled up
-	status = FT_Channel_Write(I2C,handle,noOfBytesToTransfer,
-		buffer,&noOfBytesTransferred);
-	if( (FT_OK != status) && (noOfBytesToTransfer != noOfBytesTransferred) )
+	i=0;
+	for(addr=I2C_SCAN_FIRST_ADDRESS; addr<=I2C_SCAN_LAST_ADDRESS; addr++)
 	{
-		Infra_DbgPrintStatus(status);
-		DBG(MSG_ERR,"noOfBytesToTransfer=%d noOfBytesTransferred=%d\n",
-			(int)noOfBytesToTransfer,(int)noOfBytesTransferred);
+		i += I2C_AddStart(context,&outBuffer[i]);
+		if(I2C_SCAN_READ_PROBE(addr))
+		{
+			i += I2C_AddWriteByte(context,&outBuffer[i],
+				(uint8)((addr<<1) | I2C_ADDRESS_READ_MASK));
+			i += I2C_AddReadByte(context,&outBuffer[i],FALSE);
+		}
+		else
+		{
+			i += I2C_AddWriteByte(context,&outBuffer[i],
+				(uint8)((addr<<1) & I2C_ADDRESS_WRITE_MASK));
+		}
+		i += I2C_AddStop(context,&outBuffer[i]);
 	}
-	Infra_Delay(I2C_Timings[mode][I2C_CONDITION_PRESTART]);
+	outBuffer[i++] = MPSSE_CMD_SEND_IMMEDIATE;
 
-	/*I2C_CONDITION_RESTART_4*/
-	noOfBytesToTransfer = 3;
-	noOfBytesTransferred = 0;
-	buffer[0] = MPSSE_CMD_SET_DATA_BITS_LOWBYTE;/* MPSSE command */
-	buffer[1] = VALUE_SCLHIGH_SDALOW;// _SDAHIGH; /* Value */									// should NOT be driving SDA high
-	buffer[2] = DIRECTION_SCLOUT_SDAIN;// _SDAOUT; /* Direction */								// Make this input instead to let line be pulled up
-	status = FT_Channel_Write(I2C,handle,noOfBytesToTransfer,
-		buffer,&noOfBytesTransferred);
-	if( (FT_OK != status) && (noOfBytesToTransfer != noOfBytesTransferred) )
+	status = FT_Channel_Write(I2C,handle,sizeToWrite,outBuffer,&sizeTransferred);
+	if((FT_OK == status) && (sizeTransferred != sizeToWrite))
+		status = FT_IO_ERROR;
+	if(FT_OK == status)
 	{
-		Infra_DbgPrintStatus(status);
-		DBG(MSG_ERR,"noOfBytesToTransfer=%d noOfBytesTransferred=%d\n",
-			(int)noOfBytesToTransfer,(int)noOfBytesTransferred);
+		status = FT_Channel_Read(I2C,handle,sizeToRead,inBuffer,&sizeTransferred);
+		if((FT_OK == status) && (sizeTransferred != sizeToRead))
+		{
+			DBG(MSG_ERR,"Requested to read %u bytes, no. of bytes read is %u\n",
+				(unsigned)sizeToRead,(unsigned)sizeTransferred);
+			status = FT_IO_ERROR;
+		}
+	}
+	if(FT_OK == status)
+	{
+		/* Line up the address ack bits, reserved addresses count as nAcked */
+		memset(acks,0x01,sizeof(acks));
+		for(addr=I2C_SCAN_FIRST_ADDRESS, i=0; addr<=I2C_SCAN_LAST_ADDRESS; addr++)
+		{
+			acks[addr] = inBuffer[i++];
+			if(I2C_SCAN_READ_PROBE(addr))
+				i++;	/* skip the byte read */
+		}
+		status = Infra_PackLsb(acks,sizeof(acks),presence,NULL);
+		for(i=0; i<16; i++)
+			presence[i] = (uint8)~presence[i];
 	}
-	Infra_Delay(I2C_Timings[mode][I2C_CONDITION_PRESTART]);
+	INFRA_FREE(outBuffer);
+	I2C_EndTransfer(context,status);
+	UNLOCK_CHANNEL(handle);
+	FN_EXIT;
+	return status;
+}
 
-	/*I2C_CONDITION_RESTART_5*/
-	noOfBytesToTransfer = 3;
-	noOfBytesTransferred = 0;
-	buffer[0] = MPSSE_CMD_SET_DATA_BITS_LOWBYTE;/* MPSSE command */
-	buffer[1] = VALUE_SCLLOW_SDALOW;// _SDAHIGH; /* Value */									// should NOT be driving SDA high
-	buffer[2] = DIRECTION_SCLOUT_SDAIN;//  _SDAOUT; /* Direction */								// Make this input instead to let line be pulled up
-	status = FT_Channel_Write(I2C,handle,noOfBytesToTransfer,
-		buffer,&noOfBytesTransferred);
-	if( (FT_OK != status) && (noOfBytesToTransfer != noOfBytesTransferred) )
+
+/*!
+ * \brief Polls a register of an I2C slave until a condition holds
+ *
+ * This function reads one byte register of the slave over and over until (value & mask) equals
+ * expected, e.g. to wait for a conversion to complete or a PLL to lock. Rather than making a
+ * round trip per read, batches of reads are queued and checked as they come back(see
+ * Mid_PollSamples), so that most waits end after a single round trip.
+ *
+ * Each sample is START, address+W, reg, repeated START, address+R, one byte read(nAcked), STOP.
+ * A sample in which the slave nAcked any byte doesn't match, so slaves that stop responding
+ * while they are busy can be polled as well.
+ *
+ * \param[in] handle Handle of the channel
+ * \param[in] deviceAddress Address of the I2C slave
+ * \param[in] reg Address of the register to be polled
+ * \param[in] mask Bits of the register to be compared
+ * \param[in] expected Value the masked bits are waited for
+ * \param[in] timeout Time in milliseconds after which polling is given up
+ * \param[out] value Pointer to the value of the matching sample, or of the last sample on
+ *			timeout. May be NULL
+ * \param[out] elapsedUs Pointer to the time in microseconds from the start of the poll until the
+ *			matching sample was received. May be NULL
+ * \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide)
+ * \sa I2C_PollAck
+ * \note FT_OTHER_ERROR is returned if the condition didn't hold within the timeout. At least
+ *		one batch is always sampled, so a timeout of 0 checks the register once
+ * \warning The samples queued after the matching one are still clocked out on the bus
+ */
+FTDI_API FT_STATUS I2C_PollRegister(FT_HANDLE handle, uint32 deviceAddress, uint8 reg,
+	uint8 mask, uint8 expected, uint32 timeout, uint8 *value, uint32 *elapsedUs)
+{
+	FT_STATUS status;
+	ChannelContext *context;
+	uint8 *sample;
+	uint32 i;
+	FN_ENTER;
+#ifdef ENABLE_PARAMETER_CHECKING
+	CHECK_NULL_RET(handle);
+	if(deviceAddress>127)
 	{
-		Infra_DbgPrintStatus(status);
-		DBG(MSG_ERR,"noOfBytesToTransfer=%d noOfBytesTransferred=%d\n",
-			(int)noOfBytesToTransfer,(int)noOfBytesTransferred);
+		DBG(MSG_WARN, "deviceAddress(0x%x) is greater than 127\n",(unsigned)deviceAddress);
+		return FT_INVALID_PARAMETER;
+	}
+#endif
+
+	LOCK_CHANNEL(handle);
+	context = I2C_GetChannelContext(handle);
+	sample = (uint8*) INFRA_MALLOC(I2C_AddStart(context,NULL) +
+		3*I2C_AddWriteByte(context,NULL,0) + I2C_AddRestart(context,NULL) +
+		I2C_AddReadByte(context,NULL,FALSE) + I2C_AddStop(context,NULL));
+	if(NULL == sample)
+	{
+		UNLOCK_CHANNEL(handle);
+		return FT_INSUFFICIENT_RESOURCES;
+	}
+	i = I2C_AddStart(context,sample);
+	i += I2C_AddWriteByte(context,&sample[i],
+		(uint8)((deviceAddress<<1) & I2C_ADDRESS_WRITE_MASK));
+	i += I2C_AddWriteByte(context,&sample[i],reg);
+	i += I2C_AddRestart(context,&sample[i]);
+	i += I2C_AddWriteByte(context,&sample[i],
+		(uint8)((deviceAddress<<1) | I2C_ADDRESS_READ_MASK));
+	i += I2C_AddReadByte(context,&sample[i],FALSE);
+	i += I2C_AddStop(context,&sample[i]);
+
+	I2C_BeginTransfer(handle,context,0);
+	/* three ack bits and the register value per sample */
+	status = Mid_PollSamples(I2C,handle,sample,i,4,3,3,mask,expected,timeout,value,elapsedUs,
+		&context->pollBatch);
+	I2C_EndTransfer(context,MID_POLL_TRANSFER_STATUS(status));
+	INFRA_FREE(sample);
+	UNLOCK_CHANNEL(handle);
+	FN_EXIT;
+	return status;
+}
+
+/*!
+ * \brief Polls an I2C slave until it acks its address
+ *
+ * This function addresses the slave over and over until it acks, e.g. to wait for the internal
+ * write cycle of an EEPROM to complete. Batches of address probes are queued and checked as
+ * they come back(see Mid_PollSamples), so that most waits end after a single round trip.
+ *
+ * Each sample is START, address+W, STOP.
+ *
+ * \param[in] handle Handle of the channel
+ * \param[in] deviceAddress Address of the I2C slave
+ * \param[in] timeout Time in milliseconds after which polling is given up
+ * \param[out] elapsedUs Pointer to the time in microseconds from the start of the poll until the
+ *			slave acked. May be NULL
+ * \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide)
+ * \sa I2C_PollRegister
+ * \note FT_DEVICE_NOT_FOUND is returned if the slave didn't ack within the timeout
+ * \warning
+ */
+FTDI_API FT_STATUS I2C_PollAck(FT_HANDLE handle, uint32 deviceAddress, uint32 timeout,
+	uint32 *elapsedUs)
+{
+	FT_STATUS status;
+	ChannelContext *context;
+	uint8 *sample;
+	uint32 i;
+	FN_ENTER;
+#ifdef ENABLE_PARAMETER_CHECKING
+	CHECK_NULL_RET(handle);
+	if(deviceAddress>127)
+	{
+		DBG(MSG_WARN, "deviceAddress(0x%x) is greater than 127\n",(unsigned)deviceAddress);
+		return FT_INVALID_PARAMETER;
+	}
+#endif
+
+	LOCK_CHANNEL(handle);
+	context = I2C_GetChannelContext(handle);
+	sample = (uint8*) INFRA_MALLOC(I2C_AddStart(context,NULL) +
+		I2C_AddWriteByte(context,NULL,0) + I2C_AddStop(context,NULL));
+	if(NULL == sample)
+	{
+		UNLOCK_CHANNEL(handle);
+		return FT_INSUFFICIENT_RESOURCES;
+	}
+	i = I2C_AddStart(context,sample);
+	i += I2C_AddWriteByte(context,&sample[i],
+		(uint8)((deviceAddress<<1) & I2C_ADDRESS_WRITE_MASK));
+	i += I2C_AddStop(context,&sample[i]);
+
+	I2C_BeginTransfer(handle,context,0);
+	status = Mid_PollSamples(I2C,handle,sample,i,1,1,0,0,0,timeout,NULL,elapsedUs,
+		&context->ackPollBatch);
+	I2C_EndTransfer(context,MID_POLL_TRANSFER_STATUS(status));
+	if(FT_OTHER_ERROR == status)
+		status = FT_DEVICE_NOT_FOUND;
+	INFRA_FREE(sample);
+	UNLOCK_CHANNEL(handle);
+	FN_EXIT;
+	return status;
+}
+
+
+/*!
+ * \brief Estimates the time the read of a sensor takes on the bus
+ *
+ * \param[in] handle Handle of the channel
+ * \param[in] recipe Pointer to how the sensor is read
+ * \return Time in nanoseconds
+ * \sa SCHED_AddSensor
+ * \note Every byte takes 9 bit periods(8 data bits and the ack), START/repeated START and STOP
+ *		are counted as a bit period each
+ * \warning
+ */
+uint32 I2C_SchedBusTime(FT_HANDLE handle, const SCHED_Recipe *recipe)
+{
+	ChannelContext *context;
+	uint32 clockRate=I2C_CLOCK_STANDARD_MODE;
+	uint32 bits;
+
+	context = I2C_GetChannelContext(handle);
+	if((NULL != context) && (context->config.ClockRate > 0))
+		clockRate = context->config.ClockRate;
+	bits = 9*(1 + recipe->readLength) + 2;
+	if(recipe->commandLength > 0)
+		bits += 9*(1 + recipe->commandLength) + 1;
+	return (uint32)((uint64)bits*1000000000/clockRate);
+}
+
+/*!
+ * \brief Reads the sensors that are due in a tick of the scheduler
+ *
+ * The reads of all the sensors are chained into a single combined transaction(see
+ * I2C_Transfer): for each sensor the command is written, if there is one, and the data is read
+ * after a repeated START.
+ *
+ * \param[in] handle Handle of the channel
+ * \param[in] recipes Pointers to how each sensor is read
+ * \param[out] data Pointers to where the data read from each sensor is stored
+ * \param[out] sensorStatus Status of each sensor: FT_OK, FT_DEVICE_NOT_FOUND or
+ *		FT_FAILED_TO_WRITE_DEVICE
+ * \param[in] count Number of sensors
+ * \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide)
+ * \sa SCHED_Tick
+ * \note A sensor that doesn't ack only fails its own read, FT_OK is returned as long as the
+ *		transaction itself went through
+ * \warning
+ */
+FT_STATUS I2C_SchedRead(FT_HANDLE handle, const SCHED_Recipe **recipes, uint8 **data,
+	FT_STATUS *sensorStatus, uint32 count)
+{
+	FT_STATUS transferStatus;
+	I2C_Msg *msgs;
+	uint32 *first;
+	uint32 noOfMsgs=0;
+	uint32 r, m;
+
+	msgs = (I2C_Msg*) INFRA_MALLOC(2*count*sizeof(I2C_Msg) + (count+1)*sizeof(uint32));
+	if(NULL == msgs)
+		return FT_INSUFFICIENT_RESOURCES;
+	first = (uint32*)&msgs[2*count];
+	for(r=0; r<count; r++)
+	{
+		first[r] = noOfMsgs;
+		if(recipes[r]->commandLength > 0)
+		{
+			msgs[noOfMsgs].addr = recipes[r]->address;
+			msgs[noOfMsgs].flags = 0;
+			msgs[noOfMsgs].len = recipes[r]->commandLength;
+			msgs[noOfMsgs].buf = (uint8*)recipes[r]->command;
+			noOfMsgs++;
+		}
+		msgs[noOfMsgs].addr = recipes[r]->address;
+		msgs[noOfMsgs].flags = I2C_MSG_READ;
+		msgs[noOfMsgs].len = recipes[r]->readLength;
+		msgs[noOfMsgs].buf = data[r];
+		noOfMsgs++;
+	}
+	first[count] = noOfMsgs;
+
+	transferStatus = I2C_Transfer(handle,msgs,noOfMsgs);
+	if((FT_DEVICE_NOT_FOUND == transferStatus) || (FT_FAILED_TO_WRITE_DEVICE == transferStatus))
+		transferStatus = FT_OK;
+	for(r=0; (r<count) && (FT_OK == transferStatus); r++)
+	{
+		sensorStatus[r] = FT_OK;
+		for(m=first[r]; (m<first[r+1]) && (FT_OK == sensorStatus[r]); m++)
+			sensorStatus[r] = msgs[m].status;
 	}
-	Infra_Delay(I2C_Timings[mode][I2C_CONDITION_PRESTART]);
+	INFRA_FREE(msgs);
+	return transferStatus;
+}
+
+#ifdef I2C_CMD_GETDEVICEID_SUPPORTED
+/*!
+ * \brief Get the I2C device ID
+ *
+ * This function retrieves the I2C device ID
+ *
+ * \param[in] handle Handle of the channel
+ * \param[in] deviceAddress Address of the I2C slave
+ * \param[out] deviceID Address of memory where the 3byte I2C device ID will be stored
+ * \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide)
+ * \sa
+ * \note
+ * \warning
+ */
+FTDI_API FT_STATUS I2C_GetDeviceID(FT_HANDLE handle, uint8 deviceAddress,
+	uint8* deviceID)
+{
+	FT_STATUS status=FT_OTHER_ERROR;
+	ChannelContext *context;
+	bool ack;
+	FN_ENTER;
+#ifdef ENABLE_PARAMETER_CHECKING
+		CHECK_NULL_RET(handle);
+		CHECK_NULL_RET(deviceID);
+		if(deviceAddress>127)
+		{
+			DBG(MSG_WARN,"deviceAddress(0x%x) is greater than 127\n", \
+				(unsigned)deviceAddress);
+			status = FT_INVALID_PARAMETER;
+			return status;
+		}
+#endif
+
+	context = I2C_GetChannelContext(handle);
+	status = I2C_Start(handle,context);
+	CHECK_STATUS(status);
+	status = I2C_Write8bitsAndGetAck(handle,context,(uint8)I2C_CMD_GETDEVICEID_RD,&ack);
+	CHECK_STATUS(status);
+	status = I2C_Write8bitsAndGetAck(handle,context,deviceAddress, &ack);
+	CHECK_STATUS(status);
+	status = I2C_Restart(handle,context);
+	CHECK_STATUS(status);
+	status = I2C_Write8bitsAndGetAck(handle,context,(uint8)I2C_CMD_GETDEVICEID_WR,&ack);
+	CHECK_STATUS(status);
+	status = I2C_Read8bitsAndGiveAck(handle,context,&(deviceID[0]),I2C_GIVE_ACK);
+	CHECK_STATUS(status);
+	status = I2C_Read8bitsAndGiveAck(handle,context,&(deviceID[1]),I2C_GIVE_ACK);
+	CHECK_STATUS(status);
+	/*NACK 3rd byte*/
+	status = I2C_Read8bitsAndGiveAck(handle,context,&(deviceID[2]),I2C_GIVE_NACK);
+	CHECK_STATUS(status);
 
-	/*I2C_CONDITION_RESTART -tristate SCL & SDA */
-	noOfBytesToTransfer = 3;
+	FN_EXIT;
+	return status;
+}
+#endif
+
+
+/******************************************************************************/
+/*						Local function definations						  */
+/******************************************************************************/
+/*!
+ * \brief Generate I2C bus restart condition
+ *
+ * This function generates the restart condition in the I2C bus
+ *
+ * \param[in] handle Handle of the channel
+ * \param[in] context Pointer to the channel's context
+ * \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide)
+ * \sa I2C_AddRestart
+ * \note
+ * \warning
+ */
+FT_STATUS I2C_Restart(FT_HANDLE handle, const ChannelContext *context)
+{
+	FT_STATUS status;
+	uint8 buffer[I2C_CONDITION_BUFFER_SIZE];
+	uint32 noOfBytesToTransfer;
+	uint32 noOfBytesTransferred;
+
+	FN_ENTER;
+	noOfBytesToTransfer = I2C_AddRestart(context,buffer);
 	noOfBytesTransferred = 0;
-	buffer[0] = MPSSE_CMD_SET_DATA_BITS_LOWBYTE;/* MPSSE command */
-	buffer[1] = VALUE_SCLLOW_SDALOW; /* Value(0x00=SCL low, SDA low) */
-	buffer[2] = DIRECTION_SCLIN_SDAIN; /* Direction */
 	status = FT_Channel_Write(I2C,handle,noOfBytesToTransfer,
 		buffer,&noOfBytesTransferred);
 	if( (FT_OK != status) && (noOfBytesToTransfer != noOfBytesTransferred) )
@@ -761,13 +1368,10 @@ FT_STATUS I2C_Restart(FT_HANDLE handle)
 		DBG(MSG_ERR,"noOfBytesToTransfer=%d noOfBytesTransferred=%d\n",
 			(int)noOfBytesToTransfer,(int)noOfBytesTransferred);
 	}
-	Infra_Delay(I2C_Timings[mode][I2C_CONDITION_POSTSTOP]);
 
 	FN_EXIT;
 	return status;
 }
-#endif
-
 
 
 /*!
@@ -776,6 +1380,7 @@ FT_STATUS I2C_Restart(FT_HANDLE handle)
  * This function writes 8 bits of data to the I2C bus and gets the ack bit from the device
  *
  * \param[in] handle Handle of the channel
+ * \param[in] context Pointer to the channel's context
  * \param[in] data The 8bits of data that are to be written to the I2C bus
  * \param[out] ack The acknowledgment bit returned by the I2C device
  * \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide)
@@ -783,10 +1388,11 @@ FT_STATUS I2C_Restart(FT_HANDLE handle)
  * \note
  * \warning
  */
-FT_STATUS I2C_Write8bitsAndGetAck(FT_HANDLE handle, uint8 data, bool *ack)
+FT_STATUS I2C_Write8bitsAndGetAck(FT_HANDLE handle, const ChannelContext *context,
+	uint8 data, bool *ack)
 {
 	FT_STATUS status = FT_OTHER_ERROR;
-	uint8 buffer[20] = {0};
+	uint8 buffer[I2C_BYTE_BUFFER_SIZE+1] = {0};
 	uint8 inBuffer[3] = {0};
 	uint32 noOfBytes = 0;
 	uint32 noOfBytesTransferred = 0;
@@ -795,24 +1401,8 @@ FT_STATUS I2C_Write8bitsAndGetAck(FT_HANDLE handle, uint8 data, bool *ack)
 	FN_ENTER;
 	DBG(MSG_DEBUG,"----------Writing byte 0x%x \n",data);
 
-	/* Set direction */
-	buffer[noOfBytes++] = MPSSE_CMD_SET_DATA_BITS_LOWBYTE;
-	buffer[noOfBytes++] = VALUE_SCLLOW_SDALOW;
-	buffer[noOfBytes++] = DIRECTION_SCLOUT_SDAOUT;
-
-	/* Command to write 8 bits */
-	buffer[noOfBytes++]= MPSSE_CMD_DATA_OUT_BITS_NEG_EDGE;
-	buffer[noOfBytes++]= DATA_SIZE_8BITS;
-	buffer[noOfBytes++] = data;
-
-	/* Set SDA to input mode before reading ACK bit */
-	buffer[noOfBytes++] = MPSSE_CMD_SET_DATA_BITS_LOWBYTE;
-	buffer[noOfBytes++] = VALUE_SCLLOW_SDALOW;
-	buffer[noOfBytes++] = DIRECTION_SCLOUT_SDAIN;
-
-	/* Command to get ACK bit */
-	buffer[noOfBytes++] = MPSSE_CMD_DATA_IN_BITS_POS_EDGE;
-	buffer[noOfBytes++] = DATA_SIZE_1BIT;
+	/* Write 8 bits and get ACK bit */
+	noOfBytes += I2C_AddWriteByte(context,buffer,data);
 
 	/* Command MPSSE to send data to PC immediately */
 	buffer[noOfBytes++] = MPSSE_CMD_SEND_IMMEDIATE;
@@ -872,6 +1462,7 @@ FT_STATUS I2C_Write8bitsAndGetAck(FT_HANDLE handle, uint8 data, bool *ack)
  * This function reads 8 bits of data from the I2C bus and then writes an ack bit to the bus
  *
  * \param[in] handle Handle of the channel
+ * \param[in] context Pointer to the channel's context
  * \param[in] *data Pointer to the buffer where the 8bits would be read to
  * \param[in] ack Gives ack to device if set, otherwise gives nAck
  * \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide)
@@ -879,10 +1470,11 @@ FT_STATUS I2C_Write8bitsAndGetAck(FT_HANDLE handle, uint8 data, bool *ack)
  * \note
  * \warning
  */
-FT_STATUS I2C_Read8bitsAndGiveAck(FT_HANDLE handle, uint8 *data, bool ack)
+FT_STATUS I2C_Read8bitsAndGiveAck(FT_HANDLE handle, const ChannelContext *context,
+	uint8 *data, bool ack)
 {
 	FT_STATUS status = FT_OTHER_ERROR;
-	uint8 buffer[20] = {0};
+	uint8 buffer[I2C_BYTE_BUFFER_SIZE+1] = {0};
 	uint8 inBuffer[3] = {0};
 	uint32 noOfBytes = 0;
 	uint32 noOfBytesTransferred = 0;
@@ -890,46 +1482,8 @@ FT_STATUS I2C_Read8bitsAndGiveAck(FT_HANDLE handle, uint8 *data, bool ack)
 
 	FN_ENTER;
 
-
-	/* Set pin directions - SCL is output driven low, SDA is input (set high but does not matter) */
-	buffer[noOfBytes++] = MPSSE_CMD_SET_DATA_BITS_LOWBYTE;
-	buffer[noOfBytes++] = VALUE_SCLLOW_SDALOW;
-	buffer[noOfBytes++] = DIRECTION_SCLOUT_SDAIN;
-
-	/* Command to read 8 bits */
-	buffer[noOfBytes++] = MPSSE_CMD_DATA_IN_BITS_POS_EDGE;
-	buffer[noOfBytes++] = DATA_SIZE_8BITS;
-
-	/* Set directions to make SDA drive out. Pre-set state of SDA first though to avoid glitch */
-	if (ack)
-	{
-		/* We will drive the ACK bit to a '0' so pre-set pin to a '0' */
-		buffer[noOfBytes++] = MPSSE_CMD_SET_DATA_BITS_LOWBYTE;
-		buffer[noOfBytes++] = VALUE_SCLLOW_SDALOW;
-		buffer[noOfBytes++] = DIRECTION_SCLOUT_SDAOUT;
-
-		/* Clock out the ack bit as a '0' on negative edge */
-		buffer[noOfBytes++] = MPSSE_CMD_DATA_OUT_BITS_NEG_EDGE;
-		buffer[noOfBytes++] = DATA_SIZE_1BIT;
-		buffer[noOfBytes++] = SEND_ACK;
-	}
-	else
-	{
-		/* We will release the ACK bit to a '1' so pre-set pin to a '1' by making it an input */
-		buffer[noOfBytes++] = MPSSE_CMD_SET_DATA_BITS_LOWBYTE;
-		buffer[noOfBytes++] = VALUE_SCLLOW_SDALOW;
-		buffer[noOfBytes++] = DIRECTION_SCLOUT_SDAIN;
-
-		/* Clock out the ack bit as a '1' on negative edge - never actually seen on line since SDA is input but burns off one bit time */
-		buffer[noOfBytes++] = MPSSE_CMD_DATA_OUT_BITS_NEG_EDGE;
-		buffer[noOfBytes++] = DATA_SIZE_1BIT;
-		buffer[noOfBytes++] = SEND_NACK;
-	}
-
-	/* Back to Idle */
-	buffer[noOfBytes++] = MPSSE_CMD_SET_DATA_BITS_LOWBYTE;
-	buffer[noOfBytes++] = VALUE_SCLLOW_SDALOW;
-	buffer[noOfBytes++] = DIRECTION_SCLOUT_SDAIN;
+	/* Read 8 bits and give ACK/nACK bit, then go back to idle */
+	noOfBytes += I2C_AddReadByte(context,buffer,ack);
 
 	/* Command MPSSE to send data to PC immediately */
 	buffer[noOfBytes++] = MPSSE_CMD_SEND_IMMEDIATE;
@@ -989,10 +1543,12 @@ FT_STATUS I2C_Read8bitsAndGiveAck(FT_HANDLE handle, uint8 *data, bool ack)
  * \brief This function generates the START, ADDRESS, DATA(write) & STOP phases in the I2C
  *		bus without having delays between these phases
  *
- * This function allocates memory locally, makes MPSSE command frames to write each data
- * byte/bit, makes MPSSE command frames to read the acknowledgement bits, and then writes
- * all these to the MPSSE in one shot. This function is useful where delays between START, DATA
- * and STOP phases are not prefered.
+ * This function makes MPSSE command frames to write each data
+ * byte/bit, makes MPSSE command frames to read the acknowledgement bits, and writes
+ * them to the MPSSE in chunks of I2C_FAST_CHUNK_SIZE bytes. The commands of the next chunk are
+ * queued before the results of the current one are read, so the bus doesn't stall between
+ * chunks and the memory used doesn't depend on the size of the transfer. This function is
+ * useful where delays between START, DATA and STOP phases are not prefered.
  *
  * \param[in] handle Handle of the channel
  * \param[in] deviceAddress Address of the I2C Slave. This parameter is ignored if flag
@@ -1003,9 +1559,13 @@ FT_STATUS I2C_Read8bitsAndGiveAck(FT_HANDLE handle, uint8 *data, bool ack)
  * \param[in] *buffer Pointer to the buffer from where data is to be written. The user application
  * 			is expected to send a byte array of length sizeToTransfer. However if
  *			I2C_TRANSFER_OPTIONS_FAST_TRANSFER_BITS is set then the length of the byte
- *			array should be sizeToTransfer/8.
- * \param[out] *ack Pointer to the buffer to where the ack bits are to be stored. The ack bits are
- *			 ignored if NULL is passed
+ *			array should be (sizeToTransfer+7)/8, the bits are written MSB first and those
+ *			of the last byte are taken from its MSBs.
+ * \param[out] *ackBitmap Pointer to the buffer to where the ack bits of the data bytes are to be
+ *			 stored, packed 8 per byte(see Infra_PackLsb). A set bit means the byte was nAcked.
+ *			 The buffer should be (sizeToTransfer+7)/8 bytes long. Ignored if NULL is passed
+ * \param[out] *firstNack Index of the first data byte that was nAcked, sizeToTransfer if all
+ *			 were acked. Ignored if NULL is passed
  * \param[out] sizeTransferred Pointer to variable containing the number of bytes/bits written
  * \param[in] options This parameter specifies data transfer options. Namely if a start/stop
  *			conditions are required, if size is in bytes or bits, if address is provided.
@@ -1017,212 +1577,151 @@ FT_STATUS I2C_Read8bitsAndGiveAck(FT_HANDLE handle, uint8 *data, bool ack)
  *			I2C_TRANSFER_OPTIONS_STOP_BIT
  * \note The I2C_TRANSFER_OPTIONS_BREAK_ON_NACK bit in the options parameter is not
  *          applicable for this function.
+ * \note If firstNack is provided and the slave nAcks its address then FT_DEVICE_NOT_FOUND is
+ *          returned, otherwise the address ack bit is ignored as before
  * \warning
  */
 FT_STATUS I2C_FastWrite(FT_HANDLE handle, uint32 deviceAddress,
-uint32 sizeToTransfer, uint8 *buffer, uint8 *ack, uint32 *sizeTransferred, uint32 options)
+uint32 sizeToTransfer, uint8 *buffer, uint8 *ackBitmap, uint32 *firstNack,
+uint32 *sizeTransferred, uint32 options)
 {
 	FT_STATUS status=FT_OK;
-	uint32 i=0; /* index of cmdBuffer that is filled */
-	uint32 j=0; /* scratch register */
+	uint32 i; /* index of cmdBuffer that is filled */
+	uint32 j; /* number of address ack bytes read with the chunk */
 	uint32 sizeTotal;
 	uint8* outBuffer;
+	uint8* inBuffer;
 	uint32 bytesRead;
+	uint32 done; /* first byte of the chunk whose acks are read */
+	uint32 next; /* first byte of the chunk after it */
+	uint32 nack;
+	uint32 noOfAcks;
 	uint32 bytesToTransfer;
-	uint8 tempAddress;
-	uint8* inBuffer;
+	ChannelContext *context;
 
 
 	FN_ENTER;
+	context = I2C_GetChannelContext(handle);
 
 
-	if(!(options & I2C_TRANSFER_OPTIONS_FAST_TRANSFER_BYTES))
+	if(!(options & I2C_TRANSFER_OPTIONS_FAST_TRANSFER))
 	{
-		// Fast read supports I2C_TRANSFER_OPTIONS_FAST_TRANSFER_BYTES only, not I2C_TRANSFER_OPTIONS_FAST_TRANSFER_BITS
 		return FT_INVALID_PARAMETER;
 	}
+	/* Bytes of the buffer that hold the bits, the last one may be partly used */
+	bytesToTransfer = I2C_FAST_TRANSFER_IN_BITS(options)?((sizeToTransfer+7)/8):sizeToTransfer;
 
 
 	//--------------------------------------------------------------------------------------------
-	// ############## Allocate COMMAND buffer #############
-	
-	bytesToTransfer = sizeToTransfer;
-	
-	/* Calculate size of required buffer */
-	sizeTotal = 0 /* for send immediate */
-	+ (bytesToTransfer*(6+5)) /* the size of data itself */
-	+ ((!(options & I2C_TRANSFER_OPTIONS_NO_ADDRESS))?(11):(0)) /* for address byte */
-	+ ((options & I2C_TRANSFER_OPTIONS_START_BIT)?((START_DURATION_1+	\
-			START_DURATION_2+1)*3):0) /* size required for START */
-	+ ((options & I2C_TRANSFER_OPTIONS_STOP_BIT)?((STOP_DURATION_1+		\
-			STOP_DURATION_2+STOP_DURATION_3+1)*3):0); /* size for STOP */
-
-	/* Allocate buffers */
+	// ############## Allocate buffers #############
+	/* Largest chunk: START, address, I2C_FAST_CHUNK_SIZE data bytes, STOP & SEND_IMMEDIATE */
+	sizeTotal = ((I2C_FAST_CHUNK_SIZE+1)*I2C_AddWriteByte(context,NULL,0))
+		+ I2C_AddStart(context,NULL) + I2C_AddStop(context,NULL) + 1;
 	outBuffer = (uint8*) INFRA_MALLOC(sizeTotal);
 	if(NULL == outBuffer)
 	{
 		return FT_INSUFFICIENT_RESOURCES;
 	}
-
-
-	//--------------------------------------------------------------------------------------------
-	// ############## Write START command #############
-	if(options & I2C_TRANSFER_OPTIONS_START_BIT)
+	inBuffer = (uint8*) INFRA_MALLOC(I2C_FAST_CHUNK_SIZE+1);
+	if(NULL == inBuffer)
 	{
-		DBG(MSG_DEBUG,"adding START condition\n");
-		/* SCL high, SDA high */
-		for(j=0;j<START_DURATION_1;j++)
-		{
-			outBuffer[i++] = MPSSE_CMD_SET_DATA_BITS_LOWBYTE;
-			outBuffer[i++] = VALUE_SCLHIGH_SDAHIGH;
-			outBuffer[i++] = DIRECTION_SCLOUT_SDAIN;
-		}
-		/* SCL high, SDA low */
-		for(j=0;j<START_DURATION_2;j++)
-		{
-			outBuffer[i++] = MPSSE_CMD_SET_DATA_BITS_LOWBYTE;
-			outBuffer[i++] = VALUE_SCLHIGH_SDALOW;
-			outBuffer[i++] = DIRECTION_SCLOUT_SDAOUT;
-		}
-		/*SCL low, SDA low */
-		outBuffer[i++] = MPSSE_CMD_SET_DATA_BITS_LOWBYTE;
-		outBuffer[i++] = VALUE_SCLLOW_SDALOW;
-		outBuffer[i++] = DIRECTION_SCLOUT_SDAOUT;
+		INFRA_FREE(outBuffer);
+		return FT_INSUFFICIENT_RESOURCES;
 	}
+	*sizeTransferred = 0;
+	if(NULL != firstNack)
+		*firstNack = sizeToTransfer;
 
 
 	//--------------------------------------------------------------------------------------------
-	// ############## Write ADDRESS #############
-	if(!(options & I2C_TRANSFER_OPTIONS_NO_ADDRESS))
-	{
-		tempAddress = (uint8)deviceAddress;
-		tempAddress = (tempAddress << 1);
-		tempAddress = (tempAddress & I2C_ADDRESS_WRITE_MASK);
-		DBG(MSG_DEBUG,"7bit I2C address plus direction bit = 0x%x\n", tempAddress);
-
-		/*set direction*/
-		outBuffer[i++] = MPSSE_CMD_SET_DATA_BITS_LOWBYTE;
-		outBuffer[i++] = VALUE_SCLLOW_SDALOW;
-		outBuffer[i++] = DIRECTION_SCLOUT_SDAOUT;
-
-		/* write address + direction bit */
-		outBuffer[i++] = MPSSE_CMD_DATA_OUT_BITS_NEG_EDGE;
-		outBuffer[i++] = DATA_SIZE_8BITS;
-		outBuffer[i++] = tempAddress;
-
-		/* Set SDA to input mode before reading ACK bit */
-		outBuffer[i++] = MPSSE_CMD_SET_DATA_BITS_LOWBYTE;
-		outBuffer[i++] = VALUE_SCLLOW_SDALOW;
-		outBuffer[i++] = DIRECTION_SCLOUT_SDAIN;
-
-		/* Command to get ACK bit */
-		outBuffer[i++] = MPSSE_CMD_DATA_IN_BITS_POS_EDGE;
-		outBuffer[i++] = DATA_SIZE_1BIT;
-	}
+	// ############## Write commands of the first chunk #############
+	i = I2C_AddFastChunk(context,outBuffer,deviceAddress,buffer,0,sizeToTransfer,options,FALSE);
+	DBG(MSG_DEBUG,"i=%u sizeToTransfer=%u\n",(unsigned)i,(unsigned)sizeToTransfer);
+	status = FT_Channel_Write(I2C,handle,i,outBuffer,&bytesRead);
+	if((FT_OK == status) && (bytesRead != i))
+		status = FT_IO_ERROR;
 
 
-	//--------------------------------------------------------------------------------------------
-	// ############## Write ACTUAL DATA #############
-	for (j=0; j<bytesToTransfer; j++)
+	for(done=0; FT_OK == status; done=next)
 	{
-		/*set direction*/
-		outBuffer[i++] = MPSSE_CMD_SET_DATA_BITS_LOWBYTE;
-		outBuffer[i++] = VALUE_SCLLOW_SDALOW;
-		outBuffer[i++] = DIRECTION_SCLOUT_SDAOUT;
+		next = ((bytesToTransfer-done) > I2C_FAST_CHUNK_SIZE)?
+			(done+I2C_FAST_CHUNK_SIZE):bytesToTransfer;
 
-		/* Command to write 8 bits */
-		outBuffer[i++] = MPSSE_CMD_DATA_OUT_BITS_NEG_EDGE;
-		outBuffer[i++] = DATA_SIZE_8BITS;
-		outBuffer[i++] = buffer[j];
-
-		/* Set SDA to input mode before reading ACK bit */
-		outBuffer[i++] = MPSSE_CMD_SET_DATA_BITS_LOWBYTE;
-		outBuffer[i++] = VALUE_SCLLOW_SDALOW;
-		outBuffer[i++] = DIRECTION_SCLOUT_SDAIN;
-
-		/* Command to get ACK bit */
-		outBuffer[i++] = MPSSE_CMD_DATA_IN_BITS_POS_EDGE;
-		outBuffer[i++] = DATA_SIZE_1BIT;
-	}
-
-
-	//--------------------------------------------------------------------------------------------
-	// ############## Write STOP command #############
-	if(options & I2C_TRANSFER_OPTIONS_STOP_BIT)
-	{
-		/* SCL low, SDA low */
-		for(j=0;j<STOP_DURATION_1;j++)
+		//----------------------------------------------------------------------------------------
+		// ############## Queue commands of the next chunk #############
+		if(next < bytesToTransfer)
 		{
-			outBuffer[i++] = MPSSE_CMD_SET_DATA_BITS_LOWBYTE;
-			outBuffer[i++] = VALUE_SCLLOW_SDALOW;
-			outBuffer[i++] = DIRECTION_SCLOUT_SDAOUT;
+			i = I2C_AddFastChunk(context,outBuffer,deviceAddress,buffer,next,sizeToTransfer,
+				options,FALSE);
+			status = FT_Channel_Write(I2C,handle,i,outBuffer,&bytesRead);
+			if((FT_OK == status) && (bytesRead != i))
+				status = FT_IO_ERROR;
+			if(FT_OK != status)
+				break;
 		}
-		/* SCL high, SDA low */
-		for(j=0;j<STOP_DURATION_2;j++)
+
+		//----------------------------------------------------------------------------------------
+		// ############## Read ACKS #############
+		/* Read the ack of the address, followed by the 1bit ack after each 8bits written. There
+		are no ack bits when the size is in bits */
+		j = ((0 == done) && !(options & I2C_TRANSFER_OPTIONS_NO_ADDRESS))?1:0;
+		noOfAcks = I2C_FAST_TRANSFER_IN_BITS(options)?0:(next-done);
+		if((j+noOfAcks) > 0)
 		{
-			outBuffer[i++] = MPSSE_CMD_SET_DATA_BITS_LOWBYTE;
-			outBuffer[i++] = VALUE_SCLHIGH_SDALOW;
-			outBuffer[i++] = DIRECTION_SCLOUT_SDAOUT;
+			status = FT_Channel_Read(I2C, handle, j+noOfAcks, inBuffer, &bytesRead);
+			if((FT_OK == status) && (bytesRead != (j+noOfAcks)))
+			{
+				DBG(MSG_ERR,"Requested to read %u ack bytes, no. of bytes read is %u\n",
+					(unsigned)(j+noOfAcks),(unsigned)bytesRead);
+				status = FT_IO_ERROR;
+			}
 		}
-		/* SCL high, SDA high */
-		for(j=0;j<STOP_DURATION_3;j++)
+		if(FT_OK != status)
+			break;
+		if(I2C_FAST_TRANSFER_IN_BITS(options))
 		{
-			outBuffer[i++] = MPSSE_CMD_SET_DATA_BITS_LOWBYTE;
-			outBuffer[i++] = VALUE_SCLHIGH_SDAHIGH;
-			outBuffer[i++] = DIRECTION_SCLOUT_SDAIN;
+			*sizeTransferred = (next < bytesToTransfer)?(next*8):sizeToTransfer;
+		}
+		else if((NULL != ackBitmap) || (NULL != firstNack))
+		{/* Pack the ack bits of the data bytes into the caller's bitmap */
+			status = Infra_PackLsb(inBuffer+j, next-done,
+				(NULL==ackBitmap)?NULL:&ackBitmap[done/8], &nack);
+			if((FT_OK == status) && (NULL != firstNack) && (nack < (next-done)) &&
+				(*firstNack == sizeToTransfer))
+				*firstNack = done+nack;
+			if((FT_OK == status) && j && (NULL != firstNack) && (inBuffer[0] & 0x01))
+			{
+				DBG(MSG_ERR,"I2C device with address 0x%x didn't ack when addressed\n",
+					(unsigned)deviceAddress);
+				status = FT_DEVICE_NOT_FOUND;
+			}
 		}
-		outBuffer[i++] = MPSSE_CMD_SET_DATA_BITS_LOWBYTE;
-		outBuffer[i++] = VALUE_SCLHIGH_SDAHIGH;
-		outBuffer[i++] = DIRECTION_SCLIN_SDAIN; /* Tristate the SCL & SDA pins */
+		if(!I2C_FAST_TRANSFER_IN_BITS(options))
+			*sizeTransferred = next;
+		if(next >= bytesToTransfer)
+			break;
 	}
-
-
-	//--------------------------------------------------------------------------------------------
-	// ############## Write commands #############
-	DBG(MSG_DEBUG,"i=%u bytesToTransfer=%u\n",(unsigned)i,(unsigned)bytesToTransfer);
-	status = FT_Channel_Write(I2C,handle,i,outBuffer,&bytesRead);
-	*sizeTransferred = sizeToTransfer;
+	INFRA_FREE(inBuffer);
 	INFRA_FREE(outBuffer);
 	CHECK_STATUS(status);
 
 
-	//--------------------------------------------------------------------------------------------
-	// ############## Read ACKS #############
-	/* Read ack of address */
-	if(!(options & I2C_TRANSFER_OPTIONS_NO_ADDRESS))
-	{
-		uint8 addAck;
-		status = FT_Channel_Read(I2C, handle, 1, &addAck, &bytesRead);
-		CHECK_STATUS(status);
-	}
-
-	/* Read 1bit ack after each 8bits written */
-	inBuffer = INFRA_MALLOC(bytesToTransfer);
-	if(NULL != inBuffer)
-	{
-		status = FT_Channel_Read(I2C, handle, bytesToTransfer, inBuffer, &bytesRead);
-		if (status == FT_OK && ack)
-		{/* Copy the ack bits into the ack buffer if provided */
-			INFRA_MEMCPY(ack,inBuffer,bytesRead);
-		}
-		INFRA_FREE(inBuffer);
-		CHECK_STATUS(status);
-	}
-
-
 	FN_EXIT;
 	return status;
 }
 
 
+
 /*!
  * \brief This function generates the START, ADDRESS, DATA(read) & STOP phases in the I2C
  *		bus without having delays between these phases
  *
- * This function allocates memory locally, makes MPSSE command frames to read each data
- * byte/bit, makes MPSSE command frames to write the acknowledgement bits, and then writes
- * all these to the MPSSE in one shot. This function is useful where delays between START, DATA
- * and STOP phases are not prefered.
+ * This function makes MPSSE command frames to read each data
+ * byte/bit, makes MPSSE command frames to write the acknowledgement bits, and writes
+ * them to the MPSSE in chunks of I2C_FAST_CHUNK_SIZE bytes. The commands of the next chunk are
+ * queued before the results of the current one are read, so the bus doesn't stall between
+ * chunks and the memory used doesn't depend on the size of the transfer. This function is
+ * useful where delays between START, DATA and STOP phases are not prefered.
  *
  * \param[in] handle Handle of the channel
  * \param[in] deviceAddress Address of the I2C Slave. This parameter is ignored if flag
@@ -1233,7 +1732,8 @@ uint32 sizeToTransfer, uint8 *buffer, uint8 *ack, uint32 *sizeTransferred, uint3
  * \param[in] *buffer Pointer to the buffer to where data is to be read. The user application
  * 			is expected to send a byte array of length sizeToTransfer. However if
  *			I2C_TRANSFER_OPTIONS_FAST_TRANSFER_BITS is set then the length of the byte
- *			array should be sizeToTransfer/8
+ *			array should be (sizeToTransfer+7)/8, the bits are read MSB first and those
+ *			of the last byte are returned in its MSBs
  * \param[out] *ack Reserved (place holder for buffer in which user can provide ack/nAck bits)
  * \param[out] sizeTransferred Pointer to variable containing the number of bytes/bits written
  * \param[in] options This parameter specifies data transfer options. Namely if a start/stop
@@ -1252,219 +1752,229 @@ FT_STATUS I2C_FastRead(FT_HANDLE handle,uint32 deviceAddress,
 uint32 sizeToTransfer, uint8 *buffer, uint8 *ack, uint32 *sizeTransferred, uint32 options)
 {
 	FT_STATUS status=FT_OK;
-	uint32 i=0; /* index of cmdBuffer that is filled */
-	uint32 j=0; /* scratch register */
+	uint32 i; /* index of cmdBuffer that is filled */
 	uint32 sizeTotal;
 	uint8* outBuffer;
 	uint32 bytesRead;
+	uint32 done; /* first byte of the chunk that is read */
+	uint32 next; /* first byte of the chunk after it */
+	uint8 addAck;
 	uint32 bytesToTransfer;
-	uint8 tempAddress;
+	ChannelContext *context;
 
 
 	FN_ENTER;
+	context = I2C_GetChannelContext(handle);
 
 
-	if(!(options & I2C_TRANSFER_OPTIONS_FAST_TRANSFER_BYTES))
+	if(!(options & I2C_TRANSFER_OPTIONS_FAST_TRANSFER))
 	{
-		// Fast read supports I2C_TRANSFER_OPTIONS_FAST_TRANSFER_BYTES only, not I2C_TRANSFER_OPTIONS_FAST_TRANSFER_BITS
 		return FT_INVALID_PARAMETER;
 	}
+	/* Bytes of the buffer that hold the bits, the last one may be partly used */
+	bytesToTransfer = I2C_FAST_TRANSFER_IN_BITS(options)?((sizeToTransfer+7)/8):sizeToTransfer;
 
 
 	//--------------------------------------------------------------------------------------------
 	// ############## Allocate COMMAND buffer #############
-	
-	bytesToTransfer = sizeToTransfer;
-	
-	/* Calculate size of required buffer */
-	sizeTotal = 0 /* for send immediate */
-	+ (bytesToTransfer*(8+6)) /* the size of data itself */
-	+ ((!(options & I2C_TRANSFER_OPTIONS_NO_ADDRESS))?(11):(0)) /* for address byte */
-	+ ((options & I2C_TRANSFER_OPTIONS_START_BIT)?((START_DURATION_1+	\
-			START_DURATION_2+1)*3):0) /* size required for START */
-	+ ((options & I2C_TRANSFER_OPTIONS_STOP_BIT)?((STOP_DURATION_1+		\
-			STOP_DURATION_2+STOP_DURATION_3+1)*3):0); /* size for STOP */
-
-	/* Allocate buffers */
+	/* Largest chunk: START, address, I2C_FAST_CHUNK_SIZE data bytes, STOP & SEND_IMMEDIATE */
+	sizeTotal = (I2C_FAST_CHUNK_SIZE*I2C_AddReadByte(context,NULL,TRUE))
+		+ I2C_AddWriteByte(context,NULL,0) + I2C_AddStart(context,NULL)
+		+ I2C_AddStop(context,NULL) + 1;
 	outBuffer = (uint8*) INFRA_MALLOC(sizeTotal);
 	if(NULL == outBuffer)
 	{
 		return FT_INSUFFICIENT_RESOURCES;
 	}
+	*sizeTransferred = 0;
 
 
 	//--------------------------------------------------------------------------------------------
-	// ############## Write START command #############
-	if(options & I2C_TRANSFER_OPTIONS_START_BIT)
-	{
-		DBG(MSG_DEBUG,"adding START condition\n");
-		/* SCL high, SDA high */
-		for(j=0;j<START_DURATION_1;j++)
-		{
-			outBuffer[i++] = MPSSE_CMD_SET_DATA_BITS_LOWBYTE;
-			outBuffer[i++] = VALUE_SCLHIGH_SDAHIGH;
-			outBuffer[i++] = DIRECTION_SCLOUT_SDAIN;
-		}
-		/* SCL high, SDA low */
-		for(j=0;j<START_DURATION_2;j++)
-		{
-			outBuffer[i++] = MPSSE_CMD_SET_DATA_BITS_LOWBYTE;
-			outBuffer[i++] = VALUE_SCLHIGH_SDALOW;
-			outBuffer[i++] = DIRECTION_SCLOUT_SDAOUT;
-		}
-		/*SCL low, SDA low */
-		outBuffer[i++] = MPSSE_CMD_SET_DATA_BITS_LOWBYTE;
-		outBuffer[i++] = VALUE_SCLLOW_SDALOW;
-		outBuffer[i++] = DIRECTION_SCLOUT_SDAOUT;
-	}
+	// ############## Write commands of the first chunk #############
+	i = I2C_AddFastChunk(context,outBuffer,deviceAddress,NULL,0,sizeToTransfer,options,TRUE);
+	DBG(MSG_DEBUG,"i=%u sizeToTransfer=%u\n",(unsigned)i,(unsigned)sizeToTransfer);
+	status = FT_Channel_Write(I2C,handle,i,outBuffer,&bytesRead);
+	if((FT_OK == status) && (bytesRead != i))
+		status = FT_IO_ERROR;
 
 
 	//--------------------------------------------------------------------------------------------
-	// ############## Write ADDRESS #############
-	if(!(options & I2C_TRANSFER_OPTIONS_NO_ADDRESS))
+	// ############## Read ack of address #############
+	if((FT_OK == status) && !(options & I2C_TRANSFER_OPTIONS_NO_ADDRESS))
 	{
-		tempAddress = (uint8)deviceAddress;
-		tempAddress = (tempAddress << 1);
-		tempAddress = (tempAddress | I2C_ADDRESS_READ_MASK);
-		DBG(MSG_DEBUG,"7bit I2C address plus direction bit = 0x%x\n", tempAddress);
-
-		/*set direction*/
-		outBuffer[i++] = MPSSE_CMD_SET_DATA_BITS_LOWBYTE;
-		outBuffer[i++] = VALUE_SCLLOW_SDALOW;
-		outBuffer[i++] = DIRECTION_SCLOUT_SDAOUT;
-
-		/* write address + direction bit */
-		outBuffer[i++] = MPSSE_CMD_DATA_OUT_BITS_NEG_EDGE;
-		outBuffer[i++] = DATA_SIZE_8BITS;
-		outBuffer[i++] = tempAddress;
-
-		/* Set SDA to input mode before reading ACK bit */
-		outBuffer[i++] = MPSSE_CMD_SET_DATA_BITS_LOWBYTE;
-		outBuffer[i++] = VALUE_SCLLOW_SDALOW;
-		outBuffer[i++] = DIRECTION_SCLOUT_SDAIN;
-
-		/* Command to get ACK bit */
-		outBuffer[i++] = MPSSE_CMD_DATA_IN_BITS_POS_EDGE;
-		outBuffer[i++] = DATA_SIZE_1BIT;
+		status = FT_Channel_Read(I2C, handle, 1, &addAck, &bytesRead);
+		if((FT_OK == status) && (1 != bytesRead))
+			status = FT_IO_ERROR;
 	}
 
 
-	//--------------------------------------------------------------------------------------------
-	// ############## Read ACTUAL DATA #############	
-	for (j=0; j<bytesToTransfer; j++)
+	for(done=0; FT_OK == status; done=next)
 	{
-		/*set direction*/
-		outBuffer[i++] = MPSSE_CMD_SET_DATA_BITS_LOWBYTE;
-		outBuffer[i++] = VALUE_SCLLOW_SDALOW;
-		outBuffer[i++] = DIRECTION_SCLOUT_SDAIN;
-
-		/*Command to read 8 bits*/
-		outBuffer[i++] = MPSSE_CMD_DATA_IN_BITS_POS_EDGE;
-		outBuffer[i++] = DATA_SIZE_8BITS;
+		next = ((bytesToTransfer-done) > I2C_FAST_CHUNK_SIZE)?
+			(done+I2C_FAST_CHUNK_SIZE):bytesToTransfer;
 
-		/*Command MPSSE to send data to PC immediately */
-		if (j < bytesToTransfer - 1)// then ack
+		//----------------------------------------------------------------------------------------
+		// ############## Queue commands of the next chunk #############
+		if(next < bytesToTransfer)
 		{
-			// We will drive the ACK bit to a '0' so pre-set pin to a '0'
-			outBuffer[i++] = MPSSE_CMD_SET_DATA_BITS_LOWBYTE;
-			outBuffer[i++] = VALUE_SCLLOW_SDALOW;
-			outBuffer[i++] = DIRECTION_SCLOUT_SDAOUT;
-
-			// Clock out the ack bit as a '0' on negative edge
-			outBuffer[i++] = MPSSE_CMD_DATA_OUT_BITS_NEG_EDGE;
-			outBuffer[i++] = DATA_SIZE_1BIT;
-			outBuffer[i++] = SEND_ACK;
+			i = I2C_AddFastChunk(context,outBuffer,deviceAddress,NULL,next,sizeToTransfer,
+				options,TRUE);
+			status = FT_Channel_Write(I2C,handle,i,outBuffer,&bytesRead);
+			if((FT_OK == status) && (bytesRead != i))
+				status = FT_IO_ERROR;
+			if(FT_OK != status)
+				break;
+		}
+
+		//----------------------------------------------------------------------------------------
+		// ############## Read ACTUAL DATA #############
+		/* Read the actual data from the MPSSE-chip into the host system */
+		status = FT_Channel_Read(I2C, handle, next-done, &buffer[done], &bytesRead);
+		if(FT_OK != status)
+			break;
+		if(bytesRead != (next-done))
+		{/* the rest of the data may still arrive, the channel has to be purged */
+			DBG(MSG_ERR,"Requested to read %u bytes, no. of bytes read is %u\n",
+				(unsigned)(next-done),(unsigned)bytesRead);
+			*sizeTransferred = done+bytesRead;
+			if(I2C_FAST_TRANSFER_IN_BITS(options))
+				*sizeTransferred *= 8;
+			status = FT_IO_ERROR;
+			break;
 		}
-		else// otherwise nack last byte
+		*sizeTransferred = next;
+		if(I2C_FAST_TRANSFER_IN_BITS(options))
 		{
-			// We will release the ACK bit to a '1' so pre-set pin to a '1' by making it an input
-			outBuffer[i++] = MPSSE_CMD_SET_DATA_BITS_LOWBYTE;
-			outBuffer[i++] = VALUE_SCLLOW_SDALOW;
-			outBuffer[i++] = DIRECTION_SCLOUT_SDAIN;
-
-			// Clock out the ack bit as a '1' on negative edge - never actually seen on line since SDA is input but burns off one bit time
-			outBuffer[i++] = MPSSE_CMD_DATA_OUT_BITS_NEG_EDGE;
-			outBuffer[i++] = DATA_SIZE_1BIT;
-			outBuffer[i++] = SEND_NACK;
+			*sizeTransferred = (next < bytesToTransfer)?(next*8):sizeToTransfer;
+			if((next == bytesToTransfer) && (sizeToTransfer % 8))
+			{/* the MPSSE shifts the bits in from the LSB, they are returned in the MSBs */
+				buffer[next-1] = (uint8)(buffer[next-1] << (8 - (sizeToTransfer % 8)));
+			}
 		}
-
-		/*Back to Idle*/
-		outBuffer[i++] = MPSSE_CMD_SET_DATA_BITS_LOWBYTE;
-		outBuffer[i++] = VALUE_SCLLOW_SDALOW;
-		outBuffer[i++] = DIRECTION_SCLOUT_SDAIN;
+		if(next >= bytesToTransfer)
+			break;
 	}
+	INFRA_FREE(outBuffer);
+	CHECK_STATUS(status);
 
 
-	//--------------------------------------------------------------------------------------------
-	// ############## Write STOP command #############
-	if(options & I2C_TRANSFER_OPTIONS_STOP_BIT)
+	FN_EXIT;
+	return status;
+}
+
+/*!
+ * \brief Adds the commands of one chunk of a fast transfer to a buffer
+ *
+ * The first chunk starts with the START condition and the address, the last one ends with the
+ * STOP condition(if the options ask for them). Every chunk ends with SEND_IMMEDIATE so that its
+ * results can be read while the next chunk is being processed. When the size is in bits the data
+ * is clocked with one byte command, and the bits of the last partly used byte with a bit
+ * command, without ack bits.
+ *
+ * \param[in] context Pointer to the channel's context
+ * \param[out] buffer Buffer to which the commands are added
+ * \param[in] deviceAddress Address of the I2C slave
+ * \param[in] data Data to be written, ignored if read is set
+ * \param[in] first Index of the first data byte of the chunk
+ * \param[in] sizeToTransfer Number of bytes(or bits) of the whole transfer
+ * \param[in] options Transfer options
+ * \param[in] read Set if data is read, otherwise it is written
+ * \return Number of bytes added to the buffer
+ * \sa I2C_FastWrite, I2C_FastRead, I2C_FAST_CHUNK_SIZE
+ * \note
+ * \warning
+ */
+uint32 I2C_AddFastChunk(const ChannelContext *context, uint8 *buffer, uint32 deviceAddress,
+	uint8 *data, uint32 first, uint32 sizeToTransfer, uint32 options, bool read)
+{
+	uint32 i=0;
+	uint32 j;
+	uint32 last;
+	uint32 total;
+	uint32 tailBits=0;
+
+	total = I2C_FAST_TRANSFER_IN_BITS(options)?((sizeToTransfer+7)/8):sizeToTransfer;
+	last = ((total-first) > I2C_FAST_CHUNK_SIZE)?(first+I2C_FAST_CHUNK_SIZE):total;
+	if(0 == first)
 	{
-		/* SCL low, SDA low */
-		for(j=0;j<STOP_DURATION_1;j++)
+		if(options & I2C_TRANSFER_OPTIONS_START_BIT)
 		{
-			outBuffer[i++] = MPSSE_CMD_SET_DATA_BITS_LOWBYTE;
-			outBuffer[i++] = VALUE_SCLLOW_SDALOW;
-			outBuffer[i++] = DIRECTION_SCLOUT_SDAOUT;
+			DBG(MSG_DEBUG,"adding START condition\n");
+			i += I2C_AddStart(context,&buffer[i]);
+		}
+		if(!(options & I2C_TRANSFER_OPTIONS_NO_ADDRESS))
+		{/* write address + direction bit & get ACK bit */
+			i += I2C_AddWriteByte(context,&buffer[i],(uint8)(((uint8)deviceAddress << 1) |
+				(read?I2C_ADDRESS_READ_MASK:0)));
+		}
+	}
+	if(I2C_FAST_TRANSFER_IN_BITS(options))
+	{
+		if((last == total) && (sizeToTransfer % 8))
+		{/* the last byte is partly used */
+			tailBits = sizeToTransfer % 8;
+			last--;
 		}
-		/* SCL high, SDA low */
-		for(j=0;j<STOP_DURATION_2;j++)
+		/* SDA is released for reading */
+		buffer[i++] = MPSSE_CMD_SET_DATA_BITS_LOWBYTE;
+		buffer[i++] = read?VALUE_SCLLOW_SDAHIGH:VALUE_SCLLOW_SDALOW;
+		buffer[i++] = (read && !I2C_DRIVES_ONLY_ZERO(context))?
+			DIRECTION_SCLOUT_SDAIN:DIRECTION_SCLOUT_SDAOUT;
+		if(last > first)
 		{
-			outBuffer[i++] = MPSSE_CMD_SET_DATA_BITS_LOWBYTE;
-			outBuffer[i++] = VALUE_SCLHIGH_SDALOW;
-			outBuffer[i++] = DIRECTION_SCLOUT_SDAOUT;
+			buffer[i++] = read?MPSSE_CMD_DATA_IN_BYTES_POS_EDGE:
+				MPSSE_CMD_DATA_OUT_BYTES_NEG_EDGE;
+			buffer[i++] = (uint8)((last-first-1) & 0xFF);
+			buffer[i++] = (uint8)(((last-first-1)>>8) & 0xFF);
+			if(!read)
+			{
+				INFRA_MEMCPY(&buffer[i],&data[first],last-first);
+				i += last-first;
+			}
 		}
-		/* SCL high, SDA high */
-		for(j=0;j<STOP_DURATION_3;j++)
+		if(tailBits > 0)
 		{
-			outBuffer[i++] = MPSSE_CMD_SET_DATA_BITS_LOWBYTE;
-			outBuffer[i++] = VALUE_SCLHIGH_SDAHIGH;
-			outBuffer[i++] = DIRECTION_SCLOUT_SDAIN;
+			buffer[i++] = read?MPSSE_CMD_DATA_IN_BITS_POS_EDGE:
+				MPSSE_CMD_DATA_OUT_BITS_NEG_EDGE;
+			buffer[i++] = (uint8)(tailBits-1);
+			if(!read)
+				buffer[i++] = data[last];
+			last++;
 		}
-		outBuffer[i++] = MPSSE_CMD_SET_DATA_BITS_LOWBYTE;
-		outBuffer[i++] = VALUE_SCLHIGH_SDAHIGH;
-		outBuffer[i++] = DIRECTION_SCLIN_SDAIN; /* Tristate the SCL & SDA pins */
 	}
-
-
-	//--------------------------------------------------------------------------------------------
-	// ############## Write commands #############
-	DBG(MSG_DEBUG,"i=%u bytesToTransfer=%u\n",(unsigned)i,(unsigned)bytesToTransfer);
-	status = FT_Channel_Write(I2C,handle,i,outBuffer,&bytesRead);
-	*sizeTransferred = sizeToTransfer;
-	INFRA_FREE(outBuffer);
-	CHECK_STATUS(status);
-
-
-	//--------------------------------------------------------------------------------------------
-	// ############## Read ACKS #############
-	/* Read ack of address */
-	if(!(options & I2C_TRANSFER_OPTIONS_NO_ADDRESS))
+	else
 	{
-		uint8 addAck;
-		status = FT_Channel_Read(I2C, handle, 1, &addAck, &bytesRead);
-		CHECK_STATUS(status);
+		for(j=first; j<last; j++)
+		{
+			if(read)
+			{/* ack every byte but the last one */
+				i += I2C_AddReadByte(context,&buffer[i],(j < (total-1))?TRUE:FALSE);
+			}
+			else
+			{
+				i += I2C_AddWriteByte(context,&buffer[i],data[j]);
+			}
+		}
 	}
-
-
-	//--------------------------------------------------------------------------------------------
-	// ############## Read ACTUAL DATA #############
-	/* Read the actual data from the MPSSE-chip into the host system */
-	status = FT_Channel_Read(I2C, handle, bytesToTransfer, buffer, &bytesRead);
-	CHECK_STATUS(status);
-
-
-	FN_EXIT;
-	return status;
+	if((last == total) && (options & I2C_TRANSFER_OPTIONS_STOP_BIT))
+	{
+		i += I2C_AddStop(context,&buffer[i]);
+	}
+	/* Command MPSSE to send data to PC immediately */
+	buffer[i++] = MPSSE_CMD_SEND_IMMEDIATE;
+	return i;
 }
 
 
 
+
 /*!
  * \brief Write I2C device address
  *
  * This function writes the direction and address bits to the I2C bus, and then gets the ACK
  *
  * \param[in] handle Handle of the channel
+ * \param[in] context Pointer to the channel's context
  * \param[in] deviceAddress Address of the I2C device
  * \param[in] direction 0=Write; 1=Read
  * \param[in] AddLen10Bit Setting this bit specifies 10bit addressing, otherwise 7bit
@@ -1473,8 +1983,8 @@ uint32 sizeToTransfer, uint8 *buffer, uint8 *ack, uint32 *sizeTransferred, uint3
  * \note
  * \warning
  */
-FT_STATUS I2C_WriteDeviceAddress(FT_HANDLE handle, uint32 deviceAddress,
-			bool direction, bool AddLen10Bit, bool *ack)
+FT_STATUS I2C_WriteDeviceAddress(FT_HANDLE handle, const ChannelContext *context,
+			uint32 deviceAddress, bool direction, bool AddLen10Bit, bool *ack)
 {
 	FT_STATUS status=FT_OTHER_ERROR;
 	uint8 tempAddress;
@@ -1490,7 +2000,7 @@ FT_STATUS I2C_WriteDeviceAddress(FT_HANDLE handle, uint32 deviceAddress,
 			tempAddress = (tempAddress & I2C_ADDRESS_WRITE_MASK);
 		DBG(MSG_DEBUG,"7bit I2C address plus direction bit = 0x%x\n",\
 			tempAddress);
-		status = I2C_Write8bitsAndGetAck(handle,tempAddress,ack);
+		status = I2C_Write8bitsAndGetAck(handle,context,tempAddress,ack);
 		if(FT_OK != status)
 			Infra_DbgPrintStatus(status);
 		if((*ack))
@@ -1508,24 +2018,131 @@ FT_STATUS I2C_WriteDeviceAddress(FT_HANDLE handle, uint32 deviceAddress,
 	return status;
 }
 
+/*!
+ * \brief Allocates storage for the channel's context
+ *
+ * This function adds a node for the channel to the linked list of channel contexts, or reuses
+ * the node of a closed channel. Nothing is done if the channel already has a node
+ *
+ * \param[in] handle Handle of the channel
+ * \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide)
+ * \sa I2C_DelChannelConfig
+ * \note
+ * \warning
+ */
+FT_STATUS I2C_AddChannelConfig(FT_HANDLE handle)
+{
+	FT_STATUS status=FT_OK;
+	ChannelContext *tempNode=NULL;
+	ChannelContext *freeNode=NULL;
+	ChannelContext *defaultContext;
+	FN_ENTER;
+	DBG(MSG_DEBUG,"handle=0x%x\n",(unsigned)handle);
+
+	defaultContext = I2C_GetDefaultContext();
+	Infra_Lock();
+	for(tempNode=I2C_ListHead; NULL != tempNode; tempNode=tempNode->next)
+	{
+		if(tempNode->handle == handle)
+		{/* Channel is being reinitialized */
+			Infra_Unlock();
+			FN_EXIT;
+			return status;
+		}
+		if((NULL == tempNode->handle) && (NULL == freeNode))
+			freeNode = tempNode;
+	}
+	if(NULL != freeNode)
+	{/* the node is filled in before it can be found by its handle. Its link is left alone, the
+		list may be walked meanwhile */
+		INFRA_MEMCPY(&freeNode->config,&defaultContext->config,
+			offsetof(ChannelContext,next) - offsetof(ChannelContext,config));
+		INFRA_STORE_POINTER(&freeNode->handle,handle);
+	}
+	else
+	{
+		tempNode = (ChannelContext *) INFRA_MALLOC(sizeof(ChannelContext));
+		if(NULL == tempNode)
+		{
+			status = FT_INSUFFICIENT_RESOURCES;
+			DBG(MSG_ERR,"Failed allocating memory\n");
+		}
+		else
+		{
+			INFRA_MEMCPY(tempNode,defaultContext,sizeof(ChannelContext));
+			tempNode->handle = handle;
+			tempNode->next = I2C_ListHead;
+			INFRA_STORE_POINTER(&I2C_ListHead,tempNode);
+		}
+	}
+	Infra_Unlock();
+	FN_EXIT;
+	return status;
+}
+
+/*!
+ * \brief Releases the channel's context
+ *
+ * This function traverses the linked list of channel contexts, finds the channel with the given
+ * handle and then releases its node
+ *
+ * \param[in] handle Handle of the channel
+ * \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide)
+ * \sa I2C_AddChannelConfig
+ * \note The node is kept for the next channel that is initialized
+ * \warning
+ */
+FT_STATUS I2C_DelChannelConfig(FT_HANDLE handle)
+{
+	FT_STATUS status=FT_OK;
+	ChannelContext *tempNode;
+	FN_ENTER;
+
+	if(NULL == handle)
+		return status;
+	Infra_Lock();
+	for(tempNode=I2C_ListHead; NULL != tempNode; tempNode=tempNode->next)
+	{
+		if(tempNode->handle == handle)
+		{/*Node found*/
+			INFRA_STORE_POINTER(&tempNode->handle,NULL);
+			break;
+		}
+	}
+	Infra_Unlock();
+	FN_EXIT;
+	return status;
+}
+
 /*!
  * \brief Saves the channel's configuration data
  *
- * This function saves the channel's configuration data
+ * This function saves the channel's configuration data in the channel's context and works out
+ * the bus timings for the configured clock rate
  *
  * \param[in] handle Handle of the channel
  * \param[in] config Pointer to ChannelConfig structure(memory to be allocated by caller)
  * \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide)
- * \sa
+ * \sa I2C_SetTimings
  * \note
  * \warning
  */
 FT_STATUS I2C_SaveChannelConfig(FT_HANDLE handle, ChannelConfig *config)
 {
 	FT_STATUS status=FT_OTHER_ERROR;
+	ChannelContext *tempNode;
 	FN_ENTER;
 
-	status = FT_OK;
+	tempNode = I2C_FindChannelContext(handle);
+	if(NULL != tempNode)
+	{/*Node found*/
+		INFRA_MEMCPY(&(tempNode->config),config,sizeof(ChannelConfig));
+		status = Mid_GetFtDeviceType(handle,&(tempNode->ftDevice));
+		CHECK_STATUS(status);
+		I2C_SetTimings(tempNode);
+		/* FT_InitChannel left the device's buffers empty */
+		tempNode->dirty = FALSE;
+	}
 	FN_EXIT;
 	return status;
 }
@@ -1545,106 +2162,1039 @@ FT_STATUS I2C_SaveChannelConfig(FT_HANDLE handle, ChannelConfig *config)
 FT_STATUS I2C_GetChannelConfig(FT_HANDLE handle, ChannelConfig *config)
 {
 	FT_STATUS status=FT_OTHER_ERROR;
+	ChannelContext *tempNode;
 	FN_ENTER;
 
-	status = FT_OK;
+	tempNode = I2C_FindChannelContext(handle);
+	if(NULL != tempNode)
+	{/*Node found*/
+		INFRA_MEMCPY(config,&(tempNode->config),sizeof(ChannelConfig));
+		status = FT_OK;
+	}
 	FN_EXIT;
 	return status;
 }
 
-
-
 /*!
-* \brief Generates the I2C Start condition
-*
-* This function generates the I2C start condition on the bus.
-*
-* \param[in] handle Handle of the channel
-* \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide)
-* \sa
-* \note
-* \warning
-*/
-FT_STATUS I2C_Start(FT_HANDLE handle)
+ * \brief Finds the channel's context
+ *
+ * This function is called by every transfer, so it doesn't take the lock: it walks the list of
+ * channel contexts, which only grows, with the loads that pair with the stores of
+ * I2C_AddChannelConfig and I2C_DelChannelConfig.
+ *
+ * \param[in] handle Handle of the channel
+ * \return Pointer to the channel's context, NULL if the channel wasn't initialized using
+ *		I2C_InitChannel
+ * \sa I2C_GetChannelContext
+ * \note
+ * \warning
+ */
+ChannelContext *I2C_FindChannelContext(FT_HANDLE handle)
 {
-	FT_STATUS status;
-	uint8 buffer[(START_DURATION_1 + START_DURATION_2 + 1) * 3];
-	uint32 i = 0, j = 0;
-	uint32 noOfBytesTransferred;
-	FN_ENTER;
+	ChannelContext *tempNode;
 
-	/* SCL high, SDA high */
-	for (j = 0; j<START_DURATION_1; j++)
-	{
-		buffer[i++] = MPSSE_CMD_SET_DATA_BITS_LOWBYTE;
-		buffer[i++] = VALUE_SCLHIGH_SDAHIGH;
-		buffer[i++] = DIRECTION_SCLOUT_SDAIN; // Make this input instead to let line be pulled up
-	}
-	/* SCL high, SDA low */
-	for (j = 0; j<START_DURATION_2; j++)
+	if(NULL == handle)
+		return NULL;
+	for(tempNode=(ChannelContext *)INFRA_LOAD_POINTER(&I2C_ListHead); NULL != tempNode;
+		tempNode=tempNode->next)
 	{
-		buffer[i++] = MPSSE_CMD_SET_DATA_BITS_LOWBYTE;
-		buffer[i++] = VALUE_SCLHIGH_SDALOW;
-		buffer[i++] = DIRECTION_SCLOUT_SDAOUT;
+		if((FT_HANDLE)INFRA_LOAD_POINTER(&tempNode->handle) == handle)
+			return tempNode;
 	}
-	/*SCL low, SDA low */
-	buffer[i++] = MPSSE_CMD_SET_DATA_BITS_LOWBYTE;
-	buffer[i++] = VALUE_SCLLOW_SDALOW;
-	buffer[i++] = DIRECTION_SCLOUT_SDAOUT;
+	return NULL;
+}
 
-	status = FT_Channel_Write(I2C, handle, i, buffer, &noOfBytesTransferred);
+/*!
+ * \brief Retrieves the channel's context
+ *
+ * The public functions call this function once and pass the context on to the functions that
+ * generate the bus conditions and the bytes
+ *
+ * \param[in] handle Handle of the channel
+ * \return Pointer to the channel's context. A context holding standard mode timings is returned
+ *		if the channel wasn't initialized using I2C_InitChannel
+ * \sa I2C_FindChannelContext
+ * \note
+ * \warning
+ */
+ChannelContext *I2C_GetChannelContext(FT_HANDLE handle)
+{
+	ChannelContext *tempNode;
 
-	FN_EXIT;
-	return status;
+	tempNode = I2C_FindChannelContext(handle);
+	if(NULL != tempNode)
+		return tempNode;
+	DBG(MSG_NOTICE,"handle 0x%x has no context, using default timings\n",(unsigned)handle);
+	return I2C_GetDefaultContext();
 }
 
 /*!
-* \brief Generates the I2C Stop condition
-*
-* This function generates the I2C stop condition on the bus.
-*
-* \param[in] handle Handle of the channel
-* \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide)
-* \sa
-* \note
-* \warning
-*/
-FT_STATUS I2C_Stop(FT_HANDLE handle)
+ * \brief Returns the context used for channels that were not initialized
+ *
+ * The default context is for a standard mode bus without 3-phase clocking, on a chip of unknown
+ * type so that the bus conditions are made of SET_DATA_BITS commands only. It is filled in by
+ * the first call, with the lock taken, and published with INFRA_STORE_POINTER so that the later
+ * calls don't take the lock.
+ *
+ * \param none
+ * \return Pointer to the default context
+ * \sa I2C_GetChannelContext
+ * \note
+ * \warning Not to be called with the lock taken(Infra_Lock)
+ */
+ChannelContext *I2C_GetDefaultContext(void)
 {
-	FT_STATUS status;
-	uint8 buffer[(STOP_DURATION_1 + STOP_DURATION_2 + STOP_DURATION_3 + 1) * 3];
-	uint32 i = 0, j = 0;
-	uint32 noOfBytesTransferred;
+	ChannelContext *context;
 
-	FN_ENTER;
-	/* SCL low, SDA low */
-	for (j = 0; j<STOP_DURATION_1; j++)
+	context = (ChannelContext *)INFRA_LOAD_POINTER(&I2C_DefaultReady);
+	if(NULL != context)
+		return context;
+	Infra_Lock();
+	if(NULL == I2C_DefaultReady)
 	{
-		buffer[i++] = MPSSE_CMD_SET_DATA_BITS_LOWBYTE;
-		buffer[i++] = VALUE_SCLLOW_SDALOW;
-		buffer[i++] = DIRECTION_SCLOUT_SDAOUT;
+		I2C_DefaultContext.config.ClockRate = I2C_CLOCK_STANDARD_MODE;
+		I2C_DefaultContext.config.Options = I2C_DISABLE_3PHASE_CLOCKING;
+		I2C_DefaultContext.ftDevice = FT_DEVICE_UNKNOWN;
+		I2C_SetTimings(&I2C_DefaultContext);
+		INFRA_STORE_POINTER(&I2C_DefaultReady,&I2C_DefaultContext);
 	}
-	/* SCL high, SDA low */
-	for (j = 0; j<STOP_DURATION_2; j++)
-	{
-		buffer[i++] = MPSSE_CMD_SET_DATA_BITS_LOWBYTE;
-		buffer[i++] = VALUE_SCLHIGH_SDALOW;
-		buffer[i++] = DIRECTION_SCLOUT_SDAOUT;
+	Infra_Unlock();
+	return &I2C_DefaultContext;
+}
+
+/*!
+ * \brief Works out the clock rate I2C_InitChannel sets
+ *
+ * \param[in] config Pointer to the channel's configuration
+ * \return Clock rate to be passed to FT_InitChannel
+ * \sa I2C_GetMpsseClock
+ * \note The bus is in fast mode between high speed mode transfers
+ * \warning
+ */
+uint32 I2C_GetInitClock(const ChannelConfig *config)
+{
+	uint32 clockRate;
+
+	clockRate = (uint32)config->ClockRate;
+	if(clockRate > I2C_CLOCK_FAST_MODE_PLUS)
+		clockRate = I2C_CLOCK_FAST_MODE;
+	if(!(config->Options & I2C_DISABLE_3PHASE_CLOCKING))
+	{/* Adjust clock rate if 3phase clocking should be enabled */
+		clockRate = (clockRate * 3)/2;
 	}
-	/* SCL high, SDA high */
-	for (j = 0; j<STOP_DURATION_3; j++)
+	return clockRate;
+}
+
+/*!
+ * \brief Restores the state I2C_InitChannel left the channel in
+ *
+ * \param[in] handle Handle of the channel
+ * \param[in] context Pointer to the channel's context
+ * \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide)
+ * \sa I2C_RecoverChannel, FT_RecoverChannel
+ * \note The channel is marked clean if the recovery succeeded
+ * \warning
+ */
+FT_STATUS I2C_Recover(FT_HANDLE handle, ChannelContext *context)
+{
+	FT_STATUS status;
+	uint8 buffer[10];
+	uint32 i=0;
+
+	if(!(context->config.Options & I2C_DISABLE_3PHASE_CLOCKING))
+		buffer[i++] = MPSSE_CMD_ENABLE_3PHASE_CLOCKING;
+	if(context->config.Options & I2C_ENABLE_CLOCK_STRETCHING)
+		buffer[i++] = MPSSE_CMD_ENABLE_ADAPTIVE_CLOCKING;
+	if(I2C_DRIVES_ONLY_ZERO(context))
 	{
-		buffer[i++] = MPSSE_CMD_SET_DATA_BITS_LOWBYTE;
-		buffer[i++] = VALUE_SCLHIGH_SDAHIGH;
-		buffer[i++] = DIRECTION_SCLOUT_SDAIN; // Make this input instead to let line be pulled up
+		buffer[i++] = MPSSE_CMD_ENABLE_DRIVE_ONLY_ZERO;
+		buffer[i++] = 0x03; /* LowByte */
+		buffer[i++] = 0x00; /* HighByte */
 	}
+	/* Idle bus, SCL & SDA tristated */
 	buffer[i++] = MPSSE_CMD_SET_DATA_BITS_LOWBYTE;
 	buffer[i++] = VALUE_SCLHIGH_SDAHIGH;
-	buffer[i++] = DIRECTION_SCLIN_SDAIN; /* Tristate the SCL & SDA pins */
+	buffer[i++] = DIRECTION_SCLIN_SDAIN;
+	status = FT_RecoverChannel(handle,I2C_GetInitClock(&context->config),buffer,i);
+	if(FT_OK == status)
+		context->dirty = FALSE;
+	else
+		DBG(MSG_ERR,"recovering handle 0x%x failed, status 0x%x\n",(unsigned)handle,
+			(unsigned)status);
+	return status;
+}
 
-	status = FT_Channel_Write(I2C, handle, i, buffer, &noOfBytesTransferred);
+/*!
+ * \brief Works out the bus timings and the command sequences for the channel's clock rate
+ *
+ * This function picks the I2C mode that matches the channel's clock rate, works out how the bus
+ * conditions are to be held and then generates the command sequences used by the transfers.
+ *
+ * \param[in] context Pointer to the channel's context, with config and ftDevice filled in
+ * \return none
+ * \sa I2C_SetHolds, I2C_MakeSequences
+ * \note
+ * \warning
+ */
+void I2C_SetTimings(ChannelContext *context)
+{
+	uint32 sclRate;
+
+	sclRate = (uint32)context->config.ClockRate;
+	if(0 == sclRate)
+		sclRate = I2C_CLOCK_STANDARD_MODE;
+
+	if(sclRate <= I2C_CLOCK_STANDARD_MODE)
+		context->mode = I2C_STANDARD_MODE;
+	else if(sclRate <= I2C_CLOCK_FAST_MODE)
+		context->mode = I2C_FAST_MODE;
+	else if(sclRate <= I2C_CLOCK_FAST_MODE_PLUS)
+		context->mode = I2C_FAST_MODE_PLUS;
+	else
+		context->mode = I2C_HIGH_SPEED_MODE;
 
-	FN_EXIT;
-	return status;
+	context->mpsseClock = I2C_GetMpsseClock(context,sclRate);
+	I2C_SetHolds(context,context->mpsseClock);
+	I2C_MakeSequences(context);
 }
 
+/*!
+ * \brief Works out the base clock and divisor of the MPSSE clock for a SCL rate
+ *
+ * The clock is set 1.5 times faster than SCL when 3-phase clocking is enabled. The divisor is
+ * worked out by Mid_GetClockDivisor, as for the clock FT_InitChannel sets.
+ *
+ * \param[in] context Pointer to the channel's context
+ * \param[in] sclRate SCL frequency in Hz
+ * \param[out] base Base clock in Hz, MID_6MHZ(divide by 5 enabled) or MID_30MHZ
+ * \return Value of the divisor passed to the SET_CLOCK_FREQUENCY command
+ * \sa I2C_GetMpsseClock, I2C_AddClock
+ * \note
+ * \warning
+ */
+uint32 I2C_GetClockDivisor(const ChannelContext *context, uint32 sclRate, uint32 *base)
+{
+	uint32 mpsseClock;
+
+	mpsseClock = sclRate;
+	if(!(context->config.Options & I2C_DISABLE_3PHASE_CLOCKING))
+		mpsseClock = (sclRate * 3)/2;
+	return Mid_GetClockDivisor(context->ftDevice,mpsseClock,base);
+}
+
+/*!
+ * \brief Works out the frequency of the MPSSE clock for a SCL rate
+ *
+ * \param[in] context Pointer to the channel's context
+ * \param[in] sclRate SCL frequency in Hz
+ * \return Frequency of the MPSSE clock in Hz, as set by I2C_AddClock
+ * \sa I2C_GetClockDivisor
+ * \note
+ * \warning
+ */
+uint32 I2C_GetMpsseClock(const ChannelContext *context, uint32 sclRate)
+{
+	uint32 base;
+	uint32 value;
+
+	value = I2C_GetClockDivisor(context,sclRate,&base);
+	return base/(value + 1);
+}
+
+/*!
+ * \brief Adds the commands that change the SCL rate to a buffer
+ *
+ * \param[in] context Pointer to the channel's context
+ * \param[out] buffer Buffer to which the commands are added
+ * \param[in] sclRate SCL frequency in Hz
+ * \return Number of bytes added to the buffer
+ * \sa Mid_SetClock, I2C_GetClockDivisor
+ * \note The divide by 5 commands are left out for FT2232D, which doesn't support them
+ * \warning
+ */
+uint32 I2C_AddClock(const ChannelContext *context, uint8 *buffer, uint32 sclRate)
+{
+	uint32 i=0;
+	uint32 base;
+	uint32 value;
+
+	value = I2C_GetClockDivisor(context,sclRate,&base);
+	if(FT_DEVICE_2232C != context->ftDevice)
+		buffer[i++] = (MID_30MHZ == base)?DISABLE_CLOCK_DIVIDE:ENABLE_CLOCK_DIVIDE;
+	buffer[i++] = MID_SET_CLOCK_FREQUENCY_CMD;
+	buffer[i++] = (uint8)(value & 0xFF);
+	buffer[i++] = (uint8)((value>>8) & 0xFF);
+	return i;
+}
+
+/*!
+ * \brief Works out how the bus conditions are to be held
+ *
+ * This function converts the minimum times of the row of I2C_Timings of the channel's mode into
+ * commands. On hi-speed chips a condition in which SCL is high is held using the clock-only
+ * command with SCL tristated, which takes a known number of bit periods. Otherwise(and for the
+ * conditions in which SCL is low) SET_DATA_BITS commands are repeated.
+ *
+ * Clock-only delays aren't used when clock stretching is enabled, as the MPSSE would wait for
+ * the tristated SCL to follow the clock.
+ *
+ * \param[in] context Pointer to the channel's context, with the mode filled in
+ * \param[in] mpsseClock Frequency of the MPSSE clock while the conditions are generated
+ * \return none
+ * \sa I2C_Timings
+ * \note SCL is expected to be pulled up while it is tristated
+ * \warning
+ */
+void I2C_SetHolds(ChannelContext *context, uint32 mpsseClock)
+{
+	uint32 cmdNs;
+	uint64 ns;
+	uint64 count;
+	bool clockOnly;
+	int c;
+
+	clockOnly = ((FT_DEVICE_2232H == context->ftDevice) ||
+		(FT_DEVICE_4232H == context->ftDevice) || (FT_DEVICE_232H == context->ftDevice));
+	cmdNs = clockOnly?I2C_SET_DATA_BITS_NS_HISPEED:I2C_SET_DATA_BITS_NS_FULLSPEED;
+	if(context->config.Options & I2C_ENABLE_CLOCK_STRETCHING)
+		clockOnly = FALSE;
+
+	for(c=0; c<I2C_MAXIMUM_SUPPORTED_CONDITIONS; c++)
+	{
+		ns = I2C_Timings[context->mode][c];
+		if(clockOnly && (I2C_CONDITION_POSTSTART != c) && (I2C_CONDITION_PRESTOP != c))
+		{/* a bit period is never shorter than one cycle of the MPSSE clock */
+			context->holdCommands[c] = 1;
+			count = ((ns * mpsseClock) + 999999999ULL)/1000000000ULL;
+			if(count > (0x10000*8))
+				count = 0x10000*8;
+			context->holdBits[c] = (uint32)count;
+		}
+		else
+		{
+			count = (ns + cmdNs - 1)/cmdNs;
+			if(count < 1)
+				count = 1;
+			if(count > I2C_MAX_HOLD_COMMANDS)
+				count = I2C_MAX_HOLD_COMMANDS;
+			context->holdCommands[c] = (uint16)count;
+			context->holdBits[c] = 0;
+		}
+		DBG(MSG_DEBUG,"condition %d: %u ns, %u commands, %u clock-only bits\n",c,
+			(unsigned)ns,(unsigned)context->holdCommands[c],(unsigned)context->holdBits[c]);
+	}
+}
+
+/*!
+ * \brief Generates the command sequences of the channel
+ *
+ * This function generates the START, STOP and RESTART sequences and the sequences that write
+ * and read a byte, and stores them in the channel's context. Transfers copy them from there
+ * instead of generating the commands each time.
+ *
+ * In high speed mode START is generated with fast mode timings and is followed by the master
+ * code, the switch to the high speed clock and a repeated START. STOP switches back to the fast
+ * mode clock, so the bus is in fast mode between transfers.
+ *
+ * \param[in] context Pointer to the channel's context, with the bus timings worked out
+ * \return none
+ * \sa I2C_SetTimings
+ * \note
+ * \warning
+ */
+void I2C_MakeSequences(ChannelContext *context)
+{
+	uint32 i;
+
+	if(I2C_HIGH_SPEED_MODE == context->mode)
+	{
+		context->mode = I2C_FAST_MODE;
+		I2C_SetHolds(context,I2C_GetMpsseClock(context,I2C_CLOCK_FAST_MODE));
+		i = I2C_MakeStart(context,context->start);
+		i += I2C_MakeMasterCode(context,&context->start[i]);
+		context->mode = I2C_HIGH_SPEED_MODE;
+		I2C_SetHolds(context,context->mpsseClock);
+		i += I2C_AddClock(context,&context->start[i],(uint32)context->config.ClockRate);
+		i += I2C_MakeRestart(context,&context->start[i]);
+		context->startLen = i;
+		i = I2C_MakeStop(context,context->stop);
+		i += I2C_AddClock(context,&context->stop[i],I2C_CLOCK_FAST_MODE);
+		context->stopLen = i;
+	}
+	else
+	{
+		context->startLen = I2C_MakeStart(context,context->start);
+		context->stopLen = I2C_MakeStop(context,context->stop);
+	}
+	context->restartLen = I2C_MakeRestart(context,context->restart);
+	context->writeByteLen = I2C_MakeWriteByte(context,context->writeByte,
+		&(context->writeByteData));
+	context->readByteLen = I2C_MakeReadByte(context,context->readByteAck,TRUE);
+	I2C_MakeReadByte(context,context->readByteNack,FALSE);
+	DBG(MSG_DEBUG,"START %u bytes, STOP %u bytes, RESTART %u bytes\n",
+		(unsigned)context->startLen,(unsigned)context->stopLen,(unsigned)context->restartLen);
+}
+
+/*!
+ * \brief Adds the commands that put the bus in a condition and hold it there
+ *
+ * This function adds SET_DATA_BITS commands and, if the context says so, a clock-only delay to
+ * a buffer. SCL is tristated instead of driven while the clock-only delay runs.
+ *
+ * \param[in] context Pointer to the channel's context
+ * \param[out] buffer Buffer to which the commands are added, NULL to only get the length
+ * \param[in] condition The condition whose timing is to be used
+ * \param[in] value Value of SCL & SDA
+ * \param[in] direction Direction of SCL & SDA
+ * \return Number of bytes added to the buffer
+ * \sa I2C_SetTimings
+ * \note
+ * \warning
+ */
+uint32 I2C_AddCondition(const ChannelContext *context, uint8 *buffer,
+	I2C_Bus_Condition condition, uint8 value, uint8 direction)
+{
+	uint32 i=0;
+	uint32 j;
+	uint32 bits = context->holdBits[condition];
+
+	if(bits > 0)
+		direction &= (uint8)~I2C_DIRECTION_SCL_MASK;
+	for(j=0; j<context->holdCommands[condition]; j++)
+	{
+		if(NULL != buffer)
+		{
+			buffer[i] = MPSSE_CMD_SET_DATA_BITS_LOWBYTE;
+			buffer[i+1] = value;
+			buffer[i+2] = direction;
+		}
+		i += 3;
+	}
+	if((bits > 0) && (bits <= 8))
+	{
+		if(NULL != buffer)
+		{
+			buffer[i] = MPSSE_CMD_CLOCK_N_BITS;
+			buffer[i+1] = (uint8)(bits-1);
+		}
+		i += 2;
+	}
+	else if(bits > 8)
+	{
+		bits = ((bits+7)/8)-1;
+		if(NULL != buffer)
+		{
+			buffer[i] = MPSSE_CMD_CLOCK_N_BYTES;
+			buffer[i+1] = (uint8)(bits & 0xFF);
+			buffer[i+2] = (uint8)((bits>>8) & 0xFF);
+		}
+		i += 3;
+	}
+	return i;
+}
+
+/*!
+ * \brief Generates the START condition
+ *
+ * SCL high, SDA high -> SCL high, SDA low -> SCL low, SDA low
+ *
+ * \param[in] context Pointer to the channel's context
+ * \param[out] buffer Buffer to which the commands are added, NULL to only get the length
+ * \return Number of bytes added to the buffer
+ * \sa I2C_AddStart
+ * \note
+ * \warning
+ */
+uint32 I2C_MakeStart(const ChannelContext *context, uint8 *buffer)
+{
+	uint32 i=0;
+	i += I2C_AddCondition(context,buffer,I2C_CONDITION_PRESTART,
+		VALUE_SCLHIGH_SDAHIGH,DIRECTION_SCLOUT_SDAIN);
+	i += I2C_AddCondition(context,(NULL==buffer)?NULL:&buffer[i],I2C_CONDITION_START,
+		VALUE_SCLHIGH_SDALOW,DIRECTION_SCLOUT_SDAOUT);
+	i += I2C_AddCondition(context,(NULL==buffer)?NULL:&buffer[i],I2C_CONDITION_POSTSTART,
+		VALUE_SCLLOW_SDALOW,DIRECTION_SCLOUT_SDAOUT);
+	return i;
+}
+
+/*!
+ * \brief Generates the STOP condition
+ *
+ * SCL low, SDA low -> SCL high, SDA low -> SCL high, SDA high -> SCL & SDA tristated
+ *
+ * \param[in] context Pointer to the channel's context
+ * \param[out] buffer Buffer to which the commands are added, NULL to only get the length
+ * \return Number of bytes added to the buffer
+ * \sa I2C_AddStop
+ * \note
+ * \warning
+ */
+uint32 I2C_MakeStop(const ChannelContext *context, uint8 *buffer)
+{
+	uint32 i=0;
+	i += I2C_AddCondition(context,buffer,I2C_CONDITION_PRESTOP,
+		VALUE_SCLLOW_SDALOW,DIRECTION_SCLOUT_SDAOUT);
+	i += I2C_AddCondition(context,(NULL==buffer)?NULL:&buffer[i],I2C_CONDITION_STOP,
+		VALUE_SCLHIGH_SDALOW,DIRECTION_SCLOUT_SDAOUT);
+	i += I2C_AddCondition(context,(NULL==buffer)?NULL:&buffer[i],I2C_CONDITION_POSTSTOP,
+		VALUE_SCLHIGH_SDAHIGH,DIRECTION_SCLOUT_SDAIN);
+	if(NULL != buffer)
+	{/* Tristate the SCL & SDA pins */
+		buffer[i] = MPSSE_CMD_SET_DATA_BITS_LOWBYTE;
+		buffer[i+1] = VALUE_SCLHIGH_SDAHIGH;
+		buffer[i+2] = DIRECTION_SCLIN_SDAIN;
+	}
+	i += 3;
+	return i;
+}
+
+/*!
+ * \brief Generates the repeated START condition
+ *
+ * SCL low, SDA released -> START condition
+ *
+ * \param[in] context Pointer to the channel's context
+ * \param[out] buffer Buffer to which the commands are added, NULL to only get the length
+ * \return Number of bytes added to the buffer
+ * \sa I2C_AddRestart, I2C_MakeStart
+ * \note
+ * \warning
+ */
+uint32 I2C_MakeRestart(const ChannelContext *context, uint8 *buffer)
+{
+	uint32 i=0;
+	i += I2C_AddCondition(context,buffer,I2C_CONDITION_PRESTOP,
+		VALUE_SCLLOW_SDAHIGH,DIRECTION_SCLOUT_SDAIN);
+	i += I2C_MakeStart(context,(NULL==buffer)?NULL:&buffer[i]);
+	return i;
+}
+
+/*!
+ * \brief Adds the START condition to a buffer
+ *
+ * \param[in] context Pointer to the channel's context
+ * \param[out] buffer Buffer to which the commands are added, NULL to only get the length
+ * \return Number of bytes added to the buffer
+ * \sa I2C_MakeStart
+ * \note
+ * \warning
+ */
+uint32 I2C_AddStart(const ChannelContext *context, uint8 *buffer)
+{
+	if(NULL != buffer)
+	{
+		INFRA_MEMCPY(buffer,context->start,context->startLen);
+	}
+	return context->startLen;
+}
+
+/*!
+ * \brief Adds the STOP condition to a buffer
+ *
+ * \param[in] context Pointer to the channel's context
+ * \param[out] buffer Buffer to which the commands are added, NULL to only get the length
+ * \return Number of bytes added to the buffer
+ * \sa I2C_MakeStop
+ * \note
+ * \warning
+ */
+uint32 I2C_AddStop(const ChannelContext *context, uint8 *buffer)
+{
+	if(NULL != buffer)
+	{
+		INFRA_MEMCPY(buffer,context->stop,context->stopLen);
+	}
+	return context->stopLen;
+}
+
+/*!
+ * \brief Adds the repeated START condition to a buffer
+ *
+ * \param[in] context Pointer to the channel's context
+ * \param[out] buffer Buffer to which the commands are added, NULL to only get the length
+ * \return Number of bytes added to the buffer
+ * \sa I2C_MakeRestart
+ * \note
+ * \warning
+ */
+uint32 I2C_AddRestart(const ChannelContext *context, uint8 *buffer)
+{
+	if(NULL != buffer)
+	{
+		INFRA_MEMCPY(buffer,context->restart,context->restartLen);
+	}
+	return context->restartLen;
+}
+
+/*!
+ * \brief Prepares the channel for a transfer
+ *
+ * A channel that a previous transfer left in an unknown state is recovered(see
+ * I2C_RecoverChannel), otherwise the device's buffers are purged only if the caller asks for it.
+ * The channel is then marked dirty until I2C_EndTransfer finds that the transfer completed.
+ *
+ * \param[in] handle Handle of the channel
+ * \param[in] context Pointer to the channel's context
+ * \param[in] options Transfer options, I2C_TRANSFER_OPTIONS_PURGE forces a purge
+ * \return none
+ * \sa I2C_EndTransfer
+ * \note Channels without a context(not initialized) are always purged
+ * \warning
+ */
+void I2C_BeginTransfer(FT_HANDLE handle, ChannelContext *context, uint32 options)
+{
+	if(context->dirty && (&I2C_DefaultContext != context))
+	{
+		I2C_Recover(handle,context);
+	}
+	else if((&I2C_DefaultContext == context) || (options & I2C_TRANSFER_OPTIONS_PURGE))
+	{
+		DBG(MSG_DEBUG,"purging handle 0x%x\n",(unsigned)handle);
+		Mid_PurgeDevice(handle);
+	}
+	if(&I2C_DefaultContext != context)
+		context->dirty = TRUE;
+}
+
+/*!
+ * \brief Records the state in which a transfer left the channel
+ *
+ * The channel is clean if everything that was written was processed and everything the MPSSE
+ * returned was read. A nAck from a slave doesn't change this, other errors(e.g. timeouts or short
+ * reads) do.
+ *
+ * \param[in] context Pointer to the channel's context
+ * \param[in] status Status of the transfer
+ * \return none
+ * \sa I2C_BeginTransfer
+ * \note
+ * \warning
+ */
+void I2C_EndTransfer(ChannelContext *context, FT_STATUS status)
+{
+	if(&I2C_DefaultContext != context)
+	{
+		context->dirty = ((FT_OK == status) || (FT_DEVICE_NOT_FOUND == status) ||
+			(FT_FAILED_TO_WRITE_DEVICE == status))?FALSE:TRUE;
+	}
+}
+
+/*!
+ * \brief Adds the commands of a combined transaction to a buffer
+ *
+ * START, then for each message a repeated START(unless I2C_MSG_NO_START), the address and the
+ * data bytes, then STOP and SEND_IMMEDIATE. A message flagged I2C_MSG_STOP is followed by STOP,
+ * and the next message by START instead of a repeated START.
+ *
+ * \param[in] context Pointer to the channel's context
+ * \param[out] buffer Buffer to which the commands are added, NULL to only get the length
+ * \param[in] msgs Array of messages
+ * \param[in] count Number of messages
+ * \param[out] sizeToRead Number of bytes that the MPSSE will return for these commands
+ * \return Number of bytes added to the buffer
+ * \sa I2C_Transfer, I2C_ParseTransfer
+ * \note
+ * \warning
+ */
+uint32 I2C_AddTransfer(const ChannelContext *context, uint8 *buffer, I2C_Msg *msgs,
+	uint32 count, uint32 *sizeToRead)
+{
+	uint32 i=0;
+	uint32 m;
+	uint32 j;
+	bool read;
+	bool ack;
+	bool stopped=TRUE;
+
+	*sizeToRead = 0;
+	for(m=0; m<count; m++)
+	{
+		read = (msgs[m].flags & I2C_MSG_READ)?TRUE:FALSE;
+		if(!(msgs[m].flags & I2C_MSG_NO_START))
+		{
+			if(stopped)
+				i += I2C_AddStart(context,(NULL==buffer)?NULL:&buffer[i]);
+			else
+				i += I2C_AddRestart(context,(NULL==buffer)?NULL:&buffer[i]);
+			i += I2C_AddWriteByte(context,(NULL==buffer)?NULL:&buffer[i],
+				(uint8)((msgs[m].addr<<1) | (read?I2C_ADDRESS_READ_MASK:0)));
+			(*sizeToRead)++;
+		}
+		for(j=0; j<msgs[m].len; j++)
+		{
+			if(read)
+			{/* nAck the last byte before a (repeated) START or STOP */
+				ack = ((j < (msgs[m].len-1)) || (((m+1) < count) &&
+					(msgs[m+1].flags & I2C_MSG_NO_START)))?TRUE:FALSE;
+				i += I2C_AddReadByte(context,(NULL==buffer)?NULL:&buffer[i],ack);
+			}
+			else
+			{
+				i += I2C_AddWriteByte(context,(NULL==buffer)?NULL:&buffer[i],
+					msgs[m].buf[j]);
+			}
+		}
+		*sizeToRead += msgs[m].len;
+		stopped = ((msgs[m].flags & I2C_MSG_STOP) && ((m+1) < count))?TRUE:FALSE;
+		if(stopped)
+			i += I2C_AddStop(context,(NULL==buffer)?NULL:&buffer[i]);
+	}
+	i += I2C_AddStop(context,(NULL==buffer)?NULL:&buffer[i]);
+	if(NULL != buffer)
+		buffer[i] = MPSSE_CMD_SEND_IMMEDIATE;
+	i++;
+	return i;
+}
+
+/*!
+ * \brief Distributes the bytes read back for a combined transaction to its messages
+ *
+ * \param[in,out] msgs Array of messages whose status, sizeTransferred and read buffers are
+ *			filled in
+ * \param[in] count Number of messages
+ * \param[in] inBuffer Bytes returned by the MPSSE for the commands made by I2C_AddTransfer
+ * \return Status of the first message that failed, FT_OK if none did
+ * \sa I2C_Transfer, I2C_AddTransfer
+ * \note
+ * \warning
+ */
+FT_STATUS I2C_ParseTransfer(I2C_Msg *msgs, uint32 count, uint8 *inBuffer)
+{
+	FT_STATUS status=FT_OK;
+	uint32 m;
+	uint32 firstNack;
+	bool ignore;
+
+	for(m=0; m<count; m++)
+	{
+		ignore = (msgs[m].flags & I2C_MSG_IGNORE_NACK)?TRUE:FALSE;
+		msgs[m].status = FT_OK;
+		msgs[m].sizeTransferred = msgs[m].len;
+		if(!(msgs[m].flags & I2C_MSG_NO_START))
+		{
+			if((*inBuffer++ & 0x01) && !ignore)
+			{
+				DBG(MSG_ERR,"I2C device with address 0x%x didn't ack when addressed\n",
+					(unsigned)msgs[m].addr);
+				msgs[m].status = FT_DEVICE_NOT_FOUND;
+				msgs[m].sizeTransferred = 0;
+			}
+		}
+		if(msgs[m].flags & I2C_MSG_READ)
+		{
+			INFRA_MEMCPY(msgs[m].buf,inBuffer,msgs[m].len);
+		}
+		else
+		{
+			Infra_PackLsb(inBuffer,msgs[m].len,NULL,&firstNack);
+			if((firstNack < msgs[m].len) && (FT_OK == msgs[m].status) && !ignore)
+			{
+				DBG(MSG_WARN,"I2C device(address 0x%x) nAcked byte no %u\n",
+					(unsigned)msgs[m].addr,(unsigned)firstNack);
+				msgs[m].status = FT_FAILED_TO_WRITE_DEVICE;
+				msgs[m].sizeTransferred = firstNack;
+			}
+		}
+		inBuffer += msgs[m].len;
+		if((FT_OK == status) && (FT_OK != msgs[m].status))
+			status = msgs[m].status;
+	}
+	return status;
+}
+
+/*!
+ * \brief Marks all the messages of a combined transaction as failed
+ *
+ * Used when the transaction is given up before the bytes read back could be parsed, so that the
+ * status of every message is valid whatever I2C_Transfer returned.
+ *
+ * \param[in,out] msgs Array of messages whose status and sizeTransferred are filled in
+ * \param[in] count Number of messages
+ * \param[in] status Status given to every message
+ * \return none
+ * \sa I2C_Transfer, I2C_ParseTransfer
+ * \note
+ * \warning
+ */
+void I2C_FailTransfer(I2C_Msg *msgs, uint32 count, FT_STATUS status)
+{
+	uint32 m;
+
+	for(m=0; m<count; m++)
+	{
+		msgs[m].status = status;
+		msgs[m].sizeTransferred = 0;
+	}
+}
+
+/*!
+ * \brief Generates the commands to write a byte and to read its ack bit
+ *
+ * SDA is driven for the 8 data bits and is then made an input to clock in the ack bit. The ack
+ * bit is returned by the MPSSE as the LSB of one byte(1 = nAck). When the chip drives only
+ * zeros SDA stays an output, a '1' is clocked out while the ack bit is clocked in and the pin
+ * directions are never changed.
+ *
+ * \param[in] context Pointer to the channel's context
+ * \param[out] buffer Buffer to which the commands are written
+ * \param[out] dataOffset Index of the byte to be written within the commands
+ * \return Number of bytes written to the buffer
+ * \sa I2C_AddWriteByte
+ * \note
+ * \warning
+ */
+uint32 I2C_MakeWriteByte(const ChannelContext *context, uint8 *buffer, uint32 *dataOffset)
+{
+	uint32 i=0;
+
+	if(I2C_DRIVES_ONLY_ZERO(context))
+	{
+		/* Command to write 8 bits */
+		buffer[i++] = MPSSE_CMD_DATA_OUT_BITS_NEG_EDGE;
+		buffer[i++] = DATA_SIZE_8BITS;
+		*dataOffset = i;
+		buffer[i++] = 0;
+
+		/* Release SDA and get ACK bit */
+		buffer[i++] = MPSSE_CMD_DATA_BITS_IN_POS_OUT_NEG_EDGE;
+		buffer[i++] = DATA_SIZE_1BIT;
+		buffer[i++] = SEND_NACK;
+		return i;
+	}
+
+	/*set direction*/
+	buffer[i++] = MPSSE_CMD_SET_DATA_BITS_LOWBYTE;
+	buffer[i++] = VALUE_SCLLOW_SDALOW;
+	buffer[i++] = DIRECTION_SCLOUT_SDAOUT;
+
+	/* Command to write 8 bits */
+	buffer[i++] = MPSSE_CMD_DATA_OUT_BITS_NEG_EDGE;
+	buffer[i++] = DATA_SIZE_8BITS;
+	*dataOffset = i;
+	buffer[i++] = 0;
+
+	/* Set SDA to input mode before reading ACK bit */
+	buffer[i++] = MPSSE_CMD_SET_DATA_BITS_LOWBYTE;
+	buffer[i++] = VALUE_SCLLOW_SDALOW;
+	buffer[i++] = DIRECTION_SCLOUT_SDAIN;
+
+	/* Command to get ACK bit */
+	buffer[i++] = MPSSE_CMD_DATA_IN_BITS_POS_EDGE;
+	buffer[i++] = DATA_SIZE_1BIT;
+	return i;
+}
+
+/*!
+ * \brief Generates the commands to read a byte and to give an ack/nAck
+ *
+ * When the chip drives only zeros, 1s are clocked out while the data bits are clocked in so that
+ * SDA is released without changing the pin directions.
+ *
+ * \param[in] context Pointer to the channel's context
+ * \param[out] buffer Buffer to which the commands are written
+ * \param[in] ack Gives ack to device if set, otherwise gives nAck
+ * \return Number of bytes written to the buffer
+ * \sa I2C_AddReadByte
+ * \note
+ * \warning
+ */
+uint32 I2C_MakeReadByte(const ChannelContext *context, uint8 *buffer, bool ack)
+{
+	uint32 i=0;
+
+	if(I2C_DRIVES_ONLY_ZERO(context))
+	{
+		/* Release SDA and read 8 bits */
+		buffer[i++] = MPSSE_CMD_DATA_BITS_IN_POS_OUT_NEG_EDGE;
+		buffer[i++] = DATA_SIZE_8BITS;
+		buffer[i++] = 0xFF;
+
+		/* Clock out the ack bit, a nAck leaves SDA released */
+		buffer[i++] = MPSSE_CMD_DATA_OUT_BITS_NEG_EDGE;
+		buffer[i++] = DATA_SIZE_1BIT;
+		buffer[i++] = ack?SEND_ACK:SEND_NACK;
+		return i;
+	}
+
+	/*set direction*/
+	buffer[i++] = MPSSE_CMD_SET_DATA_BITS_LOWBYTE;
+	buffer[i++] = VALUE_SCLLOW_SDALOW;
+	buffer[i++] = DIRECTION_SCLOUT_SDAIN;
+
+	/*Command to read 8 bits*/
+	buffer[i++] = MPSSE_CMD_DATA_IN_BITS_POS_EDGE;
+	buffer[i++] = DATA_SIZE_8BITS;
+
+	if(ack)
+	{
+		/* We will drive the ACK bit to a '0' so pre-set pin to a '0' */
+		buffer[i++] = MPSSE_CMD_SET_DATA_BITS_LOWBYTE;
+		buffer[i++] = VALUE_SCLLOW_SDALOW;
+		buffer[i++] = DIRECTION_SCLOUT_SDAOUT;
+
+		/* Clock out the ack bit as a '0' on negative edge */
+		buffer[i++] = MPSSE_CMD_DATA_OUT_BITS_NEG_EDGE;
+		buffer[i++] = DATA_SIZE_1BIT;
+		buffer[i++] = SEND_ACK;
+	}
+	else
+	{
+		/* We will release the ACK bit to a '1' so pre-set pin to a '1' by making it an input */
+		buffer[i++] = MPSSE_CMD_SET_DATA_BITS_LOWBYTE;
+		buffer[i++] = VALUE_SCLLOW_SDALOW;
+		buffer[i++] = DIRECTION_SCLOUT_SDAIN;
+
+		/* Clock out the ack bit as a '1' on negative edge - never actually seen on line since
+		SDA is input but burns off one bit time */
+		buffer[i++] = MPSSE_CMD_DATA_OUT_BITS_NEG_EDGE;
+		buffer[i++] = DATA_SIZE_1BIT;
+		buffer[i++] = SEND_NACK;
+	}
+
+	/*Back to Idle*/
+	buffer[i++] = MPSSE_CMD_SET_DATA_BITS_LOWBYTE;
+	buffer[i++] = VALUE_SCLLOW_SDALOW;
+	buffer[i++] = DIRECTION_SCLOUT_SDAIN;
+	return i;
+}
+
+/*!
+ * \brief Generates the commands that write the high speed mode master code
+ *
+ * The master code is written at fast mode speed and is nAcked by all slaves, so the ack bit is
+ * clocked without being read.
+ *
+ * \param[in] context Pointer to the channel's context
+ * \param[out] buffer Buffer to which the commands are written
+ * \return Number of bytes written to the buffer
+ * \sa I2C_MakeSequences
+ * \note
+ * \warning
+ */
+uint32 I2C_MakeMasterCode(const ChannelContext *context, uint8 *buffer)
+{
+	uint32 i=0;
+
+	if(!I2C_DRIVES_ONLY_ZERO(context))
+	{/*set direction*/
+		buffer[i++] = MPSSE_CMD_SET_DATA_BITS_LOWBYTE;
+		buffer[i++] = VALUE_SCLLOW_SDALOW;
+		buffer[i++] = DIRECTION_SCLOUT_SDAOUT;
+	}
+
+	/* Command to write 8 bits */
+	buffer[i++] = MPSSE_CMD_DATA_OUT_BITS_NEG_EDGE;
+	buffer[i++] = DATA_SIZE_8BITS;
+	buffer[i++] = I2C_HS_MASTER_CODE;
+
+	if(!I2C_DRIVES_ONLY_ZERO(context))
+	{/* Release SDA */
+		buffer[i++] = MPSSE_CMD_SET_DATA_BITS_LOWBYTE;
+		buffer[i++] = VALUE_SCLLOW_SDALOW;
+		buffer[i++] = DIRECTION_SCLOUT_SDAIN;
+	}
+
+	/* Clock the ack bit without reading it */
+	buffer[i++] = MPSSE_CMD_DATA_OUT_BITS_NEG_EDGE;
+	buffer[i++] = DATA_SIZE_1BIT;
+	buffer[i++] = SEND_NACK;
+	return i;
+}
+
+/*!
+ * \brief Adds the commands to write a byte and to read its ack bit to a buffer
+ *
+ * \param[in] context Pointer to the channel's context
+ * \param[out] buffer Buffer to which the commands are added, NULL to only get the length
+ * \param[in] data Byte to be written
+ * \return Number of bytes added to the buffer
+ * \sa I2C_MakeWriteByte
+ * \note
+ * \warning
+ */
+uint32 I2C_AddWriteByte(const ChannelContext *context, uint8 *buffer, uint8 data)
+{
+	if(NULL != buffer)
+	{
+		INFRA_MEMCPY(buffer,context->writeByte,context->writeByteLen);
+		buffer[context->writeByteData] = data;
+	}
+	return context->writeByteLen;
+}
+
+/*!
+ * \brief Adds the commands to read a byte and to give an ack/nAck to a buffer
+ *
+ * \param[in] context Pointer to the channel's context
+ * \param[out] buffer Buffer to which the commands are added, NULL to only get the length
+ * \param[in] ack Gives ack to device if set, otherwise gives nAck
+ * \return Number of bytes added to the buffer
+ * \sa I2C_MakeReadByte
+ * \note
+ * \warning
+ */
+uint32 I2C_AddReadByte(const ChannelContext *context, uint8 *buffer, bool ack)
+{
+	if(NULL != buffer)
+	{
+		INFRA_MEMCPY(buffer,ack?context->readByteAck:context->readByteNack,
+			context->readByteLen);
+	}
+	return context->readByteLen;
+}
+
+
+
+/*!
+* \brief Generates the I2C Start condition
+*
+* This function generates the I2C start condition on the bus.
+*
+* \param[in] handle Handle of the channel
+* \param[in] context Pointer to the channel's context
+* \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide)
+* \sa
+* \note
+* \warning
+*/
+FT_STATUS I2C_Start(FT_HANDLE handle, const ChannelContext *context)
+{
+	FT_STATUS status;
+	uint8 buffer[I2C_CONDITION_BUFFER_SIZE];
+	uint32 i;
+	uint32 noOfBytesTransferred;
+	FN_ENTER;
+
+	i = I2C_AddStart(context,buffer);
+	status = FT_Channel_Write(I2C, handle, i, buffer, &noOfBytesTransferred);
+
+	FN_EXIT;
+	return status;
+}
+
+/*!
+* \brief Generates the I2C Stop condition
+*
+* This function generates the I2C stop condition on the bus.
+*
+* \param[in] handle Handle of the channel
+* \param[in] context Pointer to the channel's context
+* \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide)
+* \sa
+* \note
+* \warning
+*/
+FT_STATUS I2C_Stop(FT_HANDLE handle, const ChannelContext *context)
+{
+	FT_STATUS status;
+	uint8 buffer[I2C_CONDITION_BUFFER_SIZE];
+	uint32 i;
+	uint32 noOfBytesTransferred;
+
+	FN_ENTER;
+	i = I2C_AddStop(context,buffer);
+	status = FT_Channel_Write(I2C, handle, i, buffer, &noOfBytesTransferred);
+
+	FN_EXIT;
+	return status;
+}
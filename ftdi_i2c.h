@@ -82,6 +82,26 @@
 	     1bit acknowledgement will be read after that, which will however be just ignored */
 	#define I2C_TRANSFER_OPTIONS_NO_ADDRESS		0x00000040
 
+	/* The device's buffers are purged before a transfer only if an earlier transfer failed and
+	left them in an unknown state. Setting this bit forces the purge */
+	#define I2C_TRANSFER_OPTIONS_PURGE			0x00000080
+
+
+/* Flags of I2C_Msg, used by I2C_Transfer */
+	/* The message reads from the slave, otherwise it writes to it */
+	#define I2C_MSG_READ			0x00000001
+
+	/* Don't generate a repeated START and don't send the address. The data of the message
+	continues the previous message, in the same direction */
+	#define I2C_MSG_NO_START		0x00000002
+
+	/* Don't fail the transfer if the slave nAcks the address or a byte written in this message */
+	#define I2C_MSG_IGNORE_NACK		0x00000004
+
+	/* End the message with a STOP, the next message starts with a START. Needed e.g. by bus
+	switches, which only apply a new channel selection on STOP */
+	#define I2C_MSG_STOP			0x00000008
+
 
 #define I2C_CMD_GETDEVICEID_RD	0xF9
 #define I2C_CMD_GETDEVICEID_WR	0xF8
@@ -92,6 +112,32 @@
 /* 3-phase clocking is enabled by default. Setting this bit in ConfigOptions will disable it */
 #define I2C_DISABLE_3PHASE_CLOCKING	0x0001
 
+/* Clock stretching by slaves is supported on hi-speed chips(FT2232H, FT4232H & FT232H) when this
+bit is set in ConfigOptions. The MPSSE is put in adaptive clocking mode, in which it waits for
+SCL to go high before continuing. SCL has to be connected to GPIOL3(ADBUS7) as well */
+#define I2C_ENABLE_CLOCK_STRETCHING	0x0004
+
+/* Fast initialization: the device isn't reset and the MPSSE isn't reset/re-enabled when it is
+found already running(e.g. when a channel is reopened), and the fixed waits are replaced by
+waiting for the MPSSE to echo a command. Setting this bit in ConfigOptions selects it */
+#define I2C_ENABLE_FAST_INIT		0x0080
+
+/* Calibration: after initialization the latency timer and the USB transfer sizes are measured on
+the device and the best ones for short register accesses(latency) or block transfers(throughput)
+are applied, overriding LatencyTimer. Setting one of these bits in ConfigOptions selects it */
+#define I2C_CALIBRATE_LATENCY		0x0100
+#define I2C_CALIBRATE_THROUGHPUT	0x0200
+
+/* Upper limit of SET_DATA_BITS commands per bus condition */
+#define I2C_MAX_HOLD_COMMANDS	64
+
+/* Largest START/STOP/RESTART sequence that can be generated. In high speed mode START is made of
+7 conditions(START, repeated START), the master code and a clock change */
+#define I2C_CONDITION_BUFFER_SIZE	(7*((I2C_MAX_HOLD_COMMANDS*3)+3)+32)
+
+/* Largest sequence of commands that writes or reads one byte */
+#define I2C_BYTE_BUFFER_SIZE	16
+
 
 
 /******************************************************************************/
@@ -148,6 +194,76 @@ typedef struct ChannelConfig_t
 	*/
 }ChannelConfig;
 
+/* One segment of a combined I2C transaction(see I2C_Transfer) */
+typedef struct I2C_Msg_t
+{
+	uint32			addr;	/* 7bit address of the slave */
+	uint32			flags;	/* I2C_MSG_* */
+	uint32			len;	/* number of bytes to be written/read */
+	uint8			*buf;	/* data to be written, or buffer for the data read */
+	FT_STATUS		status;	/* returned: FT_OK, FT_DEVICE_NOT_FOUND if the address was nAcked or
+							FT_FAILED_TO_WRITE_DEVICE if a byte written was nAcked */
+	uint32			sizeTransferred;	/* returned: bytes read, or bytes written before
+							the first nAck */
+}I2C_Msg;
+
+/* This enum lists the supported I2C modes*/
+typedef enum I2C_Modes_t{
+I2C_STANDARD_MODE = 0,
+I2C_FAST_MODE,
+I2C_FAST_MODE_PLUS,
+I2C_HIGH_SPEED_MODE,
+I2C_MAXIMUM_SUPPORTED_MODES
+}I2C_Modes;
+
+/* This enum lists the various I2C bus condition*/
+typedef enum I2C_Bus_Condition_t{
+I2C_CONDITION_PRESTART,
+I2C_CONDITION_START,
+I2C_CONDITION_POSTSTART,
+I2C_CONDITION_PRESTOP,
+I2C_CONDITION_STOP,
+I2C_CONDITION_POSTSTOP,
+I2C_MAXIMUM_SUPPORTED_CONDITIONS
+}I2C_Bus_Condition;
+
+/* This structure associates the channel configuration information to a handle and holds the
+bus timings and the MPSSE command sequences derived from it. The structures are stored in the
+form of a linked list */
+typedef struct ChannelContext_t
+{
+	FT_HANDLE 		handle;
+	ChannelConfig	config;		/* as passed to I2C_InitChannel */
+	FT_DEVICE		ftDevice;
+	uint32			mpsseClock;	/* frequency the MPSSE clock was set to, in Hz */
+	I2C_Modes		mode;
+	/* Number of SET_DATA_BITS commands that hold each bus condition */
+	uint16			holdCommands[I2C_MAXIMUM_SUPPORTED_CONDITIONS];
+	/* Number of clock-only bit periods that follow them(0 if clock-only delays aren't used) */
+	uint32			holdBits[I2C_MAXIMUM_SUPPORTED_CONDITIONS];
+	/* Command sequences that generate the bus conditions */
+	uint8			start[I2C_CONDITION_BUFFER_SIZE];
+	uint8			stop[I2C_CONDITION_BUFFER_SIZE];
+	uint8			restart[I2C_CONDITION_BUFFER_SIZE];
+	uint32			startLen;	/* 0 until the sequences have been generated */
+	uint32			stopLen;
+	uint32			restartLen;
+	/* Command sequences that write a byte(data at writeByteData) and read one */
+	uint8			writeByte[I2C_BYTE_BUFFER_SIZE];
+	uint8			readByteAck[I2C_BYTE_BUFFER_SIZE];
+	uint8			readByteNack[I2C_BYTE_BUFFER_SIZE];
+	uint32			writeByteLen;
+	uint32			writeByteData;
+	uint32			readByteLen;
+	/* Set while the state of the device's buffers is unknown(transfer in progress or failed) */
+	bool			dirty;
+	/* Number of samples I2C_PollRegister and I2C_PollAck queue in their first batch, learnt from
+	the last poll */
+	uint32			pollBatch;
+	uint32			ackPollBatch;
+	struct ChannelContext_t *next;
+}ChannelContext;
+
 
 /******************************************************************************/
 /*								External variables							  */
@@ -164,12 +280,25 @@ FTDI_API FT_STATUS I2C_GetNumChannels(uint32 *numChannels);
 FTDI_API FT_STATUS I2C_GetChannelInfo(uint32 index,
 	FT_DEVICE_LIST_INFO_NODE *chanInfo);
 FTDI_API FT_STATUS I2C_OpenChannel(uint32 index, FT_HANDLE *handle);
+FTDI_API FT_STATUS I2C_OpenChannelEx(void *arg, uint32 flags, FT_HANDLE *handle);
 FTDI_API FT_STATUS I2C_InitChannel(FT_HANDLE handle, ChannelConfig *config);
 FTDI_API FT_STATUS I2C_CloseChannel(FT_HANDLE handle);
+FTDI_API FT_STATUS I2C_RecoverChannel(FT_HANDLE handle);
+FTDI_API FT_STATUS I2C_CalibrateChannel(FT_HANDLE handle, uint32 workload,
+	FT_TransportProfile *profiles);
 FTDI_API FT_STATUS I2C_DeviceRead(FT_HANDLE handle, uint32 deviceAddress,
 uint32 sizeToTransfer, uint8 *buffer, uint32 *sizeTransfered, uint32 options);
 FTDI_API FT_STATUS I2C_DeviceWrite(FT_HANDLE handle, uint32 deviceAddress,
 uint32 sizeToTransfer, uint8 *buffer, uint32 *sizeTransfered, uint32 options);
+FTDI_API FT_STATUS I2C_DeviceWriteGetAcks(FT_HANDLE handle, uint32 deviceAddress,
+uint32 sizeToTransfer, uint8 *buffer, uint32 *sizeTransfered, uint32 options,
+uint8 *ackBitmap, uint32 *firstNack);
+FTDI_API FT_STATUS I2C_Transfer(FT_HANDLE handle, I2C_Msg *msgs, uint32 count);
+FTDI_API FT_STATUS I2C_ScanBus(FT_HANDLE handle, uint8 *presence);
+FTDI_API FT_STATUS I2C_PollRegister(FT_HANDLE handle, uint32 deviceAddress, uint8 reg,
+	uint8 mask, uint8 expected, uint32 timeout, uint8 *value, uint32 *elapsedUs);
+FTDI_API FT_STATUS I2C_PollAck(FT_HANDLE handle, uint32 deviceAddress, uint32 timeout,
+	uint32 *elapsedUs);
 FTDI_API FT_STATUS I2C_GetDeviceID(FT_HANDLE handle, uint8 deviceAddress,
 uint8* deviceID);
 
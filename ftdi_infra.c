@@ -32,6 +32,10 @@
 /******************************************************************************/
 #include "ftdi_infra.h"		/*portable infrastructure(datatypes, libraries, etc)*/
 
+#ifdef __SSE2__
+#include <emmintrin.h>		/*SSE2 intrinsics used by Infra_PackLsb*/
+#endif
+
 /******************************************************************************/
 /*								Global variables							  */
 /******************************************************************************/
@@ -40,6 +44,13 @@
 	int currentDebugLevel = MSG_DEBUG;
 #endif
 
+/* Lock of the lists the library keeps about the channels(see Infra_Lock) */
+#ifdef _WIN32
+	static SRWLOCK Infra_ListLock = SRWLOCK_INIT;
+#else
+	static pthread_mutex_t Infra_ListLock = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
 /******************************************************************************/
 /*						Global function definitions						  */
 /******************************************************************************/
@@ -155,6 +166,85 @@ FT_STATUS Infra_DbgPrintStatus(FT_STATUS status)
 }
 
 
+/*!
+ * \brief Packs the least significant bit of each byte of an array into a bitmap
+ *
+ * The MPSSE returns every bit that was clocked in as one byte with the bit of interest in its
+ * LSB (e.g. the ack bit read after each byte written to an I2C slave). This function gathers
+ * these bits into a bitmap, 8 per byte, bit n of the array going to bit (n%8) of bitmap[n/8],
+ * and also reports the index of the first byte that had its LSB set. 16 bytes are processed
+ * per iteration using SSE2 movemask where available, 8 bytes per iteration otherwise.
+ *
+ * \param[in] src Pointer to the bytes read from the MPSSE
+ * \param[in] count Number of bytes in src
+ * \param[out] bitmap Pointer to the bitmap, (count+7)/8 bytes long. May be NULL
+ * \param[out] firstSet Index of the first byte having LSB set, count if there was none.
+ *			May be NULL
+ * \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide)
+ * \sa
+ * \note Unused bits of the last bitmap byte are cleared
+ * \warning
+ */
+FT_STATUS Infra_PackLsb(const uint8 *src, uint32 count, uint8 *bitmap,
+	uint32 *firstSet)
+{
+	FT_STATUS status=FT_OK;
+	uint32 first = count;
+	uint32 i = 0;
+	uint32 j;
+	uint8 packed;
+
+	if((NULL == src) && (count > 0))
+		return FT_INVALID_PARAMETER;
+
+#ifdef __SSE2__
+	for(; (i+16) <= count; i+=16)
+	{
+		__m128i v = _mm_loadu_si128((const __m128i *)(src+i));
+		/* move bit0 of each byte to bit7, where movemask picks it up */
+		uint32 mask = (uint32)_mm_movemask_epi8(_mm_slli_epi16(v,7));
+		if(NULL != bitmap)
+		{
+			bitmap[i/8] = (uint8)mask;
+			bitmap[i/8+1] = (uint8)(mask>>8);
+		}
+		if(unlikely(mask != 0) && (first == count))
+			first = i + (uint32)__builtin_ctz(mask);
+	}
+#endif
+
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+	for(; (i+8) <= count; i+=8)
+	{
+		uint64 word;
+		memcpy(&word,src+i,sizeof(word));
+		/* the multiply gathers bit0 of byte n into bit (56+n), without carries */
+		packed = (uint8)(((word & 0x0101010101010101ULL) *
+			0x0102040810204080ULL) >> 56);
+		if(NULL != bitmap)
+			bitmap[i/8] = packed;
+		if(unlikely(packed != 0) && (first == count))
+			first = i + (uint32)__builtin_ctz(packed);
+	}
+#endif
+
+	/* Remaining bytes, at most 7 if either of the above loops ran */
+	for(; i < count; i+=8)
+	{
+		packed = 0;
+		for(j=0; (j<8) && ((i+j)<count); j++)
+			packed |= (uint8)((src[i+j] & 0x01) << j);
+		if(NULL != bitmap)
+			bitmap[i/8] = packed;
+		if((packed != 0) && (first == count))
+			first = i + (uint32)__builtin_ctz(packed);
+	}
+
+	if(NULL != firstSet)
+		*firstSet = first;
+	return status;
+}
+
 /******************************************************************************/
 /*						Local function definitions						  */
 /*!
@@ -186,6 +276,72 @@ FT_STATUS Infra_Delay(uint64 delay)
 	return status;
 }
 
+/*!
+ * \brief Reads a monotonic time stamp
+ *
+ * This function returns the time elapsed from an arbitrary fixed point in the past. It is meant
+ * for measuring intervals, e.g. how long a device took to become ready, and is not affected by
+ * changes made to the system time.
+ *
+ * \return Time stamp in microseconds
+ * \sa
+ * \note
+ * \warning
+ */
+uint64 Infra_GetTimeUs(void)
+{
+#ifdef _WIN32
+	LARGE_INTEGER frequency;
+	LARGE_INTEGER counter;
+	QueryPerformanceFrequency(&frequency);
+	QueryPerformanceCounter(&counter);
+	return (uint64)((counter.QuadPart / frequency.QuadPart) * 1000000 +
+		((counter.QuadPart % frequency.QuadPart) * 1000000) / frequency.QuadPart);
+#else
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC,&now);
+	return (uint64)now.tv_sec * 1000000 + (uint64)(now.tv_nsec / 1000);
+#endif
+}
+
+/*!
+ * \brief Takes the lock of the library's channel lists
+ *
+ * The lists of channel contexts and the enumeration snapshot are shared by all the channels.
+ * Changes to them and lookups in them are made under this lock, so that different channels can
+ * be opened, initialized, used and closed from different threads.
+ *
+ * \return none
+ * \sa Infra_Unlock
+ * \note The lock isn't recursive, and isn't held while talking to a device
+ * \warning
+ */
+void Infra_Lock(void)
+{
+#ifdef _WIN32
+	AcquireSRWLockExclusive(&Infra_ListLock);
+#else
+	pthread_mutex_lock(&Infra_ListLock);
+#endif
+}
+
+/*!
+ * \brief Releases the lock of the library's channel lists
+ *
+ * \return none
+ * \sa Infra_Lock
+ * \note
+ * \warning
+ */
+void Infra_Unlock(void)
+{
+#ifdef _WIN32
+	ReleaseSRWLockExclusive(&Infra_ListLock);
+#else
+	pthread_mutex_unlock(&Infra_ListLock);
+#endif
+}
+
 /******************************************************************************/
 /*						Local function definitions						  */
 /******************************************************************************/
@@ -45,6 +45,8 @@
 #ifdef __linux
 #include<stdarg.h>	/*for va_start() & va_arg()*/
 #include<unistd.h>	/*for Sleep()*/
+#include<time.h>	/*for clock_gettime()*/
+#include<pthread.h>	/*for pthread_mutex_lock()*/
 #endif
 
 #ifndef _MSC_VER
@@ -54,6 +56,7 @@
 #include<stdio.h>
 #include<stdlib.h>
 #include<string.h>
+#include<stddef.h>	/*for offsetof()*/
 #include"ftd2xx.h"
 
 
@@ -173,6 +176,19 @@ status=FT_INVALID_PARAMETER ; return(status);}else{;}};
 #define INFRA_MEMCPY(dest,src,siz)	memcpy(dest,src,siz);\
 	DBG(MSG_DEBUG,"INFRA_MEMCPY dest:0x%x src:0x%x size:0x%x\n",dest,src,siz);
 
+/* Pointers read without taking the lock(Infra_Lock): the load sees everything written before the
+store that published the pointer */
+#ifdef _MSC_VER
+	#define INFRA_LOAD_POINTER(location)	\
+		InterlockedCompareExchangePointer((PVOID volatile*)(location),NULL,NULL)
+	#define INFRA_STORE_POINTER(location,value)	\
+		InterlockedExchangePointer((PVOID volatile*)(location),(PVOID)(value))
+#else
+	#define INFRA_LOAD_POINTER(location)	__atomic_load_n((location),__ATOMIC_ACQUIRE)
+	#define INFRA_STORE_POINTER(location,value)	\
+		__atomic_store_n((location),(value),__ATOMIC_RELEASE)
+#endif
+
 
 /******************************************************************************/
 /*								Define platform								  */
@@ -209,6 +225,11 @@ status=FT_INVALID_PARAMETER ; return(status);}else{;}};
 /******************************************************************************/
 FT_STATUS Infra_DbgPrintStatus(FT_STATUS status);
 FT_STATUS Infra_Delay(uint64 delay);
+uint64 Infra_GetTimeUs(void);
+void Infra_Lock(void);
+void Infra_Unlock(void);
+FT_STATUS Infra_PackLsb(const uint8 *src, uint32 count, uint8 *bitmap,
+	uint32 *firstSet);
 
 
 
@@ -0,0 +1,1057 @@
+/*!
+ * \file ftdi_libusb.c
+ *
+ * \author FTDI
+ * \date 20261018
+ *
+ * Copyright (C) 2000-2014 Future Technology Devices International Limited
+ *
+ *
+ * THIS SOFTWARE IS PROVIDED BY FUTURE TECHNOLOGY DEVICES INTERNATIONAL LIMITED ``AS IS'' AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL FUTURE TECHNOLOGY DEVICES INTERNATIONAL LIMITED
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Project: libMPSSE
+ * Module: Libusb
+ *
+ * Rivision History:
+ * 0.1 - initial version
+ */
+
+
+/******************************************************************************/
+/*								Include files					  			  */
+/******************************************************************************/
+#include "ftdi_infra.h"		/*Common portable infrastructure(datatypes, libraries, etc)*/
+#include "ftdi_common.h"	/*Common across I2C, SPI, JTAG modules*/
+#include "ftdi_libusb.h"	/*Libusb backend specific*/
+
+
+/******************************************************************************/
+/*								Macro and type defines					  		  */
+/******************************************************************************/
+
+
+/******************************************************************************/
+/*								Local function declarations					  */
+/******************************************************************************/
+FT_STATUS Usb_CreateDeviceInfoList(LPDWORD numDevices);
+FT_STATUS Usb_GetDeviceInfoList(FT_DEVICE_LIST_INFO_NODE *list, LPDWORD numDevices);
+FT_STATUS Usb_Open(uint32 index, FT_HANDLE *handle);
+FT_STATUS Usb_OpenEx(PVOID arg, DWORD flags, FT_HANDLE *handle);
+FT_STATUS Usb_Close(FT_HANDLE handle);
+FT_STATUS Usb_Write(FT_HANDLE handle, LPVOID buffer, DWORD bytesToWrite, LPDWORD bytesWritten);
+FT_STATUS Usb_Read(FT_HANDLE handle, LPVOID buffer, DWORD bytesToRead, LPDWORD bytesRead);
+FT_STATUS Usb_GetQueueStatus(FT_HANDLE handle, LPDWORD amountInRxQueue);
+FT_STATUS Usb_Purge(FT_HANDLE handle, ULONG mask);
+FT_STATUS Usb_ResetDevice(FT_HANDLE handle);
+FT_STATUS Usb_SetBitMode(FT_HANDLE handle, UCHAR mask, UCHAR mode);
+FT_STATUS Usb_SetLatencyTimer(FT_HANDLE handle, UCHAR latency);
+FT_STATUS Usb_SetUSBParameters(FT_HANDLE handle, ULONG inTransferSize, ULONG outTransferSize);
+FT_STATUS Usb_SetChars(FT_HANDLE handle, UCHAR eventCh, UCHAR eventChEn, UCHAR errorCh,
+	UCHAR errorChEn);
+FT_STATUS Usb_SetTimeouts(FT_HANDLE handle, ULONG readTimeout, ULONG writeTimeout);
+FT_STATUS Usb_GetDeviceInfo(FT_HANDLE handle, FT_DEVICE *ftDevice, LPDWORD deviceID,
+	PCHAR serialNumber, PCHAR description);
+
+FT_STATUS Usb_Status(int error);
+FT_STATUS Usb_Init(void);
+FT_STATUS Usb_Enumerate(Usb_Port **ports, uint32 *numPorts);
+void Usb_FreePorts(Usb_Port *ports, uint32 numPorts);
+FT_STATUS Usb_OpenPort(const Usb_Port *port, FT_HANDLE *handle);
+void Usb_FreeDevice(Usb_Device *device);
+FT_STATUS Usb_Control(Usb_Device *device, uint8 request, uint16 value);
+FT_STATUS Usb_Wait(int *completed, uint32 timeout, uint64 start);
+FT_STATUS Usb_Submit(Usb_Transfer *usbTransfer);
+FT_STATUS Usb_Recycle(Usb_Device *device, bool drop);
+void LIBUSB_CALL Usb_InCallback(struct libusb_transfer *transfer);
+void LIBUSB_CALL Usb_OutCallback(struct libusb_transfer *transfer);
+
+
+/******************************************************************************/
+/*								Global variables							  */
+/******************************************************************************/
+
+const Backend_Ops Backend_Libusb =
+{
+	"libusb",
+	Usb_CreateDeviceInfoList,
+	Usb_GetDeviceInfoList,
+	Usb_Open,
+	Usb_OpenEx,
+	Usb_Close,
+	Usb_Write,
+	Usb_Read,
+	Usb_GetQueueStatus,
+	Usb_Purge,
+	Usb_ResetDevice,
+	Usb_SetBitMode,
+	Usb_SetLatencyTimer,
+	Usb_SetUSBParameters,
+	Usb_SetChars,
+	Usb_SetTimeouts,
+	Usb_GetDeviceInfo
+};
+
+/* Context of libusb, created on first use */
+static libusb_context *Usb_Context=NULL;
+
+/* Ports found by the last Usb_CreateDeviceInfoList, Usb_Open takes an index into them */
+static Usb_Port *Usb_Ports=NULL;
+static uint32 Usb_NumPorts=0;
+
+
+/******************************************************************************/
+/*						Local function definitions						  */
+/******************************************************************************/
+
+/*!
+ * \brief Enumerates the ports
+ *
+ * This function takes a snapshot of the ports of the supported chips that are connected to the
+ * host system, for Usb_GetDeviceInfoList and Usb_Open
+ *
+ * \param[out] numDevices Number of ports
+ * \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide)
+ * \sa
+ * \note
+ * \warning To be called with the lock taken(Infra_Lock), as Mid_RefreshChannels does
+ */
+FT_STATUS Usb_CreateDeviceInfoList(LPDWORD numDevices)
+{
+	FT_STATUS status;
+	FN_ENTER;
+	Usb_FreePorts(Usb_Ports,Usb_NumPorts);
+	Usb_Ports = NULL;
+	Usb_NumPorts = 0;
+	status = Usb_Init();
+	if(FT_OK == status)
+		status = Usb_Enumerate(&Usb_Ports,&Usb_NumPorts);
+	*numDevices = Usb_NumPorts;
+	FN_EXIT;
+	return status;
+}
+
+/*!
+ * \brief Returns the information of the ports found by Usb_CreateDeviceInfoList
+ *
+ * \param[out] list Array of the information of the ports(memory to be allocated by caller)
+ * \param[out] numDevices Number of ports
+ * \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide)
+ * \sa
+ * \note
+ * \warning To be called with the lock taken(Infra_Lock), as Mid_RefreshChannels does
+ */
+FT_STATUS Usb_GetDeviceInfoList(FT_DEVICE_LIST_INFO_NODE *list, LPDWORD numDevices)
+{
+	uint32 i;
+
+	for(i=0; i<Usb_NumPorts; i++)
+	{
+		INFRA_MEMCPY(&list[i],&Usb_Ports[i].info,sizeof(FT_DEVICE_LIST_INFO_NODE));
+	}
+	*numDevices = Usb_NumPorts;
+	return FT_OK;
+}
+
+/*!
+ * \brief Opens a port found by Usb_CreateDeviceInfoList
+ *
+ * \param[in] index Index of the port
+ * \param[out] handle Pointer to the handle
+ * \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide)
+ * \sa
+ * \note
+ * \warning
+ */
+FT_STATUS Usb_Open(uint32 index, FT_HANDLE *handle)
+{
+	FT_STATUS status=FT_DEVICE_NOT_FOUND;
+	Usb_Port port;
+	FN_ENTER;
+
+	Infra_Lock();
+	if(index < Usb_NumPorts)
+	{
+		INFRA_MEMCPY(&port,&Usb_Ports[index],sizeof(Usb_Port));
+		libusb_ref_device(port.device);
+		status = FT_OK;
+	}
+	Infra_Unlock();
+	if(FT_OK == status)
+	{
+		status = Usb_OpenPort(&port,handle);
+		libusb_unref_device(port.device);
+	}
+	FN_EXIT;
+	return status;
+}
+
+/*!
+ * \brief Opens a port by its serial number, description or location
+ *
+ * The ports are enumerated afresh, the snapshot taken by Usb_CreateDeviceInfoList is left as it
+ * is so that its indices stay valid.
+ *
+ * \param[in] arg Serial number or description(string), or location ID(cast to a pointer)
+ * \param[in] flags FT_OPEN_BY_SERIAL_NUMBER, FT_OPEN_BY_DESCRIPTION or FT_OPEN_BY_LOCATION
+ * \param[out] handle Pointer to the handle
+ * \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide)
+ * \sa
+ * \note
+ * \warning
+ */
+FT_STATUS Usb_OpenEx(PVOID arg, DWORD flags, FT_HANDLE *handle)
+{
+	FT_STATUS status;
+	Usb_Port *ports=NULL;
+	uint32 numPorts=0;
+	uint32 i;
+	FN_ENTER;
+
+	Infra_Lock();
+	status = Usb_Init();
+	Infra_Unlock();
+	CHECK_STATUS(status);
+	status = Usb_Enumerate(&ports,&numPorts);
+	CHECK_STATUS(status);
+	for(i=0; i<numPorts; i++)
+	{
+		if(((FT_OPEN_BY_SERIAL_NUMBER == flags) &&
+				(0 == strcmp(ports[i].info.SerialNumber,(const char*)arg))) ||
+			((FT_OPEN_BY_DESCRIPTION == flags) &&
+				(0 == strcmp(ports[i].info.Description,(const char*)arg))) ||
+			((FT_OPEN_BY_LOCATION == flags) && (ports[i].info.LocId == (DWORD)(size_t)arg)))
+			break;
+	}
+	if(i < numPorts)
+		status = Usb_OpenPort(&ports[i],handle);
+	else
+		status = FT_DEVICE_NOT_FOUND;
+	Usb_FreePorts(ports,numPorts);
+	FN_EXIT;
+	return status;
+}
+
+/*!
+ * \brief Closes a port
+ *
+ * \param[in] handle Handle of the port
+ * \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide)
+ * \sa
+ * \note The IN transfers that are queued are cancelled
+ * \warning
+ */
+FT_STATUS Usb_Close(FT_HANDLE handle)
+{
+	FT_STATUS status=FT_OK;
+	FN_ENTER;
+	CHECK_NULL_RET(handle);
+	Usb_FreeDevice((Usb_Device*)handle);
+	FN_EXIT;
+	return status;
+}
+
+/*!
+ * \brief Writes to a port
+ *
+ * The data is split into transfers of outTransferSize bytes of which up to USB_OUT_TRANSFERS
+ * are in flight at a time. The transfers point into the caller's buffer, the data isn't copied.
+ *
+ * \param[in] handle Handle of the port
+ * \param[in] buffer Data to be written
+ * \param[in] bytesToWrite Number of bytes to be written
+ * \param[out] bytesWritten Number of bytes written
+ * \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide)
+ * \sa
+ * \note As with D2XX, FT_OK is returned with fewer bytes written when the write timeout expires
+ * \warning
+ */
+FT_STATUS Usb_Write(FT_HANDLE handle, LPVOID buffer, DWORD bytesToWrite, LPDWORD bytesWritten)
+{
+	FT_STATUS status=FT_OK;
+	Usb_Device *device=(Usb_Device*)handle;
+	Usb_Transfer *usbTransfer;
+	uint64 start;
+	uint32 offset=0;
+	uint32 size;
+	uint32 oldest=0;
+	uint32 inFlight=0;
+	int error;
+
+	*bytesWritten = 0;
+	start = Infra_GetTimeUs();
+	while((offset < bytesToWrite) || (0 != inFlight))
+	{
+		/* Keep the OUT endpoint busy */
+		while((FT_OK == status) && (inFlight < USB_OUT_TRANSFERS) && (offset < bytesToWrite))
+		{
+			usbTransfer = &device->out[(oldest+inFlight)%USB_OUT_TRANSFERS];
+			size = bytesToWrite - offset;
+			if(size > device->outTransferSize)
+				size = device->outTransferSize;
+			libusb_fill_bulk_transfer(usbTransfer->transfer,device->usbHandle,
+				device->outEndpoint,(unsigned char*)buffer + offset,(int)size,Usb_OutCallback,
+				usbTransfer,0);
+			usbTransfer->completed = 0;
+			error = libusb_submit_transfer(usbTransfer->transfer);
+			if(error < 0)
+			{
+				usbTransfer->completed = 1;
+				status = Usb_Status(error);
+				break;
+			}
+			offset += size;
+			inFlight++;
+		}
+		if(0 == inFlight)
+			break;
+
+		usbTransfer = &device->out[oldest];
+		if(FT_OK == status)
+			status = Usb_Wait(&usbTransfer->completed,device->writeTimeout,start);
+		if((FT_OK == status) && !usbTransfer->completed)
+		{/* Timed out, nothing more is submitted and the transfers in flight are cancelled */
+			DBG(MSG_DEBUG,"write timed out after %u bytes\n",(unsigned)*bytesWritten);
+			offset = bytesToWrite;
+		}
+		if(!usbTransfer->completed)
+		{
+			libusb_cancel_transfer(usbTransfer->transfer);
+			Usb_Wait(&usbTransfer->completed,USB_CANCEL_TIMEOUT,Infra_GetTimeUs());
+			offset = bytesToWrite;
+		}
+		if(usbTransfer->completed)
+		{
+			*bytesWritten += usbTransfer->transfer->actual_length;
+			if(FT_OK == status)
+				status = usbTransfer->status;
+		}
+		oldest = (oldest+1)%USB_OUT_TRANSFERS;
+		inFlight--;
+		if(FT_OK != status)
+			offset = bytesToWrite;
+	}
+	return status;
+}
+
+/*!
+ * \brief Reads from a port
+ *
+ * The payload of the queued IN transfers is copied in the order they were submitted, and every
+ * transfer that has been emptied is submitted again.
+ *
+ * \param[in] handle Handle of the port
+ * \param[out] buffer Buffer the data is read into
+ * \param[in] bytesToRead Number of bytes to be read
+ * \param[out] bytesRead Number of bytes read
+ * \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide)
+ * \sa
+ * \note As with D2XX, FT_OK is returned with fewer bytes read when the read timeout expires
+ * \warning
+ */
+FT_STATUS Usb_Read(FT_HANDLE handle, LPVOID buffer, DWORD bytesToRead, LPDWORD bytesRead)
+{
+	FT_STATUS status=FT_OK;
+	Usb_Device *device=(Usb_Device*)handle;
+	Usb_Transfer *head;
+	uint64 start;
+	uint32 count;
+
+	*bytesRead = 0;
+	start = Infra_GetTimeUs();
+	while((FT_OK == status) && (*bytesRead < bytesToRead))
+	{
+		status = Usb_Recycle(device,FALSE);
+		if(FT_OK != status)
+			break;
+		head = &device->in[device->head];
+		if(!head->completed)
+		{
+			status = Usb_Wait(&head->completed,device->readTimeout,start);
+			if(!head->completed)
+				break;
+			continue;
+		}
+		count = head->end - head->offset;
+		if(count > bytesToRead - *bytesRead)
+			count = bytesToRead - *bytesRead;
+		INFRA_MEMCPY((uint8*)buffer + *bytesRead,
+			head->transfer->buffer + head->offset,count);
+		head->offset += count;
+		*bytesRead += count;
+	}
+	return status;
+}
+
+/*!
+ * \brief Returns the number of bytes that can be read without waiting
+ *
+ * \param[in] handle Handle of the port
+ * \param[out] amountInRxQueue Number of bytes received
+ * \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide)
+ * \sa
+ * \note The transfers that completed already are processed first
+ * \warning
+ */
+FT_STATUS Usb_GetQueueStatus(FT_HANDLE handle, LPDWORD amountInRxQueue)
+{
+	FT_STATUS status;
+	Usb_Device *device=(Usb_Device*)handle;
+	struct timeval tv={0,0};
+	uint32 i;
+	Usb_Transfer *usbTransfer;
+	int error;
+
+	*amountInRxQueue = 0;
+	error = libusb_handle_events_timeout_completed(Usb_Context,&tv,NULL);
+	if((error < 0) && (LIBUSB_ERROR_INTERRUPTED != error))
+		return Usb_Status(error);
+	status = Usb_Recycle(device,FALSE);
+	for(i=0; (FT_OK == status) && (i<USB_IN_TRANSFERS); i++)
+	{
+		usbTransfer = &device->in[(device->head+i)%USB_IN_TRANSFERS];
+		if(!usbTransfer->completed)
+			break;
+		*amountInRxQueue += usbTransfer->end - usbTransfer->offset;
+	}
+	return status;
+}
+
+/*!
+ * \brief Purges the buffers of a port
+ *
+ * \param[in] handle Handle of the port
+ * \param[in] mask FT_PURGE_RX and/or FT_PURGE_TX
+ * \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide)
+ * \sa
+ * \note Purging the receive buffer also drops the data of the IN transfers that completed
+ * \warning
+ */
+FT_STATUS Usb_Purge(FT_HANDLE handle, ULONG mask)
+{
+	FT_STATUS status=FT_OK;
+	Usb_Device *device=(Usb_Device*)handle;
+
+	if(mask & FT_PURGE_RX)
+	{
+		status = Usb_Control(device,USB_SIO_RESET,USB_SIO_TCIFLUSH);
+		if(FT_OK == status)
+			status = Usb_Recycle(device,TRUE);
+	}
+	if((FT_OK == status) && (mask & FT_PURGE_TX))
+		status = Usb_Control(device,USB_SIO_RESET,USB_SIO_TCOFLUSH);
+	return status;
+}
+
+FT_STATUS Usb_ResetDevice(FT_HANDLE handle)
+{
+	return Usb_Control((Usb_Device*)handle,USB_SIO_RESET,USB_SIO_RESET_SIO);
+}
+
+FT_STATUS Usb_SetBitMode(FT_HANDLE handle, UCHAR mask, UCHAR mode)
+{
+	return Usb_Control((Usb_Device*)handle,USB_SIO_SET_BITMODE,(uint16)((mode<<8) | mask));
+}
+
+FT_STATUS Usb_SetLatencyTimer(FT_HANDLE handle, UCHAR latency)
+{
+	return Usb_Control((Usb_Device*)handle,USB_SIO_SET_LATENCY_TIMER,latency);
+}
+
+/*!
+ * \brief Sets the size of the transfers
+ *
+ * \param[in] handle Handle of the port
+ * \param[in] inTransferSize Size of the IN transfers
+ * \param[in] outTransferSize Size of the OUT transfers
+ * \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide)
+ * \sa
+ * \note The sizes are rounded up to whole packets. The IN transfers that are queued already
+ * keep their size
+ * \warning
+ */
+FT_STATUS Usb_SetUSBParameters(FT_HANDLE handle, ULONG inTransferSize, ULONG outTransferSize)
+{
+	Usb_Device *device=(Usb_Device*)handle;
+
+	if((inTransferSize < USB_MIN_TRANSFER_SIZE) || (inTransferSize > USB_MAX_TRANSFER_SIZE) ||
+		(outTransferSize < USB_MIN_TRANSFER_SIZE) || (outTransferSize > USB_MAX_TRANSFER_SIZE))
+		return FT_INVALID_PARAMETER;
+	device->inTransferSize = (uint32)((inTransferSize + device->packetSize - 1) /
+		device->packetSize * device->packetSize);
+	if(device->inTransferSize > USB_MAX_TRANSFER_SIZE)
+		device->inTransferSize = USB_MAX_TRANSFER_SIZE;
+	device->outTransferSize = (uint32)outTransferSize;
+	return FT_OK;
+}
+
+FT_STATUS Usb_SetChars(FT_HANDLE handle, UCHAR eventCh, UCHAR eventChEn, UCHAR errorCh,
+	UCHAR errorChEn)
+{
+	FT_STATUS status;
+	Usb_Device *device=(Usb_Device*)handle;
+
+	status = Usb_Control(device,USB_SIO_SET_EVENT_CHAR,(uint16)(eventCh | (eventChEn?0x100:0)));
+	if(FT_OK == status)
+		status = Usb_Control(device,USB_SIO_SET_ERROR_CHAR,
+			(uint16)(errorCh | (errorChEn?0x100:0)));
+	return status;
+}
+
+FT_STATUS Usb_SetTimeouts(FT_HANDLE handle, ULONG readTimeout, ULONG writeTimeout)
+{
+	Usb_Device *device=(Usb_Device*)handle;
+
+	device->readTimeout = (uint32)readTimeout;
+	device->writeTimeout = (uint32)writeTimeout;
+	return FT_OK;
+}
+
+FT_STATUS Usb_GetDeviceInfo(FT_HANDLE handle, FT_DEVICE *ftDevice, LPDWORD deviceID,
+	PCHAR serialNumber, PCHAR description)
+{
+	Usb_Device *device=(Usb_Device*)handle;
+
+	if(NULL != ftDevice)
+		*ftDevice = (FT_DEVICE)device->info.Type;
+	if(NULL != deviceID)
+		*deviceID = device->info.ID;
+	if(NULL != serialNumber)
+		strcpy(serialNumber,device->info.SerialNumber);
+	if(NULL != description)
+		strcpy(description,device->info.Description);
+	return FT_OK;
+}
+
+/*!
+ * \brief Maps an error code of libusb to a status code
+ *
+ * \param[in] error Error code of libusb(LIBUSB_ERROR_*), or a number of bytes
+ * \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide)
+ * \sa
+ * \note
+ * \warning
+ */
+FT_STATUS Usb_Status(int error)
+{
+	switch(error)
+	{
+		case LIBUSB_ERROR_NO_DEVICE:
+		case LIBUSB_ERROR_NOT_FOUND:
+			return FT_DEVICE_NOT_FOUND;
+		case LIBUSB_ERROR_ACCESS:
+		case LIBUSB_ERROR_BUSY:
+			return FT_DEVICE_NOT_OPENED;
+		case LIBUSB_ERROR_NO_MEM:
+			return FT_INSUFFICIENT_RESOURCES;
+		case LIBUSB_ERROR_INVALID_PARAM:
+			return FT_INVALID_PARAMETER;
+		default:
+			return (error < 0) ? FT_IO_ERROR : FT_OK;
+	}
+}
+
+/*!
+ * \brief Creates the context of libusb if it doesn't exist yet
+ *
+ * \param none
+ * \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide)
+ * \sa
+ * \note The context lives as long as the library
+ * \warning To be called with the lock taken(Infra_Lock)
+ */
+FT_STATUS Usb_Init(void)
+{
+	int error;
+
+	if(NULL != Usb_Context)
+		return FT_OK;
+	error = libusb_init(&Usb_Context);
+	if(error < 0)
+	{
+		DBG(MSG_ERR,"libusb_init failed(%d)\n",error);
+		Usb_Context = NULL;
+	}
+	return Usb_Status(error);
+}
+
+/*!
+ * \brief Finds the ports of the supported chips
+ *
+ * The information of the ports is filled in the way D2XX does it: the serial number and the
+ * description of each port of a multi port chip end with the letter of the port, and the
+ * location ID is made up of the bus number, the device address and the port number.
+ *
+ * \param[out] ports Array of the ports, to be freed with Usb_FreePorts
+ * \param[out] numPorts Number of ports
+ * \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide)
+ * \sa
+ * \note The default description of the chip is used if the string descriptors can't be read,
+ * e.g. for lack of permissions
+ * \warning
+ */
+FT_STATUS Usb_Enumerate(Usb_Port **ports, uint32 *numPorts)
+{
+	libusb_device **list;
+	libusb_device_handle *usbHandle;
+	struct libusb_device_descriptor descriptor;
+	FT_DEVICE_LIST_INFO_NODE info;
+	Usb_Port *port;
+	const char *name;
+	ssize_t count;
+	ssize_t i;
+	uint32 numInterfaces;
+	uint32 j;
+	size_t len;
+
+	*ports = NULL;
+	*numPorts = 0;
+	count = libusb_get_device_list(Usb_Context,&list);
+	if(count < 0)
+		return Usb_Status((int)count);
+	*ports = (Usb_Port*)INFRA_MALLOC(sizeof(Usb_Port)*USB_MAX_INTERFACES*(count+1));
+	if(NULL == *ports)
+	{
+		libusb_free_device_list(list,1);
+		return FT_INSUFFICIENT_RESOURCES;
+	}
+	for(i=0; i<count; i++)
+	{
+		if((0 != libusb_get_device_descriptor(list[i],&descriptor)) ||
+			(USB_VENDOR_FTDI != descriptor.idVendor))
+			continue;
+		memset(&info,0,sizeof(info));
+		if((USB_PRODUCT_2232 == descriptor.idProduct) && (USB_BCD_2232D == descriptor.bcdDevice))
+		{
+			info.Type = FT_DEVICE_2232C;
+			name = "Dual RS232";
+			numInterfaces = 2;
+		}
+		else if((USB_PRODUCT_2232 == descriptor.idProduct) &&
+			(USB_BCD_2232H == descriptor.bcdDevice))
+		{
+			info.Type = FT_DEVICE_2232H;
+			name = "Dual RS232-HS";
+			numInterfaces = 2;
+		}
+		else if((USB_PRODUCT_4232 == descriptor.idProduct) &&
+			(USB_BCD_4232H == descriptor.bcdDevice))
+		{
+			info.Type = FT_DEVICE_4232H;
+			name = "Quad RS232-HS";
+			numInterfaces = 4;
+		}
+		else if((USB_PRODUCT_232H == descriptor.idProduct) &&
+			(USB_BCD_232H == descriptor.bcdDevice))
+		{
+			info.Type = FT_DEVICE_232H;
+			name = "Single RS232-HS";
+			numInterfaces = 1;
+		}
+		else
+			continue;
+		if(FT_DEVICE_2232C != info.Type)
+			info.Flags = FT_FLAGS_HISPEED;
+		info.ID = ((ULONG)descriptor.idVendor << 16) | descriptor.idProduct;
+		strcpy(info.Description,name);
+		if(0 == libusb_open(list[i],&usbHandle))
+		{
+			if(descriptor.iSerialNumber)
+				libusb_get_string_descriptor_ascii(usbHandle,descriptor.iSerialNumber,
+					(unsigned char*)info.SerialNumber,sizeof(info.SerialNumber)-1);
+			if(descriptor.iProduct)
+				libusb_get_string_descriptor_ascii(usbHandle,descriptor.iProduct,
+					(unsigned char*)info.Description,sizeof(info.Description)-2);
+			libusb_close(usbHandle);
+		}
+
+		for(j=0; j<numInterfaces; j++)
+		{
+			port = &(*ports)[*numPorts];
+			INFRA_MEMCPY(&port->info,&info,sizeof(info));
+			port->info.LocId = ((DWORD)libusb_get_bus_number(list[i]) << 12) |
+				((DWORD)libusb_get_device_address(list[i]) << 4) | (j+1);
+			if(numInterfaces > 1)
+			{
+				len = strlen(port->info.SerialNumber);
+				if((len > 0) && (len < sizeof(port->info.SerialNumber)-1))
+				{
+					port->info.SerialNumber[len] = (char)('A'+j);
+					port->info.SerialNumber[len+1] = '\0';
+				}
+				len = strlen(port->info.Description);
+				port->info.Description[len] = ' ';
+				port->info.Description[len+1] = (char)('A'+j);
+				port->info.Description[len+2] = '\0';
+			}
+			port->device = libusb_ref_device(list[i]);
+			port->interface = (uint8)j;
+			(*numPorts)++;
+		}
+	}
+	libusb_free_device_list(list,1);
+	DBG(MSG_DEBUG,"%u ports\n",(unsigned)*numPorts);
+	return FT_OK;
+}
+
+/*!
+ * \brief Frees the ports found by Usb_Enumerate
+ *
+ * \param[in] ports Array of the ports, may be NULL
+ * \param[in] numPorts Number of ports
+ * \return none
+ * \sa
+ * \note
+ * \warning
+ */
+void Usb_FreePorts(Usb_Port *ports, uint32 numPorts)
+{
+	uint32 i;
+
+	if(NULL == ports)
+		return;
+	for(i=0; i<numPorts; i++)
+		libusb_unref_device(ports[i].device);
+	INFRA_FREE(ports);
+}
+
+/*!
+ * \brief Opens a port
+ *
+ * This function claims the interface of the port, resets the port and queues the IN transfers
+ *
+ * \param[in] port Port to be opened
+ * \param[out] handle Pointer to the handle
+ * \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide)
+ * \sa
+ * \note The kernel driver(ftdi_sio) is detached from the interface while it is claimed
+ * \warning
+ */
+FT_STATUS Usb_OpenPort(const Usb_Port *port, FT_HANDLE *handle)
+{
+	FT_STATUS status=FT_OK;
+	Usb_Device *device;
+	int packetSize;
+	int error;
+	uint32 i;
+	FN_ENTER;
+
+	device = (Usb_Device*)INFRA_MALLOC(sizeof(Usb_Device));
+	if(NULL == device)
+		return FT_INSUFFICIENT_RESOURCES;
+	memset(device,0,sizeof(Usb_Device));
+	device->interface = port->interface;
+	device->index = (uint16)(port->interface + 1);
+	device->inEndpoint = (uint8)(LIBUSB_ENDPOINT_IN | (2*port->interface + 1));
+	device->outEndpoint = (uint8)(LIBUSB_ENDPOINT_OUT | (2*port->interface + 2));
+	device->inTransferSize = USB_DEFAULT_TRANSFER_SIZE;
+	device->outTransferSize = USB_DEFAULT_TRANSFER_SIZE;
+	device->readTimeout = USB_DEFAULT_TIMEOUT;
+	device->writeTimeout = USB_DEFAULT_TIMEOUT;
+	INFRA_MEMCPY(&device->info,&port->info,sizeof(FT_DEVICE_LIST_INFO_NODE));
+	packetSize = libusb_get_max_packet_size(port->device,device->inEndpoint);
+	device->packetSize = (packetSize > USB_STATUS_SIZE) ? (uint32)packetSize :
+		USB_MIN_TRANSFER_SIZE;
+	for(i=0; i<USB_IN_TRANSFERS; i++)
+	{
+		device->in[i].device = device;
+		device->in[i].completed = 1;
+		device->in[i].transfer = libusb_alloc_transfer(0);
+		if(NULL != device->in[i].transfer)
+		{
+			device->in[i].transfer->buffer = (unsigned char*)INFRA_MALLOC(USB_MAX_TRANSFER_SIZE);
+			if(NULL == device->in[i].transfer->buffer)
+				status = FT_INSUFFICIENT_RESOURCES;
+		}
+		else
+			status = FT_INSUFFICIENT_RESOURCES;
+	}
+	for(i=0; i<USB_OUT_TRANSFERS; i++)
+	{
+		device->out[i].device = device;
+		device->out[i].completed = 1;
+		device->out[i].transfer = libusb_alloc_transfer(0);
+		if(NULL == device->out[i].transfer)
+			status = FT_INSUFFICIENT_RESOURCES;
+	}
+
+	if(FT_OK == status)
+	{
+		error = libusb_open(port->device,&device->usbHandle);
+		if(0 == error)
+		{
+			libusb_set_auto_detach_kernel_driver(device->usbHandle,1);
+			error = libusb_claim_interface(device->usbHandle,device->interface);
+			if(0 != error)
+			{
+				libusb_close(device->usbHandle);
+				device->usbHandle = NULL;
+			}
+		}
+		status = Usb_Status(error);
+	}
+	if(FT_OK == status)
+		status = Usb_Control(device,USB_SIO_RESET,USB_SIO_RESET_SIO);
+	for(i=0; (FT_OK == status) && (i<USB_IN_TRANSFERS); i++)
+		status = Usb_Submit(&device->in[i]);
+
+	if(FT_OK == status)
+	{
+		*handle = (FT_HANDLE)device;
+		DBG(MSG_DEBUG,"opened %s, %u byte packets\n",device->info.Description,
+			(unsigned)device->packetSize);
+	}
+	else
+	{
+		DBG(MSG_ERR,"failed to open %s\n",port->info.Description);
+		Usb_FreeDevice(device);
+	}
+	FN_EXIT;
+	return status;
+}
+
+/*!
+ * \brief Releases an open port
+ *
+ * \param[in] device The port, partially opened ones included
+ * \return none
+ * \sa
+ * \note
+ * \warning
+ */
+void Usb_FreeDevice(Usb_Device *device)
+{
+	uint32 i;
+
+	for(i=0; i<USB_IN_TRANSFERS; i++)
+	{
+		if(!device->in[i].completed)
+			libusb_cancel_transfer(device->in[i].transfer);
+	}
+	for(i=0; i<USB_IN_TRANSFERS; i++)
+	{
+		if(!device->in[i].completed)
+			Usb_Wait(&device->in[i].completed,USB_CANCEL_TIMEOUT,Infra_GetTimeUs());
+		if(NULL != device->in[i].transfer)
+		{
+			INFRA_FREE(device->in[i].transfer->buffer);
+			libusb_free_transfer(device->in[i].transfer);
+		}
+	}
+	for(i=0; i<USB_OUT_TRANSFERS; i++)
+	{
+		if(NULL != device->out[i].transfer)
+			libusb_free_transfer(device->out[i].transfer);
+	}
+	if(NULL != device->usbHandle)
+	{
+		libusb_release_interface(device->usbHandle,device->interface);
+		libusb_close(device->usbHandle);
+	}
+	INFRA_FREE(device);
+}
+
+/*!
+ * \brief Sends a vendor request to the port
+ *
+ * \param[in] device The port
+ * \param[in] request Request(USB_SIO_*)
+ * \param[in] value Value of the request
+ * \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide)
+ * \sa
+ * \note
+ * \warning
+ */
+FT_STATUS Usb_Control(Usb_Device *device, uint8 request, uint16 value)
+{
+	int error;
+
+	error = libusb_control_transfer(device->usbHandle,USB_REQUEST_TYPE_OUT,request,value,
+		device->index,NULL,0,USB_CONTROL_TIMEOUT);
+	if(error < 0)
+	{
+		DBG(MSG_ERR,"request 0x%x failed(%d)\n",(unsigned)request,error);
+	}
+	return Usb_Status(error);
+}
+
+/*!
+ * \brief Handles the events of libusb until a transfer completes
+ *
+ * \param[in] completed Pointer to the completed flag of the transfer
+ * \param[in] timeout Time in milliseconds from start after which waiting is given up, 0 to wait
+ *			as long as it takes
+ * \param[in] start Time(Infra_GetTimeUs) the timeout is counted from
+ * \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide)
+ * \sa
+ * \note FT_OK is returned on timeout, the caller checks the completed flag
+ * \warning
+ */
+FT_STATUS Usb_Wait(int *completed, uint32 timeout, uint64 start)
+{
+	struct timeval tv;
+	uint64 elapsed;
+	uint64 left;
+	int error;
+
+	while(!*completed)
+	{
+		left = USB_EVENT_SLICE;
+		if(0 != timeout)
+		{
+			elapsed = Infra_GetTimeUs() - start;
+			if(elapsed >= (uint64)timeout*1000)
+				break;
+			if((uint64)timeout*1000 - elapsed < left)
+				left = (uint64)timeout*1000 - elapsed;
+		}
+		tv.tv_sec = (long)(left/1000000);
+		tv.tv_usec = (long)(left%1000000);
+		error = libusb_handle_events_timeout_completed(Usb_Context,&tv,completed);
+		if((error < 0) && (LIBUSB_ERROR_INTERRUPTED != error))
+			return Usb_Status(error);
+	}
+	return FT_OK;
+}
+
+/*!
+ * \brief Queues an IN transfer
+ *
+ * \param[in] usbTransfer The transfer
+ * \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide)
+ * \sa
+ * \note
+ * \warning
+ */
+FT_STATUS Usb_Submit(Usb_Transfer *usbTransfer)
+{
+	Usb_Device *device=usbTransfer->device;
+	int error;
+
+	libusb_fill_bulk_transfer(usbTransfer->transfer,device->usbHandle,device->inEndpoint,
+		usbTransfer->transfer->buffer,(int)device->inTransferSize,Usb_InCallback,usbTransfer,0);
+	usbTransfer->offset = 0;
+	usbTransfer->end = 0;
+	usbTransfer->completed = 0;
+	error = libusb_submit_transfer(usbTransfer->transfer);
+	if(error < 0)
+	{
+		usbTransfer->completed = 1;
+		DBG(MSG_ERR,"submitting failed(%d)\n",error);
+	}
+	return Usb_Status(error);
+}
+
+/*!
+ * \brief Queues again the IN transfers that have been consumed
+ *
+ * Starting at the head, every completed transfer without payload left is submitted again, until
+ * a transfer is found that is in flight or holds payload.
+ *
+ * \param[in] device The port
+ * \param[in] drop TRUE to drop the payload of the completed transfers
+ * \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide). The error of a
+ *		failed transfer is returned once
+ * \sa
+ * \note
+ * \warning
+ */
+FT_STATUS Usb_Recycle(Usb_Device *device, bool drop)
+{
+	FT_STATUS status=FT_OK;
+	Usb_Transfer *head;
+	uint32 i;
+
+	for(i=0; (FT_OK == status) && (i<USB_IN_TRANSFERS); i++)
+	{
+		head = &device->in[device->head];
+		if(!head->completed || (!drop && (head->offset != head->end)))
+			break;
+		status = head->status;
+		head->status = FT_OK;
+		if(FT_OK == status)
+			status = Usb_Submit(head);
+		else
+			Usb_Submit(head);
+		device->head = (device->head+1)%USB_IN_TRANSFERS;
+	}
+	return status;
+}
+
+/*!
+ * \brief Completion of an IN transfer
+ *
+ * This function strips the modem status bytes from the packets of the transfer. The payload of
+ * the first packet is left where it is and the payload of the following ones is moved down to
+ * follow it, so that a transfer of a single packet, the usual case for short replies, isn't
+ * copied at all.
+ *
+ * \param[in] transfer The transfer
+ * \return none
+ * \sa
+ * \note Called by libusb from within libusb_handle_events_timeout_completed
+ * \warning
+ */
+void LIBUSB_CALL Usb_InCallback(struct libusb_transfer *transfer)
+{
+	Usb_Transfer *usbTransfer=(Usb_Transfer*)transfer->user_data;
+	uint32 packetSize=usbTransfer->device->packetSize;
+	uint32 actual=(uint32)transfer->actual_length;
+	uint32 src;
+	uint32 count;
+	uint32 end=USB_STATUS_SIZE;
+
+	if((LIBUSB_TRANSFER_COMPLETED == transfer->status) ||
+		(LIBUSB_TRANSFER_CANCELLED == transfer->status))
+		usbTransfer->status = FT_OK;
+	else if(LIBUSB_TRANSFER_NO_DEVICE == transfer->status)
+		usbTransfer->status = FT_DEVICE_NOT_FOUND;
+	else
+		usbTransfer->status = FT_IO_ERROR;
+
+	for(src=0; src<actual; src+=packetSize)
+	{
+		count = actual - src;
+		if(count > packetSize)
+			count = packetSize;
+		if(count <= USB_STATUS_SIZE)
+			continue;
+		count -= USB_STATUS_SIZE;
+		if(end != src + USB_STATUS_SIZE)
+			memmove(&transfer->buffer[end],&transfer->buffer[src + USB_STATUS_SIZE],count);
+		end += count;
+	}
+	usbTransfer->offset = USB_STATUS_SIZE;
+	usbTransfer->end = end;
+	usbTransfer->completed = 1;
+}
+
+/*!
+ * \brief Completion of an OUT transfer
+ *
+ * \param[in] transfer The transfer
+ * \return none
+ * \sa
+ * \note Called by libusb from within libusb_handle_events_timeout_completed
+ * \warning
+ */
+void LIBUSB_CALL Usb_OutCallback(struct libusb_transfer *transfer)
+{
+	Usb_Transfer *usbTransfer=(Usb_Transfer*)transfer->user_data;
+
+	if((LIBUSB_TRANSFER_COMPLETED == transfer->status) ||
+		(LIBUSB_TRANSFER_CANCELLED == transfer->status))
+		usbTransfer->status = FT_OK;
+	else if(LIBUSB_TRANSFER_NO_DEVICE == transfer->status)
+		usbTransfer->status = FT_DEVICE_NOT_FOUND;
+	else
+		usbTransfer->status = FT_IO_ERROR;
+	usbTransfer->completed = 1;
+}
+
@@ -0,0 +1,139 @@
+/*!
+ * \file ftdi_libusb.h
+ *
+ * \author FTDI
+ * \date 20261018
+ *
+ * Copyright (C) 2000-2014 Future Technology Devices International Limited
+ *
+ *
+ * THIS SOFTWARE IS PROVIDED BY FUTURE TECHNOLOGY DEVICES INTERNATIONAL LIMITED ``AS IS'' AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL FUTURE TECHNOLOGY DEVICES INTERNATIONAL LIMITED
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Project: libMPSSE
+ * Module: Libusb
+ *
+ * Rivision History:
+ * 0.1 - initial version
+ */
+
+#ifndef FTDI_LIBUSB_H
+#define FTDI_LIBUSB_H
+
+#include <libusb.h>
+#include "ftdi_backend.h"
+
+
+/******************************************************************************/
+/*								Macro defines								  */
+/******************************************************************************/
+#define USB_VENDOR_FTDI					0x0403
+#define USB_PRODUCT_2232				0x6010	/* FT2232D, FT2232H */
+#define USB_PRODUCT_4232				0x6011	/* FT4232H */
+#define USB_PRODUCT_232H				0x6014	/* FT232H */
+
+/* bcdDevice of the chips, it tells the FT2232D from the FT2232H */
+#define USB_BCD_2232D					0x0500
+#define USB_BCD_2232H					0x0700
+#define USB_BCD_4232H					0x0800
+#define USB_BCD_232H					0x0900
+
+/* Largest number of interfaces(ports) of a chip */
+#define USB_MAX_INTERFACES				4
+
+/* Vendor requests of the chips, sent to the port(wIndex) with bmRequestType out/vendor/device */
+#define USB_REQUEST_TYPE_OUT			0x40
+#define USB_SIO_RESET					0x00
+#define USB_SIO_SET_EVENT_CHAR			0x06
+#define USB_SIO_SET_ERROR_CHAR			0x07
+#define USB_SIO_SET_LATENCY_TIMER		0x09
+#define USB_SIO_SET_BITMODE				0x0B
+/* Values of USB_SIO_RESET. TCIFLUSH drops the data on its way to the host, TCOFLUSH the data on
+its way to the chip */
+#define USB_SIO_RESET_SIO				0
+#define USB_SIO_TCOFLUSH				1
+#define USB_SIO_TCIFLUSH				2
+
+/* Every bulk IN packet starts with two bytes of modem status */
+#define USB_STATUS_SIZE					2
+
+/* Number of bulk transfers kept queued on the IN endpoint, and in flight on the OUT endpoint */
+#define USB_IN_TRANSFERS				4
+#define USB_OUT_TRANSFERS				4
+/* Bounds of the transfer sizes set by FT_SetUSBParameters, and their initial value */
+#define USB_MIN_TRANSFER_SIZE			64
+#define USB_MAX_TRANSFER_SIZE			65536
+#define USB_DEFAULT_TRANSFER_SIZE		4096
+
+/* Timeouts in milliseconds of the control requests, of the reads and writes until
+FT_SetTimeouts is called, and of the cancelling of the IN transfers on close */
+#define USB_CONTROL_TIMEOUT				1000
+#define USB_DEFAULT_TIMEOUT				5000
+#define USB_CANCEL_TIMEOUT				1000
+/* Longest time in microseconds events are waited for at once, so that a wait without timeout
+still notices errors */
+#define USB_EVENT_SLICE					100000
+
+
+/******************************************************************************/
+/*								Type defines								  */
+/******************************************************************************/
+
+/* A bulk transfer of a port. The payload of an IN transfer is buffer[offset] to buffer[end], the
+modem status bytes having been stripped on completion */
+typedef struct Usb_Transfer_t
+{
+	struct libusb_transfer	*transfer;
+	struct Usb_Device_t		*device;
+	uint32					offset;
+	uint32					end;
+	/* Nonzero when the transfer is not in flight */
+	int						completed;
+	/* Status of the last completion */
+	FT_STATUS				status;
+}Usb_Transfer;
+
+/* A port found by the enumeration */
+typedef struct Usb_Port_t
+{
+	libusb_device			*device;
+	uint8					interface;
+	FT_DEVICE_LIST_INFO_NODE info;
+}Usb_Port;
+
+/* An open port, its address is the handle of the channel */
+typedef struct Usb_Device_t
+{
+	libusb_device_handle	*usbHandle;
+	uint8					interface;
+	uint8					inEndpoint;
+	uint8					outEndpoint;
+	/* wIndex of the vendor requests */
+	uint16					index;
+	uint32					packetSize;
+	FT_DEVICE_LIST_INFO_NODE info;
+	/* The IN transfers are submitted and consumed in turn, head is the next one to be consumed */
+	Usb_Transfer			in[USB_IN_TRANSFERS];
+	uint32					head;
+	Usb_Transfer			out[USB_OUT_TRANSFERS];
+	uint32					inTransferSize;
+	uint32					outTransferSize;
+	uint32					readTimeout;
+	uint32					writeTimeout;
+}Usb_Device;
+
+
+/******************************************************************************/
+/*								External variables							  */
+/******************************************************************************/
+/* The libusb-1.0 backend */
+extern const Backend_Ops Backend_Libusb;
+
+#endif /* FTDI_LIBUSB_H */
+
@@ -35,6 +35,7 @@
 #include "ftdi_infra.h"		/*Common portable infrastructure(datatypes, libraries, etc)*/
 #include "ftdi_common.h"	/*Common across I2C, SPI, JTAG modules*/
 #include "ftdi_mid.h"		/*Midlayer specific specific*/
+#include "ftdi_backend.h"	/*Transport backends*/
 #include "string.h"
 
 /******************************************************************************/
@@ -47,7 +48,13 @@
 /******************************************************************************/
 /*								Local function declarations					  */
 /******************************************************************************/
-
+FT_STATUS Mid_RefreshChannels(void);
+FT_STATUS Mid_FastInit(FT_HANDLE handle, FT_DEVICE ftDevice, uint32 clockRate,
+	uint32 latencyTimer);
+FT_STATUS Mid_WaitForEcho(FT_HANDLE handle, UCHAR *command, DWORD length, UCHAR ecoCmd,
+	uint32 timeout, bool *echoed);
+FT_STATUS Mid_ApplyProfile(FT_HANDLE handle, const FT_TransportProfile *profile);
+FT_STATUS Mid_MeasureTransport(FT_HANDLE handle, FT_TransportProfile *profile);
 
 
 
@@ -55,6 +62,19 @@
 /*								Global variables							  */
 /******************************************************************************/
 
+/* Snapshot of the devices connected to the host system, taken by Mid_RefreshChannels */
+static FT_DEVICE_LIST_INFO_NODE *Mid_DeviceList=NULL;
+/* Index in Mid_DeviceList of each channel that has an MPSSE */
+static uint32 *Mid_ChannelMap=NULL;
+static uint32 Mid_NumChannels=MID_NO_CHANNEL_FOUND;
+static bool Mid_SnapshotValid=FALSE;
+/* Backend the snapshot was taken with, the channels of the snapshot are opened with it */
+static const Backend_Ops *Mid_SnapshotBackend=NULL;
+
+/* Candidate settings tried by FT_CalibrateChannel */
+static const uint8 Mid_LatencyTimers[] = {1, 2, 4, 8, 16};
+static const uint32 Mid_TransferSizes[] = {512, 4096, 65536};
+
 
 
 /******************************************************************************/
@@ -84,66 +104,15 @@
  */
 FT_STATUS FT_GetNumChannels(FT_LegacyProtocol Protocol, uint32 *numChans)
 {
-	DWORD tempNumChannels;
-	FT_DEVICE_LIST_INFO_NODE *pDeviceList;
-	FT_DEVICE_LIST_INFO_NODE deviceList;
-
 	FT_STATUS status;
-	uint32 devLoop = MID_NO_CHANNEL_FOUND;
-	//bool ret;
-
 	FN_ENTER;
-	/*initalize *numChansto 0 */
-	*numChans = MID_NO_CHANNEL_FOUND;
-	/*Get the number of devices connected to the system(FT_CreateDeviceInfoList)*/
-	status = FT_CreateDeviceInfoList(&tempNumChannels);
-//	printf("\n status=0x%x     tempNumChannels=%d\n",status,tempNumChannels);
-	/*Check if the status is Ok */
-	if(status == FT_OK)
-	{
-
-		/*Check if No of channel is greater than 0*/
-		if(tempNumChannels > MID_NO_CHANNEL_FOUND)
-		{
-			/*Allocate space for getting the information about the device (based on
-			number of devices)*/
-			pDeviceList = INFRA_MALLOC(sizeof(FT_DEVICE_LIST_INFO_NODE)\
-				*tempNumChannels);
-			if(NULL == pDeviceList)
-			{
-				return FT_INSUFFICIENT_RESOURCES;
-			}
-			/*get the devices information(FT_GetDeviceInfoList)*/
-			status = FT_GetDeviceInfoList(pDeviceList,\
-				&tempNumChannels);
-			while(devLoop < tempNumChannels)
-			{
-				deviceList = pDeviceList[devLoop];
-				/*check if device is I2C*/
-				//ret = midCheckI2C(deviceList);
-				if(Mid_CheckMPSSEAvailable(deviceList))
-				{
-					/*increment *numChans*/
-					*numChans = *numChans + 1;
-				}
-				devLoop++;
-			}
-			INFRA_FREE(pDeviceList);
-		}
-		else
-		{
-			*numChans = tempNumChannels;
-			//resource Not found		MID_T0DO
-        }
-	}
-	else
-	{
-		*numChans = tempNumChannels;
-	}
-	/*return status*/
+	/* this is where the application looks at what is connected, so the snapshot is retaken */
+	Infra_Lock();
+	status = Mid_RefreshChannels();
+	*numChans = Mid_NumChannels;
+	Infra_Unlock();
 	FN_EXIT;
 	return status;
-
 }
 
 
@@ -160,68 +129,30 @@ FT_STATUS FT_GetNumChannels(FT_LegacyProtocol Protocol, uint32 *numChans)
  * \return status
  * \sa
  * \note memory should be allocated and freed by caller
+ * \note The information comes from the snapshot taken by the last FT_GetNumChannels, the devices
+ * are only enumerated if there is no snapshot yet
  * \warning
  */
 FT_STATUS FT_GetChannelInfo(FT_LegacyProtocol Protocol, uint32 index,
 			FT_DEVICE_LIST_INFO_NODE *chanInfo)
 {
-	DWORD tempNumChannels;
-	uint32 channelCount;
-	FT_DEVICE_LIST_INFO_NODE *pDeviceList;
-	FT_DEVICE_LIST_INFO_NODE deviceList;
-
-	FT_STATUS status;
-	uint32 devLoop = MID_NO_CHANNEL_FOUND;
-
+	FT_STATUS status=FT_OK;
 	FN_ENTER;
 
-	/*initalize *numChansto 0 */
-	channelCount = MID_NO_CHANNEL_FOUND;
-
-	/*Get the number of devices connected to the system(FT_CreateDeviceInfoList)*/
-	status = FT_CreateDeviceInfoList(&tempNumChannels);
-	CHECK_STATUS(status);
-
-	/*Check if No of channel is greater than 0*/
-	if(tempNumChannels >= index)
+	Infra_Lock();
+	if(!Mid_SnapshotValid)
+		status = Mid_RefreshChannels();
+	if((FT_OK == status) && ((MID_NO_CHANNEL_FOUND == index) || (index > Mid_NumChannels)))
 	{
-		/*Allocate space for getting the information about the device (based on
-		number of devices)*/
-		pDeviceList = INFRA_MALLOC(sizeof(FT_DEVICE_LIST_INFO_NODE)\
-			*tempNumChannels);
-		if(NULL == pDeviceList)
-		{
-			return FT_INSUFFICIENT_RESOURCES;
-		}
-
-		/*get the devices information(FT_GetDeviceInfoList)*/
-		status = FT_GetDeviceInfoList(pDeviceList,\
-			&tempNumChannels);
-		CHECK_STATUS(status);
-
-		while(devLoop < tempNumChannels)
-		{
-			deviceList = pDeviceList[devLoop];
-			if(Mid_CheckMPSSEAvailable(deviceList))
-			{
-				/*increment *numChans*/
-				channelCount++;
-			}
-			/*check if the index matches the I2C channel count*/
-			if(channelCount == index)
-			{
-				INFRA_MEMCPY(chanInfo,&deviceList,sizeof(FT_DEVICE_LIST_INFO_NODE));
-				break;
-			}
-			devLoop++;
-		}
-		INFRA_FREE(pDeviceList);
+		/* The index of the device is greater than the max number of devices available */
+		status = FT_INVALID_HANDLE;
 	}
-	else
+	if(FT_OK == status)
 	{
-		/* The index of the device is greater than the max number of devices available */
-		return FT_INVALID_HANDLE;
+		INFRA_MEMCPY(chanInfo,&Mid_DeviceList[Mid_ChannelMap[index-1]],
+			sizeof(FT_DEVICE_LIST_INFO_NODE));
 	}
+	Infra_Unlock();
 	FN_EXIT;
 
 	/*return status*/
@@ -238,71 +169,41 @@ FT_STATUS FT_GetChannelInfo(FT_LegacyProtocol Protocol, uint32 index,
  * \param[in] index Index of the channel
  * \param[out] handle Pointer to the handle
  * \return status
- * \sa
+ * \sa FT_OpenChannelEx
  * \note Trying to open an already open channel will return an error code
+ * \note The index refers to the snapshot taken by the last FT_GetNumChannels, the devices are
+ * only enumerated if there is no snapshot yet
  * \warning
  */
 FT_STATUS FT_OpenChannel(FT_LegacyProtocol Protocol, uint32 index,
 			FT_HANDLE *handle)
 {
-	/* Opens a channel and returns the pointer to its handle */
-	DWORD tempNumChannels;
-	uint32 channelCount;
-	FT_DEVICE_LIST_INFO_NODE *pDeviceList;
-	FT_DEVICE_LIST_INFO_NODE deviceList;
-
-	FT_STATUS status;
-	uint32 devLoop = MID_NO_CHANNEL_FOUND;
+	FT_STATUS status=FT_OK;
+	uint32 devIndex=0;
+	const Backend_Ops *ops=NULL;
 	FN_ENTER;
 
-	/*initalize *numChansto 0 */
-	channelCount = MID_NO_CHANNEL_FOUND;
-
-	/*Get the number of devices connected to the system(FT_CreateDeviceInfoList)*/
-	status = FT_CreateDeviceInfoList(&tempNumChannels);
-	CHECK_STATUS(status);
-
-	/*Check if No of channel is greater than 0*/
-	if(tempNumChannels >= index)
+	Infra_Lock();
+	if(!Mid_SnapshotValid)
+		status = Mid_RefreshChannels();
+	if((FT_OK == status) && ((MID_NO_CHANNEL_FOUND == index) || (index > Mid_NumChannels)))
 	{
-		/*Allocate space for getting the information about the device (based on
-		number of devices)*/
-		pDeviceList = INFRA_MALLOC(sizeof(FT_DEVICE_LIST_INFO_NODE)\
-			*tempNumChannels);
-		if(NULL == pDeviceList)
-		{
-			return FT_INSUFFICIENT_RESOURCES;
-		}
-		/*get the devices information(FT_GetDeviceInfoList)*/
-		status = FT_GetDeviceInfoList(pDeviceList,\
-			&tempNumChannels);
-		CHECK_STATUS(status);
-
-		/*loop until No of devices */
-		while(devLoop < tempNumChannels)
-		{
-			deviceList = pDeviceList[devLoop];
-			/*check if device is I2C*/
-			if(Mid_CheckMPSSEAvailable(deviceList))
-			{
-				/*increment *numChans*/
-				channelCount++;
-			}
-			/*check if the index matches the I2C channel count*/
-			if(channelCount == index)
-			{
-				/*call FT_Open*/
-				status = FT_Open(devLoop,handle);
-				break;
-			}
-			devLoop++;
-		}
-		INFRA_FREE(pDeviceList);
+		/* The index of the device is greater than the max number of devices available */
+		status = FT_INVALID_HANDLE;
 	}
-	else
+	if(FT_OK == status)
 	{
-		/* The index of the device is greater than the max number of devices available */
-		return FT_INVALID_HANDLE;
+		devIndex = Mid_ChannelMap[index-1];
+		ops = Mid_SnapshotBackend;
+	}
+	Infra_Unlock();
+	if(FT_OK == status)
+		status = ops->open(devIndex,handle);
+	if(FT_OK == status)
+	{
+		status = Backend_Attach(*handle,ops);
+		if(FT_OK != status)
+			ops->close(*handle);
 	}
 	FN_EXIT;
 	/*return status*/
@@ -310,6 +211,43 @@ FT_STATUS FT_OpenChannel(FT_LegacyProtocol Protocol, uint32 index,
 }
 
 
+/*!
+ * \brief Opens a channel by its serial number, description or location
+ *
+ * This function opens the channel with FT_OpenEx of the selected backend, without enumerating
+ * the devices
+ *
+ * \param[in] Protocol Specifies the protocol type(I2C/SPI/JTAG)
+ * \param[in] arg Serial number or description(string), or location ID(cast to a pointer)
+ * \param[in] flags FT_OPEN_BY_SERIAL_NUMBER, FT_OPEN_BY_DESCRIPTION or FT_OPEN_BY_LOCATION
+ * \param[out] handle Pointer to the handle
+ * \return status
+ * \sa FT_OpenChannel
+ * \note The serial number and description of each port of a multi port chip end with the
+ * letter of the port, e.g. "FT2232H A"
+ * \warning The caller has to make sure that the channel has an MPSSE
+ */
+FT_STATUS FT_OpenChannelEx(FT_LegacyProtocol Protocol, PVOID arg, DWORD flags,
+			FT_HANDLE *handle)
+{
+	FT_STATUS status;
+	const Backend_Ops *ops;
+	FN_ENTER;
+	Infra_Lock();
+	ops = Backend_GetSelected();
+	Infra_Unlock();
+	status = ops->openEx(arg,flags,handle);
+	if(FT_OK == status)
+	{
+		status = Backend_Attach(*handle,ops);
+		if(FT_OK != status)
+			ops->close(*handle);
+	}
+	FN_EXIT;
+	return status;
+}
+
+
 /*!
  * \brief Initializes a channel
  *
@@ -329,7 +267,8 @@ FT_STATUS FT_OpenChannel(FT_LegacyProtocol Protocol, uint32 index,
  * \param[in] varArg3 Configuration options
  * \return status
  * \sa
- * \note
+ * \note If MID_ENABLE_FAST_INIT is set in the configuration options then the device isn't reset
+ * and the MPSSE is reused when it is found running(see Mid_FastInit)
  * \warning
  */
 FT_STATUS FT_InitChannel(FT_LegacyProtocol Protocol, FT_HANDLE handle,...)
@@ -357,62 +296,70 @@ FT_STATUS FT_InitChannel(FT_LegacyProtocol Protocol, FT_HANDLE handle,...)
 	/*Get the device type*/
 	status = Mid_GetFtDeviceType(handle, &ftDevice);
 	CHECK_STATUS(status);
-	/*reset the device*/
-	status = Mid_ResetDevice(handle);
-	CHECK_STATUS(status);
-	/*Purge*/
-	status = Mid_PurgeDevice(handle);
-	CHECK_STATUS(status);
-	/*set USB buffer size*/
-	status = Mid_SetUSBParameters(handle,\
-		USB_INPUT_BUFFER_SIZE,USB_OUTPUT_BUFFER_SIZE);
-	CHECK_STATUS(status);
-	/*sets the special characters for the device,
-	disable event and error characters*/
-	status = Mid_SetDeviceSpecialChar(handle,FALSE,DISABLE_EVENT,FALSE,\
-		DISABLE_CHAR);
-	CHECK_STATUS(status);
-	/*SetTimeOut*/
-#ifdef FT800_HACK
-	status = Mid_SetDeviceTimeOut(handle, 0 \
-		/*DEVICE_READ_TIMEOUT_INFINITE*/,DEVICE_WRITE_TIMEOUT);
-	CHECK_STATUS(status);
-#else
-	status = Mid_SetDeviceTimeOut(handle, 5000 \
-		/*DEVICE_READ_TIMEOUT_INFINITE*/,DEVICE_WRITE_TIMEOUT);
-	CHECK_STATUS(status);
-#endif
-	/*SetLatencyTimer*/
-	status = Mid_SetLatencyTimer(handle,(UCHAR)latencyTimer);
-	CHECK_STATUS(status);
-	/*ResetMPSSE*/
-	status = Mid_ResetMPSSE(handle);
-	CHECK_STATUS(status);
-	/*EnableMPSSEInterface*/
-	status = Mid_EnableMPSSEIn(handle);
-	CHECK_STATUS(status);
-	/*20110608 - enabling loopback before sync*/
-	status = Mid_SetDeviceLoopbackState(handle,MID_LOOPBACK_TRUE);
-	CHECK_STATUS(status);
-	/*Sync MPSSE */
-	status = Mid_SyncMPSSE(handle);
-	CHECK_STATUS(status);
-	/*wait for USB*/
-	INFRA_SLEEP(50);
-	/*set Clock frequency*/
-	status = Mid_SetClock(handle, ftDevice, clockRate);
-	CHECK_STATUS(status);
-	DBG(MSG_INFO, "Mid_SetClock Status Ok return 0x%x\n",(unsigned)status);
-	INFRA_SLEEP(20);
-	/*Stop Loop back*/
-	status = Mid_SetDeviceLoopbackState(handle,MID_LOOPBACK_FALSE);
-	CHECK_STATUS(status);
-	DBG(MSG_INFO, "Mid_SetDeviceLoopbackState Status Ok return 0x%x\n",\
-		(unsigned)status);
-	status = Mid_EmptyDeviceInputBuff(handle);
-	CHECK_STATUS(status);
-	DBG(MSG_INFO, "Mid_EmptyDeviceInputBuff Status Ok return 0x%x\n",(unsigned)\
-		status);
+	if(configOptions & MID_ENABLE_FAST_INIT)
+	{
+		status = Mid_FastInit(handle,ftDevice,clockRate,latencyTimer);
+		CHECK_STATUS(status);
+	}
+	else
+	{
+		/*reset the device*/
+		status = Mid_ResetDevice(handle);
+		CHECK_STATUS(status);
+		/*Purge*/
+		status = Mid_PurgeDevice(handle);
+		CHECK_STATUS(status);
+		/*set USB buffer size*/
+		status = Mid_SetUSBParameters(handle,\
+			USB_INPUT_BUFFER_SIZE,USB_OUTPUT_BUFFER_SIZE);
+		CHECK_STATUS(status);
+		/*sets the special characters for the device,
+		disable event and error characters*/
+		status = Mid_SetDeviceSpecialChar(handle,FALSE,DISABLE_EVENT,FALSE,\
+			DISABLE_CHAR);
+		CHECK_STATUS(status);
+		/*SetTimeOut*/
+		status = Mid_SetDeviceTimeOut(handle,MID_READ_TIMEOUT,DEVICE_WRITE_TIMEOUT);
+		CHECK_STATUS(status);
+		/*SetLatencyTimer*/
+		status = Mid_SetLatencyTimer(handle,(UCHAR)latencyTimer);
+		CHECK_STATUS(status);
+		/*ResetMPSSE*/
+		status = Mid_ResetMPSSE(handle);
+		CHECK_STATUS(status);
+		/*EnableMPSSEInterface*/
+		status = Mid_EnableMPSSEIn(handle);
+		CHECK_STATUS(status);
+		/*20110608 - enabling loopback before sync*/
+		status = Mid_SetDeviceLoopbackState(handle,MID_LOOPBACK_TRUE);
+		CHECK_STATUS(status);
+		/*Sync MPSSE */
+		status = Mid_SyncMPSSE(handle);
+		CHECK_STATUS(status);
+		/*wait for USB*/
+		INFRA_SLEEP(50);
+		/*set Clock frequency*/
+		status = Mid_SetClock(handle, ftDevice, clockRate);
+		CHECK_STATUS(status);
+		DBG(MSG_INFO, "Mid_SetClock Status Ok return 0x%x\n",(unsigned)status);
+		INFRA_SLEEP(20);
+		/*Stop Loop back*/
+		status = Mid_SetDeviceLoopbackState(handle,MID_LOOPBACK_FALSE);
+		CHECK_STATUS(status);
+		DBG(MSG_INFO, "Mid_SetDeviceLoopbackState Status Ok return 0x%x\n",\
+			(unsigned)status);
+		status = Mid_EmptyDeviceInputBuff(handle);
+		CHECK_STATUS(status);
+		DBG(MSG_INFO, "Mid_EmptyDeviceInputBuff Status Ok return 0x%x\n",(unsigned)\
+			status);
+	}
+	if(configOptions & (MID_CALIBRATE_LATENCY | MID_CALIBRATE_THROUGHPUT))
+	{
+		status = FT_CalibrateChannel(handle,clockRate,
+			(configOptions & MID_CALIBRATE_THROUGHPUT)?FT_PROFILE_THROUGHPUT:FT_PROFILE_LATENCY,
+			NULL);
+		CHECK_STATUS(status);
+	}
 
 	switch(Protocol)
 	{
@@ -481,7 +428,9 @@ FT_STATUS FT_CloseChannel(FT_LegacyProtocol Protocol, FT_HANDLE handle)
 {
 	FT_STATUS status;
 	FN_ENTER;
-	status = FT_Close(handle);
+	status = Backend_Get(handle)->close(handle);
+	if(FT_OK == status)
+		Backend_Detach(handle);
 	FN_EXIT;
 	return status;
 }
@@ -509,7 +458,7 @@ FT_STATUS FT_Channel_Read(FT_LegacyProtocol Protocol, FT_HANDLE handle,
 {
 	FT_STATUS status;
 	FN_ENTER;
-	status = FT_Read(handle, buffer, noOfBytes, \
+	status = Backend_Get(handle)->read(handle, buffer, noOfBytes, \
 		(DWORD*)noOfBytesTransferred);
 #if 0
 /* Disabled after code review */
@@ -594,7 +543,7 @@ FT_STATUS FT_Channel_Write(FT_LegacyProtocol Protocol, FT_HANDLE handle,
 	}
 #endif
 
-	status = FT_Write(handle, buffer, noOfBytes, \
+	status = Backend_Get(handle)->write(handle, buffer, noOfBytes, \
 		(DWORD*)noOfBytesTransferred);
 #if 0
 /* Disabled after code review */
@@ -699,7 +648,7 @@ FT_STATUS Mid_ResetDevice(FT_HANDLE handle)
 {
 	FT_STATUS status;
 	FN_ENTER;
-	status = FT_ResetDevice(handle);
+	status = Backend_Get(handle)->resetDevice(handle);
 	FN_EXIT;
 	return status;
 
@@ -719,7 +668,7 @@ FT_STATUS Mid_PurgeDevice (FT_HANDLE handle)
 {
 	FT_STATUS status;
 	FN_ENTER;
-	status = FT_Purge(handle, FT_PURGE_RX | FT_PURGE_TX);
+	status = Backend_Get(handle)->purge(handle, FT_PURGE_RX | FT_PURGE_TX);
 	FN_EXIT;
 	return status;
 }
@@ -743,7 +692,7 @@ FT_STATUS Mid_SetUSBParameters(FT_HANDLE handle,DWORD inputBufSize,DWORD \
 {
 	FT_STATUS status;
 	FN_ENTER;
-	status = FT_SetUSBParameters(handle,inputBufSize,\
+	status = Backend_Get(handle)->setUSBParameters(handle,inputBufSize,\
 		outputBufSize);
 	FN_EXIT;
 	return status;
@@ -768,7 +717,7 @@ FT_STATUS Mid_SetDeviceSpecialChar(FT_HANDLE handle,UCHAR eventCh,
 {
 	FT_STATUS status;
 	FN_ENTER;
-	status = FT_SetChars(handle,eventCh,eventStatus,\
+	status = Backend_Get(handle)->setChars(handle,eventCh,eventStatus,\
 		errorCh,errorStatus);
 	FN_EXIT;
 	return status;
@@ -793,7 +742,7 @@ FT_STATUS Mid_SetDeviceTimeOut(FT_HANDLE handle,DWORD rdTimeOut,\
 {
 	FT_STATUS status;
 	FN_ENTER;
-	status = FT_SetTimeouts(handle,rdTimeOut,wrTimeOut);
+	status = Backend_Get(handle)->setTimeouts(handle,rdTimeOut,wrTimeOut);
 	FN_EXIT;
 	return status;
 }
@@ -814,7 +763,7 @@ FT_STATUS Mid_SetLatencyTimer (FT_HANDLE handle, UCHAR milliSecond)
 {
 	FT_STATUS status;
 	FN_ENTER;
-	status = FT_SetLatencyTimer(handle,milliSecond);
+	status = Backend_Get(handle)->setLatencyTimer(handle,milliSecond);
 	FN_EXIT;
 	return status;
  }
@@ -833,7 +782,7 @@ FT_STATUS Mid_ResetMPSSE(FT_HANDLE handle)
 {
 	FT_STATUS status;
 	FN_ENTER;
-	status = FT_SetBitMode(handle, INTERFACE_MASK_IN,\
+	status = Backend_Get(handle)->setBitMode(handle, INTERFACE_MASK_IN,\
 		RESET_INTERFACE);
 	FN_EXIT;
 	return status;
@@ -853,7 +802,7 @@ FT_STATUS Mid_EnableMPSSEIn(FT_HANDLE handle)
 {
 	FT_STATUS status;
 	FN_ENTER;
-	status = FT_SetBitMode(handle,INTERFACE_MASK_IN,\
+	status = Backend_Get(handle)->setBitMode(handle,INTERFACE_MASK_IN,\
 		ENABLE_MPSSE);
 	FN_EXIT;
 	return status;
@@ -862,41 +811,35 @@ FT_STATUS Mid_EnableMPSSEIn(FT_HANDLE handle)
 /*!
  * \brief syncronize MPSSE Channel
  *
- * This function syncronice the MPSSE by continiously sending 0XAA until it is it is readback
- *and then sends 0XAB once and read until we get it back
+ * This function syncronizes the MPSSE in a single round trip. Both bad commands are sent in one
+ * write followed by SEND_IMMEDIATE, and the function returns as soon as 0xFA 0xAB is read back.
+ * Since the MPSSE processes the commands in order, nothing that was sent before is still pending
+ * once the echo of the last one has arrived, so it can also be used to resyncronize a channel
+ * after an error
  * \param[in] handle Handle of the channel
  * \return status
- * \sa
- * \note
+ * \sa Mid_WaitForEcho
+ * \note FT_OTHER_ERROR is returned if the echo isn't received within MID_SYNC_TIMEOUT
  * \warning
  */
 FT_STATUS Mid_SyncMPSSE(FT_HANDLE handle)
 {
 	FT_STATUS status;
-
-	UCHAR cmdEchoed;
-
+	UCHAR buffer[3];
+	bool echoed=FALSE;
 	FN_ENTER;
-	status = Mid_EmptyDeviceInputBuff(handle);
+
+	status = Mid_PurgeDevice(handle);
 	CHECK_STATUS(status);
-	/*send and receive command*/
-	status = Mid_SendReceiveCmdFromMPSSE(handle,MID_ECHO_COMMAND_CONTINUOUSLY,\
-		MID_ECHO_CMD_1,&cmdEchoed);
+	buffer[0] = MID_ECHO_CMD_1;
+	buffer[1] = MID_ECHO_CMD_2;
+	buffer[2] = MPSSE_CMD_SEND_IMMEDIATE;
+	status = Mid_WaitForEcho(handle,buffer,sizeof(buffer),MID_ECHO_CMD_2,MID_SYNC_TIMEOUT,
+		&echoed);
 	CHECK_STATUS(status);
-	/**/
-
-	if(cmdEchoed == MID_CMD_ECHOED)
-	{
-		status = Mid_SendReceiveCmdFromMPSSE(handle,MID_ECHO_COMMAND_ONCE,\
-			MID_ECHO_CMD_2,&cmdEchoed);
-		CHECK_STATUS(status);
-		if (cmdEchoed != MID_CMD_ECHOED)
-		{
-			status = FT_OTHER_ERROR;
-		}
-	}
-	else
+	if(!echoed)
 	{
+		DBG(MSG_ERR,"MPSSE didn't echo 0x%x\n",(unsigned)MID_ECHO_CMD_2);
 		status = FT_OTHER_ERROR;
 	}
 	FN_EXIT;
@@ -904,115 +847,6 @@ FT_STATUS Mid_SyncMPSSE(FT_HANDLE handle)
 }
 
 
-
-/*!
- * \brief sends the data and read it back from the device
- *
- * This function sends the ecoCmd based on the ecoCmdFlag(continiously/Once) and reads it back
- * \param[in] handle Handle of the channel
- * \param[in] echoCmdFlag specifies whether to sen char continiously or once
- * \param[in] ecoCmd char to be sent
- * \param[out] cmdEchoed 1 if char echoed from device otherwise 0
- * \return status
- * \sa
- * \note
- * \warning
- */
-
-
-
-FT_STATUS Mid_SendReceiveCmdFromMPSSE(FT_HANDLE handle, UCHAR echoCmdFlag,UCHAR ecoCmd,UCHAR *cmdEchoed)
-{
-	FT_STATUS status;
-	DWORD bytesInInputBuf = 0;
-	DWORD numOfBytesRead = 0;
-	DWORD bytesWritten;
-	DWORD byteCounter;
-	UCHAR cmdResponse = MID_CMD_NOT_ECHOED;
-	int loopCounter = 0;
-	UCHAR *readBuffer=NULL;
-
-	FN_ENTER;
-	readBuffer = (UCHAR*)INFRA_MALLOC(MID_MAX_IN_BUF_SIZE);
-	if(NULL == readBuffer)
-	{
-		return FT_INSUFFICIENT_RESOURCES;
-	}
-	/*initialize cmdEchoed to MID_CMD_NOT_ECHOED*/
-	*cmdEchoed = MID_CMD_NOT_ECHOED;
-	/* check whether command has to be sent only once*/
-	if (echoCmdFlag == MID_ECHO_COMMAND_ONCE)
-	{
-		status = FT_Write(handle,&ecoCmd,1,&bytesWritten);
-		CHECK_STATUS(status);
-	}
-
-	do
-	{
-		DBG(MSG_DEBUG,"In Loop Mid_SendReceiveCmdFromMPSSE loopCounter = %d \n"\
-			,loopCounter);
-		/*check whether command has to be sent every time in the loop*/
-		if(echoCmdFlag == MID_ECHO_COMMAND_CONTINUOUSLY)
-		{
-		  status = FT_Write(handle,&ecoCmd,1,&bytesWritten);
-		 CHECK_STATUS(status);
-		}
-		/*read the no of bytes available in Receive buffer*/
-		status = FT_GetQueueStatus(handle,&bytesInInputBuf);
-		CHECK_STATUS(status);
-		INFRA_SLEEP(1);
-		DBG(MSG_DEBUG,"bytesInInputBuf size =  %d\n",bytesInInputBuf);
-		if(bytesInInputBuf >0)
-		{
-			MID_CHK_IN_BUF_OK(bytesInInputBuf);
-			status = FT_Read(handle,readBuffer,bytesInInputBuf,&numOfBytesRead);
-			CHECK_STATUS(status);
-			if(numOfBytesRead >0)
-			{
-				byteCounter = 0;
-				do
-				{
-					if(byteCounter <= (numOfBytesRead-1))
-					{
-						if(readBuffer[byteCounter]==MID_BAD_COMMAND_RESPONSE)
-						{
-							cmdResponse = MID_BAD_COMMAND_RESPONSE;
-						}
-						else
-						{
-							if(cmdResponse == MID_BAD_COMMAND_RESPONSE)
-							{
-								if(readBuffer[byteCounter]==ecoCmd)
-								{
-									*cmdEchoed = MID_CMD_ECHOED;
-								}
-							}
-							cmdResponse = MID_CMD_NOT_ECHOED;
-						}
-					}
-					byteCounter++;
-				}while((byteCounter < bytesInInputBuf)&&(*cmdEchoed == MID_CMD_NOT_ECHOED));
-			}
-		}
-
-		/*for breaking the loop */
-		loopCounter++;
-		if(loopCounter > MID_MAX_IN_BUF_SIZE)
-		{
-			DBG(MSG_DEBUG,"Loop breaked after executing %u times\n",(unsigned)MID_MAX_IN_BUF_SIZE);
-			status = FT_OTHER_ERROR;
-			break;
-		}
-	}while((*cmdEchoed == MID_CMD_NOT_ECHOED) && (status == FT_OK));
-	if(NULL != readBuffer)
-	{
-		INFRA_FREE(readBuffer);//Bug12
-	}
-	FN_EXIT;
-	return status;
-}
-
-
 /*!
  * \brief sets the pin state
  *
@@ -1043,7 +877,7 @@ FT_STATUS Mid_SetGPIOLow(FT_HANDLE handle, uint8 value, uint8 direction)
 	*/
 	FN_EXIT;
 
-	return FT_Write(handle,inputBuffer,bufIdx,&bytesWritten);
+	return Backend_Get(handle)->write(handle,inputBuffer,bufIdx,&bytesWritten);
 
 }
 
@@ -1053,11 +887,10 @@ FT_STATUS Mid_GetFtDeviceType(FT_HANDLE handle, FT_DEVICE *ftDevice)
 	DWORD deviceID;
 	CHAR pSerialNumber[300];
 	CHAR pDescription[300];
-	VOID *Dummy=NULL;
 
 	FN_ENTER;
-	status = FT_GetDeviceInfo(handle, ftDevice, &deviceID, \
-		(PCHAR)pSerialNumber, (PCHAR)pDescription, Dummy);
+	status = Backend_Get(handle)->getDeviceInfo(handle, ftDevice, &deviceID, \
+		(PCHAR)pSerialNumber, (PCHAR)pDescription);
 
 #ifdef INFRA_DEBUG_ENABLE
 	switch(*ftDevice)
@@ -1098,12 +931,51 @@ FT_STATUS Mid_GetFtDeviceType(FT_HANDLE handle, FT_DEVICE *ftDevice)
 	return status;
 }
 
+/*!
+ * \brief Works out the base clock and divisor of the MPSSE clock for a frequency
+ *
+ * The divisor is rounded up so that the clock is never faster than requested. Hi-speed chips
+ * use the 30MHz base whenever it gets closer to the requested frequency than the 6MHz one(divide
+ * by 5 enabled), e.g. 5.1MHz is made 5MHz rather than 3MHz. FT2232D only has the 6MHz base.
+ *
+ * \param[in] ftDevice Type of the chip
+ * \param[in] clock Requested frequency of the MPSSE clock in Hz
+ * \param[out] base Base clock in Hz, MID_6MHZ or MID_30MHZ
+ * \return Value of the divisor passed to the SET_CLOCK_FREQUENCY command
+ * \sa Mid_SetClock
+ * \note The frequency set is base/(divisor+1)
+ * \warning
+ */
+uint32 Mid_GetClockDivisor(FT_DEVICE ftDevice, uint32 clock, uint32 *base)
+{
+	uint32 value;
+	uint32 fastValue;
+
+	if(0 == clock)
+		clock = 1;
+	*base = MID_6MHZ;
+	value = (MID_6MHZ + clock - 1)/clock - 1;
+	if(FT_DEVICE_2232C != ftDevice)
+	{/* Assuming all new chips will he HS MPSSE devices */
+		fastValue = (MID_30MHZ + clock - 1)/clock - 1;
+		if((MID_30MHZ/(fastValue + 1)) > (MID_6MHZ/(value + 1)))
+		{
+			*base = MID_30MHZ;
+			value = fastValue;
+		}
+	}
+	if(value > 0xFFFF)
+		value = 0xFFFF;
+	return value;
+}
+
 /*!
  * \brief sets the clock
  *
- * This function fids the device type. based on the device type calculate the value for the clock
- * requested in the parameter and sets it.
+ * This function calculates the value for the clock requested in the parameter for the device
+ * type(see Mid_GetClockDivisor) and sets it.
  * \param[in] handle Handle of the channel
+ * \param[in] ftDevice Type of the chip
  * \param[in] clock Clock value to be set
  * \return status
  * \sa
@@ -1115,56 +987,26 @@ FT_STATUS Mid_SetClock(FT_HANDLE handle, FT_DEVICE ftDevice, uint32 clock)
 	UCHAR inputBuffer[10];
 	DWORD bytesWritten = 0;
 	DWORD bufIdx = 0;
-	uint8 valueH, valueL;
+	uint32 base;
 	uint32 value;
 	FT_STATUS status;
 
 	FN_ENTER;
-	switch(ftDevice)
+	value = Mid_GetClockDivisor(ftDevice,clock,&base);
+	/* FT2232D(FT_DEVICE_2232C in D2XX) has no divide by 5 commands */
+	if(FT_DEVICE_2232C != ftDevice)
 	{
-		case FT_DEVICE_2232C:/* This is actually FT2232D but defined is FT_DEVICE_2232C
-			in D2XX. Also, it is the only FS device that supports MPSSE */
-			value = (MID_6MHZ/clock) - 1;
-			break;
-
-		default:/* Assuming all new chips will he HS MPSSE devices */
-			DBG(MSG_DEBUG,"Unknown device type(0x%x). Assuming high speed device",(unsigned)ftDevice);
-			/* Fall through */
-		case FT_DEVICE_2232H:
-		case FT_DEVICE_4232H:
-		case FT_DEVICE_232H:
-			if(clock <= MID_6MHZ)
-			{
-				DBG(MSG_DEBUG,"handle=0x%x value=0x%x ENABLE_CLOCK_DIVIDE\n",\
-					(unsigned)handle,(unsigned)value);
-				value = ENABLE_CLOCK_DIVIDE;
-				status = FT_Write(handle,&value,1,\
-					&bytesWritten);
-				CHECK_STATUS(status);
-				value = (MID_6MHZ/clock) - 1;
-			}
-			else
-			{
-				DBG(MSG_DEBUG,"handle=0x%x value=0x%x DISABLE_CLOCK_DIVIDE\n",\
-					(unsigned)handle,(unsigned)value);
-				value = DISABLE_CLOCK_DIVIDE;
-				status = FT_Write(handle,&value,1,\
-					&bytesWritten);
-				CHECK_STATUS(status);
-				value = (MID_30MHZ/clock) - 1;
-			}
-			break;
+		inputBuffer[bufIdx++] = (MID_30MHZ == base)?DISABLE_CLOCK_DIVIDE:ENABLE_CLOCK_DIVIDE;
 	}
-	/*calculate valueH and ValueL*/
-	valueL = (uint8)value;
-	valueH = (uint8)(value>>8);
 	/*set the clock*/
 	inputBuffer[bufIdx++] = MID_SET_CLOCK_FREQUENCY_CMD;
-	DBG(MSG_DEBUG,"valueL=0x%x valueH=0x%x \n",valueL,valueH);
-	inputBuffer[bufIdx++] = valueL;
-	inputBuffer[bufIdx++] = valueH;
+	inputBuffer[bufIdx++] = (uint8)value;
+	inputBuffer[bufIdx++] = (uint8)(value>>8);
+	DBG(MSG_DEBUG,"handle=0x%x base=%u value=0x%x\n",(unsigned)handle,(unsigned)base,
+		(unsigned)value);
+	status = Backend_Get(handle)->write(handle,inputBuffer,bufIdx,&bytesWritten);
 	FN_EXIT;
-	return FT_Write(handle,inputBuffer,bufIdx,&bytesWritten);
+	return status;
 }
 
 /*!
@@ -1195,7 +1037,7 @@ FT_STATUS Mid_SetDeviceLoopbackState(FT_HANDLE handle,uint8 loopBackFlag)
 		inputBuffer[bufIdx++] = MID_TURN_ON_LOOPBACK_CMD;
 	}
 	FN_EXIT;
-	return FT_Write(handle,inputBuffer,bufIdx,&bytesWritten);
+	return Backend_Get(handle)->write(handle,inputBuffer,bufIdx,&bytesWritten);
 }
 
 /*!
@@ -1215,6 +1057,7 @@ FT_STATUS Mid_EmptyDeviceInputBuff(FT_HANDLE handle)
 	UCHAR *readBuffer;
 	DWORD bytesInInputBuf = 0;
 	DWORD numOfBytesRead = 0;
+	const Backend_Ops *ops=Backend_Get(handle);
 
 	FN_ENTER;
 	readBuffer = (UCHAR*)INFRA_MALLOC(MID_MAX_IN_BUF_SIZE);
@@ -1222,7 +1065,7 @@ FT_STATUS Mid_EmptyDeviceInputBuff(FT_HANDLE handle)
 	{
 		return FT_INSUFFICIENT_RESOURCES;
 	}
-	status = FT_GetQueueStatus(handle,&bytesInInputBuf);
+	status = ops->getQueueStatus(handle,&bytesInInputBuf);
 	CHECK_STATUS(status);
 	if(bytesInInputBuf > 0)
 	{
@@ -1230,14 +1073,14 @@ FT_STATUS Mid_EmptyDeviceInputBuff(FT_HANDLE handle)
 		{
 			if(bytesInInputBuf >MID_MAX_IN_BUF_SIZE)
 			{
-				status = FT_Read(handle,readBuffer,\
+				status = ops->read(handle,readBuffer,\
 					MID_MAX_IN_BUF_SIZE,&numOfBytesRead);
 				CHECK_STATUS(status);
 				bytesInInputBuf = bytesInInputBuf - numOfBytesRead;
 			}
 			else
 			{
-				status = FT_Read(handle,readBuffer,\
+				status = ops->read(handle,readBuffer,\
 					bytesInInputBuf,&numOfBytesRead);
 				CHECK_STATUS(status);
 				bytesInInputBuf = bytesInInputBuf - numOfBytesRead;
@@ -1284,7 +1127,7 @@ FTDI_API FT_STATUS FT_WriteGPIO(FT_HANDLE handle, uint8 dir, uint8 value)
 	buffer[bufIdx++] = value;
 	buffer[bufIdx++] = dir;
 #endif
-	status = FT_Write(handle,buffer,bufIdx,&bytesWritten);
+	status = Backend_Get(handle)->write(handle,buffer,bufIdx,&bytesWritten);
 	FN_EXIT;
 	return status;
 }
@@ -1318,14 +1161,14 @@ FTDI_API FT_STATUS FT_ReadGPIO(FT_HANDLE handle,uint8 *value)
 	buffer[bytesToTransfer++] = MPSSE_CMD_GET_DATA_BITS_LOWBYTE;
 	buffer[bytesToTransfer++] = MPSSE_CMD_SEND_IMMEDIATE;
 #endif
-	status = FT_Write(handle,buffer,bytesToTransfer,\
+	status = Backend_Get(handle)->write(handle,buffer,bytesToTransfer,\
 		&bytesTransfered);
 	CHECK_STATUS(status);
 	DBG(MSG_DEBUG,"bytesToTransfer=0x%x bytesTransfered=0x%x\n",\
 		(unsigned)bytesToTransfer,(unsigned)bytesTransfered);
 	bytesToTransfer = 1;
 	bytesTransfered = 0;
-	status = FT_Read(handle,readBuffer,bytesToTransfer,\
+	status = Backend_Get(handle)->read(handle,readBuffer,bytesToTransfer,\
 		&bytesTransfered);
 	CHECK_STATUS(status);
 	DBG(MSG_DEBUG,"bytesToTransfer=0x%x bytesTransfered=0x%x\n",\
@@ -1338,11 +1181,709 @@ FTDI_API FT_STATUS FT_ReadGPIO(FT_HANDLE handle,uint8 *value)
 	return status;
 }
 
+/*!
+ * \brief Resyncronizes the MPSSE of a channel
+ *
+ * This function drops whatever is pending in the buffers of the channel and waits until the MPSSE
+ * echoes a bad command, so that the next command is known to start on a clean stream. It is meant
+ * to be called after a transfer failed or timed out, instead of closing and initializing the
+ * channel again.
+ *
+ * \param[in] handle Handle of the channel
+ * \return status
+ * \sa Mid_SyncMPSSE
+ * \note The configuration of the channel(clock, pin states) is left as it is
+ * \warning
+ */
+FTDI_API FT_STATUS FT_SyncChannel(FT_HANDLE handle)
+{
+	FT_STATUS status;
+	FN_ENTER;
+	status = Mid_SyncMPSSE(handle);
+	FN_EXIT;
+	return status;
+}
+
+/*!
+ * \brief Brings a channel back into a known state after a failed transfer
+ *
+ * This function drains what a failed transfer left in the buffers and resyncronizes the command
+ * parser of the MPSSE. If the MPSSE doesn't echo the probe(e.g. it is still waiting for the data
+ * of a command that was cut short), it is reset and enabled again. The clock and the state the
+ * protocol module passes in restore are then written in one go, and the function returns once
+ * the MPSSE has processed them.
+ *
+ * \param[in] handle Handle of the channel
+ * \param[in] clockRate Clock rate the channel was initialized with
+ * \param[in] restore MPSSE commands that restore the protocol's state(pins, clocking options)
+ * \param[in] restoreLength Number of bytes in restore
+ * \return status
+ * \sa FT_InitChannel, Mid_SyncMPSSE
+ * \note Takes a few milliseconds if the MPSSE is still in sync, otherwise up to MID_SYNC_TIMEOUT
+ * \warning The pins are tristated between the reset of the MPSSE and the restore
+ */
+FT_STATUS FT_RecoverChannel(FT_HANDLE handle, uint32 clockRate, uint8 *restore,
+	uint32 restoreLength)
+{
+	FT_STATUS status;
+	FT_DEVICE ftDevice;
+	UCHAR buffer[3];
+	DWORD bytesWritten=0;
+	bool echoed=FALSE;
+	FN_ENTER;
+
+	DBG(MSG_WARN,"recovering handle 0x%x\n",(unsigned)handle);
+	status = Mid_GetFtDeviceType(handle,&ftDevice);
+	CHECK_STATUS(status);
+	status = Mid_EmptyDeviceInputBuff(handle);
+	CHECK_STATUS(status);
+	status = Mid_PurgeDevice(handle);
+	CHECK_STATUS(status);
+	buffer[0] = MID_ECHO_CMD_1;
+	buffer[1] = MID_ECHO_CMD_2;
+	buffer[2] = MPSSE_CMD_SEND_IMMEDIATE;
+	status = Mid_WaitForEcho(handle,buffer,sizeof(buffer),MID_ECHO_CMD_2,MID_PROBE_TIMEOUT,
+		&echoed);
+	CHECK_STATUS(status);
+	if(!echoed)
+	{
+		DBG(MSG_WARN,"MPSSE out of sync, resetting it\n");
+		status = Mid_ResetMPSSE(handle);
+		CHECK_STATUS(status);
+		status = Mid_EnableMPSSEIn(handle);
+		CHECK_STATUS(status);
+		status = Mid_SyncMPSSE(handle);
+		CHECK_STATUS(status);
+	}
+
+	status = Mid_SetClock(handle,ftDevice,clockRate);
+	CHECK_STATUS(status);
+	status = Mid_SetDeviceLoopbackState(handle,MID_LOOPBACK_FALSE);
+	CHECK_STATUS(status);
+	if(restoreLength > 0)
+	{
+		status = Backend_Get(handle)->write(handle,restore,restoreLength,&bytesWritten);
+		CHECK_STATUS(status);
+	}
+	/*the echo comes back once the commands above have been processed*/
+	buffer[0] = MID_ECHO_CMD_2;
+	buffer[1] = MPSSE_CMD_SEND_IMMEDIATE;
+	status = Mid_WaitForEcho(handle,buffer,2,MID_ECHO_CMD_2,MID_SYNC_TIMEOUT,&echoed);
+	CHECK_STATUS(status);
+	if(!echoed)
+		status = FT_OTHER_ERROR;
+	FN_EXIT;
+	return status;
+}
+
+/*!
+ * \brief Measures the transport settings of a channel and picks the best for each workload
+ *
+ * This function tries every combination of the candidate latency timers(Mid_LatencyTimers) and
+ * USB transfer sizes(Mid_TransferSizes) on the live device. For each of them it measures the
+ * round trip of a short command/response exchange, as made by register accesses, and the rate
+ * of a block read clocked at the highest clock rate, as made by memory dumps. The profile with
+ * the shortest round trip becomes the FT_PROFILE_LATENCY profile, the one with the highest rate
+ * the FT_PROFILE_THROUGHPUT profile. The profile of the given workload is then applied.
+ *
+ * \param[in] handle Handle of the channel
+ * \param[in] clockRate Clock rate the channel is set back to after the measurement
+ * \param[in] workload Workload class whose profile is applied, FT_PROFILE_LATENCY or
+ *			FT_PROFILE_THROUGHPUT
+ * \param[out] profiles Array of FT_PROFILE_COUNT profiles, indexed by workload class. May be
+ *			NULL
+ * \return status
+ * \sa FT_SetTransportProfile
+ * \note Takes in the order of 100ms
+ * \warning The pins of the low byte are tristated and the clock toggles while measuring, the
+ * caller has to restore their state
+ */
+FT_STATUS FT_CalibrateChannel(FT_HANDLE handle, uint32 clockRate, uint32 workload,
+	FT_TransportProfile *profiles)
+{
+	FT_STATUS status;
+	FT_STATUS clockStatus;
+	FT_DEVICE ftDevice;
+	FT_TransportProfile candidate;
+	FT_TransportProfile best[FT_PROFILE_COUNT];
+	UCHAR buffer[3];
+	DWORD bytesWritten=0;
+	uint32 l;
+	uint32 t;
+	FN_ENTER;
+
+	if(workload >= FT_PROFILE_COUNT)
+		return FT_INVALID_PARAMETER;
+	status = Mid_GetFtDeviceType(handle,&ftDevice);
+	CHECK_STATUS(status);
+	/*keep the block read off the bus*/
+	buffer[0] = MPSSE_CMD_SET_DATA_BITS_LOWBYTE;
+	buffer[1] = 0x00;
+	buffer[2] = 0x00;
+	status = Backend_Get(handle)->write(handle,buffer,3,&bytesWritten);
+	CHECK_STATUS(status);
+	status = Mid_SetClock(handle,ftDevice,(FT_DEVICE_2232C == ftDevice)?MID_6MHZ:MID_30MHZ);
+	CHECK_STATUS(status);
+
+	memset(best,0,sizeof(best));
+	for(l=0; (FT_OK == status) &&
+		(l<sizeof(Mid_LatencyTimers)/sizeof(Mid_LatencyTimers[0])); l++)
+	{
+		for(t=0; (FT_OK == status) &&
+			(t<sizeof(Mid_TransferSizes)/sizeof(Mid_TransferSizes[0])); t++)
+		{
+			candidate.latencyTimer = Mid_LatencyTimers[l];
+			candidate.inTransferSize = Mid_TransferSizes[t];
+			candidate.outTransferSize = Mid_TransferSizes[t];
+			status = Mid_ApplyProfile(handle,&candidate);
+			if(FT_OK == status)
+				status = Mid_MeasureTransport(handle,&candidate);
+			if(FT_OK != status)
+				break;
+			DBG(MSG_DEBUG,"latency timer %u, transfer size %u: round trip %uus, %u bytes/s\n",
+				(unsigned)candidate.latencyTimer,(unsigned)candidate.inTransferSize,
+				(unsigned)candidate.roundTripUs,(unsigned)candidate.bytesPerSecond);
+			if((0 == best[FT_PROFILE_LATENCY].roundTripUs) ||
+				(candidate.roundTripUs < best[FT_PROFILE_LATENCY].roundTripUs))
+			{
+				INFRA_MEMCPY(&best[FT_PROFILE_LATENCY],&candidate,sizeof(candidate));
+			}
+			if(candidate.bytesPerSecond > best[FT_PROFILE_THROUGHPUT].bytesPerSecond)
+			{
+				INFRA_MEMCPY(&best[FT_PROFILE_THROUGHPUT],&candidate,sizeof(candidate));
+			}
+		}
+	}
+
+	clockStatus = Mid_SetClock(handle,ftDevice,clockRate);
+	if(FT_OK == status)
+		status = clockStatus;
+	if(FT_OK == status)
+		status = Mid_ApplyProfile(handle,&best[workload]);
+	if(FT_OK == status)
+	{
+		DBG(MSG_INFO,"handle 0x%x: applied latency timer %u, transfer size %u\n",
+			(unsigned)handle,(unsigned)best[workload].latencyTimer,
+			(unsigned)best[workload].inTransferSize);
+		if(NULL != profiles)
+		{
+			INFRA_MEMCPY(profiles,best,sizeof(best));
+		}
+	}
+	FN_EXIT;
+	return status;
+}
+
+/*!
+ * \brief Applies a transport profile to a channel
+ *
+ * This function sets the latency timer and the USB transfer sizes of the channel. Together with
+ * the profiles returned by I2C_CalibrateChannel/SPI_CalibrateChannel it switches a channel
+ * between latency-bound and throughput-bound work at runtime.
+ *
+ * \param[in] handle Handle of the channel
+ * \param[in] profile Pointer to the profile, only latencyTimer, inTransferSize and
+ *			outTransferSize are used
+ * \return status
+ * \sa FT_CalibrateChannel
+ * \note The transfer sizes have to be multiples of 64 between 64 and 65536
+ * \warning
+ */
+FTDI_API FT_STATUS FT_SetTransportProfile(FT_HANDLE handle, const FT_TransportProfile *profile)
+{
+	FT_STATUS status;
+	FN_ENTER;
+	CHECK_NULL_RET(profile);
+	if((profile->inTransferSize < 64) || (profile->inTransferSize > USB_INPUT_BUFFER_SIZE) ||
+		(profile->inTransferSize % 64) || (profile->outTransferSize < 64) ||
+		(profile->outTransferSize > USB_OUTPUT_BUFFER_SIZE) || (profile->outTransferSize % 64))
+	{
+		DBG(MSG_WARN,"invalid transfer size in(%u) out(%u)\n",
+			(unsigned)profile->inTransferSize,(unsigned)profile->outTransferSize);
+		return FT_INVALID_PARAMETER;
+	}
+	status = Mid_ApplyProfile(handle,profile);
+	FN_EXIT;
+	return status;
+}
+
+/*!
+ * \brief Selects the transport backend
+ *
+ * This function selects the backend through which the channels are enumerated and opened by
+ * I2C_GetNumChannels/SPI_GetNumChannels, I2C_OpenChannel/SPI_OpenChannel and
+ * I2C_OpenChannelEx/SPI_OpenChannelEx. Every later access to a channel goes through the backend
+ * it was opened with.
+ *
+ * \param[in] name Name of the backend, "d2xx" or NULL for the FTDI D2XX driver(default),
+ *			"emulator" for the MPSSE emulator, "libusb" for libusb-1.0 if the library was built
+ *			with MPSSE_LIBUSB_BACKEND
+ * \return status
+ * \sa FT_GetNumChannels
+ * \note The channels that are open already keep their backend. The snapshot of the channels is
+ * dropped, the channels are enumerated again on the next call that needs them. Until this
+ * function is called, the backend named by the environment variable LIBMPSSE_BACKEND is used
+ * \warning
+ */
+FTDI_API FT_STATUS FT_SetBackend(const char *name)
+{
+	FT_STATUS status=FT_OK;
+	const Backend_Ops *ops;
+	FN_ENTER;
+	ops = Backend_Find(name);
+	if(NULL == ops)
+	{
+		DBG(MSG_WARN,"no backend named %s\n",name);
+		return FT_INVALID_PARAMETER;
+	}
+	Infra_Lock();
+	Backend_Select(ops);
+	Mid_SnapshotValid = FALSE;
+	Infra_Unlock();
+	FN_EXIT;
+	return status;
+}
+
 FT_STATUS Mid_GetQueueStatus(FT_HANDLE handle, LPDWORD lpdwAmountInRxQueue)
 {
 	FT_STATUS status;
 	FN_ENTER;
-	status = FT_GetQueueStatus(handle, lpdwAmountInRxQueue);
+	status = Backend_Get(handle)->getQueueStatus(handle, lpdwAmountInRxQueue);
+	FN_EXIT;
+	return status;
+}
+
+/*!
+ * \brief Repeats a sequence of commands until the bytes it returns match
+ *
+ * This function is the engine of the polling functions of the protocol modules(I2C_PollRegister,
+ * I2C_PollAck, SPI_PollStatus). Instead of making a round trip per sample, a batch of identical
+ * samples is written in one go followed by SEND_IMMEDIATE, and the samples are checked on the host
+ * as the batch comes back. A sample matches if bit 0 of its first acks bytes is 0 and
+ * (byte at dataOffset & mask) equals expected. The batch doubles on every miss. The number of
+ * samples the poll needed is saved in *pollBatch and used as the size of the first batch of the
+ * next poll, so that waits of a similar length end after one round trip.
+ *
+ * \param[in] Protocol Protocol of the channel
+ * \param[in] handle Handle of the channel
+ * \param[in] sample Commands of one sample
+ * \param[in] sampleLen Number of bytes in sample
+ * \param[in] readLen Number of bytes returned by a sample
+ * \param[in] acks Number of ack bytes at the start of the bytes returned by a sample
+ * \param[in] dataOffset Offset of the byte compared within the bytes returned by a sample
+ * \param[in] mask Bits of the byte to be compared, 0 to match on the acks only
+ * \param[in] expected Value the masked bits are waited for
+ * \param[in] timeout Time in milliseconds after which polling is given up
+ * \param[out] value Byte at dataOffset of the matching sample, or of the last sample on timeout.
+ *			May be NULL
+ * \param[out] elapsedUs Time in microseconds until the matching sample was received. May be NULL
+ * \param[in,out] pollBatch Size of the first batch, updated when a sample matched
+ * \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide)
+ * \sa
+ * \note FT_OTHER_ERROR is returned if no sample matched within the timeout. At least one batch
+ *		is always sampled, so a timeout of 0 checks once
+ * \warning To be called with the channel locked
+ */
+FT_STATUS Mid_PollSamples(FT_LegacyProtocol Protocol, FT_HANDLE handle, const uint8 *sample,
+	uint32 sampleLen, uint32 readLen, uint32 acks, uint32 dataOffset, uint8 mask,
+	uint8 expected, uint32 timeout, uint8 *value, uint32 *elapsedUs, uint32 *pollBatch)
+{
+	FT_STATUS status=FT_OK;
+	uint8 *outBuffer;
+	uint8 *inBuffer;
+	uint8 *result;
+	uint8 ackBits;
+	uint64 start;
+	uint64 now;
+	uint32 maxBatch;
+	uint32 batch;
+	uint32 samplesTaken=0;
+	uint32 sizeToWrite;
+	uint32 sizeTransferred=0;
+	uint32 i;
+	uint32 j;
+	bool found=FALSE;
+	FN_ENTER;
+
+	start = Infra_GetTimeUs();
+	maxBatch = MID_POLL_BUFFER_SIZE/sampleLen;
+	if(maxBatch > MID_POLL_MAX_BATCH)
+		maxBatch = MID_POLL_MAX_BATCH;
+	if(0 == maxBatch)
+		maxBatch = 1;
+
+	/* The buffer is filled with maxBatch samples once and the batches are sent from its start */
+	outBuffer = (uint8*) INFRA_MALLOC(maxBatch*sampleLen + 1 + readLen*maxBatch);
+	if(NULL == outBuffer)
+		return FT_INSUFFICIENT_RESOURCES;
+	inBuffer = outBuffer + maxBatch*sampleLen + 1;
+	for(i=0; i<maxBatch; i++)
+	{
+		INFRA_MEMCPY(&outBuffer[i*sampleLen],sample,sampleLen);
+	}
+
+	batch = (0 == *pollBatch)?1:*pollBatch;
+	while(FT_OK == status)
+	{
+		if(batch > maxBatch)
+			batch = maxBatch;
+		/* SEND_IMMEDIATE goes over the first byte of the next sample for this batch */
+		sizeToWrite = batch*sampleLen;
+		outBuffer[sizeToWrite++] = MPSSE_CMD_SEND_IMMEDIATE;
+		status = FT_Channel_Write(Protocol,handle,sizeToWrite,outBuffer,&sizeTransferred);
+		outBuffer[sizeToWrite-1] = sample[0];
+		if((FT_OK == status) && (sizeTransferred != sizeToWrite))
+			status = FT_IO_ERROR;
+		if(FT_OK == status)
+		{
+			status = FT_Channel_Read(Protocol,handle,readLen*batch,inBuffer,&sizeTransferred);
+			if((FT_OK == status) && (sizeTransferred != readLen*batch))
+			{
+				DBG(MSG_ERR,"Requested to read %u bytes, no. of bytes read is %u\n",
+					(unsigned)(readLen*batch),(unsigned)sizeTransferred);
+				status = FT_IO_ERROR;
+			}
+		}
+		if(FT_OK != status)
+			break;
+		now = Infra_GetTimeUs();
+
+		for(i=0; (i<batch) && !found; i++)
+		{
+			result = &inBuffer[readLen*i];
+			for(j=0, ackBits=0; j<acks; j++)
+				ackBits |= result[j];
+			if(!(ackBits & 0x01) && ((result[dataOffset] & mask) == expected))
+				found = TRUE;
+		}
+		samplesTaken += i;
+		if(NULL != value)
+			*value = inBuffer[readLen*(i-1) + dataOffset];
+		if(NULL != elapsedUs)
+			*elapsedUs = (uint32)(now - start);
+		if(found)
+			break;
+		if((now - start) >= (uint64)timeout*1000)
+		{
+			DBG(MSG_DEBUG,"no match after %u samples\n",(unsigned)samplesTaken);
+			break;
+		}
+		batch *= 2;
+	}
+
+	if(found)
+	{
+		*pollBatch = (samplesTaken < maxBatch)?samplesTaken:maxBatch;
+		DBG(MSG_DEBUG,"matched after %u samples\n",(unsigned)samplesTaken);
+	}
+	INFRA_FREE(outBuffer);
+	if((FT_OK == status) && !found)
+		status = FT_OTHER_ERROR;	/* timed out, the channel itself is fine */
+	FN_EXIT;
+	return status;
+}
+
+
+/*!
+ * \brief Takes a snapshot of the channels connected to the host system
+ *
+ * This function enumerates the devices once and keeps their information together with the list
+ * of the channels that have an MPSSE, so that FT_GetChannelInfo and FT_OpenChannel don't have to
+ * enumerate the devices again.
+ *
+ * \param none
+ * \return status
+ * \sa FT_GetNumChannels
+ * \note The previous snapshot is dropped, also when the enumeration fails
+ * \warning To be called with the lock taken(Infra_Lock)
+ */
+FT_STATUS Mid_RefreshChannels(void)
+{
+	FT_STATUS status;
+	DWORD numDevices=0;
+	uint32 devLoop;
+	FN_ENTER;
+
+	if(NULL != Mid_DeviceList)
+		INFRA_FREE(Mid_DeviceList);
+	Mid_DeviceList = NULL;
+	Mid_ChannelMap = NULL;
+	Mid_NumChannels = MID_NO_CHANNEL_FOUND;
+	Mid_SnapshotValid = FALSE;
+	Mid_SnapshotBackend = Backend_GetSelected();
+
+	/*Get the number of devices connected to the system(FT_CreateDeviceInfoList)*/
+	status = Mid_SnapshotBackend->createDeviceInfoList(&numDevices);
+	CHECK_STATUS(status);
+	if(numDevices > MID_NO_CHANNEL_FOUND)
+	{
+		/*the channel map is kept in the same allocation as the device information*/
+		Mid_DeviceList = INFRA_MALLOC((sizeof(FT_DEVICE_LIST_INFO_NODE) + sizeof(uint32))\
+			*numDevices);
+		if(NULL == Mid_DeviceList)
+			return FT_INSUFFICIENT_RESOURCES;
+		Mid_ChannelMap = (uint32*)&Mid_DeviceList[numDevices];
+		/*get the devices information(FT_GetDeviceInfoList)*/
+		status = Mid_SnapshotBackend->getDeviceInfoList(Mid_DeviceList,&numDevices);
+		if(FT_OK != status)
+		{
+			INFRA_FREE(Mid_DeviceList);
+			Mid_DeviceList = NULL;
+			Mid_ChannelMap = NULL;
+			return status;
+		}
+		for(devLoop=0; devLoop<numDevices; devLoop++)
+		{
+			if(Mid_CheckMPSSEAvailable(Mid_DeviceList[devLoop]))
+				Mid_ChannelMap[Mid_NumChannels++] = devLoop;
+		}
+	}
+	Mid_SnapshotValid = TRUE;
+	DBG(MSG_DEBUG,"%u devices, %u MPSSE channels\n",(unsigned)numDevices,
+		(unsigned)Mid_NumChannels);
+	FN_EXIT;
+	return status;
+}
+
+/*!
+ * \brief Initializes the USB function and the MPSSE of a channel without fixed waits
+ *
+ * This function is the MID_ENABLE_FAST_INIT counterpart of the initialization done by
+ * FT_InitChannel. The device is not reset. The MPSSE is probed with a bad command first, and is
+ * only reset and enabled if it doesn't answer, i.e. if the channel wasn't left in MPSSE mode. The
+ * waits for the USB and for the clock setting are replaced by waiting for the MPSSE to echo a
+ * bad command sent after the commands it has to process. The state that a previous user of the
+ * channel could have left behind(loopback, 3-phase/adaptive clocking, drive-only-zero) is
+ * cleared in the same write.
+ *
+ * \param[in] handle Handle of the channel
+ * \param[in] ftDevice Type of the chip
+ * \param[in] clockRate Clock rate
+ * \param[in] latencyTimer Latency timer
+ * \return status
+ * \sa FT_InitChannel
+ * \note Only the channel itself is touched, so the channels of a multi channel chip can be
+ * initialized from different threads at the same time
+ * \warning If the channel isn't in MPSSE mode the probe is sent out as serial data on TXD
+ */
+FT_STATUS Mid_FastInit(FT_HANDLE handle, FT_DEVICE ftDevice, uint32 clockRate,
+	uint32 latencyTimer)
+{
+	FT_STATUS status;
+	UCHAR buffer[10];
+	DWORD bufIdx=0;
+	bool echoed=FALSE;
+	FN_ENTER;
+
+	/*Purge*/
+	status = Mid_PurgeDevice(handle);
+	CHECK_STATUS(status);
+	status = Mid_SetUSBParameters(handle,USB_INPUT_BUFFER_SIZE,USB_OUTPUT_BUFFER_SIZE);
+	CHECK_STATUS(status);
+	status = Mid_SetDeviceSpecialChar(handle,FALSE,DISABLE_EVENT,FALSE,DISABLE_CHAR);
+	CHECK_STATUS(status);
+	status = Mid_SetDeviceTimeOut(handle,MID_READ_TIMEOUT,DEVICE_WRITE_TIMEOUT);
+	CHECK_STATUS(status);
+	status = Mid_SetLatencyTimer(handle,(UCHAR)latencyTimer);
+	CHECK_STATUS(status);
+
+	/*Is the MPSSE running already?*/
+	buffer[0] = MID_ECHO_CMD_1;
+	buffer[1] = MPSSE_CMD_SEND_IMMEDIATE;
+	status = Mid_WaitForEcho(handle,buffer,2,MID_ECHO_CMD_1,MID_PROBE_TIMEOUT,
+		&echoed);
+	CHECK_STATUS(status);
+	if(!echoed)
+	{
+		DBG(MSG_DEBUG,"MPSSE isn't running, enabling it\n");
+		status = Mid_ResetMPSSE(handle);
+		CHECK_STATUS(status);
+		status = Mid_EnableMPSSEIn(handle);
+		CHECK_STATUS(status);
+		status = Mid_PurgeDevice(handle);
+		CHECK_STATUS(status);
+		status = Mid_WaitForEcho(handle,buffer,2,MID_ECHO_CMD_1,MID_SYNC_TIMEOUT,
+			&echoed);
+		CHECK_STATUS(status);
+		if(!echoed)
+			return FT_OTHER_ERROR;
+	}
+
+	status = Mid_SetClock(handle,ftDevice,clockRate);
+	CHECK_STATUS(status);
+	buffer[bufIdx++] = MID_TURN_OFF_LOOPBACK_CMD;
+	if(FT_DEVICE_2232C != ftDevice)
+	{/*commands of the hi-speed chips*/
+		buffer[bufIdx++] = MPSSE_CMD_DISABLE_3PHASE_CLOCKING;
+		buffer[bufIdx++] = MPSSE_CMD_DISABLE_ADAPTIVE_CLOCKING;
+	}
+	if(FT_DEVICE_232H == ftDevice)
+	{
+		buffer[bufIdx++] = MPSSE_CMD_ENABLE_DRIVE_ONLY_ZERO;
+		buffer[bufIdx++] = 0x00;
+		buffer[bufIdx++] = 0x00;
+	}
+	buffer[bufIdx++] = MID_ECHO_CMD_2;
+	buffer[bufIdx++] = MPSSE_CMD_SEND_IMMEDIATE;
+	/*the echo comes back once the clock and the commands above have been processed*/
+	status = Mid_WaitForEcho(handle,buffer,bufIdx,MID_ECHO_CMD_2,MID_SYNC_TIMEOUT,
+		&echoed);
+	CHECK_STATUS(status);
+	if(!echoed)
+		status = FT_OTHER_ERROR;
+	FN_EXIT;
+	return status;
+}
+
+/*!
+ * \brief Writes commands ending with a bad command and waits until the MPSSE echoes it
+ *
+ * The MPSSE answers a bad command with MID_BAD_COMMAND_RESPONSE followed by the command. Since the
+ * commands are processed in order, the echo also tells that the commands before it are done.
+ * Everything read before the echo is discarded. The read timeout of the channel is set to the time
+ * left, so the thread blocks in the driver until bytes arrive rather than polling the queue, and
+ * no more bytes are read than are needed to complete the echo.
+ *
+ * \param[in] handle Handle of the channel
+ * \param[in] command Commands to be written, the last ones being ecoCmd and SEND_IMMEDIATE
+ * \param[in] length Number of bytes in command
+ * \param[in] ecoCmd Bad command whose echo is waited for
+ * \param[in] timeout Time in milliseconds after which waiting is given up
+ * \param[out] echoed TRUE if the echo was received
+ * \return status
+ * \sa Mid_SyncMPSSE
+ * \note The read timeout is set back to MID_READ_TIMEOUT before returning
+ * \warning
+ */
+FT_STATUS Mid_WaitForEcho(FT_HANDLE handle, UCHAR *command, DWORD length, UCHAR ecoCmd,
+	uint32 timeout, bool *echoed)
+{
+	FT_STATUS status;
+	UCHAR readBuffer[2];
+	DWORD bytesWritten=0;
+	DWORD numOfBytesRead=0;
+	DWORD matched=0;
+	DWORD i;
+	uint64 deadline;
+	uint64 now;
+	const Backend_Ops *ops=Backend_Get(handle);
+	FN_ENTER;
+
+	*echoed = FALSE;
+	status = Mid_SetDeviceTimeOut(handle,timeout,DEVICE_WRITE_TIMEOUT);
+	CHECK_STATUS(status);
+	deadline = Infra_GetTimeUs() + (uint64)timeout*1000;
+	status = ops->write(handle,command,length,&bytesWritten);
+	while((FT_OK == status) && !*echoed)
+	{
+		/*matched is the number of bytes of the echo received already*/
+		status = ops->read(handle,readBuffer,2-matched,&numOfBytesRead);
+		if((FT_OK != status) || (0 == numOfBytesRead))
+			break;
+		for(i=0; i<numOfBytesRead; i++)
+		{
+			if((1 == matched) && (readBuffer[i] == ecoCmd))
+				*echoed = TRUE;
+			else
+				matched = (readBuffer[i] == MID_BAD_COMMAND_RESPONSE)?1:0;
+		}
+		now = Infra_GetTimeUs();
+		if(*echoed || (now >= deadline))
+			break;
+		status = Mid_SetDeviceTimeOut(handle,(DWORD)((deadline-now+999)/1000),
+			DEVICE_WRITE_TIMEOUT);
+	}
+	DBG(MSG_DEBUG,"echo of 0x%x %s\n",(unsigned)ecoCmd,*echoed?"received":"timed out");
+	if(FT_OK == status)
+		status = Mid_SetDeviceTimeOut(handle,MID_READ_TIMEOUT,DEVICE_WRITE_TIMEOUT);
+	else
+		Mid_SetDeviceTimeOut(handle,MID_READ_TIMEOUT,DEVICE_WRITE_TIMEOUT);
+	FN_EXIT;
+	return status;
+}
+
+/*!
+ * \brief Sets the latency timer and the USB transfer sizes of a channel
+ *
+ * \param[in] handle Handle of the channel
+ * \param[in] profile Pointer to the profile to be applied
+ * \return status
+ * \sa FT_SetTransportProfile
+ * \note
+ * \warning
+ */
+FT_STATUS Mid_ApplyProfile(FT_HANDLE handle, const FT_TransportProfile *profile)
+{
+	FT_STATUS status;
+	FN_ENTER;
+	status = Mid_SetUSBParameters(handle,profile->inTransferSize,profile->outTransferSize);
+	CHECK_STATUS(status);
+	status = Mid_SetLatencyTimer(handle,profile->latencyTimer);
+	FN_EXIT;
+	return status;
+}
+
+/*!
+ * \brief Measures the round trip and the block read rate of a channel with its current settings
+ *
+ * The round trip is the average over MID_CALIBRATE_ROUND_TRIPS reads of the low byte pins
+ * followed by SEND_IMMEDIATE. The rate is that of a MID_CALIBRATE_BLOCK_SIZE bytes read.
+ *
+ * \param[in] handle Handle of the channel
+ * \param[out] profile Pointer to the profile whose roundTripUs and bytesPerSecond are filled in
+ * \return status
+ * \sa FT_CalibrateChannel
+ * \note
+ * \warning
+ */
+FT_STATUS Mid_MeasureTransport(FT_HANDLE handle, FT_TransportProfile *profile)
+{
+	FT_STATUS status;
+	UCHAR command[4];
+	UCHAR *readBuffer;
+	DWORD bytesWritten=0;
+	DWORD bytesRead=0;
+	uint64 start;
+	uint64 elapsed;
+	uint32 i;
+	const Backend_Ops *ops=Backend_Get(handle);
+	FN_ENTER;
+
+	readBuffer = (UCHAR*)INFRA_MALLOC(MID_CALIBRATE_BLOCK_SIZE);
+	if(NULL == readBuffer)
+		return FT_INSUFFICIENT_RESOURCES;
+	status = Mid_PurgeDevice(handle);
+
+	command[0] = MPSSE_CMD_GET_DATA_BITS_LOWBYTE;
+	command[1] = MPSSE_CMD_SEND_IMMEDIATE;
+	start = Infra_GetTimeUs();
+	for(i=0; (FT_OK == status) && (i<MID_CALIBRATE_ROUND_TRIPS); i++)
+	{
+		status = ops->write(handle,command,2,&bytesWritten);
+		if(FT_OK == status)
+			status = ops->read(handle,readBuffer,1,&bytesRead);
+		if((FT_OK == status) && (1 != bytesRead))
+			status = FT_IO_ERROR;
+	}
+	elapsed = Infra_GetTimeUs() - start;
+	profile->roundTripUs = (uint32)(elapsed/MID_CALIBRATE_ROUND_TRIPS);
+
+	command[0] = MPSSE_CMD_DATA_IN_BYTES_POS_EDGE;
+	command[1] = (uint8)((MID_CALIBRATE_BLOCK_SIZE-1) & 0xFF);
+	command[2] = (uint8)(((MID_CALIBRATE_BLOCK_SIZE-1)>>8) & 0xFF);
+	command[3] = MPSSE_CMD_SEND_IMMEDIATE;
+	start = Infra_GetTimeUs();
+	if(FT_OK == status)
+		status = ops->write(handle,command,4,&bytesWritten);
+	if(FT_OK == status)
+		status = ops->read(handle,readBuffer,MID_CALIBRATE_BLOCK_SIZE,&bytesRead);
+	if((FT_OK == status) && (MID_CALIBRATE_BLOCK_SIZE != bytesRead))
+		status = FT_IO_ERROR;
+	elapsed = Infra_GetTimeUs() - start;
+	profile->bytesPerSecond = (0 == elapsed)?0:
+		(uint32)(((uint64)MID_CALIBRATE_BLOCK_SIZE*1000000)/elapsed);
+
+	INFRA_FREE(readBuffer);
 	FN_EXIT;
 	return status;
 }
@@ -43,13 +43,9 @@
 
 #define MID_MAX_IN_BUF_SIZE         	4096
 
-#define MID_ECHO_COMMAND_ONCE			0
-#define MID_ECHO_COMMAND_CONTINUOUSLY   1
 #define MID_ECHO_CMD_1					0xAA
 #define MID_ECHO_CMD_2					0xAB
 #define MID_BAD_COMMAND_RESPONSE        0xFA
-#define MID_CMD_NOT_ECHOED				0
-#define MID_CMD_ECHOED					1
 
 /*clock*/
 #define MID_SET_LOW_BYTE_DATA_BITS_CMD	0x80
@@ -73,6 +69,39 @@
 
 #define MID_LEN_MAX_ERROR_STRING		500
 
+/* Bit of the options passed to FT_InitChannel that selects the fast initialization. It is
+I2C_ENABLE_FAST_INIT and SPI_CONFIG_OPTION_FAST_INIT in the protocol modules */
+#define MID_ENABLE_FAST_INIT			0x00000080
+/* Time in milliseconds the MPSSE is given to echo a command when it is thought to be running
+already(fast initialization, recovery), and when it has just been enabled or reconfigured */
+#define MID_PROBE_TIMEOUT				10
+#define MID_SYNC_TIMEOUT				500
+
+/* Bits of the options passed to FT_InitChannel that make it calibrate the transport and apply
+the profile of a workload class(FT_CalibrateChannel). They are I2C_CALIBRATE_LATENCY/THROUGHPUT
+and SPI_CONFIG_OPTION_CALIBRATE_LATENCY/THROUGHPUT in the protocol modules */
+#define MID_CALIBRATE_LATENCY			0x00000100
+#define MID_CALIBRATE_THROUGHPUT		0x00000200
+/* Number of round trips averaged, and size of the block read, by Mid_MeasureTransport */
+#define MID_CALIBRATE_ROUND_TRIPS		8
+#define MID_CALIBRATE_BLOCK_SIZE		16384
+
+/* Mid_PollSamples queues at most this many samples, or as many as fit in MID_POLL_BUFFER_SIZE
+bytes of commands, per round trip */
+#define MID_POLL_MAX_BATCH				64
+#define MID_POLL_BUFFER_SIZE			16384
+/* Status of a Mid_PollSamples call as seen by the protocol modules' end of transfer: a poll
+that timed out or couldn't start left the channel in a known state */
+#define MID_POLL_TRANSFER_STATUS(status)	(((FT_OTHER_ERROR == (status)) || \
+	(FT_INSUFFICIENT_RESOURCES == (status)))?FT_OK:(status))
+
+/* Read timeout of the channels, in milliseconds */
+#ifdef FT800_HACK
+#define MID_READ_TIMEOUT				DEVICE_READ_TIMEOUT_INFINITE
+#else
+#define MID_READ_TIMEOUT				5000
+#endif
+
 #define MID_CHK_IN_BUF_OK(size)	{if(size > MID_MAX_IN_BUF_SIZE) \
 	{ return FT_INSUFFICIENT_RESOURCES;}}
 
@@ -81,8 +110,14 @@ FT_STATUS FT_GetChannelInfo(FT_LegacyProtocol Protocol, uint32 index,
 			FT_DEVICE_LIST_INFO_NODE *chanInfo);
 FT_STATUS FT_OpenChannel(FT_LegacyProtocol Protocol, uint32 index,
 			FT_HANDLE *handle);
+FT_STATUS FT_OpenChannelEx(FT_LegacyProtocol Protocol, PVOID arg, DWORD flags,
+			FT_HANDLE *handle);
 FT_STATUS FT_InitChannel(FT_LegacyProtocol Protocol, FT_HANDLE handle,...);
 FT_STATUS FT_CloseChannel(FT_LegacyProtocol Protocol, FT_HANDLE handle);
+FT_STATUS FT_RecoverChannel(FT_HANDLE handle, uint32 clockRate, uint8 *restore,
+			uint32 restoreLength);
+FT_STATUS FT_CalibrateChannel(FT_HANDLE handle, uint32 clockRate, uint32 workload,
+			FT_TransportProfile *profiles);
 FT_STATUS FT_Channel_Read(FT_LegacyProtocol Protocol, FT_HANDLE handle,
 				uint32 noOfBytes, uint8* buffer, uint32 *noOfBytesTransferred);
 FT_STATUS FT_Channel_Write(FT_LegacyProtocol Protocol, FT_HANDLE handle,
@@ -104,10 +139,9 @@ extern FT_STATUS Mid_SetLatencyTimer (FT_HANDLE handle, UCHAR milliSecond);
 extern FT_STATUS Mid_ResetMPSSE(FT_HANDLE handle);
 extern FT_STATUS Mid_EnableMPSSEIn(FT_HANDLE handle);
 extern FT_STATUS Mid_SyncMPSSE(FT_HANDLE handle);
-extern FT_STATUS Mid_SendReceiveCmdFromMPSSE(FT_HANDLE handle,UCHAR\
-	echoCmdFlag,UCHAR ecoCmd,UCHAR *cmdEchoed);
 extern FT_STATUS Mid_SetGPIOLow(FT_HANDLE handle, uint8 value, uint8 \
 	direction);
+extern uint32 Mid_GetClockDivisor(FT_DEVICE ftDevice, uint32 clock, uint32 *base);
 extern FT_STATUS Mid_SetClock(FT_HANDLE handle, FT_DEVICE ftDevice, uint32 \
 	clock);
 extern FT_STATUS Mid_GetFtDeviceType(FT_HANDLE handle,FT_DEVICE *ftDevice);
@@ -116,7 +150,14 @@ extern FT_STATUS Mid_SetDeviceLoopbackState(FT_HANDLE handle,uint8 \
 extern FT_STATUS Mid_EmptyDeviceInputBuff(FT_HANDLE handle);
 FTDI_API FT_STATUS FT_WriteGPIO(FT_HANDLE handle, uint8 dir, uint8 value);
 FTDI_API FT_STATUS FT_ReadGPIO(FT_HANDLE handle,uint8 *value);
+FTDI_API FT_STATUS FT_SyncChannel(FT_HANDLE handle);
+FTDI_API FT_STATUS FT_SetTransportProfile(FT_HANDLE handle, const FT_TransportProfile *profile);
+FTDI_API FT_STATUS FT_SetBackend(const char *name);
 extern FT_STATUS Mid_GetQueueStatus(FT_HANDLE handle, LPDWORD lpdwAmountInRxQueue);
+extern FT_STATUS Mid_PollSamples(FT_LegacyProtocol Protocol, FT_HANDLE handle,
+	const uint8 *sample, uint32 sampleLen, uint32 readLen, uint32 acks, uint32 dataOffset,
+	uint8 mask, uint8 expected, uint32 timeout, uint8 *value, uint32 *elapsedUs,
+	uint32 *pollBatch);
 
 #endif /* FTDI_MID_H */
 
@@ -0,0 +1,398 @@
+/*!
+ * \file ftdi_mux.c
+ *
+ * \author FTDI
+ * \date 20261018
+ *
+ * Copyright (C) 2000-2014 Future Technology Devices International Limited
+ *
+ *
+ * THIS SOFTWARE IS PROVIDED BY FUTURE TECHNOLOGY DEVICES INTERNATIONAL LIMITED ``AS IS'' AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL FUTURE TECHNOLOGY DEVICES INTERNATIONAL LIMITED
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Project: libMPSSE
+ * Module: Mux
+ *
+ * Rivision History:
+ * 0.1 - initial version
+ */
+
+
+/******************************************************************************/
+/*								Include files					  			  */
+/******************************************************************************/
+#include "ftdi_infra.h"		/*Common portable infrastructure(datatypes, libraries, etc)*/
+#include "ftdi_common.h"	/*Common across I2C, SPI, JTAG modules*/
+#include "ftdi_mux.h"		/*Mux specific*/
+
+
+/******************************************************************************/
+/*								Macro and type defines					  		  */
+/******************************************************************************/
+/* Enabling the macro will lead to checking of all parameters that are passed to the library from
+    the user application*/
+#define ENABLE_PARAMETER_CHECKING	1
+
+
+/******************************************************************************/
+/*								Local function declarations					  */
+/******************************************************************************/
+Mux *MUX_Find(FT_HANDLE handle, uint32 muxAddress);
+uint8 MUX_ControlValue(const Mux *mux, uint32 channel);
+
+
+/******************************************************************************/
+/*								Global variables							  */
+/******************************************************************************/
+
+/*Root of the linked list that holds the muxes*/
+static Mux *MUX_ListHead=NULL;
+
+
+/******************************************************************************/
+/*						Public function definitions						  */
+/******************************************************************************/
+
+/*!
+ * \brief Registers an I2C bus multiplexer
+ *
+ * The muxes sit on the I2C bus of the channel itself, cascaded muxes are not supported. The
+ * selection of each mux is cached, it starts out unknown.
+ *
+ * \param[in] handle Handle of the channel the mux is connected to
+ * \param[in] muxAddress Address of the mux
+ * \param[in] type MUX_TYPE_SWITCH or MUX_TYPE_MUX
+ * \param[in] numChannels Number of downstream channels, at most MUX_MAX_CHANNELS
+ * \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide)
+ * \sa MUX_Remove
+ * \note If the mux is already registered then it is replaced
+ * \warning
+ */
+FTDI_API FT_STATUS MUX_Add(FT_HANDLE handle, uint32 muxAddress, uint32 type,
+	uint32 numChannels)
+{
+	FT_STATUS status=FT_OK;
+	Mux *mux;
+	FN_ENTER;
+#ifdef ENABLE_PARAMETER_CHECKING
+	CHECK_NULL_RET(handle);
+	if((muxAddress > 127) || ((MUX_TYPE_SWITCH != type) && (MUX_TYPE_MUX != type)) ||
+		(0 == numChannels) || (numChannels > MUX_MAX_CHANNELS))
+		return FT_INVALID_PARAMETER;
+#endif
+
+	MUX_Remove(handle,muxAddress);
+	mux = (Mux*) INFRA_MALLOC(sizeof(Mux));
+	if(NULL == mux)
+		return FT_INSUFFICIENT_RESOURCES;
+	memset(mux,0,sizeof(Mux));
+	mux->handle = handle;
+	mux->muxAddress = muxAddress;
+	mux->type = type;
+	mux->numChannels = numChannels;
+	mux->stateValid = FALSE;
+	mux->next = MUX_ListHead;
+	MUX_ListHead = mux;
+	FN_EXIT;
+	return status;
+}
+
+/*!
+ * \brief Unregisters an I2C bus multiplexer
+ *
+ * \param[in] handle Handle of the channel the mux is connected to
+ * \param[in] muxAddress Address of the mux
+ * \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide)
+ * \sa MUX_Add
+ * \note The mux is left as it is on the bus
+ * \warning
+ */
+FTDI_API FT_STATUS MUX_Remove(FT_HANDLE handle, uint32 muxAddress)
+{
+	FT_STATUS status=FT_OK;
+	Mux *mux;
+	Mux *lastNode=NULL;
+	FN_ENTER;
+
+	for(mux=MUX_ListHead; NULL != mux; lastNode=mux, mux=mux->next)
+	{
+		if((mux->handle == handle) && (mux->muxAddress == muxAddress))
+		{
+			if(NULL == lastNode)
+				MUX_ListHead = mux->next;
+			else
+				lastNode->next = mux->next;
+			INFRA_FREE(mux);
+			break;
+		}
+	}
+	FN_EXIT;
+	return status;
+}
+
+/*!
+ * \brief Forgets the cached selection of all the muxes of a channel
+ *
+ * The next transfer through each mux writes its control register again.
+ *
+ * \param[in] handle Handle of the channel
+ * \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide)
+ * \sa
+ * \note To be called when the muxes may have changed behind the library's back, e.g. after they
+ *		were reset or after another master used the bus
+ * \warning
+ */
+FTDI_API FT_STATUS MUX_Invalidate(FT_HANDLE handle)
+{
+	FT_STATUS status=FT_OK;
+	Mux *mux;
+	FN_ENTER;
+
+	for(mux=MUX_ListHead; NULL != mux; mux=mux->next)
+	{
+		if(mux->handle == handle)
+			mux->stateValid = FALSE;
+	}
+	FN_EXIT;
+	return status;
+}
+
+/*!
+ * \brief Selects a channel of a mux
+ *
+ * \param[in] handle Handle of the channel the mux is connected to
+ * \param[in] muxAddress Address of the mux
+ * \param[in] channel Downstream channel to be selected, MUX_CHANNEL_NONE to deselect all of them
+ * \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide)
+ * \sa MUX_Transfer
+ * \note Nothing is written to the bus if the muxes are already in the required state
+ * \warning
+ */
+FTDI_API FT_STATUS MUX_Select(FT_HANDLE handle, uint32 muxAddress, uint32 channel)
+{
+	return MUX_Transfer(handle,muxAddress,channel,NULL,0);
+}
+
+/*!
+ * \brief Performs a combined I2C transaction with slaves behind a channel of a mux
+ *
+ * The messages are preceded by a write to the control register of the mux if the channel is not
+ * already selected, and by a write that deselects every other mux of the channel that may still
+ * have a channel selected, so that identical slaves behind different muxes don't answer together.
+ * Each of these writes ends with a STOP, which is when the mux applies the new selection, and
+ * they are compiled into the same command buffer as the messages(see I2C_Transfer). Routing to a
+ * channel that is already selected costs nothing.
+ *
+ * \param[in] handle Handle of the channel the mux is connected to
+ * \param[in] muxAddress Address of the mux
+ * \param[in] channel Downstream channel of the mux the slaves are connected to
+ * \param[in,out] msgs Array of messages, as for I2C_Transfer
+ * \param[in] count Number of messages in the array
+ * \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide). If a mux didn't
+ *			ack its control register write then the status of that write is returned
+ * \sa I2C_Transfer, MUX_Invalidate
+ * \note The cached selection of a mux is only updated when it acked the write, and becomes
+ *		unknown otherwise
+ * \warning
+ */
+FTDI_API FT_STATUS MUX_Transfer(FT_HANDLE handle, uint32 muxAddress, uint32 channel,
+	I2C_Msg *msgs, uint32 count)
+{
+	FT_STATUS status=FT_OK;
+	Mux *target;
+	Mux *mux;
+	I2C_Msg *allMsgs;
+	uint32 numMuxes=0;
+	uint32 numSelects=0;
+	uint32 i;
+	uint8 value;
+	FN_ENTER;
+#ifdef ENABLE_PARAMETER_CHECKING
+	CHECK_NULL_RET(handle);
+	if((count > 0) && (NULL == msgs))
+		return FT_INVALID_PARAMETER;
+#endif
+
+	target = MUX_Find(handle,muxAddress);
+	if((NULL == target) || ((channel >= target->numChannels) && (MUX_CHANNEL_NONE != channel)))
+		return FT_INVALID_PARAMETER;
+	for(mux=MUX_ListHead; NULL != mux; mux=mux->next)
+	{
+		if(mux->handle == handle)
+			numMuxes++;
+	}
+	allMsgs = (I2C_Msg*) INFRA_MALLOC((numMuxes + count)*sizeof(I2C_Msg));
+	if(NULL == allMsgs)
+		return FT_INSUFFICIENT_RESOURCES;
+
+	for(mux=MUX_ListHead; NULL != mux; mux=mux->next)
+	{
+		if(mux->handle != handle)
+			continue;
+		value = MUX_ControlValue(mux,(mux == target)?channel:MUX_CHANNEL_NONE);
+		if(mux->stateValid && (mux->state == value))
+			continue;
+		mux->select = value;
+		mux->stateValid = FALSE;
+		allMsgs[numSelects].addr = mux->muxAddress;
+		allMsgs[numSelects].flags = I2C_MSG_STOP;
+		allMsgs[numSelects].len = 1;
+		allMsgs[numSelects].buf = &mux->select;
+		allMsgs[numSelects].status = FT_OTHER_ERROR;
+		numSelects++;
+	}
+	if(count > 0)
+	{
+		INFRA_MEMCPY(&allMsgs[numSelects],msgs,count*sizeof(I2C_Msg));
+	}
+	DBG(MSG_DEBUG,"mux 0x%x channel %u, %u control register writes\n",(unsigned)muxAddress,
+		(unsigned)channel,(unsigned)numSelects);
+
+	status = I2C_Transfer(handle,allMsgs,numSelects + count);
+	for(i=0; i<numSelects; i++)
+	{
+		if(FT_OK != allMsgs[i].status)
+			continue;
+		for(mux=MUX_ListHead; NULL != mux; mux=mux->next)
+		{
+			if((mux->handle == handle) && (mux->muxAddress == allMsgs[i].addr))
+			{
+				mux->state = mux->select;
+				mux->stateValid = TRUE;
+			}
+		}
+	}
+	if(count > 0)
+	{
+		INFRA_MEMCPY(msgs,&allMsgs[numSelects],count*sizeof(I2C_Msg));
+	}
+	INFRA_FREE(allMsgs);
+	FN_EXIT;
+	return status;
+}
+
+/*!
+ * \brief Reads from a slave behind a channel of a mux
+ *
+ * \param[in] handle Handle of the channel the mux is connected to
+ * \param[in] muxAddress Address of the mux
+ * \param[in] channel Downstream channel of the mux the slave is connected to
+ * \param[in] deviceAddress Address of the I2C slave
+ * \param[in] sizeToTransfer Number of bytes to be read
+ * \param[out] buffer Pointer to the buffer where data is to be read
+ * \param[out] sizeTransferred Pointer to variable containing the number of bytes read
+ * \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide)
+ * \sa MUX_Transfer
+ * \note
+ * \warning
+ */
+FTDI_API FT_STATUS MUX_DeviceRead(FT_HANDLE handle, uint32 muxAddress, uint32 channel,
+	uint32 deviceAddress, uint32 sizeToTransfer, uint8 *buffer, uint32 *sizeTransferred)
+{
+	FT_STATUS status;
+	I2C_Msg msg;
+	FN_ENTER;
+#ifdef ENABLE_PARAMETER_CHECKING
+	CHECK_NULL_RET(sizeTransferred);
+#endif
+
+	msg.addr = deviceAddress;
+	msg.flags = I2C_MSG_READ;
+	msg.len = sizeToTransfer;
+	msg.buf = buffer;
+	msg.sizeTransferred = 0;
+	status = MUX_Transfer(handle,muxAddress,channel,&msg,1);
+	*sizeTransferred = msg.sizeTransferred;
+	FN_EXIT;
+	return status;
+}
+
+/*!
+ * \brief Writes to a slave behind a channel of a mux
+ *
+ * \param[in] handle Handle of the channel the mux is connected to
+ * \param[in] muxAddress Address of the mux
+ * \param[in] channel Downstream channel of the mux the slave is connected to
+ * \param[in] deviceAddress Address of the I2C slave
+ * \param[in] sizeToTransfer Number of bytes to be written
+ * \param[in] buffer Pointer to the buffer from where data is to be written
+ * \param[out] sizeTransferred Pointer to variable containing the number of bytes written
+ * \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide)
+ * \sa MUX_Transfer
+ * \note
+ * \warning
+ */
+FTDI_API FT_STATUS MUX_DeviceWrite(FT_HANDLE handle, uint32 muxAddress, uint32 channel,
+	uint32 deviceAddress, uint32 sizeToTransfer, uint8 *buffer, uint32 *sizeTransferred)
+{
+	FT_STATUS status;
+	I2C_Msg msg;
+	FN_ENTER;
+#ifdef ENABLE_PARAMETER_CHECKING
+	CHECK_NULL_RET(sizeTransferred);
+#endif
+
+	msg.addr = deviceAddress;
+	msg.flags = 0;
+	msg.len = sizeToTransfer;
+	msg.buf = buffer;
+	msg.sizeTransferred = 0;
+	status = MUX_Transfer(handle,muxAddress,channel,&msg,1);
+	*sizeTransferred = msg.sizeTransferred;
+	FN_EXIT;
+	return status;
+}
+
+
+/******************************************************************************/
+/*						Local function definitions						  */
+/******************************************************************************/
+
+/*!
+ * \brief Finds a mux
+ *
+ * \param[in] handle Handle of the channel the mux is connected to
+ * \param[in] muxAddress Address of the mux
+ * \return Pointer to the mux, NULL if it wasn't registered
+ * \sa
+ * \note
+ * \warning
+ */
+Mux *MUX_Find(FT_HANDLE handle, uint32 muxAddress)
+{
+	Mux *mux;
+
+	for(mux=MUX_ListHead; NULL != mux; mux=mux->next)
+	{
+		if((mux->handle == handle) && (mux->muxAddress == muxAddress))
+			break;
+	}
+	if(NULL == mux)
+		DBG(MSG_ERR,"no mux at address 0x%x\n",(unsigned)muxAddress);
+	return mux;
+}
+
+/*!
+ * \brief Works out the value of the control register of a mux that selects a channel
+ *
+ * \param[in] mux Pointer to the mux
+ * \param[in] channel Downstream channel, MUX_CHANNEL_NONE for none
+ * \return Value of the control register
+ * \sa
+ * \note
+ * \warning
+ */
+uint8 MUX_ControlValue(const Mux *mux, uint32 channel)
+{
+	if(MUX_CHANNEL_NONE == channel)
+		return 0;
+	if(MUX_TYPE_MUX == mux->type)
+		return (uint8)(MUX_MUX_ENABLE | channel);
+	return (uint8)(1 << channel);
+}
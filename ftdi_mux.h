@@ -0,0 +1,90 @@
+/*!
+ * \file ftdi_mux.h
+ *
+ * \author FTDI
+ * \date 20261018
+ *
+ * Copyright (C) 2000-2014 Future Technology Devices International Limited
+ *
+ *
+ * THIS SOFTWARE IS PROVIDED BY FUTURE TECHNOLOGY DEVICES INTERNATIONAL LIMITED ``AS IS'' AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL FUTURE TECHNOLOGY DEVICES INTERNATIONAL LIMITED
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Project: libMPSSE
+ * Module: Mux
+ *
+ * Rivision History:
+ * 0.1 - initial version
+ */
+
+#ifndef FTDI_MUX_H
+#define FTDI_MUX_H
+
+#include "ftdi_i2c.h"
+
+
+/******************************************************************************/
+/*								Macro defines								  */
+/******************************************************************************/
+/* Types of I2C bus multiplexers, see MUX_Add */
+/* Switch, the control register holds one enable bit per channel(TCA9548A, PCA9548A, PCA9546A,
+PCA9543A) */
+#define MUX_TYPE_SWITCH			0
+/* Multiplexer, the control register holds an enable bit and the number of the channel(PCA9544A,
+PCA9542A, PCA9540B) */
+#define MUX_TYPE_MUX			1
+
+/* Enable bit of the control register of a MUX_TYPE_MUX */
+#define MUX_MUX_ENABLE			0x04
+
+/* Channel number that deselects all the channels of a mux */
+#define MUX_CHANNEL_NONE		0xFF
+
+/* Largest number of channels of a mux */
+#define MUX_MAX_CHANNELS		8
+
+
+/******************************************************************************/
+/*								Type defines								  */
+/******************************************************************************/
+
+/* A mux on the I2C bus of a channel. The muxes are stored in the form of a linked list */
+typedef struct Mux_t
+{
+	FT_HANDLE		handle;
+	uint32			muxAddress;
+	uint32			type;		/* MUX_TYPE_* */
+	uint32			numChannels;
+	bool			stateValid;	/* the control register is known to hold state */
+	uint8			state;		/* cached value of the control register */
+	uint8			select;		/* value being written to the control register */
+	struct Mux_t	*next;
+}Mux;
+
+
+/******************************************************************************/
+/*								Function declarations						  */
+/******************************************************************************/
+FTDI_API FT_STATUS MUX_Add(FT_HANDLE handle, uint32 muxAddress, uint32 type,
+	uint32 numChannels);
+FTDI_API FT_STATUS MUX_Remove(FT_HANDLE handle, uint32 muxAddress);
+FTDI_API FT_STATUS MUX_Invalidate(FT_HANDLE handle);
+FTDI_API FT_STATUS MUX_Select(FT_HANDLE handle, uint32 muxAddress, uint32 channel);
+FTDI_API FT_STATUS MUX_Transfer(FT_HANDLE handle, uint32 muxAddress, uint32 channel,
+	I2C_Msg *msgs, uint32 count);
+FTDI_API FT_STATUS MUX_DeviceRead(FT_HANDLE handle, uint32 muxAddress, uint32 channel,
+	uint32 deviceAddress, uint32 sizeToTransfer, uint8 *buffer, uint32 *sizeTransferred);
+FTDI_API FT_STATUS MUX_DeviceWrite(FT_HANDLE handle, uint32 muxAddress, uint32 channel,
+	uint32 deviceAddress, uint32 sizeToTransfer, uint8 *buffer, uint32 *sizeTransferred);
+
+/******************************************************************************/
+
+
+#endif	/*FTDI_MUX_H*/
+
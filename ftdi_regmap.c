@@ -0,0 +1,577 @@
+/*!
+ * \file ftdi_regmap.c
+ *
+ * \author FTDI
+ * \date 20261018
+ *
+ * Copyright (C) 2000-2014 Future Technology Devices International Limited
+ *
+ *
+ * THIS SOFTWARE IS PROVIDED BY FUTURE TECHNOLOGY DEVICES INTERNATIONAL LIMITED ``AS IS'' AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL FUTURE TECHNOLOGY DEVICES INTERNATIONAL LIMITED
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Project: libMPSSE
+ * Module: Regmap
+ *
+ * Rivision History:
+ * 0.1 - initial version
+ */
+
+
+/******************************************************************************/
+/*								Include files					  			  */
+/******************************************************************************/
+#include "ftdi_infra.h"		/*Common portable infrastructure(datatypes, libraries, etc)*/
+#include "ftdi_common.h"	/*Common across I2C, SPI, JTAG modules*/
+#include "ftdi_regmap.h"	/*Regmap specific*/
+
+
+/******************************************************************************/
+/*								Macro and type defines					  		  */
+/******************************************************************************/
+/* Enabling the macro will lead to checking of all parameters that are passed to the library from
+    the user application*/
+#define ENABLE_PARAMETER_CHECKING	1
+
+/* The register is never read from the device to fill the cache */
+#define REGMAP_NO_FILL(flags)	((flags) & (REGMAP_FLAG_VOLATILE | REGMAP_FLAG_PRECIOUS))
+
+/* I2C_Transfer went out on the bus and filled in the status of every message, some of which
+the slave may have nAcked */
+#define REGMAP_TRANSFER_DONE(status)	((FT_OK == (status)) || \
+	(FT_DEVICE_NOT_FOUND == (status)) || (FT_FAILED_TO_WRITE_DEVICE == (status)))
+
+
+/******************************************************************************/
+/*								Local function declarations					  */
+/******************************************************************************/
+Regmap *REGMAP_Find(FT_HANDLE handle, uint32 deviceAddress);
+FT_STATUS REGMAP_WriteDevice(Regmap *map, uint32 reg, uint8 value);
+FT_STATUS REGMAP_ReadDevice(Regmap *map, uint32 reg, uint8 *value);
+
+
+/******************************************************************************/
+/*								Global variables							  */
+/******************************************************************************/
+
+/*Root of the linked list that holds the register maps*/
+static Regmap *REGMAP_ListHead=NULL;
+
+
+/******************************************************************************/
+/*						Public function definitions						  */
+/******************************************************************************/
+
+/*!
+ * \brief Creates the register cache of an I2C slave
+ *
+ * This function allocates a cache for registers 0 to numRegisters-1 of the slave. The registers
+ * are 8bit wide and have 8bit addresses. All the registers start out uncached and with no flags.
+ *
+ * \param[in] handle Handle of the channel the slave is connected to
+ * \param[in] deviceAddress Address of the I2C slave
+ * \param[in] numRegisters Number of registers, at most REGMAP_MAX_REGISTERS
+ * \param[in] options REGMAP_OPTION_*
+ * \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide)
+ * \sa REGMAP_Exit
+ * \note If a map already exists for the slave then it is replaced
+ * \warning
+ */
+FTDI_API FT_STATUS REGMAP_Init(FT_HANDLE handle, uint32 deviceAddress, uint32 numRegisters,
+	uint32 options)
+{
+	FT_STATUS status=FT_OK;
+	Regmap *map;
+	FN_ENTER;
+#ifdef ENABLE_PARAMETER_CHECKING
+	CHECK_NULL_RET(handle);
+	if((deviceAddress > 127) || (0 == numRegisters) || (numRegisters > REGMAP_MAX_REGISTERS))
+		return FT_INVALID_PARAMETER;
+#endif
+
+	REGMAP_Exit(handle,deviceAddress);
+	map = (Regmap*) INFRA_MALLOC(sizeof(Regmap));
+	if(NULL == map)
+		return FT_INSUFFICIENT_RESOURCES;
+	map->values = (uint8*) INFRA_MALLOC(2*numRegisters);
+	if(NULL == map->values)
+	{
+		INFRA_FREE(map);
+		return FT_INSUFFICIENT_RESOURCES;
+	}
+	map->flags = map->values + numRegisters;
+	memset(map->values,0,2*numRegisters);
+	map->handle = handle;
+	map->deviceAddress = deviceAddress;
+	map->numRegisters = numRegisters;
+	map->options = options;
+	map->next = REGMAP_ListHead;
+	REGMAP_ListHead = map;
+	FN_EXIT;
+	return status;
+}
+
+/*!
+ * \brief Deletes the register cache of an I2C slave
+ *
+ * \param[in] handle Handle of the channel the slave is connected to
+ * \param[in] deviceAddress Address of the I2C slave
+ * \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide)
+ * \sa REGMAP_Init
+ * \note Writes that were not synced are lost
+ * \warning
+ */
+FTDI_API FT_STATUS REGMAP_Exit(FT_HANDLE handle, uint32 deviceAddress)
+{
+	Regmap *map;
+	Regmap *lastNode=NULL;
+	FN_ENTER;
+
+	for(map=REGMAP_ListHead; NULL != map; lastNode=map, map=map->next)
+	{
+		if((map->handle == handle) && (map->deviceAddress == deviceAddress))
+		{
+			if(NULL == lastNode)
+				REGMAP_ListHead = map->next;
+			else
+				lastNode->next = map->next;
+			INFRA_FREE(map->values);
+			INFRA_FREE(map);
+			break;
+		}
+	}
+	FN_EXIT;
+	return FT_OK;
+}
+
+/*!
+ * \brief Sets the flags of a register
+ *
+ * \param[in] handle Handle of the channel the slave is connected to
+ * \param[in] deviceAddress Address of the I2C slave
+ * \param[in] reg Address of the register
+ * \param[in] flags REGMAP_FLAG_VOLATILE and/or REGMAP_FLAG_PRECIOUS, 0 for a plain register
+ * \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide)
+ * \sa
+ * \note Making a register volatile drops its cached value
+ * \warning
+ */
+FTDI_API FT_STATUS REGMAP_SetFlags(FT_HANDLE handle, uint32 deviceAddress, uint32 reg,
+	uint8 flags)
+{
+	Regmap *map;
+	FN_ENTER;
+
+	map = REGMAP_Find(handle,deviceAddress);
+	if((NULL == map) || (reg >= map->numRegisters))
+		return FT_INVALID_PARAMETER;
+	flags &= REGMAP_FLAG_VOLATILE | REGMAP_FLAG_PRECIOUS;
+	if(flags & REGMAP_FLAG_VOLATILE)
+		map->flags[reg] = flags;
+	else
+		map->flags[reg] = (map->flags[reg] & (REGMAP_STATE_VALID | REGMAP_STATE_DIRTY)) | flags;
+	FN_EXIT;
+	return FT_OK;
+}
+
+/*!
+ * \brief Reads a register
+ *
+ * The cached value is returned if there is one, otherwise the register is read from the slave
+ * and, unless it is volatile, cached.
+ *
+ * \param[in] handle Handle of the channel the slave is connected to
+ * \param[in] deviceAddress Address of the I2C slave
+ * \param[in] reg Address of the register
+ * \param[out] value Pointer to the value of the register
+ * \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide)
+ * \sa REGMAP_Prefetch
+ * \note
+ * \warning
+ */
+FTDI_API FT_STATUS REGMAP_Read(FT_HANDLE handle, uint32 deviceAddress, uint32 reg,
+	uint8 *value)
+{
+	FT_STATUS status=FT_OK;
+	Regmap *map;
+	FN_ENTER;
+#ifdef ENABLE_PARAMETER_CHECKING
+	CHECK_NULL_RET(value);
+#endif
+
+	map = REGMAP_Find(handle,deviceAddress);
+	if((NULL == map) || (reg >= map->numRegisters))
+		return FT_INVALID_PARAMETER;
+	if(map->flags[reg] & REGMAP_STATE_VALID)
+	{
+		*value = map->values[reg];
+	}
+	else
+	{
+		status = REGMAP_ReadDevice(map,reg,value);
+		if((FT_OK == status) && !(map->flags[reg] & REGMAP_FLAG_VOLATILE))
+		{
+			map->values[reg] = *value;
+			map->flags[reg] |= REGMAP_STATE_VALID;
+		}
+	}
+	FN_EXIT;
+	return status;
+}
+
+/*!
+ * \brief Writes a register
+ *
+ * The write goes to the cache and is sent to the slave by the next REGMAP_Sync. Writing the
+ * value that the register already holds costs nothing. Volatile registers are written to the
+ * slave right away, after the pending writes so that the order of the writes is kept.
+ *
+ * \param[in] handle Handle of the channel the slave is connected to
+ * \param[in] deviceAddress Address of the I2C slave
+ * \param[in] reg Address of the register
+ * \param[in] value Value to be written
+ * \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide)
+ * \sa REGMAP_Sync
+ * \note
+ * \warning
+ */
+FTDI_API FT_STATUS REGMAP_Write(FT_HANDLE handle, uint32 deviceAddress, uint32 reg,
+	uint8 value)
+{
+	FT_STATUS status=FT_OK;
+	Regmap *map;
+	FN_ENTER;
+
+	map = REGMAP_Find(handle,deviceAddress);
+	if((NULL == map) || (reg >= map->numRegisters))
+		return FT_INVALID_PARAMETER;
+	if(map->flags[reg] & REGMAP_FLAG_VOLATILE)
+	{
+		status = REGMAP_Sync(handle,deviceAddress);
+		if(FT_OK == status)
+			status = REGMAP_WriteDevice(map,reg,value);
+	}
+	else if(!(map->flags[reg] & REGMAP_STATE_VALID) || (map->values[reg] != value))
+	{
+		map->values[reg] = value;
+		map->flags[reg] |= REGMAP_STATE_VALID | REGMAP_STATE_DIRTY;
+	}
+	FN_EXIT;
+	return status;
+}
+
+/*!
+ * \brief Changes some bits of a register
+ *
+ * This function does a read-modify-write of the register, the read being served from the cache
+ * whenever possible(see REGMAP_Read and REGMAP_Write).
+ *
+ * \param[in] handle Handle of the channel the slave is connected to
+ * \param[in] deviceAddress Address of the I2C slave
+ * \param[in] reg Address of the register
+ * \param[in] mask Bits to be changed
+ * \param[in] value New value of the bits
+ * \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide)
+ * \sa
+ * \note FT_INVALID_PARAMETER is returned for a precious register that isn't cached, as it
+ *		would have to be read
+ * \warning
+ */
+FTDI_API FT_STATUS REGMAP_UpdateBits(FT_HANDLE handle, uint32 deviceAddress, uint32 reg,
+	uint8 mask, uint8 value)
+{
+	FT_STATUS status;
+	Regmap *map;
+	uint8 old;
+	FN_ENTER;
+
+	map = REGMAP_Find(handle,deviceAddress);
+	if((NULL == map) || (reg >= map->numRegisters))
+		return FT_INVALID_PARAMETER;
+	if((map->flags[reg] & REGMAP_FLAG_PRECIOUS) && !(map->flags[reg] & REGMAP_STATE_VALID))
+	{
+		DBG(MSG_ERR,"precious register 0x%x isn't cached\n",(unsigned)reg);
+		return FT_INVALID_PARAMETER;
+	}
+	status = REGMAP_Read(handle,deviceAddress,reg,&old);
+	if(FT_OK == status)
+		status = REGMAP_Write(handle,deviceAddress,reg,(uint8)((old & ~mask) | (value & mask)));
+	FN_EXIT;
+	return status;
+}
+
+/*!
+ * \brief Fills the cache for a range of registers
+ *
+ * This function reads all the registers of the range that aren't cached, volatile or precious.
+ * Each run of consecutive registers is read with one sequential read, and all the runs are read
+ * in a single round trip(see I2C_Transfer).
+ *
+ * \param[in] handle Handle of the channel the slave is connected to
+ * \param[in] deviceAddress Address of the I2C slave
+ * \param[in] first Address of the first register
+ * \param[in] count Number of registers
+ * \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide)
+ * \sa
+ * \note
+ * \warning
+ */
+FTDI_API FT_STATUS REGMAP_Prefetch(FT_HANDLE handle, uint32 deviceAddress, uint32 first,
+	uint32 count)
+{
+	FT_STATUS status=FT_OK;
+	Regmap *map;
+	I2C_Msg *msgs;
+	uint8 *regs;
+	uint32 m=0;
+	uint32 reg;
+	uint32 i;
+	FN_ENTER;
+
+	map = REGMAP_Find(handle,deviceAddress);
+	if((NULL == map) || (first > map->numRegisters) || (count > (map->numRegisters - first)))
+		return FT_INVALID_PARAMETER;
+	if(0 == count)
+		return FT_OK;
+	/* a write and a read message per run, the address byte of each run */
+	msgs = (I2C_Msg*) INFRA_MALLOC(2*count*sizeof(I2C_Msg) + count);
+	if(NULL == msgs)
+		return FT_INSUFFICIENT_RESOURCES;
+	regs = (uint8*)&msgs[2*count];
+
+	for(reg=first; reg<(first+count); reg++)
+	{
+		if(REGMAP_NO_FILL(map->flags[reg]) || (map->flags[reg] & REGMAP_STATE_VALID))
+			continue;
+		if((m > 0) && !(map->options & REGMAP_OPTION_NO_AUTO_INCREMENT) &&
+			((regs[m/2-1] + msgs[m-1].len) == reg))
+		{/* continues the last run */
+			msgs[m-1].len++;
+			continue;
+		}
+		regs[m/2] = (uint8)reg;
+		msgs[m].addr = deviceAddress;
+		msgs[m].flags = 0;
+		msgs[m].len = 1;
+		msgs[m].buf = &regs[m/2];
+		msgs[m].status = FT_OTHER_ERROR;
+		m++;
+		msgs[m].addr = deviceAddress;
+		msgs[m].flags = I2C_MSG_READ;
+		msgs[m].len = 1;
+		msgs[m].buf = &map->values[reg];
+		msgs[m].status = FT_OTHER_ERROR;
+		m++;
+	}
+	if(m > 0)
+	{
+		status = I2C_Transfer(handle,msgs,m);
+		/* the statuses of the messages are only meaningful if the transaction went out */
+		for(i=1; (i<m) && REGMAP_TRANSFER_DONE(status); i+=2)
+		{
+			if((FT_OK == msgs[i-1].status) && (FT_OK == msgs[i].status))
+			{
+				for(reg=regs[i/2]; reg<(regs[i/2]+msgs[i].len); reg++)
+					map->flags[reg] |= REGMAP_STATE_VALID;
+			}
+		}
+	}
+	INFRA_FREE(msgs);
+	FN_EXIT;
+	return status;
+}
+
+/*!
+ * \brief Writes the pending writes to the slave
+ *
+ * Each run of consecutive dirty registers is written with one multi-byte write, relying on the
+ * slave advancing its register pointer, and all the runs are written in a single round trip(see
+ * I2C_Transfer).
+ *
+ * \param[in] handle Handle of the channel the slave is connected to
+ * \param[in] deviceAddress Address of the I2C slave
+ * \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide)
+ * \sa REGMAP_Write
+ * \note Registers of runs that the slave nAcked remain dirty
+ * \warning
+ */
+FTDI_API FT_STATUS REGMAP_Sync(FT_HANDLE handle, uint32 deviceAddress)
+{
+	FT_STATUS status=FT_OK;
+	Regmap *map;
+	I2C_Msg *msgs;
+	uint8 *data;
+	uint32 m=0;
+	uint32 j=0;
+	uint32 reg;
+	uint32 i;
+	FN_ENTER;
+
+	map = REGMAP_Find(handle,deviceAddress);
+	if(NULL == map)
+		return FT_INVALID_PARAMETER;
+	for(reg=0; reg<map->numRegisters; reg++)
+	{
+		if(map->flags[reg] & REGMAP_STATE_DIRTY)
+			break;
+	}
+	if(reg == map->numRegisters)
+		return FT_OK;	/* nothing to write */
+
+	/* at most a message per register, made of the register address and the value */
+	msgs = (I2C_Msg*) INFRA_MALLOC(map->numRegisters*(sizeof(I2C_Msg) + 2));
+	if(NULL == msgs)
+		return FT_INSUFFICIENT_RESOURCES;
+	data = (uint8*)&msgs[map->numRegisters];
+
+	for(; reg<map->numRegisters; reg++)
+	{
+		if(!(map->flags[reg] & REGMAP_STATE_DIRTY))
+			continue;
+		if((m > 0) && !(map->options & REGMAP_OPTION_NO_AUTO_INCREMENT) &&
+			(map->flags[reg-1] & REGMAP_STATE_DIRTY))
+		{/* continues the last run */
+			data[j++] = map->values[reg];
+			msgs[m-1].len++;
+			continue;
+		}
+		msgs[m].addr = deviceAddress;
+		msgs[m].flags = 0;
+		msgs[m].len = 2;
+		msgs[m].buf = &data[j];
+		msgs[m].status = FT_OTHER_ERROR;
+		data[j++] = (uint8)reg;
+		data[j++] = map->values[reg];
+		m++;
+	}
+	DBG(MSG_DEBUG,"writing %u runs\n",(unsigned)m);
+	status = I2C_Transfer(handle,msgs,m);
+	for(i=0; (i<m) && REGMAP_TRANSFER_DONE(status); i++)
+	{
+		if(FT_OK == msgs[i].status)
+		{
+			for(reg=msgs[i].buf[0]; reg<(msgs[i].buf[0]+msgs[i].len-1); reg++)
+				map->flags[reg] &= (uint8)~REGMAP_STATE_DIRTY;
+		}
+	}
+	INFRA_FREE(msgs);
+	FN_EXIT;
+	return status;
+}
+
+/*!
+ * \brief Drops the cached values
+ *
+ * This function is meant to be called after the slave was reset or powered down, so that the
+ * registers are read from the slave again.
+ *
+ * \param[in] handle Handle of the channel the slave is connected to
+ * \param[in] deviceAddress Address of the I2C slave
+ * \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide)
+ * \sa
+ * \note Writes that were not synced are lost
+ * \warning
+ */
+FTDI_API FT_STATUS REGMAP_Invalidate(FT_HANDLE handle, uint32 deviceAddress)
+{
+	Regmap *map;
+	uint32 reg;
+	FN_ENTER;
+
+	map = REGMAP_Find(handle,deviceAddress);
+	if(NULL == map)
+		return FT_INVALID_PARAMETER;
+	for(reg=0; reg<map->numRegisters; reg++)
+		map->flags[reg] &= (uint8)~(REGMAP_STATE_VALID | REGMAP_STATE_DIRTY);
+	FN_EXIT;
+	return FT_OK;
+}
+
+
+/******************************************************************************/
+/*						Local function definitions						  */
+/******************************************************************************/
+
+/*!
+ * \brief Finds the register map of a slave
+ *
+ * \param[in] handle Handle of the channel the slave is connected to
+ * \param[in] deviceAddress Address of the I2C slave
+ * \return Pointer to the map, NULL if there is none
+ * \sa
+ * \note
+ * \warning
+ */
+Regmap *REGMAP_Find(FT_HANDLE handle, uint32 deviceAddress)
+{
+	Regmap *map;
+
+	for(map=REGMAP_ListHead; NULL != map; map=map->next)
+	{
+		if((map->handle == handle) && (map->deviceAddress == deviceAddress))
+			break;
+	}
+	if(NULL == map)
+		DBG(MSG_ERR,"no register map for slave 0x%x\n",(unsigned)deviceAddress);
+	return map;
+}
+
+/*!
+ * \brief Writes a register of the slave, bypassing the cache
+ *
+ * \param[in] map Pointer to the register map of the slave
+ * \param[in] reg Address of the register
+ * \param[in] value Value to be written
+ * \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide)
+ * \sa
+ * \note
+ * \warning
+ */
+FT_STATUS REGMAP_WriteDevice(Regmap *map, uint32 reg, uint8 value)
+{
+	I2C_Msg msg;
+	uint8 data[2];
+
+	data[0] = (uint8)reg;
+	data[1] = value;
+	msg.addr = map->deviceAddress;
+	msg.flags = 0;
+	msg.len = 2;
+	msg.buf = data;
+	return I2C_Transfer(map->handle,&msg,1);
+}
+
+/*!
+ * \brief Reads a register of the slave, bypassing the cache
+ *
+ * \param[in] map Pointer to the register map of the slave
+ * \param[in] reg Address of the register
+ * \param[out] value Pointer to the value read
+ * \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide)
+ * \sa
+ * \note
+ * \warning
+ */
+FT_STATUS REGMAP_ReadDevice(Regmap *map, uint32 reg, uint8 *value)
+{
+	I2C_Msg msgs[2];
+	uint8 address;
+
+	address = (uint8)reg;
+	msgs[0].addr = map->deviceAddress;
+	msgs[0].flags = 0;
+	msgs[0].len = 1;
+	msgs[0].buf = &address;
+	msgs[1].addr = map->deviceAddress;
+	msgs[1].flags = I2C_MSG_READ;
+	msgs[1].len = 1;
+	msgs[1].buf = value;
+	return I2C_Transfer(map->handle,msgs,2);
+}
+
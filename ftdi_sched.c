@@ -0,0 +1,333 @@
+/*!
+ * \file ftdi_sched.c
+ *
+ * \author FTDI
+ * \date 20261018
+ *
+ * Copyright (C) 2000-2014 Future Technology Devices International Limited
+ *
+ *
+ * THIS SOFTWARE IS PROVIDED BY FUTURE TECHNOLOGY DEVICES INTERNATIONAL LIMITED ``AS IS'' AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL FUTURE TECHNOLOGY DEVICES INTERNATIONAL LIMITED
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Project: libMPSSE
+ * Module: Scheduler
+ *
+ * Rivision History:
+ * 0.1 - initial version
+ */
+
+
+/******************************************************************************/
+/*								Include files					  			  */
+/******************************************************************************/
+#include "ftdi_infra.h"		/*Common portable infrastructure(datatypes, libraries, etc)*/
+#include "ftdi_common.h"	/*Common across I2C, SPI, JTAG modules*/
+#include "ftdi_sched.h"		/*Scheduler specific*/
+
+
+/******************************************************************************/
+/*								Macro and type defines					  		  */
+/******************************************************************************/
+/* Enabling the macro will lead to checking of all parameters that are passed to the library from
+    the user application*/
+#define ENABLE_PARAMETER_CHECKING	1
+
+
+/******************************************************************************/
+/*								Local function declarations					  */
+/******************************************************************************/
+SCHED_Context *SCHED_GetContext(FT_HANDLE handle);
+
+
+/******************************************************************************/
+/*								Global variables							  */
+/******************************************************************************/
+
+/*Root of the linked list that holds the schedulers, walked and changed with the lock
+taken(Infra_Lock)*/
+static SCHED_Context *SCHED_ListHead=NULL;
+
+
+/******************************************************************************/
+/*						Public function definitions						  */
+/******************************************************************************/
+
+/*!
+ * \brief Creates the scheduler of a channel
+ *
+ * This function allocates the scheduler and its sample table. Sensors are then registered with
+ * SCHED_AddSensor, and SCHED_Tick is called by the application every tickUs microseconds.
+ *
+ * \param[in] handle Handle of the channel, initialized by I2C_InitChannel or SPI_InitChannel
+ * \param[in] bus SCHED_BUS_I2C or SCHED_BUS_SPI
+ * \param[in] tickUs Period of the ticks in microseconds
+ * \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide)
+ * \sa SCHED_Exit
+ * \note An existing scheduler of the channel is replaced
+ * \warning
+ */
+FTDI_API FT_STATUS SCHED_Init(FT_HANDLE handle, uint32 bus, uint32 tickUs)
+{
+	FT_STATUS status=FT_OK;
+	SCHED_Context *context;
+	FN_ENTER;
+#ifdef ENABLE_PARAMETER_CHECKING
+	CHECK_NULL_RET(handle);
+	if(((SCHED_BUS_I2C != bus) && (SCHED_BUS_SPI != bus)) || (0 == tickUs))
+		return FT_INVALID_PARAMETER;
+#endif
+
+	SCHED_Exit(handle);
+	context = (SCHED_Context*) INFRA_MALLOC(sizeof(SCHED_Context));
+	if(NULL == context)
+		return FT_INSUFFICIENT_RESOURCES;
+	memset(context,0,sizeof(SCHED_Context));
+	context->handle = handle;
+	context->bus = bus;
+	context->tickUs = tickUs;
+	Infra_Lock();
+	context->next = SCHED_ListHead;
+	SCHED_ListHead = context;
+	Infra_Unlock();
+	FN_EXIT;
+	return status;
+}
+
+/*!
+ * \brief Deletes the scheduler of a channel
+ *
+ * \param[in] handle Handle of the channel
+ * \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide)
+ * \sa SCHED_Init
+ * \note I2C_CloseChannel and SPI_CloseChannel call this function, so the scheduler of a channel
+ *		doesn't outlive it
+ * \warning Not to be called while another thread runs SCHED_Tick, SCHED_AddSensor or
+ *		SCHED_GetSample on the same channel
+ */
+FTDI_API FT_STATUS SCHED_Exit(FT_HANDLE handle)
+{
+	FT_STATUS status=FT_OK;
+	SCHED_Context *context;
+	SCHED_Context *lastNode=NULL;
+	FN_ENTER;
+
+	Infra_Lock();
+	for(context=SCHED_ListHead; NULL != context; lastNode=context, context=context->next)
+	{
+		if(context->handle == handle)
+		{
+			if(NULL == lastNode)
+				SCHED_ListHead = context->next;
+			else
+				lastNode->next = context->next;
+			break;
+		}
+	}
+	Infra_Unlock();
+	if(NULL != context)
+	{
+		INFRA_FREE(context);
+	}
+	FN_EXIT;
+	return status;
+}
+
+/*!
+ * \brief Registers a sensor
+ *
+ * The period is rounded to a whole number of ticks. The time the read of the sensor takes on the
+ * bus is estimated from the recipe and the clock rate of the channel, and the sensor is rejected
+ * if the reads of all the sensors would no longer fit in SCHED_TICK_BUDGET_PERCENT of a tick.
+ * All the sensors are due on the first tick, so this is the worst case.
+ *
+ * \param[in] handle Handle of the channel
+ * \param[in] recipe Pointer to how the sensor is read, copied by the scheduler
+ * \param[in] periodUs Period of the reads in microseconds
+ * \param[out] sensorId Pointer to the number of the sensor, used with SCHED_GetSample
+ * \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide)
+ * \sa
+ * \note FT_INSUFFICIENT_RESOURCES is returned if the sensor doesn't fit in the tick budget
+ * \warning
+ */
+FTDI_API FT_STATUS SCHED_AddSensor(FT_HANDLE handle, const SCHED_Recipe *recipe,
+	uint32 periodUs, uint32 *sensorId)
+{
+	FT_STATUS status=FT_OK;
+	SCHED_Context *context;
+	SCHED_Sensor *sensor;
+	uint32 busTimeNs;
+	FN_ENTER;
+#ifdef ENABLE_PARAMETER_CHECKING
+	CHECK_NULL_RET(recipe);
+	CHECK_NULL_RET(sensorId);
+	if((recipe->commandLength > SCHED_MAX_COMMAND) || (0 == recipe->readLength) ||
+		(recipe->readLength > SCHED_MAX_READ))
+		return FT_INVALID_PARAMETER;
+#endif
+
+	context = SCHED_GetContext(handle);
+	if(NULL == context)
+		return FT_INVALID_HANDLE;
+	if(SCHED_MAX_SENSORS == context->numSensors)
+		return FT_INSUFFICIENT_RESOURCES;
+
+	busTimeNs = (SCHED_BUS_I2C == context->bus)?I2C_SchedBusTime(handle,recipe):
+		SPI_SchedBusTime(handle,recipe);
+	if(((uint64)context->busTimeNs + busTimeNs) >
+		((uint64)context->tickUs * 1000 * SCHED_TICK_BUDGET_PERCENT / 100))
+	{
+		DBG(MSG_ERR,"sensor needs %uns, %uns of the tick are used already\n",
+			(unsigned)busTimeNs,(unsigned)context->busTimeNs);
+		return FT_INSUFFICIENT_RESOURCES;
+	}
+
+	sensor = &context->sensors[context->numSensors];
+	memset(sensor,0,sizeof(SCHED_Sensor));
+	INFRA_MEMCPY(&sensor->recipe,recipe,sizeof(SCHED_Recipe));
+	sensor->periodTicks = (periodUs + context->tickUs/2) / context->tickUs;
+	if(0 == sensor->periodTicks)
+		sensor->periodTicks = 1;
+	sensor->busTimeNs = busTimeNs;
+	sensor->sample[0].status = FT_OTHER_ERROR;	/* no sample yet */
+	context->busTimeNs += busTimeNs;
+	*sensorId = context->numSensors++;
+	FN_EXIT;
+	return status;
+}
+
+/*!
+ * \brief Runs one tick of the scheduler
+ *
+ * All the sensors that are due in this tick are read with a single command buffer and a single
+ * round trip. Their samples are written to the back halves of the sample table, which become the
+ * front halves once the tick is complete.
+ *
+ * \param[in] handle Handle of the channel
+ * \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide)
+ * \sa SCHED_GetSample
+ * \note The application calls this function every tickUs microseconds. Slaves that nAck
+ *		don't fail the tick, their samples carry the status instead
+ * \warning
+ */
+FTDI_API FT_STATUS SCHED_Tick(FT_HANDLE handle)
+{
+	FT_STATUS status=FT_OK;
+	SCHED_Context *context;
+	SCHED_Sensor *sensor;
+	SCHED_Sample *sample;
+	uint64 timestamp;
+	uint32 count=0;
+	uint32 dueCount;
+	uint32 i;
+	FN_ENTER;
+
+	context = SCHED_GetContext(handle);
+	if(NULL == context)
+		return FT_INVALID_HANDLE;
+
+	for(i=0; i<context->numSensors; i++)
+	{
+		sensor = &context->sensors[i];
+		if(0 == (context->tick % sensor->periodTicks))
+		{
+			context->due[count] = &sensor->recipe;
+			context->data[count] = sensor->sample[sensor->front ^ 1].data;
+			count++;
+		}
+	}
+	context->tick++;
+	if(0 == count)
+		return FT_OK;
+
+	dueCount = count;
+	timestamp = Infra_GetTimeUs();
+	if(SCHED_BUS_I2C == context->bus)
+		status = I2C_SchedRead(handle,context->due,context->data,context->status,count);
+	else
+		status = SPI_SchedRead(handle,context->due,context->data,context->status,count);
+
+	for(i=0, count=0; (i<context->numSensors) && (count<dueCount); i++)
+	{
+		sensor = &context->sensors[i];
+		if(&sensor->recipe != context->due[count])
+			continue;
+		sample = &sensor->sample[sensor->front ^ 1];
+		sample->timestamp = timestamp;
+		sample->sequence = sensor->sample[sensor->front].sequence + 1;
+		sample->status = (FT_OK == status)?context->status[count]:status;
+		sensor->front ^= 1;
+		count++;
+	}
+	FN_EXIT;
+	return status;
+}
+
+/*!
+ * \brief Gets the last sample of a sensor
+ *
+ * \param[in] handle Handle of the channel
+ * \param[in] sensorId Number of the sensor, as returned by SCHED_AddSensor
+ * \param[out] sample Pointer to where the sample is copied
+ * \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide)
+ * \sa
+ * \note The sequence member is 0 until the sensor was read once
+ * \warning
+ */
+FTDI_API FT_STATUS SCHED_GetSample(FT_HANDLE handle, uint32 sensorId, SCHED_Sample *sample)
+{
+	FT_STATUS status=FT_OK;
+	SCHED_Context *context;
+	SCHED_Sensor *sensor;
+	FN_ENTER;
+#ifdef ENABLE_PARAMETER_CHECKING
+	CHECK_NULL_RET(sample);
+#endif
+
+	context = SCHED_GetContext(handle);
+	if(NULL == context)
+		return FT_INVALID_HANDLE;
+	if(sensorId >= context->numSensors)
+		return FT_INVALID_PARAMETER;
+	sensor = &context->sensors[sensorId];
+	INFRA_MEMCPY(sample,&sensor->sample[sensor->front],sizeof(SCHED_Sample));
+	FN_EXIT;
+	return status;
+}
+
+
+/******************************************************************************/
+/*						Local function definitions						  */
+/******************************************************************************/
+
+/*!
+ * \brief Finds the scheduler of a channel
+ *
+ * \param[in] handle Handle of the channel
+ * \return Pointer to the scheduler, NULL if there is none
+ * \sa
+ * \note
+ * \warning
+ */
+SCHED_Context *SCHED_GetContext(FT_HANDLE handle)
+{
+	SCHED_Context *context;
+
+	Infra_Lock();
+	for(context=SCHED_ListHead; NULL != context; context=context->next)
+	{
+		if(context->handle == handle)
+			break;
+	}
+	Infra_Unlock();
+	if(NULL == context)
+		DBG(MSG_ERR,"no scheduler for handle 0x%x\n",(unsigned)handle);
+	return context;
+}
+
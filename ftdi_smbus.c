@@ -0,0 +1,586 @@
+/*!
+ * \file ftdi_smbus.c
+ *
+ * \author FTDI
+ * \date 20261018
+ *
+ * Copyright (C) 2000-2014 Future Technology Devices International Limited
+ *
+ *
+ * THIS SOFTWARE IS PROVIDED BY FUTURE TECHNOLOGY DEVICES INTERNATIONAL LIMITED ``AS IS'' AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL FUTURE TECHNOLOGY DEVICES INTERNATIONAL LIMITED
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Project: libMPSSE
+ * Module: SMBus
+ *
+ * Rivision History:
+ * 0.1 - initial version
+ */
+
+
+/******************************************************************************/
+/*								Include files					  			  */
+/******************************************************************************/
+#include "ftdi_infra.h"		/*Common portable infrastructure(datatypes, libraries, etc)*/
+#include "ftdi_common.h"	/*Common across I2C, SPI, JTAG modules*/
+#include "ftdi_smbus.h"		/*SMBus specific*/
+
+
+/******************************************************************************/
+/*								Macro and type defines					  		  */
+/******************************************************************************/
+/* Enabling the macro will lead to checking of all parameters that are passed to the library from
+    the user application*/
+#define ENABLE_PARAMETER_CHECKING	1
+
+/* PEC is a CRC-8 with polynomial x^8+x^2+x+1 */
+#define SMBUS_PEC_POLYNOMIAL	0x07
+
+/* Number of bytes processed per step by SMBUS_Pec */
+#define SMBUS_PEC_SLICES		4
+
+#define SMBUS_ADDRESS_WRITE(address)	((uint8)((address) << 1))
+#define SMBUS_ADDRESS_READ(address)		((uint8)(((address) << 1) | 0x01))
+
+
+/******************************************************************************/
+/*								Local function declarations					  */
+/******************************************************************************/
+bool SMBUS_CheckPec(uint32 deviceAddress, const uint8 *out, uint32 outLen, const uint8 *in,
+	uint32 inLen);
+FT_STATUS SMBUS_Transfer(FT_HANDLE handle, uint32 deviceAddress, uint8 *out, uint32 outLen,
+	uint8 *in, uint32 inLen, uint32 options);
+
+
+/******************************************************************************/
+/*								Global variables							  */
+/******************************************************************************/
+
+/* SMBUS_PecTable[k][b] is the PEC of byte b followed by k zero bytes. SMBUS_PecTable[0] is the
+CRC-8 of each byte with SMBUS_PEC_POLYNOMIAL and SMBUS_PecTable[k][b] is
+SMBUS_PecTable[0][SMBUS_PecTable[k-1][b]] */
+static const uint8 SMBUS_PecTable[SMBUS_PEC_SLICES][256] =
+{
+	{
+		0x00, 0x07, 0x0E, 0x09, 0x1C, 0x1B, 0x12, 0x15, 0x38, 0x3F, 0x36, 0x31, 0x24, 0x23, 0x2A, 0x2D,
+		0x70, 0x77, 0x7E, 0x79, 0x6C, 0x6B, 0x62, 0x65, 0x48, 0x4F, 0x46, 0x41, 0x54, 0x53, 0x5A, 0x5D,
+		0xE0, 0xE7, 0xEE, 0xE9, 0xFC, 0xFB, 0xF2, 0xF5, 0xD8, 0xDF, 0xD6, 0xD1, 0xC4, 0xC3, 0xCA, 0xCD,
+		0x90, 0x97, 0x9E, 0x99, 0x8C, 0x8B, 0x82, 0x85, 0xA8, 0xAF, 0xA6, 0xA1, 0xB4, 0xB3, 0xBA, 0xBD,
+		0xC7, 0xC0, 0xC9, 0xCE, 0xDB, 0xDC, 0xD5, 0xD2, 0xFF, 0xF8, 0xF1, 0xF6, 0xE3, 0xE4, 0xED, 0xEA,
+		0xB7, 0xB0, 0xB9, 0xBE, 0xAB, 0xAC, 0xA5, 0xA2, 0x8F, 0x88, 0x81, 0x86, 0x93, 0x94, 0x9D, 0x9A,
+		0x27, 0x20, 0x29, 0x2E, 0x3B, 0x3C, 0x35, 0x32, 0x1F, 0x18, 0x11, 0x16, 0x03, 0x04, 0x0D, 0x0A,
+		0x57, 0x50, 0x59, 0x5E, 0x4B, 0x4C, 0x45, 0x42, 0x6F, 0x68, 0x61, 0x66, 0x73, 0x74, 0x7D, 0x7A,
+		0x89, 0x8E, 0x87, 0x80, 0x95, 0x92, 0x9B, 0x9C, 0xB1, 0xB6, 0xBF, 0xB8, 0xAD, 0xAA, 0xA3, 0xA4,
+		0xF9, 0xFE, 0xF7, 0xF0, 0xE5, 0xE2, 0xEB, 0xEC, 0xC1, 0xC6, 0xCF, 0xC8, 0xDD, 0xDA, 0xD3, 0xD4,
+		0x69, 0x6E, 0x67, 0x60, 0x75, 0x72, 0x7B, 0x7C, 0x51, 0x56, 0x5F, 0x58, 0x4D, 0x4A, 0x43, 0x44,
+		0x19, 0x1E, 0x17, 0x10, 0x05, 0x02, 0x0B, 0x0C, 0x21, 0x26, 0x2F, 0x28, 0x3D, 0x3A, 0x33, 0x34,
+		0x4E, 0x49, 0x40, 0x47, 0x52, 0x55, 0x5C, 0x5B, 0x76, 0x71, 0x78, 0x7F, 0x6A, 0x6D, 0x64, 0x63,
+		0x3E, 0x39, 0x30, 0x37, 0x22, 0x25, 0x2C, 0x2B, 0x06, 0x01, 0x08, 0x0F, 0x1A, 0x1D, 0x14, 0x13,
+		0xAE, 0xA9, 0xA0, 0xA7, 0xB2, 0xB5, 0xBC, 0xBB, 0x96, 0x91, 0x98, 0x9F, 0x8A, 0x8D, 0x84, 0x83,
+		0xDE, 0xD9, 0xD0, 0xD7, 0xC2, 0xC5, 0xCC, 0xCB, 0xE6, 0xE1, 0xE8, 0xEF, 0xFA, 0xFD, 0xF4, 0xF3
+	},
+	{
+		0x00, 0x15, 0x2A, 0x3F, 0x54, 0x41, 0x7E, 0x6B, 0xA8, 0xBD, 0x82, 0x97, 0xFC, 0xE9, 0xD6, 0xC3,
+		0x57, 0x42, 0x7D, 0x68, 0x03, 0x16, 0x29, 0x3C, 0xFF, 0xEA, 0xD5, 0xC0, 0xAB, 0xBE, 0x81, 0x94,
+		0xAE, 0xBB, 0x84, 0x91, 0xFA, 0xEF, 0xD0, 0xC5, 0x06, 0x13, 0x2C, 0x39, 0x52, 0x47, 0x78, 0x6D,
+		0xF9, 0xEC, 0xD3, 0xC6, 0xAD, 0xB8, 0x87, 0x92, 0x51, 0x44, 0x7B, 0x6E, 0x05, 0x10, 0x2F, 0x3A,
+		0x5B, 0x4E, 0x71, 0x64, 0x0F, 0x1A, 0x25, 0x30, 0xF3, 0xE6, 0xD9, 0xCC, 0xA7, 0xB2, 0x8D, 0x98,
+		0x0C, 0x19, 0x26, 0x33, 0x58, 0x4D, 0x72, 0x67, 0xA4, 0xB1, 0x8E, 0x9B, 0xF0, 0xE5, 0xDA, 0xCF,
+		0xF5, 0xE0, 0xDF, 0xCA, 0xA1, 0xB4, 0x8B, 0x9E, 0x5D, 0x48, 0x77, 0x62, 0x09, 0x1C, 0x23, 0x36,
+		0xA2, 0xB7, 0x88, 0x9D, 0xF6, 0xE3, 0xDC, 0xC9, 0x0A, 0x1F, 0x20, 0x35, 0x5E, 0x4B, 0x74, 0x61,
+		0xB6, 0xA3, 0x9C, 0x89, 0xE2, 0xF7, 0xC8, 0xDD, 0x1E, 0x0B, 0x34, 0x21, 0x4A, 0x5F, 0x60, 0x75,
+		0xE1, 0xF4, 0xCB, 0xDE, 0xB5, 0xA0, 0x9F, 0x8A, 0x49, 0x5C, 0x63, 0x76, 0x1D, 0x08, 0x37, 0x22,
+		0x18, 0x0D, 0x32, 0x27, 0x4C, 0x59, 0x66, 0x73, 0xB0, 0xA5, 0x9A, 0x8F, 0xE4, 0xF1, 0xCE, 0xDB,
+		0x4F, 0x5A, 0x65, 0x70, 0x1B, 0x0E, 0x31, 0x24, 0xE7, 0xF2, 0xCD, 0xD8, 0xB3, 0xA6, 0x99, 0x8C,
+		0xED, 0xF8, 0xC7, 0xD2, 0xB9, 0xAC, 0x93, 0x86, 0x45, 0x50, 0x6F, 0x7A, 0x11, 0x04, 0x3B, 0x2E,
+		0xBA, 0xAF, 0x90, 0x85, 0xEE, 0xFB, 0xC4, 0xD1, 0x12, 0x07, 0x38, 0x2D, 0x46, 0x53, 0x6C, 0x79,
+		0x43, 0x56, 0x69, 0x7C, 0x17, 0x02, 0x3D, 0x28, 0xEB, 0xFE, 0xC1, 0xD4, 0xBF, 0xAA, 0x95, 0x80,
+		0x14, 0x01, 0x3E, 0x2B, 0x40, 0x55, 0x6A, 0x7F, 0xBC, 0xA9, 0x96, 0x83, 0xE8, 0xFD, 0xC2, 0xD7
+	},
+	{
+		0x00, 0x6B, 0xD6, 0xBD, 0xAB, 0xC0, 0x7D, 0x16, 0x51, 0x3A, 0x87, 0xEC, 0xFA, 0x91, 0x2C, 0x47,
+		0xA2, 0xC9, 0x74, 0x1F, 0x09, 0x62, 0xDF, 0xB4, 0xF3, 0x98, 0x25, 0x4E, 0x58, 0x33, 0x8E, 0xE5,
+		0x43, 0x28, 0x95, 0xFE, 0xE8, 0x83, 0x3E, 0x55, 0x12, 0x79, 0xC4, 0xAF, 0xB9, 0xD2, 0x6F, 0x04,
+		0xE1, 0x8A, 0x37, 0x5C, 0x4A, 0x21, 0x9C, 0xF7, 0xB0, 0xDB, 0x66, 0x0D, 0x1B, 0x70, 0xCD, 0xA6,
+		0x86, 0xED, 0x50, 0x3B, 0x2D, 0x46, 0xFB, 0x90, 0xD7, 0xBC, 0x01, 0x6A, 0x7C, 0x17, 0xAA, 0xC1,
+		0x24, 0x4F, 0xF2, 0x99, 0x8F, 0xE4, 0x59, 0x32, 0x75, 0x1E, 0xA3, 0xC8, 0xDE, 0xB5, 0x08, 0x63,
+		0xC5, 0xAE, 0x13, 0x78, 0x6E, 0x05, 0xB8, 0xD3, 0x94, 0xFF, 0x42, 0x29, 0x3F, 0x54, 0xE9, 0x82,
+		0x67, 0x0C, 0xB1, 0xDA, 0xCC, 0xA7, 0x1A, 0x71, 0x36, 0x5D, 0xE0, 0x8B, 0x9D, 0xF6, 0x4B, 0x20,
+		0x0B, 0x60, 0xDD, 0xB6, 0xA0, 0xCB, 0x76, 0x1D, 0x5A, 0x31, 0x8C, 0xE7, 0xF1, 0x9A, 0x27, 0x4C,
+		0xA9, 0xC2, 0x7F, 0x14, 0x02, 0x69, 0xD4, 0xBF, 0xF8, 0x93, 0x2E, 0x45, 0x53, 0x38, 0x85, 0xEE,
+		0x48, 0x23, 0x9E, 0xF5, 0xE3, 0x88, 0x35, 0x5E, 0x19, 0x72, 0xCF, 0xA4, 0xB2, 0xD9, 0x64, 0x0F,
+		0xEA, 0x81, 0x3C, 0x57, 0x41, 0x2A, 0x97, 0xFC, 0xBB, 0xD0, 0x6D, 0x06, 0x10, 0x7B, 0xC6, 0xAD,
+		0x8D, 0xE6, 0x5B, 0x30, 0x26, 0x4D, 0xF0, 0x9B, 0xDC, 0xB7, 0x0A, 0x61, 0x77, 0x1C, 0xA1, 0xCA,
+		0x2F, 0x44, 0xF9, 0x92, 0x84, 0xEF, 0x52, 0x39, 0x7E, 0x15, 0xA8, 0xC3, 0xD5, 0xBE, 0x03, 0x68,
+		0xCE, 0xA5, 0x18, 0x73, 0x65, 0x0E, 0xB3, 0xD8, 0x9F, 0xF4, 0x49, 0x22, 0x34, 0x5F, 0xE2, 0x89,
+		0x6C, 0x07, 0xBA, 0xD1, 0xC7, 0xAC, 0x11, 0x7A, 0x3D, 0x56, 0xEB, 0x80, 0x96, 0xFD, 0x40, 0x2B
+	},
+	{
+		0x00, 0x16, 0x2C, 0x3A, 0x58, 0x4E, 0x74, 0x62, 0xB0, 0xA6, 0x9C, 0x8A, 0xE8, 0xFE, 0xC4, 0xD2,
+		0x67, 0x71, 0x4B, 0x5D, 0x3F, 0x29, 0x13, 0x05, 0xD7, 0xC1, 0xFB, 0xED, 0x8F, 0x99, 0xA3, 0xB5,
+		0xCE, 0xD8, 0xE2, 0xF4, 0x96, 0x80, 0xBA, 0xAC, 0x7E, 0x68, 0x52, 0x44, 0x26, 0x30, 0x0A, 0x1C,
+		0xA9, 0xBF, 0x85, 0x93, 0xF1, 0xE7, 0xDD, 0xCB, 0x19, 0x0F, 0x35, 0x23, 0x41, 0x57, 0x6D, 0x7B,
+		0x9B, 0x8D, 0xB7, 0xA1, 0xC3, 0xD5, 0xEF, 0xF9, 0x2B, 0x3D, 0x07, 0x11, 0x73, 0x65, 0x5F, 0x49,
+		0xFC, 0xEA, 0xD0, 0xC6, 0xA4, 0xB2, 0x88, 0x9E, 0x4C, 0x5A, 0x60, 0x76, 0x14, 0x02, 0x38, 0x2E,
+		0x55, 0x43, 0x79, 0x6F, 0x0D, 0x1B, 0x21, 0x37, 0xE5, 0xF3, 0xC9, 0xDF, 0xBD, 0xAB, 0x91, 0x87,
+		0x32, 0x24, 0x1E, 0x08, 0x6A, 0x7C, 0x46, 0x50, 0x82, 0x94, 0xAE, 0xB8, 0xDA, 0xCC, 0xF6, 0xE0,
+		0x31, 0x27, 0x1D, 0x0B, 0x69, 0x7F, 0x45, 0x53, 0x81, 0x97, 0xAD, 0xBB, 0xD9, 0xCF, 0xF5, 0xE3,
+		0x56, 0x40, 0x7A, 0x6C, 0x0E, 0x18, 0x22, 0x34, 0xE6, 0xF0, 0xCA, 0xDC, 0xBE, 0xA8, 0x92, 0x84,
+		0xFF, 0xE9, 0xD3, 0xC5, 0xA7, 0xB1, 0x8B, 0x9D, 0x4F, 0x59, 0x63, 0x75, 0x17, 0x01, 0x3B, 0x2D,
+		0x98, 0x8E, 0xB4, 0xA2, 0xC0, 0xD6, 0xEC, 0xFA, 0x28, 0x3E, 0x04, 0x12, 0x70, 0x66, 0x5C, 0x4A,
+		0xAA, 0xBC, 0x86, 0x90, 0xF2, 0xE4, 0xDE, 0xC8, 0x1A, 0x0C, 0x36, 0x20, 0x42, 0x54, 0x6E, 0x78,
+		0xCD, 0xDB, 0xE1, 0xF7, 0x95, 0x83, 0xB9, 0xAF, 0x7D, 0x6B, 0x51, 0x47, 0x25, 0x33, 0x09, 0x1F,
+		0x64, 0x72, 0x48, 0x5E, 0x3C, 0x2A, 0x10, 0x06, 0xD4, 0xC2, 0xF8, 0xEE, 0x8C, 0x9A, 0xA0, 0xB6,
+		0x03, 0x15, 0x2F, 0x39, 0x5B, 0x4D, 0x77, 0x61, 0xB3, 0xA5, 0x9F, 0x89, 0xEB, 0xFD, 0xC7, 0xD1
+	}
+};
+
+
+/******************************************************************************/
+/*						Public function definitions						  */
+/******************************************************************************/
+
+/*!
+ * \brief Quick command
+ *
+ * The read/write bit of the address is the data of the command, no other byte is transferred.
+ *
+ * \param[in] handle Handle of the channel
+ * \param[in] deviceAddress Address of the SMBus device
+ * \param[in] read Value of the read/write bit
+ * \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide)
+ * \sa
+ * \note With the read bit set one byte is read and nAcked, so that the device has released SDA
+ *		when STOP is generated
+ * \warning
+ */
+FTDI_API FT_STATUS SMBUS_Quick(FT_HANDLE handle, uint32 deviceAddress, bool read)
+{
+	I2C_Msg msg;
+	uint8 data;
+
+	msg.addr = deviceAddress;
+	msg.flags = read?I2C_MSG_READ:0;
+	msg.len = read?1:0;
+	msg.buf = &data;
+	return I2C_Transfer(handle,&msg,1);
+}
+
+/*!
+ * \brief Send byte protocol
+ *
+ * \param[in] handle Handle of the channel
+ * \param[in] deviceAddress Address of the SMBus device
+ * \param[in] value Byte to be sent
+ * \param[in] options SMBUS_OPTION_*
+ * \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide)
+ * \sa
+ * \note
+ * \warning
+ */
+FTDI_API FT_STATUS SMBUS_SendByte(FT_HANDLE handle, uint32 deviceAddress, uint8 value,
+	uint32 options)
+{
+	uint8 out[2];
+
+	out[0] = value;
+	return SMBUS_Transfer(handle,deviceAddress,out,1,NULL,0,options);
+}
+
+/*!
+ * \brief Receive byte protocol
+ *
+ * \param[in] handle Handle of the channel
+ * \param[in] deviceAddress Address of the SMBus device
+ * \param[out] value Pointer to the byte received
+ * \param[in] options SMBUS_OPTION_*
+ * \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide)
+ * \sa
+ * \note
+ * \warning
+ */
+FTDI_API FT_STATUS SMBUS_ReceiveByte(FT_HANDLE handle, uint32 deviceAddress, uint8 *value,
+	uint32 options)
+{
+	FT_STATUS status;
+	uint8 in[2];
+#ifdef ENABLE_PARAMETER_CHECKING
+	CHECK_NULL_RET(value);
+#endif
+
+	status = SMBUS_Transfer(handle,deviceAddress,NULL,0,in,1,options);
+	if(FT_OK == status)
+		*value = in[0];
+	return status;
+}
+
+/*!
+ * \brief Write byte protocol
+ *
+ * \param[in] handle Handle of the channel
+ * \param[in] deviceAddress Address of the SMBus device
+ * \param[in] command Command code
+ * \param[in] value Data byte
+ * \param[in] options SMBUS_OPTION_*
+ * \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide)
+ * \sa
+ * \note
+ * \warning
+ */
+FTDI_API FT_STATUS SMBUS_WriteByte(FT_HANDLE handle, uint32 deviceAddress, uint8 command,
+	uint8 value, uint32 options)
+{
+	uint8 out[3];
+
+	out[0] = command;
+	out[1] = value;
+	return SMBUS_Transfer(handle,deviceAddress,out,2,NULL,0,options);
+}
+
+/*!
+ * \brief Read byte protocol
+ *
+ * The command code is written and the data byte read back in a single round trip.
+ *
+ * \param[in] handle Handle of the channel
+ * \param[in] deviceAddress Address of the SMBus device
+ * \param[in] command Command code
+ * \param[out] value Pointer to the data byte
+ * \param[in] options SMBUS_OPTION_*
+ * \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide)
+ * \sa
+ * \note
+ * \warning
+ */
+FTDI_API FT_STATUS SMBUS_ReadByte(FT_HANDLE handle, uint32 deviceAddress, uint8 command,
+	uint8 *value, uint32 options)
+{
+	FT_STATUS status;
+	uint8 in[2];
+#ifdef ENABLE_PARAMETER_CHECKING
+	CHECK_NULL_RET(value);
+#endif
+
+	status = SMBUS_Transfer(handle,deviceAddress,&command,1,in,1,options);
+	if(FT_OK == status)
+		*value = in[0];
+	return status;
+}
+
+/*!
+ * \brief Write word protocol
+ *
+ * \param[in] handle Handle of the channel
+ * \param[in] deviceAddress Address of the SMBus device
+ * \param[in] command Command code
+ * \param[in] value Data word, sent low byte first
+ * \param[in] options SMBUS_OPTION_*
+ * \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide)
+ * \sa
+ * \note
+ * \warning
+ */
+FTDI_API FT_STATUS SMBUS_WriteWord(FT_HANDLE handle, uint32 deviceAddress, uint8 command,
+	uint16 value, uint32 options)
+{
+	uint8 out[4];
+
+	out[0] = command;
+	out[1] = (uint8)(value & 0xFF);
+	out[2] = (uint8)(value >> 8);
+	return SMBUS_Transfer(handle,deviceAddress,out,3,NULL,0,options);
+}
+
+/*!
+ * \brief Read word protocol
+ *
+ * \param[in] handle Handle of the channel
+ * \param[in] deviceAddress Address of the SMBus device
+ * \param[in] command Command code
+ * \param[out] value Pointer to the data word, received low byte first
+ * \param[in] options SMBUS_OPTION_*
+ * \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide)
+ * \sa
+ * \note
+ * \warning
+ */
+FTDI_API FT_STATUS SMBUS_ReadWord(FT_HANDLE handle, uint32 deviceAddress, uint8 command,
+	uint16 *value, uint32 options)
+{
+	FT_STATUS status;
+	uint8 in[3];
+#ifdef ENABLE_PARAMETER_CHECKING
+	CHECK_NULL_RET(value);
+#endif
+
+	status = SMBUS_Transfer(handle,deviceAddress,&command,1,in,2,options);
+	if(FT_OK == status)
+		*value = (uint16)(in[0] | (in[1] << 8));
+	return status;
+}
+
+/*!
+ * \brief Process call protocol
+ *
+ * A data word is written and a data word read back, in a single round trip.
+ *
+ * \param[in] handle Handle of the channel
+ * \param[in] deviceAddress Address of the SMBus device
+ * \param[in] command Command code
+ * \param[in] value Data word written
+ * \param[out] result Pointer to the data word read
+ * \param[in] options SMBUS_OPTION_*
+ * \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide)
+ * \sa
+ * \note
+ * \warning
+ */
+FTDI_API FT_STATUS SMBUS_ProcessCall(FT_HANDLE handle, uint32 deviceAddress, uint8 command,
+	uint16 value, uint16 *result, uint32 options)
+{
+	FT_STATUS status;
+	uint8 out[3];
+	uint8 in[3];
+#ifdef ENABLE_PARAMETER_CHECKING
+	CHECK_NULL_RET(result);
+#endif
+
+	out[0] = command;
+	out[1] = (uint8)(value & 0xFF);
+	out[2] = (uint8)(value >> 8);
+	status = SMBUS_Transfer(handle,deviceAddress,out,3,in,2,options);
+	if(FT_OK == status)
+		*result = (uint16)(in[0] | (in[1] << 8));
+	return status;
+}
+
+/*!
+ * \brief Block write protocol
+ *
+ * \param[in] handle Handle of the channel
+ * \param[in] deviceAddress Address of the SMBus device
+ * \param[in] command Command code
+ * \param[in] buffer Pointer to the data bytes
+ * \param[in] count Number of data bytes, at most SMBUS_BLOCK_MAX
+ * \param[in] options SMBUS_OPTION_*
+ * \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide)
+ * \sa
+ * \note
+ * \warning
+ */
+FTDI_API FT_STATUS SMBUS_BlockWrite(FT_HANDLE handle, uint32 deviceAddress, uint8 command,
+	uint8 *buffer, uint32 count, uint32 options)
+{
+	FT_STATUS status=FT_OK;
+	uint8 out[SMBUS_BLOCK_MAX+3];
+#ifdef ENABLE_PARAMETER_CHECKING
+	if(count > 0)
+		CHECK_NULL_RET(buffer);
+	if(count > SMBUS_BLOCK_MAX)
+		return FT_INVALID_PARAMETER;
+#endif
+
+	out[0] = command;
+	out[1] = (uint8)count;
+	if(count > 0)
+	{
+		INFRA_MEMCPY(&out[2],buffer,count);
+	}
+	status = SMBUS_Transfer(handle,deviceAddress,out,count+2,NULL,0,options);
+	return status;
+}
+
+/*!
+ * \brief Block read protocol
+ *
+ * The byte count and the data are read in a single round trip: as the count isn't known when
+ * the commands are made, SMBUS_BLOCK_MAX bytes(plus the PEC) are always read after it, the last
+ * one being nAcked. Whatever was read after the data is discarded.
+ *
+ * \param[in] handle Handle of the channel
+ * \param[in] deviceAddress Address of the SMBus device
+ * \param[in] command Command code
+ * \param[out] buffer Pointer to a buffer of SMBUS_BLOCK_MAX bytes for the data
+ * \param[out] count Pointer to the number of data bytes the device returned
+ * \param[in] options SMBUS_OPTION_*
+ * \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide)
+ * \sa
+ * \note FT_IO_ERROR is returned if the device returned a count above SMBUS_BLOCK_MAX
+ * \warning
+ */
+FTDI_API FT_STATUS SMBUS_BlockRead(FT_HANDLE handle, uint32 deviceAddress, uint8 command,
+	uint8 *buffer, uint32 *count, uint32 options)
+{
+	FT_STATUS status=FT_OK;
+	I2C_Msg msgs[2];
+	uint8 in[SMBUS_BLOCK_MAX+2];
+	FN_ENTER;
+#ifdef ENABLE_PARAMETER_CHECKING
+	CHECK_NULL_RET(buffer);
+	CHECK_NULL_RET(count);
+#endif
+
+	msgs[0].addr = deviceAddress;
+	msgs[0].flags = 0;
+	msgs[0].len = 1;
+	msgs[0].buf = &command;
+	msgs[1].addr = deviceAddress;
+	msgs[1].flags = I2C_MSG_READ;
+	msgs[1].len = SMBUS_BLOCK_MAX + 1 + ((options & SMBUS_OPTION_PEC)?1:0);
+	msgs[1].buf = in;
+	*count = 0;
+	status = I2C_Transfer(handle,msgs,2);
+	if(FT_OK == status)
+	{
+		if(in[0] > SMBUS_BLOCK_MAX)
+		{
+			DBG(MSG_ERR,"block count %u is too large\n",(unsigned)in[0]);
+			status = FT_IO_ERROR;
+		}
+		else if((options & SMBUS_OPTION_PEC) &&
+			!SMBUS_CheckPec(deviceAddress,&command,1,in,in[0]+1))
+		{
+			status = FT_IO_ERROR;
+		}
+		else
+		{
+			*count = in[0];
+			INFRA_MEMCPY(buffer,&in[1],in[0]);
+		}
+	}
+	FN_EXIT;
+	return status;
+}
+
+/*!
+ * \brief Computes the Packet Error Code of some bytes
+ *
+ * The PEC is a CRC-8. Four bytes are folded in per step with four lookup tables(slice-by-4).
+ *
+ * \param[in] crc PEC of the preceding bytes, 0 to start
+ * \param[in] data Pointer to the bytes
+ * \param[in] length Number of bytes
+ * \return PEC of the preceding bytes and these bytes
+ * \sa
+ * \note The addresses(with the read/write bit) are part of the data the PEC covers
+ * \warning
+ */
+FTDI_API uint8 SMBUS_Pec(uint8 crc, const uint8 *data, uint32 length)
+{
+	for(; length >= SMBUS_PEC_SLICES; length -= SMBUS_PEC_SLICES, data += SMBUS_PEC_SLICES)
+	{
+		crc = SMBUS_PecTable[3][crc ^ data[0]] ^ SMBUS_PecTable[2][data[1]] ^
+			SMBUS_PecTable[1][data[2]] ^ SMBUS_PecTable[0][data[3]];
+	}
+	for(; length > 0; length--)
+		crc = SMBUS_PecTable[0][crc ^ *data++];
+	return crc;
+}
+
+
+/******************************************************************************/
+/*						Local function definitions						  */
+/******************************************************************************/
+
+/*!
+ * \brief Checks the PEC that follows the data read
+ *
+ * \param[in] deviceAddress Address of the SMBus device
+ * \param[in] out Bytes written before the read, NULL if there were none
+ * \param[in] outLen Number of bytes written
+ * \param[in] in Bytes read, followed by the PEC
+ * \param[in] inLen Number of bytes read, without the PEC
+ * \return TRUE if the PEC matches
+ * \sa
+ * \note
+ * \warning
+ */
+bool SMBUS_CheckPec(uint32 deviceAddress, const uint8 *out, uint32 outLen, const uint8 *in,
+	uint32 inLen)
+{
+	uint8 address;
+	uint8 crc=0;
+
+	if(outLen > 0)
+	{
+		address = SMBUS_ADDRESS_WRITE(deviceAddress);
+		crc = SMBUS_Pec(crc,&address,1);
+		crc = SMBUS_Pec(crc,out,outLen);
+	}
+	address = SMBUS_ADDRESS_READ(deviceAddress);
+	crc = SMBUS_Pec(crc,&address,1);
+	crc = SMBUS_Pec(crc,in,inLen);
+	if(crc != in[inLen])
+	{
+		DBG(MSG_ERR,"PEC mismatch, got 0x%x expected 0x%x\n",(unsigned)in[inLen],
+			(unsigned)crc);
+		return FALSE;
+	}
+	return TRUE;
+}
+
+/*!
+ * \brief Writes and/or reads the bytes of an SMBus protocol
+ *
+ * The write(if any) and the read(if any) are made into one combined transaction, so that every
+ * protocol costs a single round trip(see I2C_Transfer).
+ *
+ * \param[in] handle Handle of the channel
+ * \param[in] deviceAddress Address of the SMBus device
+ * \param[in] out Bytes to be written, with room for one more byte(the PEC) after them
+ * \param[in] outLen Number of bytes to be written
+ * \param[out] in Buffer for the bytes read, with room for one more byte(the PEC) after them
+ * \param[in] inLen Number of bytes to be read
+ * \param[in] options SMBUS_OPTION_*
+ * \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide)
+ * \sa
+ * \note
+ * \warning
+ */
+FT_STATUS SMBUS_Transfer(FT_HANDLE handle, uint32 deviceAddress, uint8 *out, uint32 outLen,
+	uint8 *in, uint32 inLen, uint32 options)
+{
+	FT_STATUS status;
+	I2C_Msg msgs[2];
+	uint32 m=0;
+	uint8 address;
+	bool pec;
+
+	pec = (options & SMBUS_OPTION_PEC)?TRUE:FALSE;
+	if(outLen > 0)
+	{
+		if(pec && (0 == inLen))
+		{/* the PEC ends a write */
+			address = SMBUS_ADDRESS_WRITE(deviceAddress);
+			out[outLen] = SMBUS_Pec(SMBUS_Pec(0,&address,1),out,outLen);
+			outLen++;
+		}
+		msgs[m].addr = deviceAddress;
+		msgs[m].flags = 0;
+		msgs[m].len = outLen;
+		msgs[m].buf = out;
+		m++;
+	}
+	if(inLen > 0)
+	{
+		msgs[m].addr = deviceAddress;
+		msgs[m].flags = I2C_MSG_READ;
+		msgs[m].len = inLen + (pec?1:0);
+		msgs[m].buf = in;
+		m++;
+	}
+	status = I2C_Transfer(handle,msgs,m);
+	if((FT_OK == status) && pec && (inLen > 0) &&
+		!SMBUS_CheckPec(deviceAddress,out,outLen,in,inLen))
+	{
+		status = FT_IO_ERROR;
+	}
+	return status;
+}
+
@@ -36,6 +36,7 @@
 #include "ftdi_common.h"	/*Common across I2C, SPI, JTAG modules*/
 #include "ftdi_spi.h"		/*SPI specific*/
 #include "ftdi_mid.h"		/*Middle layer*/
+#include "ftdi_sched.h"		/*Scheduler, SPI specific parts are implemented here*/
 
 
 /******************************************************************************/
@@ -58,6 +59,11 @@ SPI_TRANSFER_OPTIONS_SIZE_IN_BYTES bit is set in the transferOptions parameter w
 calling SPI_Read or SPI_Write */
 #define ENABLE_MULTI_BYTE_TRANSFER	1
 
+/* Used by SPI_SchedBusTime: time taken by a chip select change, and the clock rate assumed for
+channels that were not initialized */
+#define SPI_SCHED_CS_NS			500
+#define SPI_SCHED_MIN_CLOCK		1000
+
 
 /******************************************************************************/
 /*								Local function declarations					  */
@@ -67,10 +73,17 @@ FT_STATUS SPI_AddChannelConfig(FT_HANDLE handle);
 FT_STATUS SPI_DelChannelConfig(FT_HANDLE handle);
 FT_STATUS SPI_SaveChannelConfig(FT_HANDLE handle, ChannelConfig *config);
 FT_STATUS SPI_GetChannelConfig(FT_HANDLE handle, ChannelConfig **config);
+ChannelContext* SPI_GetChannelContext(FT_HANDLE handle);
 FT_STATUS SPI_DisplayList(void);
 /* Read/Write functions */
 FT_STATUS SPI_Write8bits(FT_HANDLE handle,uint8 byte, uint8 len, uint8 lsb);
 FT_STATUS SPI_Read8bits(FT_HANDLE handle,uint8 *byte, uint8 len, uint8 lsb);
+uint32 SPI_AddCS(ChannelConfig *config, uint8 *buffer, bool state);
+FT_STATUS SPI_Recover(FT_HANDLE handle, ChannelContext *context);
+ChannelContext* SPI_BeginTransfer(FT_HANDLE handle);
+void SPI_EndTransfer(ChannelContext *context, FT_STATUS status);
+uint32 SPI_AddReadWrite(const ChannelConfig *config, uint8 *buffer, const uint8 *data,
+	uint32 dataLength, uint32 sizeToTransfer);
 //FT_STATUS SPI_ToggleCS(FT_HANDLE handle, bool state);
 
 
@@ -104,6 +117,8 @@ FT_STATUS SPI_Read8bits(FT_HANDLE handle,uint8 *byte, uint8 len, uint8 lsb);
  * \note FT2232H has 2 MPSSE ports
  * \note FT4232H has 4 ports but only 2 of them have MPSSEs
  * so call to this function will return 2 if a FT4232 is connected to it.
+ * \note The devices are enumerated by this function only, SPI_GetChannelInfo and
+ * SPI_OpenChannel use the channel list taken by the last call to it
  * \warning
  */
 FTDI_API FT_STATUS SPI_GetNumChannels(uint32 *numChannels)
@@ -181,6 +196,37 @@ FTDI_API FT_STATUS SPI_OpenChannel(uint32 index, FT_HANDLE *handle)
 	return status;
 }
 
+/*!
+ * \brief Opens a channel by its serial number, description or location and returns a handle to it
+ *
+ * This function opens the channel directly, without enumerating the devices or going through
+ * the channel indexes, so that a given adapter can be opened regardless of what else is
+ * connected to the host system
+ *
+ * \param[in] arg Serial number or description(string), or location ID(cast to a pointer)
+ * \param[in] flags FT_OPEN_BY_SERIAL_NUMBER, FT_OPEN_BY_DESCRIPTION or FT_OPEN_BY_LOCATION
+ * \param[out] handle Pointer to the handle of the opened channel
+ * \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide)
+ * \sa SPI_OpenChannel
+ * \note The serial number and description of each port of a multi port chip end with the
+ * letter of the port, e.g. "FT2232H A"
+ * \warning Only the ports that have an MPSSE can be used
+ */
+FTDI_API FT_STATUS SPI_OpenChannelEx(void *arg, uint32 flags, FT_HANDLE *handle)
+{
+	FT_STATUS status;
+	FN_ENTER;
+#ifdef ENABLE_PARAMETER_CHECKING
+	CHECK_NULL_RET(handle);
+#endif
+	status = FT_OpenChannelEx(SPI,arg,flags,handle);
+	CHECK_STATUS(status);
+	status=SPI_AddChannelConfig(*handle);
+	CHECK_STATUS(status);
+	FN_EXIT;
+	return status;
+}
+
 
 /*!
  * \brief Initializes a channel
@@ -312,6 +358,7 @@ FTDI_API FT_STATUS SPI_CloseChannel(FT_HANDLE handle)
 	CHECK_STATUS(status);
 	if(FT_OK == status)
 	{
+		SCHED_Exit(handle);
 		status=SPI_DelChannelConfig(handle);
 		CHECK_STATUS(status);
 	}
@@ -319,6 +366,89 @@ FTDI_API FT_STATUS SPI_CloseChannel(FT_HANDLE handle)
 	return status;
 }
 
+/*!
+ * \brief Recovers a channel after a failed transfer
+ *
+ * This function brings a channel back into a known state without closing it: stale data is
+ * drained, the MPSSE is resyncronized(and reset if it doesn't respond), and the clock and the
+ * current directions and values of the pins, CS included, are restored from the channel's
+ * configuration data.
+ *
+ * \param[in] handle Handle of the channel
+ * \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide)
+ * \sa SPI_InitChannel
+ * \note The transfer functions do this on their own before the first transfer that follows a
+ *		failed one, so it only has to be called to recover a channel straight away
+ * \warning
+ */
+FTDI_API FT_STATUS SPI_RecoverChannel(FT_HANDLE handle)
+{
+	FT_STATUS status;
+	ChannelContext *context;
+	FN_ENTER;
+#ifdef ENABLE_PARAMETER_CHECKING
+	CHECK_NULL_RET(handle);
+#endif
+	LOCK_CHANNEL(handle);
+	context = SPI_GetChannelContext(handle);
+	if(NULL == context)
+	{
+		UNLOCK_CHANNEL(handle);
+		return FT_INVALID_HANDLE;
+	}
+	status = SPI_Recover(handle,context);
+	UNLOCK_CHANNEL(handle);
+	FN_EXIT;
+	return status;
+}
+
+/*!
+ * \brief Calibrates the transport settings of a channel
+ *
+ * This function measures the candidate latency timers and USB transfer sizes on the device,
+ * applies the best ones for the given workload and returns the best profile of every workload,
+ * so that the channel can later be switched between them using FT_SetTransportProfile.
+ *
+ * \param[in] handle Handle of the channel
+ * \param[in] workload FT_PROFILE_LATENCY for register accesses, FT_PROFILE_THROUGHPUT for block
+ *			transfers
+ * \param[out] profiles Array of FT_PROFILE_COUNT profiles indexed by workload. May be NULL
+ * \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide)
+ * \sa FT_SetTransportProfile, SPI_CONFIG_OPTION_CALIBRATE_LATENCY,
+ *		SPI_CONFIG_OPTION_CALIBRATE_THROUGHPUT
+ * \note The pins are tristated while measuring, so CS has to be pulled to its inactive level
+ * \warning
+ */
+FTDI_API FT_STATUS SPI_CalibrateChannel(FT_HANDLE handle, uint32 workload,
+	FT_TransportProfile *profiles)
+{
+	FT_STATUS status;
+	FT_STATUS recoverStatus;
+	ChannelContext *context;
+	FN_ENTER;
+#ifdef ENABLE_PARAMETER_CHECKING
+	CHECK_NULL_RET(handle);
+#endif
+	LOCK_CHANNEL(handle);
+	context = SPI_GetChannelContext(handle);
+	if(NULL == context)
+	{
+		UNLOCK_CHANNEL(handle);
+		return FT_INVALID_HANDLE;
+	}
+	status = FT_CalibrateChannel(handle,context->config.ClockRate,workload,
+		profiles);
+	if(FT_INVALID_PARAMETER != status)
+	{/* Restores the pins */
+		recoverStatus = SPI_Recover(handle,context);
+		if(FT_OK == status)
+			status = recoverStatus;
+	}
+	UNLOCK_CHANNEL(handle);
+	FN_EXIT;
+	return status;
+}
+
 /*!
  * \brief Reads data from a SPI slave device
  *
@@ -347,6 +477,7 @@ FTDI_API FT_STATUS SPI_Read(FT_HANDLE handle, uint8 *buffer,
 	uint8 byte = 0;
 	uint8 bitsToTransfer=0;
 	uint8 lsb = 0;
+	ChannelContext *context;
 
 	
 	FN_ENTER;
@@ -356,6 +487,7 @@ FTDI_API FT_STATUS SPI_Read(FT_HANDLE handle, uint8 *buffer,
 	CHECK_NULL_RET(sizeTransferred);
 #endif
 	LOCK_CHANNEL(handle);
+	context = SPI_BeginTransfer(handle);
 
 	if(transferOptions & SPI_TRANSFER_OPTIONS_LSB_FIRST)
 	{
@@ -450,6 +582,7 @@ FTDI_API FT_STATUS SPI_Read(FT_HANDLE handle, uint8 *buffer,
 		status = SPI_ToggleCS(handle,FALSE);
 		CHECK_STATUS(status);
 	}
+	SPI_EndTransfer(context,status);
 	UNLOCK_CHANNEL(handle);
 	DBG(MSG_DEBUG,"sizeToTransfer=%u  sizeTransferred=%u BitMode=%u \
 		CS_Enable=%u CS_Disable=%u\n", sizeToTransfer,*sizeTransferred,
@@ -489,6 +622,7 @@ FTDI_API FT_STATUS SPI_Write(FT_HANDLE handle, uint8 *buffer,
 	uint8 bitsToTransfer=0;
 
 	uint8 lsb = 0;
+	ChannelContext *context;
 	FN_ENTER;
 
 #ifdef ENABLE_PARAMETER_CHECKING
@@ -497,6 +631,7 @@ FTDI_API FT_STATUS SPI_Write(FT_HANDLE handle, uint8 *buffer,
 	CHECK_NULL_RET(sizeTransferred);
 #endif
 	LOCK_CHANNEL(handle);
+	context = SPI_BeginTransfer(handle);
 	status = SPI_GetChannelConfig(handle,&config);
 	CHECK_STATUS(status);
 	/* Mode is given by bit1-bit0 of ChannelConfig.Options */
@@ -591,6 +726,7 @@ FTDI_API FT_STATUS SPI_Write(FT_HANDLE handle, uint8 *buffer,
 		status = SPI_ToggleCS(handle,FALSE);
 		CHECK_STATUS(status);
 	}
+	SPI_EndTransfer(context,status);
 	UNLOCK_CHANNEL(handle);
 	DBG(MSG_DEBUG,"sizeToTransfer=%u  sizeTransferred=%u BitMode=%u \
 		CS_Enable=%u CS_Disable=%u\n",sizeToTransfer,*sizeTransferred,		\
@@ -633,7 +769,8 @@ FTDI_API FT_STATUS SPI_ReadWrite(FT_HANDLE handle, uint8 *inBuffer,
 	uint8 mode;
 	uint8 bitsToTransfer=0;
 	uint32 noOfBytesTransferred=0;
-	uint8 cmdBuffer[10];
+	uint8 cmdBuffer[3];
+	ChannelContext *context;
 	FN_ENTER;
 
 #ifdef ENABLE_PARAMETER_CHECKING
@@ -644,6 +781,7 @@ FTDI_API FT_STATUS SPI_ReadWrite(FT_HANDLE handle, uint8 *inBuffer,
 #endif
 
 	LOCK_CHANNEL(handle);
+	context = SPI_BeginTransfer(handle);
 	status = SPI_GetChannelConfig(handle,&config);
 	CHECK_STATUS(status);
 
@@ -794,6 +932,7 @@ FTDI_API FT_STATUS SPI_ReadWrite(FT_HANDLE handle, uint8 *inBuffer,
 		status = SPI_ToggleCS(handle,FALSE);
 		CHECK_STATUS(status);
 	}
+	SPI_EndTransfer(context,status);
 	UNLOCK_CHANNEL(handle);
 
 	FN_EXIT;
@@ -819,8 +958,10 @@ FTDI_API FT_STATUS SPI_IsBusy(FT_HANDLE handle, bool *state)
 	FT_STATUS status=FT_OTHER_ERROR;
 	uint32 noOfBytes=0,noOfBytesTransferred=0;
 	uint8 buffer[10];
+	ChannelContext *context;
 
 	FN_ENTER;
+	context = SPI_BeginTransfer(handle);
 	/*Enable CS*/
 	SPI_ToggleCS(handle, TRUE);
 	/*Send command to read*/
@@ -843,6 +984,7 @@ FTDI_API FT_STATUS SPI_IsBusy(FT_HANDLE handle, bool *state)
 
 	/*Disable CS*/
 	SPI_ToggleCS(handle, FALSE);
+	SPI_EndTransfer(context,status);
 	FN_EXIT;
 	return status;
 }
@@ -930,6 +1072,82 @@ FTDI_API FT_STATUS SPI_ChangeCS(FT_HANDLE handle, uint32 configOptions)
 	return status;
 }
 
+/*!
+ * \brief Polls a status register of an SPI slave until a condition holds
+ *
+ * This function reads the slave's status over and over until (status & mask) equals expected,
+ * e.g. to wait for the end of an erase or program cycle. Rather than making a round trip per
+ * read, batches of reads are queued and checked as they come back(see Mid_PollSamples), so that
+ * most waits end after a single round trip.
+ *
+ * Each sample asserts CS, clocks out the command followed by one dummy byte, and deasserts CS.
+ * The byte clocked in with the dummy byte is the status.
+ *
+ * \param[in] handle Handle of the channel
+ * \param[in] command Pointer to the bytes that make the slave return its status(e.g. 0x05 for
+ *			the read status register command of SPI flashes)
+ * \param[in] commandLength Number of bytes in command, may be 0
+ * \param[in] mask Bits of the status to be compared
+ * \param[in] expected Value the masked bits are waited for
+ * \param[in] timeout Time in milliseconds after which polling is given up
+ * \param[out] value Pointer to the status of the matching sample, or of the last sample on
+ *			timeout. May be NULL
+ * \param[out] elapsedUs Pointer to the time in microseconds from the start of the poll until the
+ *			matching sample was received. May be NULL
+ * \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide)
+ * \sa
+ * \note FT_OTHER_ERROR is returned if the condition didn't hold within the timeout. At least
+ *		one batch is always sampled, so a timeout of 0 checks the status once
+ * \warning The samples queued after the matching one are still clocked out on the bus
+ */
+FTDI_API FT_STATUS SPI_PollStatus(FT_HANDLE handle, uint8 *command, uint32 commandLength,
+	uint8 mask, uint8 expected, uint32 timeout, uint8 *value, uint32 *elapsedUs)
+{
+	FT_STATUS status=FT_OK;
+	ChannelContext *context;
+	ChannelConfig *config;
+	uint8 *sample;
+	uint32 readLen;
+	uint32 i;
+	FN_ENTER;
+#ifdef ENABLE_PARAMETER_CHECKING
+	CHECK_NULL_RET(handle);
+	if(commandLength > 0)
+		CHECK_NULL_RET(command);
+#endif
+
+	LOCK_CHANNEL(handle);
+	context = SPI_BeginTransfer(handle);
+	if(NULL == context)
+	{
+		UNLOCK_CHANNEL(handle);
+		return FT_INVALID_HANDLE;
+	}
+	config = &(context->config);
+
+	readLen = commandLength + 1;
+	sample = (uint8*) INFRA_MALLOC(3 + 3 + readLen + 3);
+	if(NULL == sample)
+	{
+		SPI_EndTransfer(context,FT_OK);
+		UNLOCK_CHANNEL(handle);
+		return FT_INSUFFICIENT_RESOURCES;
+	}
+	i = SPI_AddCS(config,sample,TRUE);
+	/* a dummy byte after the command clocks in the status */
+	i += SPI_AddReadWrite(config,&sample[i],command,commandLength,readLen);
+	i += SPI_AddCS(config,&sample[i],FALSE);
+
+	/* The status is the last byte read in each sample */
+	status = Mid_PollSamples(SPI,handle,sample,i,readLen,0,readLen-1,mask,expected,timeout,
+		value,elapsedUs,&context->pollBatch);
+	INFRA_FREE(sample);
+	SPI_EndTransfer(context,MID_POLL_TRANSFER_STATUS(status));
+	UNLOCK_CHANNEL(handle);
+	FN_EXIT;
+	return status;
+}
+
 /******************************************************************************/
 /*						Local function definations						  */
 /******************************************************************************/
@@ -958,6 +1176,7 @@ FT_STATUS SPI_AddChannelConfig(FT_HANDLE handle)
 #ifdef NO_LINKED_LIST
 	status = FT_OK;
 #else
+	Infra_Lock();
 	if(NULL == ListHead)
 	{/* Add first node */
 		ListHead = (ChannelContext *) INFRA_MALLOC(sizeof(ChannelContext));
@@ -969,6 +1188,8 @@ FT_STATUS SPI_AddChannelConfig(FT_HANDLE handle)
 		else
 		{
 			ListHead->handle = handle;
+			ListHead->pollBatch = 0;
+			ListHead->dirty = FALSE;
 			ListHead->next = NULL;
 			status = FT_OK;
 		}
@@ -989,11 +1210,14 @@ FT_STATUS SPI_AddChannelConfig(FT_HANDLE handle)
 		else
 		{
 			tempNode->handle = handle;
+			tempNode->pollBatch = 0;
+			tempNode->dirty = FALSE;
 			tempNode->next = NULL;
 			lastNode->next = tempNode;
 			status = FT_OK;
 		}
 	}
+	Infra_Unlock();
 #endif
 	FN_EXIT;
 #ifdef INFRA_DEBUG_ENABLE
@@ -1024,6 +1248,7 @@ FT_STATUS SPI_DelChannelConfig(FT_HANDLE handle)
 #ifdef NO_LINKED_LIST
 	status = FT_OK;
 #else
+	Infra_Lock();
 	if(NULL == ListHead)
 	{
 		DBG(MSG_NOTICE,"List is empty\n");
@@ -1056,6 +1281,7 @@ FT_STATUS SPI_DelChannelConfig(FT_HANDLE handle)
 			}
 		}
 	}
+	Infra_Unlock();
 #endif
 	status=FT_OK;
 	FN_EXIT;
@@ -1092,6 +1318,7 @@ FT_STATUS SPI_SaveChannelConfig(FT_HANDLE handle, ChannelConfig *config)
 		channelContext.handle = handle;
 		status = FT_OK;
 #else
+	Infra_Lock();
 	if(NULL == ListHead)
 	{
 		DBG(MSG_NOTICE,"List is empty\n");
@@ -1111,6 +1338,7 @@ FT_STATUS SPI_SaveChannelConfig(FT_HANDLE handle, ChannelConfig *config)
 			}
 		}
 	}
+	Infra_Unlock();
 #endif
 
 	FN_EXIT;
@@ -1150,6 +1378,7 @@ FT_STATUS SPI_GetChannelConfig(FT_HANDLE handle, ChannelConfig **config)
 		else
 			DBG(MSG_DEBUG,"handle not found in channel config list\n");
 #else
+	Infra_Lock();
 	if(NULL == ListHead)
 	{
 		DBG(MSG_NOTICE,"List is empty\n");
@@ -1165,6 +1394,7 @@ FT_STATUS SPI_GetChannelConfig(FT_HANDLE handle, ChannelConfig **config)
 			}
 		}
 	}
+	Infra_Unlock();
 #endif
 
 	FN_EXIT;
@@ -1174,6 +1404,38 @@ FT_STATUS SPI_GetChannelConfig(FT_HANDLE handle, ChannelConfig **config)
 	return status;
 }
 
+/*!
+ * \brief Retrieves the context of a channel
+ *
+ * This function traverses the channel configuration data linked list and returns the node of the
+ * channel with the given handle
+ *
+ * \param[in] handle Handle of the channel
+ * \return Pointer to the channel's context, NULL if the handle wasn't found
+ * \sa SPI_GetChannelConfig
+ * \note
+ * \warning
+ */
+ChannelContext* SPI_GetChannelContext(FT_HANDLE handle)
+{
+	ChannelContext *tempNode=NULL;
+	FN_ENTER;
+#ifdef NO_LINKED_LIST
+	if(handle == channelContext.handle)
+		tempNode = &channelContext;
+#else
+	Infra_Lock();
+	for(tempNode=ListHead; NULL != tempNode; tempNode=tempNode->next)
+	{
+		if(tempNode->handle == handle)
+			break;
+	}
+	Infra_Unlock();
+#endif
+	FN_EXIT;
+	return tempNode;
+}
+
 /*!
  * \brief Display the contents of linked list
  *
@@ -1225,12 +1487,10 @@ FT_STATUS SPI_DisplayList(void)
 FT_STATUS SPI_ToggleCS(FT_HANDLE handle, bool state)
 {
 	ChannelConfig *config=NULL;
-	bool activeLow;
 	FT_STATUS status=FT_OTHER_ERROR;
 	uint8 buffer[5];
 	uint32 i=0;
 	uint32 noOfBytesTransferred;
-	uint8 value, oldValue, direction;
 
 	FN_ENTER;
 	if(!state)
@@ -1258,6 +1518,105 @@ FT_STATUS SPI_ToggleCS(FT_HANDLE handle, bool state)
 	/*Get a pointer to the channel's configuration data and manipulate there directly*/
 	status = SPI_GetChannelConfig(handle,&config);
 	CHECK_STATUS(status);
+	i = SPI_AddCS(config,buffer,state);
+	status = FT_Channel_Write(SPI,handle,i,buffer,&noOfBytesTransferred);
+	CHECK_STATUS(status);
+#endif
+	FN_EXIT;
+	return status;
+}
+
+/*!
+ * \brief Restores the clock and the pin states of a channel
+ *
+ * \param[in] handle Handle of the channel
+ * \param[in] context Pointer to the channel's context
+ * \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide)
+ * \sa SPI_RecoverChannel, FT_RecoverChannel
+ * \note The channel is marked clean if the recovery succeeded
+ * \warning
+ */
+FT_STATUS SPI_Recover(FT_HANDLE handle, ChannelContext *context)
+{
+	FT_STATUS status;
+	uint8 buffer[3];
+
+	buffer[0] = MPSSE_CMD_SET_DATA_BITS_LOWBYTE;
+	buffer[1] = (uint8)((context->config.currentPinState & 0xFF00)>>8); /*Val*/
+	buffer[2] = (uint8)(context->config.currentPinState & 0x00FF); /*Dir*/
+	status = FT_RecoverChannel(handle,context->config.ClockRate,buffer,sizeof(buffer));
+	if(FT_OK == status)
+		context->dirty = FALSE;
+	else
+		DBG(MSG_ERR,"recovering handle 0x%x failed, status 0x%x\n",(unsigned)handle,
+			(unsigned)status);
+	return status;
+}
+
+/*!
+ * \brief Prepares the channel for a transfer
+ *
+ * A channel that a previous transfer left in an unknown state is recovered first. The channel is
+ * then marked dirty until SPI_EndTransfer finds that the transfer completed, so a transfer that
+ * returns early on an error leaves it marked.
+ *
+ * \param[in] handle Handle of the channel
+ * \return Pointer to the channel's context, NULL if the channel wasn't initialized
+ * \sa SPI_EndTransfer
+ * \note
+ * \warning
+ */
+ChannelContext* SPI_BeginTransfer(FT_HANDLE handle)
+{
+	ChannelContext *context;
+
+	context = SPI_GetChannelContext(handle);
+	if(NULL != context)
+	{
+		if(context->dirty)
+			SPI_Recover(handle,context);
+		context->dirty = TRUE;
+	}
+	return context;
+}
+
+/*!
+ * \brief Records the state in which a transfer left the channel
+ *
+ * \param[in] context Pointer to the channel's context, may be NULL
+ * \param[in] status Status of the transfer, FT_OK if everything that was written was processed
+ *			and everything the MPSSE returned was read
+ * \return none
+ * \sa SPI_BeginTransfer
+ * \note
+ * \warning
+ */
+void SPI_EndTransfer(ChannelContext *context, FT_STATUS status)
+{
+	if(NULL != context)
+		context->dirty = (FT_OK == status)?FALSE:TRUE;
+}
+
+/*!
+ * \brief Adds the command that sets the state of the CS line to a buffer
+ *
+ * This function works out the value and direction of the low byte pins with the channel's CS line
+ * turned ON/OFF, saves them as the current pin state and adds the MPSSE command that sets them.
+ *
+ * \param[in] config Pointer to the channel's configuration data
+ * \param[out] buffer Buffer to which the 3 bytes of the command are added
+ * \param[in] state TRUE if CS needs to be set, false otherwise
+ * \return Number of bytes added to the buffer
+ * \sa SPI_ToggleCS
+ * \note
+ * \warning
+ */
+uint32 SPI_AddCS(ChannelConfig *config, uint8 *buffer, bool state)
+{
+	bool activeLow;
+	uint32 i=0;
+	uint8 value, oldValue, direction;
+
 	activeLow = (config->configOptions & \
 		SPI_CONFIG_OPTION_CS_ACTIVELOW)?TRUE:FALSE;
 
@@ -1291,9 +1650,158 @@ FT_STATUS SPI_ToggleCS(FT_HANDLE handle, bool state)
 	buffer[i++]=value;		/*value*/
 	buffer[i++]=direction;	/*direction*/
 	DBG(MSG_DEBUG,"direction=0x%x value=0x%x\n",direction,value);
-	status = FT_Channel_Write(SPI,handle,i,buffer,&noOfBytesTransferred);
+	return i;
+}
+
+/*!
+ * \brief Adds the command that clocks bytes out and in at the same time to a buffer
+ *
+ * The command matching the SPI mode of the channel is added, followed by the bytes to be clocked
+ * out. Zeros are clocked out once the data runs out.
+ *
+ * \param[in] config Pointer to the channel's configuration data
+ * \param[out] buffer Buffer to which the command is added
+ * \param[in] data Bytes to be clocked out, may be NULL if dataLength is 0
+ * \param[in] dataLength Number of bytes in data
+ * \param[in] sizeToTransfer Number of bytes to be clocked, at least dataLength
+ * \return Number of bytes added to the buffer
+ * \sa
+ * \note The MPSSE returns sizeToTransfer bytes for this command
+ * \warning
+ */
+uint32 SPI_AddReadWrite(const ChannelConfig *config, uint8 *buffer, const uint8 *data,
+	uint32 dataLength, uint32 sizeToTransfer)
+{
+	uint32 i=0;
+
+	switch(config->configOptions & SPI_CONFIG_OPTION_MODE_MASK)
+	{
+		case SPI_CONFIG_OPTION_MODE1:
+		case SPI_CONFIG_OPTION_MODE2:
+			buffer[i++] = MPSSE_CMD_DATA_BYTES_IN_NEG_OUT_POS_EDGE;
+			break;
+		default:
+			buffer[i++] = MPSSE_CMD_DATA_BYTES_IN_POS_OUT_NEG_EDGE;
+	}
+	buffer[i++] = (uint8)((sizeToTransfer-1) & 0x000000FF);
+	buffer[i++] = (uint8)(((sizeToTransfer-1) & 0x0000FF00)>>8);
+	if(dataLength > 0)
+	{
+		INFRA_MEMCPY(&buffer[i],data,dataLength);
+	}
+	memset(&buffer[i+dataLength],0,sizeToTransfer-dataLength);
+	return i+sizeToTransfer;
+}
+
+/*!
+ * \brief Estimates the time the read of a sensor takes on the bus
+ *
+ * \param[in] handle Handle of the channel
+ * \param[in] recipe Pointer to how the sensor is read
+ * \return Time in nanoseconds
+ * \sa SCHED_AddSensor
+ * \note
+ * \warning
+ */
+uint32 SPI_SchedBusTime(FT_HANDLE handle, const SCHED_Recipe *recipe)
+{
+	ChannelConfig *config=NULL;
+	uint32 clockRate=SPI_SCHED_MIN_CLOCK;
+
+	if((FT_OK == SPI_GetChannelConfig(handle,&config)) && (config->ClockRate > clockRate))
+		clockRate = config->ClockRate;
+	return (uint32)((uint64)8*(recipe->commandLength + recipe->readLength)*1000000000 /
+		clockRate) + 2*SPI_SCHED_CS_NS;
+}
+
+/*!
+ * \brief Reads the sensors that are due in a tick of the scheduler
+ *
+ * One frame per sensor(chip select asserted, command clocked out, data clocked in, chip select
+ * deasserted) is added to a single buffer, which is written to the chip in one shot. The data of
+ * all the frames is then read back in one shot.
+ *
+ * \param[in] handle Handle of the channel
+ * \param[in] recipes Pointers to how each sensor is read
+ * \param[out] data Pointers to where the data read from each sensor is stored
+ * \param[out] sensorStatus Status of each sensor, always FT_OK as SPI doesn't acknowledge
+ * \param[in] count Number of sensors
+ * \return Returns status code of type FT_STATUS(see D2XX Programmer's Guide)
+ * \sa SCHED_Tick
+ * \note The chip select of each sensor is given by the address member of its recipe
+ * \warning
+ */
+FT_STATUS SPI_SchedRead(FT_HANDLE handle, const SCHED_Recipe **recipes, uint8 **data,
+	FT_STATUS *sensorStatus, uint32 count)
+{
+	FT_STATUS status;
+	ChannelConfig *config=NULL;
+	ChannelConfig frameConfig;
+	uint8 *outBuffer;
+	uint8 *inBuffer;
+	uint32 sizeToWrite=0;
+	uint32 sizeToRead=0;
+	uint32 sizeTransferred=0;
+	uint32 r;
+	uint32 i=0;
+	ChannelContext *context;
+	FN_ENTER;
+
+	context = SPI_BeginTransfer(handle);
+	status = SPI_GetChannelConfig(handle,&config);
 	CHECK_STATUS(status);
-#endif
+	for(r=0; r<count; r++)
+	{
+		sizeToWrite += 3 + 3 + recipes[r]->commandLength + recipes[r]->readLength + 3;
+		sizeToRead += recipes[r]->commandLength + recipes[r]->readLength;
+	}
+	sizeToWrite++;	/* for send immediate */
+	outBuffer = (uint8*) INFRA_MALLOC(sizeToWrite + sizeToRead);
+	if(NULL == outBuffer)
+	{
+		SPI_EndTransfer(context,FT_OK);
+		return FT_INSUFFICIENT_RESOURCES;
+	}
+	inBuffer = outBuffer + sizeToWrite;
+
+	for(r=0; r<count; r++)
+	{
+		INFRA_MEMCPY(&frameConfig,config,sizeof(ChannelConfig));
+		frameConfig.configOptions = (config->configOptions & ~SPI_CONFIG_OPTION_CS_MASK) |
+			(recipes[r]->address & SPI_CONFIG_OPTION_CS_MASK);
+		i += SPI_AddCS(&frameConfig,&outBuffer[i],TRUE);
+		i += SPI_AddReadWrite(config,&outBuffer[i],recipes[r]->command,
+			recipes[r]->commandLength,recipes[r]->commandLength + recipes[r]->readLength);
+		i += SPI_AddCS(&frameConfig,&outBuffer[i],FALSE);
+		config->currentPinState = frameConfig.currentPinState;
+	}
+	outBuffer[i++] = MPSSE_CMD_SEND_IMMEDIATE;
+
+	status = FT_Channel_Write(SPI,handle,sizeToWrite,outBuffer,&sizeTransferred);
+	if((FT_OK == status) && (sizeTransferred != sizeToWrite))
+		status = FT_IO_ERROR;
+	if(FT_OK == status)
+	{
+		status = FT_Channel_Read(SPI,handle,sizeToRead,inBuffer,&sizeTransferred);
+		if((FT_OK == status) && (sizeTransferred != sizeToRead))
+		{
+			DBG(MSG_ERR,"Requested to read %u bytes, no. of bytes read is %u\n",
+				(unsigned)sizeToRead,(unsigned)sizeTransferred);
+			status = FT_IO_ERROR;
+		}
+	}
+	if(FT_OK == status)
+	{
+		for(r=0, i=0; r<count; r++)
+		{
+			i += recipes[r]->commandLength;
+			INFRA_MEMCPY(data[r],&inBuffer[i],recipes[r]->readLength);
+			i += recipes[r]->readLength;
+			sensorStatus[r] = FT_OK;
+		}
+	}
+	INFRA_FREE(outBuffer);
+	SPI_EndTransfer(context,status);
 	FN_EXIT;
 	return status;
 }
@@ -65,6 +65,17 @@
 
 #define SPI_CONFIG_OPTION_CS_ACTIVELOW	0x00000020
 
+/* Fast initialization: the device isn't reset and the MPSSE isn't reset/re-enabled when it is
+found already running(e.g. when a channel is reopened), and the fixed waits are replaced by
+waiting for the MPSSE to echo a command */
+#define SPI_CONFIG_OPTION_FAST_INIT		0x00000080
+
+/* Calibration: after initialization the latency timer and the USB transfer sizes are measured on
+the device and the best ones for short register accesses(latency) or block transfers(throughput)
+are applied, overriding LatencyTimer */
+#define SPI_CONFIG_OPTION_CALIBRATE_LATENCY		0x00000100
+#define SPI_CONFIG_OPTION_CALIBRATE_THROUGHPUT	0x00000200
+
 
 /******************************************************************************/
 /*								Type defines								  */
@@ -106,6 +117,8 @@ typedef struct ChannelContext_t
 {
 	FT_HANDLE 		handle;
 	ChannelConfig	config;
+	uint32			pollBatch;	/* samples SPI_PollStatus queues first, learnt from the last poll */
+	bool			dirty;		/* set while the state of the device's buffers is unknown */
 	struct ChannelContext_t *next;
 }ChannelContext;
 
@@ -125,8 +138,12 @@ FTDI_API FT_STATUS SPI_GetNumChannels(uint32 *numChannels);
 FTDI_API FT_STATUS SPI_GetChannelInfo(uint32 index,
 	FT_DEVICE_LIST_INFO_NODE *chanInfo);
 FTDI_API FT_STATUS SPI_OpenChannel(uint32 index, FT_HANDLE *handle);
+FTDI_API FT_STATUS SPI_OpenChannelEx(void *arg, uint32 flags, FT_HANDLE *handle);
 FTDI_API FT_STATUS SPI_InitChannel(FT_HANDLE handle, ChannelConfig *config);
 FTDI_API FT_STATUS SPI_CloseChannel(FT_HANDLE handle);
+FTDI_API FT_STATUS SPI_RecoverChannel(FT_HANDLE handle);
+FTDI_API FT_STATUS SPI_CalibrateChannel(FT_HANDLE handle, uint32 workload,
+	FT_TransportProfile *profiles);
 FTDI_API FT_STATUS SPI_Read(FT_HANDLE handle, uint8 *buffer,
 	uint32 sizeToTransfer, uint32 *sizeTransfered, uint32 options);
 FTDI_API FT_STATUS SPI_Write(FT_HANDLE handle, uint8 *buffer,
@@ -137,6 +154,8 @@ FTDI_API FT_STATUS SPI_ReadWrite(FT_HANDLE handle, uint8 *inBuffer,
 FTDI_API FT_STATUS SPI_IsBusy(FT_HANDLE handle, bool *state);
 FTDI_API FT_STATUS SPI_ChangeCS(FT_HANDLE handle, uint32 configOptions);
 FTDI_API FT_STATUS SPI_ToggleCS(FT_HANDLE handle, bool state);
+FTDI_API FT_STATUS SPI_PollStatus(FT_HANDLE handle, uint8 *command, uint32 commandLength,
+	uint8 mask, uint8 expected, uint32 timeout, uint8 *value, uint32 *elapsedUs);
 
 /******************************************************************************/
 